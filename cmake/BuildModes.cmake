@@ -0,0 +1,107 @@
+# Build modes: sanitizers in Debug, IPO/LTO in optimized builds, and optional profile-guided optimization.
+
+get_property(CUTE_DOOM_MULTI_CONFIG GLOBAL PROPERTY GENERATOR_IS_MULTI_CONFIG)
+if(NOT CUTE_DOOM_MULTI_CONFIG AND NOT CMAKE_BUILD_TYPE)
+    # Keep the sanitized build as the default for development.
+    set(CMAKE_BUILD_TYPE
+        "Debug"
+        CACHE STRING "The build type" FORCE
+    )
+    set_property(
+        CACHE CMAKE_BUILD_TYPE PROPERTY STRINGS Debug Release RelWithDebInfo
+                                        MinSizeRel
+    )
+endif()
+
+option(CUTE_DOOM_SANITIZE "Build Debug binaries with ASan and UBSan" ON)
+if(CUTE_DOOM_SANITIZE)
+    set(CUTE_DOOM_SANITIZER_FLAGS
+        "$<$<CONFIG:Debug>:-fsanitize=address,undefined>"
+    )
+else()
+    set(CUTE_DOOM_SANITIZER_FLAGS "")
+endif()
+
+option(CUTE_DOOM_IPO "Use IPO/LTO in optimized builds, if supported" ON)
+
+include(CheckIPOSupported)
+if(CUTE_DOOM_IPO)
+    check_ipo_supported(RESULT CUTE_DOOM_IPO_SUPPORTED OUTPUT CUTE_DOOM_IPO_ERROR)
+    if(CUTE_DOOM_IPO_SUPPORTED)
+        set(CMAKE_INTERPROCEDURAL_OPTIMIZATION_RELEASE ON)
+        set(CMAKE_INTERPROCEDURAL_OPTIMIZATION_RELWITHDEBINFO ON)
+        set(CMAKE_INTERPROCEDURAL_OPTIMIZATION_MINSIZEREL ON)
+    else()
+        message(STATUS "IPO is not supported: ${CUTE_DOOM_IPO_ERROR}")
+    endif()
+endif()
+
+set(CUTE_DOOM_PGO
+    "OFF"
+    CACHE STRING "Profile-guided optimization: OFF, GENERATE or USE"
+)
+set_property(CACHE CUTE_DOOM_PGO PROPERTY STRINGS OFF GENERATE USE)
+set(CUTE_DOOM_PGO_DIR
+    "${PROJECT_BINARY_DIR}/pgo-profile"
+    CACHE PATH "Where profiles are written (GENERATE) or read (USE)"
+)
+set(CUTE_DOOM_PGO_TRAINING_ARGS
+    "-benchinit 100"
+    CACHE STRING "The arguments of each cute-doom run of the pgo-train target"
+)
+set(CUTE_DOOM_PGO_TRAINING_RUNS
+    "5"
+    CACHE STRING "How many times the pgo-train target runs cute-doom"
+)
+
+if(CUTE_DOOM_PGO STREQUAL "GENERATE")
+    if(CMAKE_C_COMPILER_ID MATCHES "Clang")
+        add_compile_options("-fprofile-generate=${CUTE_DOOM_PGO_DIR}")
+        add_link_options("-fprofile-generate=${CUTE_DOOM_PGO_DIR}")
+    else()
+        # The log writer and trace decoder are threads, so the counters have to be updated atomically. The prefix
+        # keeps the build directory out of the profile names, so another build directory can use them.
+        add_compile_options(
+            "-fprofile-generate=${CUTE_DOOM_PGO_DIR}" -fprofile-update=atomic
+            "-fprofile-prefix-path=${PROJECT_BINARY_DIR}"
+        )
+        add_link_options("-fprofile-generate=${CUTE_DOOM_PGO_DIR}")
+    endif()
+elseif(CUTE_DOOM_PGO STREQUAL "USE")
+    if(CMAKE_C_COMPILER_ID MATCHES "Clang")
+        add_compile_options(
+            "-fprofile-use=${CUTE_DOOM_PGO_DIR}/default.profdata"
+            -Wno-profile-instr-unprofiled
+        )
+        add_link_options("-fprofile-use=${CUTE_DOOM_PGO_DIR}/default.profdata")
+    else()
+        # Code the training run never reached is still optimized normally instead of for size.
+        add_compile_options(
+            "-fprofile-use=${CUTE_DOOM_PGO_DIR}" -fprofile-partial-training
+            "-fprofile-prefix-path=${PROJECT_BINARY_DIR}" -Wno-missing-profile
+        )
+        add_link_options("-fprofile-use=${CUTE_DOOM_PGO_DIR}")
+    endif()
+elseif(NOT CUTE_DOOM_PGO STREQUAL "OFF")
+    message(FATAL_ERROR "Unknown CUTE_DOOM_PGO mode '${CUTE_DOOM_PGO}'")
+endif()
+
+# Builds an instrumented Release binary, trains it, and rebuilds Release with the profile. The optimized binary ends up
+# in pgo/use.
+if(NOT CUTE_DOOM_PGO STREQUAL "GENERATE")
+    find_program(CUTE_DOOM_LLVM_PROFDATA llvm-profdata)
+    add_custom_target(
+        pgo-train
+        COMMAND
+            "${CMAKE_COMMAND}" "-DSOURCE_DIR=${PROJECT_SOURCE_DIR}"
+            "-DBINARY_DIR=${PROJECT_BINARY_DIR}/pgo"
+            "-DC_COMPILER=${CMAKE_C_COMPILER}"
+            "-DCOMPILER_ID=${CMAKE_C_COMPILER_ID}"
+            "-DLLVM_PROFDATA=${CUTE_DOOM_LLVM_PROFDATA}"
+            "-DTRAINING_ARGS=${CUTE_DOOM_PGO_TRAINING_ARGS}"
+            "-DTRAINING_RUNS=${CUTE_DOOM_PGO_TRAINING_RUNS}" -P
+            "${PROJECT_SOURCE_DIR}/cmake/PgoTrain.cmake"
+        USES_TERMINAL
+        VERBATIM
+    )
+endif()
@@ -43,10 +43,10 @@ function(declare_module NAME)
         -Werror=unused-function
         -Werror=unused-parameter
         -Werror=unused-variable
-        -fsanitize=address,undefined
+        ${CUTE_DOOM_SANITIZER_FLAGS}
     )
     target_link_options(
-        ${DM_TARGET_NAME} ${DM_PUBLICITY} -fsanitize=address,undefined
+        ${DM_TARGET_NAME} ${DM_PUBLICITY} ${CUTE_DOOM_SANITIZER_FLAGS}
     )
     if(DM_INTERNAL_INCLUDE)
         target_include_directories(
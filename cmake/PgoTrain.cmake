@@ -0,0 +1,54 @@
+# Run by the pgo-train target: instrumented build, training runs, optimized build.
+
+set(PROFILE_DIR "${BINARY_DIR}/profile")
+file(REMOVE_RECURSE "${PROFILE_DIR}")
+
+function(run_checked)
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        list(JOIN ARGN " " command)
+        message(FATAL_ERROR "'${command}' failed: ${result}")
+    endif()
+endfunction()
+
+function(build_stage STAGE MODE PROFILE)
+    run_checked(
+        "${CMAKE_COMMAND}" -S "${SOURCE_DIR}" -B "${BINARY_DIR}/${STAGE}"
+        -DCMAKE_BUILD_TYPE=Release "-DCMAKE_C_COMPILER=${C_COMPILER}"
+        "-DCUTE_DOOM_PGO=${MODE}" "-DCUTE_DOOM_PGO_DIR=${PROFILE}"
+    )
+    # A stale profile from an earlier training run must not leak into this one.
+    run_checked("${CMAKE_COMMAND}" --build "${BINARY_DIR}/${STAGE}" --clean-first)
+endfunction()
+
+message(STATUS "pgo-train: building the instrumented binary")
+build_stage(generate GENERATE "${PROFILE_DIR}")
+
+message(STATUS "pgo-train: training (${TRAINING_RUNS} runs)")
+separate_arguments(training_args NATIVE_COMMAND "${TRAINING_ARGS}")
+foreach(run RANGE 1 ${TRAINING_RUNS})
+    execute_process(
+        COMMAND "${BINARY_DIR}/generate/cute-doom" ${training_args}
+        WORKING_DIRECTORY "${BINARY_DIR}"
+        OUTPUT_QUIET
+        RESULT_VARIABLE result
+    )
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "Training run ${run} failed: ${result}")
+    endif()
+endforeach()
+
+if(COMPILER_ID MATCHES "Clang")
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "llvm-profdata is needed to merge Clang profiles")
+    endif()
+    file(GLOB raw_profiles "${PROFILE_DIR}/*.profraw")
+    run_checked(
+        "${LLVM_PROFDATA}" merge "-output=${PROFILE_DIR}/default.profdata"
+        ${raw_profiles}
+    )
+endif()
+
+message(STATUS "pgo-train: building the optimized binary")
+build_stage(use USE "${PROFILE_DIR}")
+message(STATUS "pgo-train: done; see ${BINARY_DIR}/use")
@@ -0,0 +1,15 @@
+#include <doom/log/flight.h>
+
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <flight recorder file>\n", argv[0]);
+        return 2;
+    }
+    if (!doom_log_flight_dump(argv[1], stdout)) {
+        fprintf(stderr, "%s: could not read %s as a flight recorder file\n", argv[0], argv[1]);
+        return 1;
+    }
+    return 0;
+}
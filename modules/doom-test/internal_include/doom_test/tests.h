@@ -0,0 +1,18 @@
+#pragma once
+
+#include <stdbool.h>
+
+#define DOOM_TEST_TESTS_X                                                                                              \
+    X(colormap)                                                                                                        \
+    X(flight)                                                                                                          \
+    X(input)                                                                                                           \
+    X(instance)                                                                                                        \
+    X(subscriptions)                                                                                                   \
+    X(tranmap)
+
+///
+/// \brief Each test sets up its own instance and returns whether it passed, after logging why not.
+///
+#define X(x) bool doom_test_##x(void);
+DOOM_TEST_TESTS_X
+#undef X
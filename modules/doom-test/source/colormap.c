@@ -0,0 +1,113 @@
+#include "doom_test/tests.h"
+
+#include <doom/init.h>
+#include <doom/misc/defaults.h>
+#include <doom/state.h>
+#include <doom/sys/clock.h>
+#include <doom/video/colormap.h>
+#include <doom/video/palette.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+enum
+{
+    wad_header_size = 12,
+    wad_entry_size = 16,
+    // Each frame gives the worker building the new set a moment; far more than it needs.
+    max_frames = 10000,
+};
+
+static const char sc_wad_path[] = "doom-test-colormap.wad";
+
+static bool s_write_wad(void);
+static const doom_video_colormaps_t* s_wait_for_change(const doom_video_colormaps_t* from);
+
+bool doom_test_colormap(void) {
+    if (!s_write_wad()) {
+        fprintf(stderr, "could not write %s\n", sc_wad_path);
+        return false;
+    }
+    char* argv[] = {"doom-test", "-iwad", (char*)sc_wad_path, "-notranmapcache", NULL};
+    doom_state_t* state = doom_instance_new(4, argv);
+    bool passed = true;
+
+    const doom_video_colormaps_t* initial = doom_video_colormaps();
+    int32_t gamma = doom_state->defaults_storage.usegamma;
+    if (initial == NULL || initial->key.gamma != gamma) {
+        fprintf(stderr, "there are no colormaps for usegamma %d after init\n", gamma);
+        doom_instance_free(&state);
+        remove(sc_wad_path);
+        return false;
+    }
+
+    // Changing usegamma at runtime builds a new set with the gamma applied to its palette.
+    int32_t brighter = gamma == doom_video_colormap_gamma_levels - 1 ? 0 : doom_video_colormap_gamma_levels - 1;
+    doom_misc_default_set_integer(doom_misc_default_find("usegamma"), brighter);
+    const doom_video_colormaps_t* rebuilt = s_wait_for_change(initial);
+    if (rebuilt == initial) {
+        fprintf(stderr, "the colormaps weren't rebuilt after usegamma changed\n");
+        passed = false;
+    } else {
+        if (rebuilt->key.gamma != brighter || rebuilt->key.palette_hash != initial->key.palette_hash) {
+            fprintf(stderr, "the rebuilt colormaps are for usegamma %d, not %d\n", rebuilt->key.gamma, brighter);
+            passed = false;
+        }
+        if (memcmp(rebuilt->palette, initial->palette, doom_video_palette_bytes) == 0) {
+            fprintf(stderr, "the rebuilt palette doesn't have the new gamma applied\n");
+            passed = false;
+        }
+    }
+
+    // Going back reuses the first set.
+    doom_misc_default_set_integer(doom_misc_default_find("usegamma"), gamma);
+    const doom_video_colormaps_t* restored = s_wait_for_change(rebuilt);
+    if (restored != initial) {
+        fprintf(stderr, "going back to usegamma %d didn't reuse its colormaps\n", gamma);
+        passed = false;
+    }
+
+    doom_instance_free(&state);
+    remove(sc_wad_path);
+    return passed;
+}
+
+bool s_write_wad(void) {
+    // A WAD with nothing but a PLAYPAL of one palette: a ramp through every channel.
+    uint8_t playpal[doom_video_palette_bytes];
+    for (size_t i = 0; i < doom_video_palette_bytes; i++) {
+        playpal[i] = (uint8_t)(i / 3 * (i % 3 + 1));
+    }
+    uint8_t header[wad_header_size] = {'I', 'W', 'A', 'D', 1, 0, 0, 0};
+    uint32_t directory = wad_header_size + doom_video_palette_bytes;
+    for (size_t i = 0; i < 4; i++) {
+        header[8 + i] = (uint8_t)(directory >> (8 * i));
+    }
+    uint8_t entry[wad_entry_size] = {wad_header_size, 0, 0, 0, 0, 0, 0, 0, 'P', 'L', 'A', 'Y', 'P', 'A', 'L', 0};
+    for (size_t i = 0; i < 4; i++) {
+        entry[4 + i] = (uint8_t)((uint32_t)doom_video_palette_bytes >> (8 * i));
+    }
+
+    FILE* fp = fopen(sc_wad_path, "wb");
+    if (fp == NULL) {
+        return false;
+    }
+    bool written = fwrite(header, 1, sizeof(header), fp) == sizeof(header) &&
+                   fwrite(playpal, 1, sizeof(playpal), fp) == sizeof(playpal) &&
+                   fwrite(entry, 1, sizeof(entry), fp) == sizeof(entry);
+    return fclose(fp) == 0 && written;
+}
+
+const doom_video_colormaps_t* s_wait_for_change(const doom_video_colormaps_t* from) {
+    const doom_video_colormaps_t* colormaps = from;
+    for (int frame = 0; frame < max_frames && colormaps == from; frame++) {
+        doom_sys_clock_frame_wait();
+        colormaps = doom_video_colormaps();
+        if (colormaps == from) {
+            thrd_yield();
+        }
+    }
+    return colormaps;
+}
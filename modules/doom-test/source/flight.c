@@ -0,0 +1,87 @@
+#include "doom_test/tests.h"
+
+#include <doom/log/flight.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+enum
+{
+    // What the writer uses; the reader must reject anything else.
+    header_size = 64,
+    capacity = 64,
+};
+
+static const char sc_path[] = "doom-test-flight.bin";
+static const char sc_message[] = "hello\n";
+
+static bool s_write(uint32_t declared_header_size, uint64_t declared_capacity, size_t file_size);
+static bool s_dump(char* text, size_t text_size);
+
+bool doom_test_flight(void) {
+    bool passed = true;
+    char text[256];
+
+    if (!s_write(header_size, capacity, header_size + capacity) || !s_dump(text, sizeof(text)) ||
+        strcmp(text, sc_message) != 0) {
+        fprintf(stderr, "a well-formed recording wasn't dumped\n");
+        passed = false;
+    }
+
+    // A header size past the end of the file used to wrap the bounds check around.
+    if (!s_write(0x10000000, capacity, header_size + capacity) || s_dump(text, sizeof(text))) {
+        fprintf(stderr, "a header size past the end of the file was accepted\n");
+        passed = false;
+    }
+    if (!s_write(header_size + 8, capacity, header_size + 8 + capacity) || s_dump(text, sizeof(text))) {
+        fprintf(stderr, "a header size the writer doesn't use was accepted\n");
+        passed = false;
+    }
+    if (!s_write(header_size, capacity, header_size + capacity / 2) || s_dump(text, sizeof(text))) {
+        fprintf(stderr, "a truncated message area was accepted\n");
+        passed = false;
+    }
+    if (!s_write(header_size, capacity, header_size / 2) || s_dump(text, sizeof(text))) {
+        fprintf(stderr, "a truncated header was accepted\n");
+        passed = false;
+    }
+
+    remove(sc_path);
+    return passed;
+}
+
+bool s_write(uint32_t declared_header_size, uint64_t declared_capacity, size_t file_size) {
+    static uint8_t bytes[2 * header_size + 2 * capacity];
+    memset(bytes, 0, sizeof(bytes));
+    doom_log_flight_header_t header = {
+        .magic = {'C', 'D', 'F', 'L', 'I', 'G', 'H', 'T'},
+        .version = doom_log_flight_version,
+        .header_size = declared_header_size,
+        .capacity = declared_capacity,
+    };
+    atomic_init(&header.cursor, sizeof(sc_message) - 1);
+    memcpy(bytes, &header, sizeof(header));
+    memcpy(bytes + header_size, sc_message, sizeof(sc_message) - 1);
+
+    FILE* fp = fopen(sc_path, "wb");
+    if (fp == NULL) {
+        return false;
+    }
+    bool written = fwrite(bytes, 1, file_size, fp) == file_size;
+    return fclose(fp) == 0 && written;
+}
+
+bool s_dump(char* text, size_t text_size) {
+    FILE* out = tmpfile();
+    if (out == NULL) {
+        return false;
+    }
+    bool dumped = doom_log_flight_dump(sc_path, out);
+    rewind(out);
+    size_t length = fread(text, 1, text_size - 1, out);
+    text[length] = '\0';
+    fclose(out);
+    return dumped;
+}
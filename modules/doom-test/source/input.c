@@ -0,0 +1,58 @@
+#include "doom_test/tests.h"
+
+#include <doom/dsda/input.h>
+#include <doom/init.h>
+#include <doom/state.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static bool s_contains(const doom_dsda_input_set_t* set, doom_dsda_input_identifier_t identifier);
+static bool s_empty(const doom_dsda_input_set_t* set);
+
+bool doom_test_input(void) {
+    char* argv[] = {"doom-test", NULL};
+    doom_state_t* state = doom_instance_new(1, argv);
+    bool passed = true;
+
+    // Many defaults leave the key at 0, which is unbound, so nothing may be bound to it.
+    if (!s_empty(doom_dsda_input_actions_for_key(0))) {
+        fprintf(stderr, "inputs are bound to key 0 after init\n");
+        passed = false;
+    }
+
+    // Moving an input to key 0 unbinds it from its old key.
+    int32_t profile = doom_state->defaults_storage.input_profile;
+    doom_dsda_input_default_t binding = doom_state->input.active->bindings[doom_dsda_input_forward];
+    if (binding.key <= 0 || !s_contains(doom_dsda_input_actions_for_key(binding.key), doom_dsda_input_forward)) {
+        fprintf(stderr, "forward isn't bound to its default key %d\n", binding.key);
+        passed = false;
+    }
+    int32_t old_key = binding.key;
+    binding.key = 0;
+    doom_dsda_input_bind(profile, doom_dsda_input_forward, binding);
+    if (old_key > 0 && s_contains(doom_dsda_input_actions_for_key(old_key), doom_dsda_input_forward)) {
+        fprintf(stderr, "forward is still bound to key %d after unbinding it\n", old_key);
+        passed = false;
+    }
+    if (!s_empty(doom_dsda_input_actions_for_key(0))) {
+        fprintf(stderr, "unbinding forward bound it to key 0\n");
+        passed = false;
+    }
+
+    doom_instance_free(&state);
+    return passed;
+}
+
+bool s_contains(const doom_dsda_input_set_t* set, doom_dsda_input_identifier_t identifier) {
+    return (set->words[identifier / 64] >> (identifier % 64) & 1) != 0;
+}
+
+bool s_empty(const doom_dsda_input_set_t* set) {
+    for (size_t i = 0; i < doom_dsda_input_set_words; i++) {
+        if (set->words[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,61 @@
+#include "doom_test/tests.h"
+
+#include <doom/init.h>
+#include <doom/log/printf.h>
+#include <doom/state.h>
+#include <doom/sys/jobs.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+static void s_fail(void* userdata);
+
+bool doom_test_instance(void) {
+    // With a worker, a failing init phase may run on either thread.
+    doom_sys_jobs_start(1);
+    bool passed = true;
+
+    // A fatal error during init ends only the new instance.
+    char* missing_argv[] = {"doom-test", "-iwad", "doom-test-missing.wad", NULL};
+    doom_state_t* missing = doom_instance_new(3, missing_argv);
+    if (missing != NULL || doom_state != NULL) {
+        fprintf(stderr, "an instance whose IWAD is missing was created\n");
+        doom_instance_free(&missing);
+        passed = false;
+    }
+
+    char* argv[] = {"doom-test", NULL};
+    doom_state_t* state = doom_instance_new(1, argv);
+    if (state == NULL) {
+        fprintf(stderr, "could not create an instance after a failed one\n");
+        doom_sys_jobs_stop();
+        return false;
+    }
+    int32_t exit_code = doom_instance_run(state, s_fail, NULL);
+    if (exit_code != -1) {
+        fprintf(stderr, "a fatal error in doom_instance_run() returned %d\n", exit_code);
+        passed = false;
+    }
+    doom_instance_free(&state);
+
+    // The worker that ran the failed task is still there for the next instance.
+    if (doom_sys_jobs_worker_count() != 1) {
+        fprintf(stderr, "the worker pool has %zu workers after the failures\n", doom_sys_jobs_worker_count());
+        passed = false;
+    }
+    state = doom_instance_new(1, argv);
+    if (state == NULL) {
+        fprintf(stderr, "could not create an instance after a failed run\n");
+        passed = false;
+    }
+    doom_instance_free(&state);
+
+    doom_sys_jobs_stop();
+    return passed;
+}
+
+void s_fail(void* userdata) {
+    (void)userdata;
+    doom_log_error("Failing on purpose");
+}
@@ -0,0 +1,30 @@
+#include "doom_test/tests.h"
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+typedef struct {
+    const char* name;
+    bool (*run)(void);
+} s_test_t;
+
+static const s_test_t sc_tests[] = {
+#define X(x) {#x, doom_test_##x},
+    DOOM_TEST_TESTS_X
+#undef X
+};
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        fprintf(stderr, "usage: %s <test>\n", argv[0]);
+        return 2;
+    }
+    for (size_t i = 0; i < sizeof(sc_tests) / sizeof(sc_tests[0]); i++) {
+        if (strcmp(sc_tests[i].name, argv[1]) == 0) {
+            return sc_tests[i].run() ? 0 : 1;
+        }
+    }
+    fprintf(stderr, "%s: no test named %s\n", argv[0], argv[1]);
+    return 2;
+}
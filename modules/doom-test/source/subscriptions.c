@@ -0,0 +1,65 @@
+#include "doom_test/tests.h"
+
+#include <doom/init.h>
+#include <doom/misc/defaults.h>
+#include <doom/misc/subscriptions.h>
+#include <doom/state.h>
+#include <doom/sys/clock.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+static void s_count(void* userdata);
+
+bool doom_test_subscriptions(void) {
+    char* argv[] = {"doom-test", NULL};
+    doom_state_t* state = doom_instance_new(1, argv);
+    bool passed = true;
+
+    int calls = 0;
+    size_t id = DOOM_MISC_SUBSCRIBE(s_count, &calls);
+    doom_misc_subscribe_default(id, "usegamma");
+    doom_misc_subscribe_default(id, "fake_contrast");
+
+    // Two changes in one frame run the callback once, at the end of the frame.
+    doom_misc_default_set_integer(doom_misc_default_find("usegamma"), 3);
+    doom_misc_default_set_boolean(doom_misc_default_find("fake_contrast"),
+                                  !doom_state->defaults_storage.fake_contrast);
+    if (calls != 0) {
+        fprintf(stderr, "the callback ran before the end of the frame\n");
+        passed = false;
+    }
+    doom_sys_clock_frame_wait();
+    if (calls != 1) {
+        fprintf(stderr, "the callback ran %d times in the first frame, not once\n", calls);
+        passed = false;
+    }
+    doom_sys_clock_frame_wait();
+    if (calls != 1) {
+        fprintf(stderr, "the callback ran again without a change\n");
+        passed = false;
+    }
+
+    // The clock follows realtic_clock_rate through its own subscription.
+    doom_misc_default_set_integer(doom_misc_default_find("realtic_clock_rate"), 200);
+    doom_sys_clock_frame_wait();
+    if (doom_state->clock.rate != 200) {
+        fprintf(stderr, "the clock runs at %d%%, not the 200%% it was set to\n", doom_state->clock.rate);
+        passed = false;
+    }
+
+    doom_misc_unsubscribe(id);
+    doom_misc_default_set_integer(doom_misc_default_find("usegamma"), 0);
+    doom_sys_clock_frame_wait();
+    if (calls != 1) {
+        fprintf(stderr, "the callback ran after unsubscribing\n");
+        passed = false;
+    }
+
+    doom_instance_free(&state);
+    return passed;
+}
+
+void s_count(void* userdata) {
+    int* calls = userdata;
+    (*calls)++;
+}
@@ -0,0 +1,117 @@
+#include "doom_test/tests.h"
+
+#include <doom/init.h>
+#include <doom/state.h>
+#include <doom/sys/jobs.h>
+#include <doom/video/palette.h>
+#include <doom/video/tranmap.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <threads.h>
+#include <time.h>
+
+enum
+{
+    wad_header_size = 12,
+    wad_entry_size = 16,
+    // Init takes well under a second; running out of this means it hung.
+    timeout_seconds = 30,
+};
+
+typedef struct {
+    mtx_t mutex;
+    cnd_t finished;
+    bool done;
+    bool has_table;
+} s_init_job_t;
+
+static const char sc_wad_path[] = "doom-test-tranmap.wad";
+
+static void s_init_job(void* userdata);
+static bool s_write_wad(void);
+
+bool doom_test_tranmap(void) {
+    if (!s_write_wad()) {
+        fprintf(stderr, "could not write %s\n", sc_wad_path);
+        return false;
+    }
+
+    // Init runs as a job on the only worker, so every phase, and the tranmap generation waiting for its own jobs,
+    // happens on that worker with nobody else to take the queue.
+    doom_sys_jobs_start(1);
+    s_init_job_t job = {0};
+    if (mtx_init(&job.mutex, mtx_plain) != thrd_success || cnd_init(&job.finished) != thrd_success) {
+        fprintf(stderr, "could not create the synchronization objects\n");
+        return false;
+    }
+    doom_sys_jobs_submit(s_init_job, &job);
+
+    struct timespec deadline;
+    timespec_get(&deadline, TIME_UTC);
+    deadline.tv_sec += timeout_seconds;
+    mtx_lock(&job.mutex);
+    while (!job.done) {
+        if (cnd_timedwait(&job.finished, &job.mutex, &deadline) == thrd_timedout) {
+            break;
+        }
+    }
+    bool done = job.done;
+    bool has_table = job.has_table;
+    mtx_unlock(&job.mutex);
+    remove(sc_wad_path);
+    if (!done) {
+        // The worker is stuck, so the pool can't be stopped; exiting takes it down.
+        fprintf(stderr, "init with one worker and no tranmap cache didn't finish in %d seconds\n", timeout_seconds);
+        return false;
+    }
+
+    doom_sys_jobs_stop();
+    cnd_destroy(&job.finished);
+    mtx_destroy(&job.mutex);
+    if (!has_table) {
+        fprintf(stderr, "there is no translucency table after init\n");
+        return false;
+    }
+    return true;
+}
+
+void s_init_job(void* userdata) {
+    s_init_job_t* job = userdata;
+    char* argv[] = {"doom-test", "-iwad", (char*)sc_wad_path, "-notranmapcache", NULL};
+    doom_state_t* state = doom_instance_new(4, argv);
+    bool has_table = state != NULL && doom_video_tranmap() != NULL;
+    doom_instance_free(&state);
+
+    mtx_lock(&job->mutex);
+    job->done = true;
+    job->has_table = has_table;
+    cnd_broadcast(&job->finished);
+    mtx_unlock(&job->mutex);
+}
+
+bool s_write_wad(void) {
+    // A WAD with nothing but a PLAYPAL of one palette: a ramp through every channel.
+    uint8_t playpal[doom_video_palette_bytes];
+    for (size_t i = 0; i < doom_video_palette_bytes; i++) {
+        playpal[i] = (uint8_t)(i / 3 * (i % 3 + 1));
+    }
+    uint8_t header[wad_header_size] = {'I', 'W', 'A', 'D', 1, 0, 0, 0};
+    uint32_t directory = wad_header_size + doom_video_palette_bytes;
+    for (size_t i = 0; i < 4; i++) {
+        header[8 + i] = (uint8_t)(directory >> (8 * i));
+    }
+    uint8_t entry[wad_entry_size] = {wad_header_size, 0, 0, 0, 0, 0, 0, 0, 'P', 'L', 'A', 'Y', 'P', 'A', 'L', 0};
+    for (size_t i = 0; i < 4; i++) {
+        entry[4 + i] = (uint8_t)((uint32_t)doom_video_palette_bytes >> (8 * i));
+    }
+
+    FILE* fp = fopen(sc_wad_path, "wb");
+    if (fp == NULL) {
+        return false;
+    }
+    bool written = fwrite(header, 1, sizeof(header), fp) == sizeof(header) &&
+                   fwrite(playpal, 1, sizeof(playpal), fp) == sizeof(playpal) &&
+                   fwrite(entry, 1, sizeof(entry), fp) == sizeof(entry);
+    return fclose(fp) == 0 && written;
+}
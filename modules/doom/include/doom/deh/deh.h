@@ -0,0 +1,77 @@
+#pragma once
+
+#include "doom/deh/tables.h"
+
+#include <phyto/string/string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The version of the compiled patch cache. Bump it when the ops or the tables change meaning.
+    ///
+    doom_deh_cache_version = 1,
+};
+
+///
+/// \brief One change a patch makes: a field of a table entry is set to a value.
+///
+/// For `doom_deh_state_field_action`, the value is a state, and the field gets that state's unpatched code pointer,
+/// like a DEHACKED "Pointer" block does.
+///
+typedef struct {
+    uint8_t table;
+    uint8_t field;
+    uint16_t reserved;
+    uint32_t index;
+    int32_t value;
+} doom_deh_op_t;
+
+///
+/// \brief A compiled patch: the changes of one or more DEHACKED/BEX files, in the order they are applied.
+///
+typedef struct {
+    doom_deh_op_t* ops;
+    size_t op_count;
+    size_t op_capacity;
+} doom_deh_patch_t;
+
+///
+/// \brief Load the patches in `dehfile_1`, `dehfile_2` and after `-deh`, and apply them to the tables.
+///
+/// The compiled patch is cached in `deh.cache` in the cache directory (see doom_sys_cache_path()), or the file after
+/// `-dehcache`, keyed by a hash of the patch files.
+/// When the same patches are loaded again, they aren't parsed. `-nodehcache` disables the cache.
+///
+void doom_deh_init(void);
+
+///
+/// \brief Compile a DEHACKED or BEX patch, appending its changes.
+///
+/// This is a single pass over the text. Thing, Frame, Weapon and Pointer blocks are compiled; other blocks and BEX
+/// sections are skipped with a note in the log.
+///
+/// \param patch The patch to append to.
+/// \param text The contents of the patch file.
+/// \param name The name of the patch file, for messages.
+///
+/// \return Whether anything was compiled.
+///
+bool doom_deh_compile(doom_deh_patch_t* patch, phyto_string_span_t text, const char* name);
+
+///
+/// \brief Apply a compiled patch to the tables. Changes to entries that don't exist are ignored.
+///
+/// \param patch The patch.
+/// \param tables The tables.
+///
+void doom_deh_apply(const doom_deh_patch_t* patch, doom_deh_tables_t* tables);
+
+///
+/// \brief Free a compiled patch.
+///
+/// \param patch The patch.
+///
+void doom_deh_patch_free(doom_deh_patch_t* patch);
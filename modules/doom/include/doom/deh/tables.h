@@ -0,0 +1,178 @@
+#pragma once
+
+#include "doom/weapons.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+///
+/// \brief The fields of a state (a frame, in DEHACKED), with their names in a patch.
+///
+#define DOOM_DEH_STATE_FIELDS_X                                                                                        \
+    X(sprite, "Sprite number")                                                                                         \
+    X(frame, "Sprite subnumber")                                                                                       \
+    X(tics, "Duration")                                                                                                \
+    X(action, "Codep frame")                                                                                           \
+    X(next_state, "Next frame")                                                                                        \
+    X(misc1, "Unknown 1")                                                                                              \
+    X(misc2, "Unknown 2")
+
+///
+/// \brief The fields of a thing (map object) type, with their names in a patch.
+///
+#define DOOM_DEH_THING_FIELDS_X                                                                                        \
+    X(doomednum, "ID #")                                                                                               \
+    X(spawn_state, "Initial frame")                                                                                    \
+    X(spawn_health, "Hit points")                                                                                      \
+    X(see_state, "First moving frame")                                                                                 \
+    X(see_sound, "Alert sound")                                                                                        \
+    X(reaction_time, "Reaction time")                                                                                  \
+    X(attack_sound, "Attack sound")                                                                                    \
+    X(pain_state, "Injury frame")                                                                                      \
+    X(pain_chance, "Pain chance")                                                                                      \
+    X(pain_sound, "Pain sound")                                                                                        \
+    X(melee_state, "Close attack frame")                                                                               \
+    X(missile_state, "Far attack frame")                                                                               \
+    X(death_state, "Death frame")                                                                                      \
+    X(xdeath_state, "Exploding frame")                                                                                 \
+    X(death_sound, "Death sound")                                                                                      \
+    X(speed, "Speed")                                                                                                  \
+    X(radius, "Width")                                                                                                 \
+    X(height, "Height")                                                                                                \
+    X(mass, "Mass")                                                                                                    \
+    X(damage, "Missile damage")                                                                                        \
+    X(active_sound, "Action sound")                                                                                    \
+    X(flags, "Bits")                                                                                                   \
+    X(raise_state, "Respawn frame")
+
+///
+/// \brief The fields of a weapon, with their names in a patch.
+///
+/// "Deselect frame" really is the state the weapon is raised with; the names are from the original DEHACKED.
+///
+#define DOOM_DEH_WEAPON_FIELDS_X                                                                                       \
+    X(ammo, "Ammo type")                                                                                               \
+    X(up_state, "Deselect frame")                                                                                      \
+    X(down_state, "Select frame")                                                                                      \
+    X(ready_state, "Bobbing frame")                                                                                    \
+    X(attack_state, "Shooting frame")                                                                                  \
+    X(flash_state, "Firing frame")
+
+#define DOOM_DEH_TABLES_X                                                                                              \
+    X(state)                                                                                                           \
+    X(thing)                                                                                                           \
+    X(weapon)
+
+///
+/// \brief The tables a patch can change.
+///
+typedef enum
+{
+#define X(x) doom_deh_table_##x,
+    DOOM_DEH_TABLES_X
+#undef X
+    doom_deh_table_count,
+} doom_deh_table_t;
+
+typedef enum
+{
+#define X(field, name) doom_deh_state_field_##field,
+    DOOM_DEH_STATE_FIELDS_X
+#undef X
+    doom_deh_state_field_count,
+} doom_deh_state_field_t;
+
+typedef enum
+{
+#define X(field, name) doom_deh_thing_field_##field,
+    DOOM_DEH_THING_FIELDS_X
+#undef X
+    doom_deh_thing_field_count,
+} doom_deh_thing_field_t;
+
+typedef enum
+{
+#define X(field, name) doom_deh_weapon_field_##field,
+    DOOM_DEH_WEAPON_FIELDS_X
+#undef X
+    doom_deh_weapon_field_count,
+} doom_deh_weapon_field_t;
+
+enum
+{
+    ///
+    /// \brief The number of states in Doom 2 v1.9.
+    ///
+    doom_deh_vanilla_state_count = 967,
+
+    ///
+    /// \brief The number of thing types in Doom 2 v1.9.
+    ///
+    doom_deh_vanilla_thing_count = 137,
+};
+
+///
+/// \brief A state of the state machine that animates things and weapons.
+///
+typedef struct {
+#define X(field, name) int32_t field;
+    DOOM_DEH_STATE_FIELDS_X
+#undef X
+} doom_deh_state_t;
+
+///
+/// \brief The properties of a thing type. `flags` holds the bits as they are in a patch.
+///
+typedef struct {
+#define X(field, name) int32_t field;
+    DOOM_DEH_THING_FIELDS_X
+#undef X
+} doom_deh_thing_t;
+
+///
+/// \brief The ammo and states of a weapon.
+///
+typedef struct {
+#define X(field, name) int32_t field;
+    DOOM_DEH_WEAPON_FIELDS_X
+#undef X
+} doom_deh_weapon_t;
+
+///
+/// \brief The game data tables that DEHACKED patches change.
+///
+typedef struct {
+    doom_deh_state_t* states;
+    size_t state_count;
+
+    doom_deh_thing_t* things;
+    size_t thing_count;
+
+    doom_deh_weapon_t weapons[doom_weapon_type_count];
+} doom_deh_tables_t;
+
+///
+/// \brief Set up the tables with their unpatched contents.
+///
+/// \param tables The tables.
+///
+void doom_deh_tables_init(doom_deh_tables_t* tables);
+
+///
+/// \brief Free the tables.
+///
+/// \param tables The tables.
+///
+void doom_deh_tables_destroy(doom_deh_tables_t* tables);
+
+///
+/// \brief Get a field of a table entry.
+///
+/// \param tables The tables.
+/// \param table Which table.
+/// \param index The entry.
+/// \param field The field, from the table's field enum.
+///
+/// \return Where the field is, or NULL if the entry doesn't exist.
+///
+int32_t* doom_deh_tables_field(doom_deh_tables_t* tables, doom_deh_table_t table, size_t index, uint32_t field);
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define DOOM_DSDA_INPUT_IDENTIFIERS_X                                                                                  \
@@ -162,7 +164,8 @@ typedef enum
 } doom_dsda_input_identifier_t;
 
 ///
-/// \brief A configured input.
+/// \brief A configured input. A key of 0 is unbound, as in the defaults; buttons are unbound when negative, since
+/// button 0 is the first one.
 ///
 typedef struct {
     int32_t key;
@@ -177,3 +180,135 @@ enum
     ///
     doom_dsda_input_profile_count = 3,
 };
+
+enum
+{
+    ///
+    /// \brief The number of distinct key codes that may be bound.
+    ///
+    doom_dsda_input_key_count = 512,
+
+    ///
+    /// \brief The number of mouse buttons that may be bound.
+    ///
+    doom_dsda_input_mouse_button_count = 16,
+
+    ///
+    /// \brief The number of joystick buttons that may be bound.
+    ///
+    doom_dsda_input_joystick_button_count = 32,
+
+    ///
+    /// \brief The number of words in a `doom_dsda_input_set_t`.
+    ///
+    doom_dsda_input_set_words = (doom_dsda_input_count + 63) / 64,
+};
+
+///
+/// \brief A set of inputs, as a bitset over `doom_dsda_input_identifier_t`.
+///
+typedef struct {
+    uint64_t words[doom_dsda_input_set_words];
+} doom_dsda_input_set_t;
+
+///
+/// \brief The bindings of one input profile, along with reverse lookup tables.
+///
+/// The reverse tables are kept in sync by doom_dsda_input_bind(), so looking up the inputs bound to an event never
+/// depends on the number of inputs.
+///
+typedef struct {
+    ///
+    /// \brief The binding of each input.
+    ///
+    doom_dsda_input_default_t bindings[doom_dsda_input_count];
+
+    ///
+    /// \brief The inputs bound to each key.
+    ///
+    doom_dsda_input_set_t by_key[doom_dsda_input_key_count];
+
+    ///
+    /// \brief The inputs bound to each mouse button.
+    ///
+    doom_dsda_input_set_t by_mouse_button[doom_dsda_input_mouse_button_count];
+
+    ///
+    /// \brief The inputs bound to each joystick button.
+    ///
+    doom_dsda_input_set_t by_joystick_button[doom_dsda_input_joystick_button_count];
+} doom_dsda_input_profile_t;
+
+///
+/// \brief The input bindings of every profile.
+///
+typedef struct {
+    ///
+    /// \brief Every profile.
+    ///
+    doom_dsda_input_profile_t profiles[doom_dsda_input_profile_count];
+
+    ///
+    /// \brief The profile selected by the `input_profile` default.
+    ///
+    const doom_dsda_input_profile_t* active;
+
+    ///
+    /// \brief The subscription which keeps `active` in sync with the `input_profile` default.
+    ///
+    size_t profile_subscription;
+
+    ///
+    /// \brief The index of the `input_profile` default in `doom_state->defaults`.
+    ///
+    size_t profile_default_index;
+} doom_dsda_input_state_t;
+
+///
+/// \brief Fill every profile with the default bindings and build the reverse tables.
+///
+/// The defaults must already be loaded.
+///
+void doom_dsda_input_init(void);
+
+///
+/// \brief Change the binding of one input, updating the reverse tables of its profile.
+///
+/// \param profile The profile to change.
+/// \param identifier The input to bind.
+/// \param binding The new binding. A key of 0 or a negative button is unbound.
+///
+void doom_dsda_input_bind(int32_t profile, doom_dsda_input_identifier_t identifier, doom_dsda_input_default_t binding);
+
+///
+/// \brief Rebuild the reverse tables of a profile from its bindings.
+///
+void doom_dsda_input_rebuild(int32_t profile);
+
+///
+/// \brief Switch to the next input profile.
+///
+void doom_dsda_input_profile_cycle(void);
+
+///
+/// \brief The inputs bound to a key in the active profile. None are bound to key 0, which means unbound.
+///
+const doom_dsda_input_set_t* doom_dsda_input_actions_for_key(int32_t key);
+
+///
+/// \brief The inputs bound to a mouse button in the active profile.
+///
+const doom_dsda_input_set_t* doom_dsda_input_actions_for_mouse_button(int32_t button);
+
+///
+/// \brief The inputs bound to a joystick button in the active profile.
+///
+const doom_dsda_input_set_t* doom_dsda_input_actions_for_joystick_button(int32_t button);
+
+///
+/// \brief Check whether an input is in a set.
+///
+static inline bool doom_dsda_input_set_contains(const doom_dsda_input_set_t* set,
+                                                doom_dsda_input_identifier_t identifier) {
+    return (set->words[identifier / 64] & (UINT64_C(1) << (identifier % 64))) != 0;
+}
@@ -6,15 +6,17 @@
 #include <stdnoreturn.h>
 
 ///
-/// \brief The state of Doom.
+/// \brief The current instance of Doom on this thread.
 ///
-/// Contains most of the game state. This structure should be allocated on the heap with doom_init(), and freed with
-/// doom_quit().
+/// Contains most of the game state. The functions without an `_ex` suffix work on this instance. It is set up by
+/// doom_init() or doom_instance_new(), and each thread has its own current instance.
+///
+/// Instances are not fully independent; see doom_instance_new() for what they share.
 ///
 /// \see doom_init
-/// \see doom_quit
+/// \see doom_instance_new
 ///
-extern doom_state_t* doom_state;
+extern _Thread_local doom_state_t* doom_state;
 
 ///
 /// \brief Initialize the global Doom state.
@@ -24,8 +26,66 @@ extern doom_state_t* doom_state;
 void doom_init(int argc, char** argv);
 
 ///
-/// \brief Free the global Doom state and exit normally.
+/// \brief Run the exit hooks, free the global Doom state and exit normally.
 ///
 /// This is meant to be called directly by main().
 ///
 noreturn void doom_quit(int32_t exit_code);
+
+///
+/// \brief Work to run on an instance with doom_instance_run().
+///
+typedef void (*doom_instance_func_t)(void* userdata);
+
+///
+/// \brief Create and initialize another instance, e.g. for a headless simulation, and make it current on this thread.
+///
+/// Unlike doom_init(), this leaves process-wide settings such as logging and process_priority alone.
+///
+/// Several instances can run on separate threads. A fatal error only ends its own instance; see doom_instance_run().
+/// The subsystems still find the instance through `doom_state` rather than a parameter, and the graph tasks and jobs
+/// they start carry it over to the workers. Some things are shared by the whole process:
+///
+/// - The worker pool and logging, including the channel masks, sinks, the async writer, tracing and the flight
+///   recorder.
+/// - The cache directory. Translucency tables are cached per palette and percentage, so instances share them
+///   without conflict. The DEHACKED cache is a single file unless each instance is given its own with `-dehcache`;
+///   sharing it is safe, since it's replaced whole, but instances with different patches keep replacing each other's.
+///
+/// \param argc The number of parameters.
+/// \param argv The parameters of the instance.
+///
+/// \return The instance, or NULL if its initialization hit a fatal error.
+///
+doom_state_t* doom_instance_new(int argc, char** argv);
+
+///
+/// \brief Make an instance current on this thread and run a function on it, catching fatal errors.
+///
+/// A fatal error, such as from doom_log_error(), runs the instance's exit hooks and returns here instead of exiting
+/// the process. The instance is unusable after that, and only doom_instance_free() may be called on it. Memory that
+/// the failed code held outside of the instance leaks.
+///
+/// \param state The instance. It stays current afterwards.
+/// \param func What to run.
+/// \param userdata The argument of `func`.
+///
+/// \return 0 if `func` returned, or the exit code of the fatal error.
+///
+int32_t doom_instance_run(doom_state_t* state, doom_instance_func_t func, void* userdata);
+
+///
+/// \brief Make an instance current on this thread.
+///
+/// \param state The instance, or NULL.
+///
+void doom_instance_make_current(doom_state_t* state);
+
+///
+/// \brief Run the exit hooks of an instance and free it, without exiting.
+///
+/// If the instance is current on this thread, no instance is current afterwards.
+///
+/// \param p_state The instance. Set to NULL.
+///
+void doom_instance_free(doom_state_t** p_state);
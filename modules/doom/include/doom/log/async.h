@@ -0,0 +1,61 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DOOM_LOG_STREAMS_X                                                                                             \
+    X(stdout, 0x1U)                                                                                                    \
+    X(stderr, 0x2U)
+
+///
+/// \brief The console streams a log record is written to.
+///
+typedef enum
+{
+#define X(x, y) doom_log_stream_##x = y,
+    DOOM_LOG_STREAMS_X
+#undef X
+} doom_log_stream_t;
+
+///
+/// \brief Start the background log writer.
+///
+/// From then on, doom_log_printf() only copies each message into a lock-free ring, and the writer thread batches
+/// them to the console. The writer is stopped at exit, after every other exit hook has run.
+///
+/// \return Whether the writer was started.
+///
+bool doom_log_async_start(void);
+
+///
+/// \brief Check whether the background log writer is running.
+///
+bool doom_log_async_running(void);
+
+///
+/// \brief Queue a formatted message for the background writer.
+///
+/// If the ring is full, this waits for the writer to make room.
+///
+/// \param streams The streams to write to, as a mask of `doom_log_stream_t`.
+/// \param message The message.
+/// \param length The length of the message, at most `doom_log_max_message_length - 1`.
+///
+/// \return false if the writer is not running, in which case the caller should write the message itself.
+///
+bool doom_log_async_push(uint32_t streams, const char* message, size_t length);
+
+///
+/// \brief Wait until every message queued so far has been written and the streams are flushed.
+///
+/// Does nothing if the writer is not running.
+///
+void doom_log_async_flush(void);
+
+///
+/// \brief Flush the queue and stop the background writer.
+///
+/// Afterwards, doom_log_printf() writes synchronously again.
+///
+void doom_log_async_stop(void);
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+
+enum
+{
+    ///
+    /// \brief The version of the flight recorder file format.
+    ///
+    doom_log_flight_version = 1,
+
+    ///
+    /// \brief The size of the message area when `-flightsize` is not given.
+    ///
+    doom_log_flight_default_capacity = 1024 * 1024,
+};
+
+///
+/// \brief The header at the start of a flight recorder file. The message area follows it.
+///
+typedef struct {
+    ///
+    /// \brief "CDFLIGHT", not NUL-terminated.
+    ///
+    char magic[8];
+
+    ///
+    /// \brief `doom_log_flight_version`.
+    ///
+    uint32_t version;
+
+    ///
+    /// \brief The offset of the message area from the start of the file.
+    ///
+    uint32_t header_size;
+
+    ///
+    /// \brief The size of the message area. Always a power of two.
+    ///
+    uint64_t capacity;
+
+    ///
+    /// \brief How many bytes have been written in total. The next byte goes at `cursor % capacity`.
+    ///
+    atomic_uint_least64_t cursor;
+} doom_log_flight_header_t;
+
+///
+/// \brief Start recording log messages into a memory-mapped circular file.
+///
+/// Messages are copied into the mapping without any system calls, and the kernel writes them out even if the process
+/// crashes. Once the file is full, the oldest messages are overwritten. Every level is recorded, whatever the console
+/// shows.
+///
+/// \param path The file to record to. It is overwritten.
+/// \param capacity The size of the message area, rounded up to a power of two.
+///
+/// \return Whether recording was started.
+///
+bool doom_log_flight_start(const char* path, size_t capacity);
+
+///
+/// \brief Stop recording and unmap the file.
+///
+/// Other threads must have stopped logging by then.
+///
+void doom_log_flight_stop(void);
+
+///
+/// \brief Decode a flight recorder file, oldest message first.
+///
+/// If the file has wrapped around, the first, partly overwritten line is skipped.
+///
+/// \param path The file to read.
+/// \param out Where to write the messages.
+///
+/// \return false if the file could not be read, is not a flight recorder file, or is truncated or corrupt.
+///
+bool doom_log_flight_dump(const char* path, FILE* out);
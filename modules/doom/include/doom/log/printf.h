@@ -1,6 +1,9 @@
 #pragma once
 
+#include <config.h>
 #include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <stdnoreturn.h>
@@ -21,6 +24,81 @@ typedef enum
 #undef X
 } doom_log_level_t;
 
+// The severity of each level, compared against DOOM_LOG_MIN_SEVERITY from config.h. These are macros so that DOOM_LOG
+// can paste the level name onto them, which makes the comparison a constant.
+#define DOOM_LOG_SEVERITY_debug 0
+#define DOOM_LOG_SEVERITY_info 1
+#define DOOM_LOG_SEVERITY_warn 2
+#define DOOM_LOG_SEVERITY_error 3
+
+///
+/// \brief Check at compile time whether a level is built in, according to the `DOOM_LOG_MIN_LEVEL` CMake option.
+///
+#define DOOM_LOG_LEVEL_COMPILED(Level) (DOOM_LOG_SEVERITY_##Level >= DOOM_LOG_MIN_SEVERITY)
+
+#define DOOM_LOG_CHANNELS_X                                                                                            \
+    X(general)                                                                                                         \
+    X(system)                                                                                                          \
+    X(config)                                                                                                          \
+    X(input)                                                                                                           \
+    X(render)                                                                                                          \
+    X(sound)                                                                                                           \
+    X(wad)                                                                                                             \
+    X(count)
+
+///
+/// \brief Log channels, one per subsystem.
+///
+typedef enum
+{
+#define X(x) doom_log_channel_##x,
+    DOOM_LOG_CHANNELS_X
+#undef X
+} doom_log_channel_t;
+
+///
+/// \brief The levels enabled on each channel. Use doom_log_enabled() instead.
+///
+extern atomic_uint doom_log_channel_masks[doom_log_channel_count];
+
+///
+/// \brief The levels that some sink (the console or a registered one) would write. Use doom_log_enabled() instead.
+///
+extern atomic_uint doom_log_sink_mask;
+
+///
+/// \brief Check whether a message on a channel would be written anywhere.
+///
+static inline bool doom_log_enabled(doom_log_channel_t channel, doom_log_level_t level) {
+    return (atomic_load_explicit(&doom_log_channel_masks[channel], memory_order_relaxed) &
+            atomic_load_explicit(&doom_log_sink_mask, memory_order_relaxed) & level) != 0;
+}
+
+///
+/// \brief Log a message on a channel.
+///
+/// Nothing is evaluated or formatted unless the level is enabled on the channel, and levels below
+/// `DOOM_LOG_MIN_LEVEL` are compiled out entirely. Debug messages go to stdout when their channel has opted into
+/// debug, even though the console doesn't write debug otherwise.
+///
+/// \param Channel The channel, without the `doom_log_channel_` prefix.
+/// \param Level The level, without the `doom_log_level_` prefix.
+///
+#define DOOM_LOG(Channel, Level, ...)                                                                                  \
+    do {                                                                                                               \
+        if (DOOM_LOG_LEVEL_COMPILED(Level) && doom_log_enabled(doom_log_channel_##Channel, doom_log_level_##Level)) {  \
+            doom_log_channel_printf(doom_log_channel_##Channel, doom_log_level_##Level, __VA_ARGS__);                  \
+        }                                                                                                              \
+    } while (0)
+
+enum
+{
+    ///
+    /// \brief The maximum length of a log message, including the NUL terminator. Longer messages are truncated.
+    ///
+    doom_log_max_message_length = 2048,
+};
+
 ///
 /// \brief Logging function.
 ///
@@ -34,9 +112,85 @@ typedef enum
 ///
 int32_t doom_log_printf(doom_log_level_t level, const char* format, ...) __attribute__((format(printf, 2, 3)));
 
+///
+/// \brief Logging function for a channel. Use DOOM_LOG instead.
+///
+/// Like doom_log_printf(), but debug messages also go to stdout if the channel has debug enabled.
+///
+/// \param channel The channel.
+/// \param level Log level.
+/// \param format Format string.
+/// \param ... Format arguments.
+///
+int32_t doom_log_channel_printf(doom_log_channel_t channel, doom_log_level_t level, const char* format, ...)
+    __attribute__((format(printf, 3, 4)));
+
+enum
+{
+    ///
+    /// \brief The maximum number of sinks that can be registered with doom_log_add_sink().
+    ///
+    doom_log_max_sinks = 8,
+};
+
+///
+/// \brief A log sink, which receives every formatted message at the levels it was registered for.
+///
+/// Sinks are called synchronously by doom_log_printf(), possibly from several threads at once.
+///
+/// \param level The level of the message.
+/// \param message The message. It is NUL-terminated, but `length` should be used instead.
+/// \param length The length of the message.
+///
+typedef void (*doom_log_sink_func_t)(doom_log_level_t level, const char* message, size_t length);
+
+///
+/// \brief Register a log sink, in addition to the console.
+///
+/// Sinks should be added and removed from one thread at a time, e.g. during startup and exit.
+///
+/// \param func The sink.
+/// \param levels The levels it receives, as a mask of `doom_log_level_t`.
+///
+/// \return The sink's index, or `doom_log_max_sinks` if there is no room left.
+///
+size_t doom_log_add_sink(doom_log_sink_func_t func, uint32_t levels);
+
+///
+/// \brief Unregister a log sink.
+///
+/// \param sink The index returned by doom_log_add_sink().
+///
+void doom_log_remove_sink(size_t sink);
+
+///
+/// \brief Set the levels enabled on a channel.
+///
+/// \param channel The channel.
+/// \param levels A mask of `doom_log_level_t`.
+///
+void doom_log_set_channel_mask(doom_log_channel_t channel, uint32_t levels);
+
+///
+/// \brief Set the levels written to the console.
+///
+/// \param stdout_levels The levels written to stdout, as a mask of `doom_log_level_t`.
+/// \param stderr_levels The levels written to stderr, as a mask of `doom_log_level_t`.
+///
+void doom_log_set_console_masks(uint32_t stdout_levels, uint32_t stderr_levels);
+
+///
+/// \brief Find a channel by name.
+///
+/// \return The channel, or `doom_log_channel_count` if there is none with that name.
+///
+doom_log_channel_t doom_log_channel_from_name(const char* name);
+
 ///
 /// \brief Log an error and exit.
 ///
+/// If the background log writer is running, it is flushed before the exit hooks run.
+///
 noreturn void doom_log_error(const char* format, ...) __attribute__((format(printf, 1, 2)));
 
 ///
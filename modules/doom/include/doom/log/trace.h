@@ -0,0 +1,114 @@
+#pragma once
+
+#include "doom/log/printf.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The maximum number of arguments of a trace message. Further arguments are dropped.
+    ///
+    doom_log_trace_max_args = 8,
+};
+
+#define DOOM_LOG_TRACE_ARG_KINDS_X                                                                                     \
+    X(int)                                                                                                             \
+    X(long)                                                                                                            \
+    X(long_long)                                                                                                       \
+    X(intmax)                                                                                                          \
+    X(size)                                                                                                            \
+    X(ptrdiff)                                                                                                         \
+    X(double)                                                                                                          \
+    X(long_double)                                                                                                     \
+    X(pointer)
+
+///
+/// \brief How a trace argument was read, which is decided by its conversion specifier.
+///
+typedef enum
+{
+#define X(x) doom_log_trace_arg_kind_##x,
+    DOOM_LOG_TRACE_ARG_KINDS_X
+#undef X
+} doom_log_trace_arg_kind_t;
+
+///
+/// \brief A call site of DOOM_LOG_TRACE.
+///
+/// The format string is parsed once, by the first thread to hit the site, so later calls only copy their arguments.
+///
+typedef struct {
+    ///
+    /// \brief Whether the site is unparsed, being parsed, or parsed, after which `arg_kinds` and `arg_count` are valid.
+    ///
+    atomic_uint state;
+
+    ///
+    /// \brief The number of arguments the format string consumes.
+    ///
+    uint32_t arg_count;
+
+    ///
+    /// \brief The kind of each argument.
+    ///
+    doom_log_trace_arg_kind_t arg_kinds[doom_log_trace_max_args];
+} doom_log_trace_site_t;
+
+///
+/// \brief Whether tracing is on. Use doom_log_trace_enabled() instead.
+///
+extern atomic_bool doom_log_trace_active;
+
+///
+/// \brief Check whether tracing is on.
+///
+static inline bool doom_log_trace_enabled(void) {
+    return atomic_load_explicit(&doom_log_trace_active, memory_order_relaxed);
+}
+
+///
+/// \brief Record a trace message without formatting it.
+///
+/// This stores the call site, a timestamp and the raw argument words in a buffer owned by the calling thread. The
+/// message is formatted later by the decoder thread. Since only the pointer is kept, `%s` arguments must still be
+/// valid when the message is decoded (e.g. string literals).
+///
+/// Use DOOM_LOG_TRACE instead of calling this directly.
+///
+void doom_log_trace_write(doom_log_trace_site_t* site, const char* format, ...) __attribute__((format(printf, 2, 3)));
+
+///
+/// \brief Record a debug trace message, if tracing is on.
+///
+/// The arguments are not evaluated when tracing is off, and the whole call is compiled out when `DOOM_LOG_MIN_LEVEL` is
+/// above debug.
+///
+#define DOOM_LOG_TRACE(Format, ...)                                                                                    \
+    do {                                                                                                               \
+        if (DOOM_LOG_LEVEL_COMPILED(debug) && doom_log_trace_enabled()) {                                              \
+            static doom_log_trace_site_t s_trace_site_;                                                                \
+            doom_log_trace_write(&s_trace_site_, Format, ##__VA_ARGS__);                                               \
+        }                                                                                                              \
+    } while (0)
+
+///
+/// \brief Turn tracing on, decoding the messages to a file on a background thread.
+///
+/// \param path The file to write decoded messages to.
+///
+/// \return Whether tracing was started.
+///
+bool doom_log_trace_start(const char* path);
+
+///
+/// \brief Decode and write out every message recorded so far.
+///
+void doom_log_trace_flush(void);
+
+///
+/// \brief Turn tracing off, write out the remaining messages and stop the decoder.
+///
+void doom_log_trace_stop(void);
@@ -26,6 +26,23 @@ int32_t doom_misc_check_parameter(const char* parameter);
 ///
 int32_t doom_misc_check_parameter_ex(const char* parameter, doom_misc_parameters_t params);
 
+///
+/// \brief Get the argument following a parameter, e.g. the file name in `-record file`.
+///
+/// \param parameter The parameter to look for.
+///
+/// \return A copy of the argument, to be freed with nonstd_free(), or NULL if the parameter is not present or has no
+/// argument.
+///
+char* doom_misc_parameter_argument(const char* parameter);
+
+///
+/// \brief Get the argument following a parameter in an explicit parameter list.
+///
+/// \see doom_misc_parameter_argument
+///
+char* doom_misc_parameter_argument_ex(const char* parameter, doom_misc_parameters_t params);
+
 ///
 /// \brief Add one parameter to the state's argv.
 ///
@@ -33,6 +50,14 @@ int32_t doom_misc_check_parameter_ex(const char* parameter, doom_misc_parameters
 ///
 void doom_misc_add_parameter(const char* parameter);
 
+///
+/// \brief Add one parameter to an explicit parameter list.
+///
+/// \param parameter The parameter to add.
+/// \param params The parameter list, usually an instance's `params`.
+///
+void doom_misc_add_parameter_ex(const char* parameter, doom_misc_parameters_t* params);
+
 ///
 /// \brief Parse the command line and set up doom_state->argv.
 ///
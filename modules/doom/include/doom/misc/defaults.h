@@ -199,10 +199,49 @@ typedef struct {
 PHYTO_COLLECTIONS_DYNAMIC_ARRAY_DECL(doom_misc_default_dyarray, doom_misc_default_t);
 
 ///
-/// \brief Construct an array of defaults, already filled with the default values.
+/// \brief Construct an array of defaults for the current instance, already filled with the default values.
+///
+/// \see doom_misc_default_dyarray_new_ex
 ///
 doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void);
 
+///
+/// \brief Find a default by name.
+///
+/// \param name The name of the default, as in the config file. The comparison is case-insensitive.
+///
+/// \return The default, or NULL if there is none with that name.
+///
+doom_misc_default_t* doom_misc_default_find(const char* name);
+
+///
+/// \brief Set an integer default, clamping it to its limits, and notify subscribers if it changed.
+///
+/// \return Whether the value changed.
+///
+bool doom_misc_default_set_integer(doom_misc_default_t* entry, int32_t value);
+
+///
+/// \brief Set a hex integer default and notify subscribers if it changed.
+///
+/// \return Whether the value changed.
+///
+bool doom_misc_default_set_hex_integer(doom_misc_default_t* entry, uint32_t value);
+
+///
+/// \brief Set a boolean default and notify subscribers if it changed.
+///
+/// \return Whether the value changed.
+///
+bool doom_misc_default_set_boolean(doom_misc_default_t* entry, bool value);
+
+///
+/// \brief Set a (non-owning) string default and notify subscribers if it changed.
+///
+/// \return Whether the value changed.
+///
+bool doom_misc_default_set_string(doom_misc_default_t* entry, phyto_string_span_t value);
+
 #define DOOM_MISC_SETUP_SCREENS_X                                                                                      \
     X(none)                                                                                                            \
     X(keys)                                                                                                            \
@@ -598,6 +637,13 @@ typedef struct {
     int32_t weapon_preferences[2][doom_weapon_type_count + 1];
 } doom_misc_default_storage_t;
 
+///
+/// \brief Construct an array of defaults whose locations point into the given storage.
+///
+/// \param storage The storage that the defaults read and write, usually an instance's `defaults_storage`.
+///
+doom_misc_default_dyarray_t doom_misc_default_dyarray_new_ex(doom_misc_default_storage_t* storage);
+
 ///
 /// \brief Load default values from the config file.
 ///
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+///
+/// \brief Hash some bytes with 64-bit FNV-1a, for cache keys and telling palettes and lumps apart.
+///
+/// \param data The bytes.
+/// \param size The number of bytes.
+///
+/// \return The hash.
+///
+uint64_t doom_misc_hash(const void* data, size_t size);
+
+///
+/// \brief Continue a hash from doom_misc_hash() with more bytes, as if they had been hashed together.
+///
+/// \param hash The hash so far.
+/// \param data The bytes.
+/// \param size The number of bytes.
+///
+/// \return The hash.
+///
+uint64_t doom_misc_hash_continue(uint64_t hash, const void* data, size_t size);
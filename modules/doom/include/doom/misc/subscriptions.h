@@ -0,0 +1,120 @@
+#pragma once
+
+#include "doom/misc/defaults.h"
+
+#include <phyto/collections/dynamic_array.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+///
+/// \brief A callback run when one of the watched defaults has changed.
+///
+/// \param userdata The pointer given to doom_misc_subscribe().
+///
+typedef void (*doom_misc_subscription_func_t)(void* userdata);
+
+///
+/// \brief A subscriber to changes of some set of defaults.
+///
+typedef struct {
+    ///
+    /// \brief The callback to run.
+    ///
+    doom_misc_subscription_func_t func;
+
+    ///
+    /// \brief Passed to the callback.
+    ///
+    void* userdata;
+
+    ///
+    /// \brief The name of the subscriber, for debugging.
+    ///
+    const char* name;
+
+    ///
+    /// \brief A bitset over the indices of `doom_state->defaults`.
+    ///
+    uint64_t* watched_defaults;
+
+    ///
+    /// \brief The number of words in `watched_defaults`.
+    ///
+    size_t watched_defaults_words;
+
+    ///
+    /// \brief A bitset over `doom_misc_setup_screen_t`.
+    ///
+    uint32_t watched_screens;
+
+    ///
+    /// \brief Whether the callback should run at the next dispatch.
+    ///
+    bool pending;
+
+    ///
+    /// \brief Whether this slot is in use.
+    ///
+    bool active;
+} doom_misc_subscription_t;
+
+PHYTO_COLLECTIONS_DYNAMIC_ARRAY_DECL(doom_misc_subscription_list, doom_misc_subscription_t);
+
+///
+/// \brief Construct an empty subscription list.
+///
+doom_misc_subscription_list_t doom_misc_subscription_list_new(void);
+
+///
+/// \brief Register a subscriber. It watches nothing until doom_misc_subscribe_default() or
+/// doom_misc_subscribe_screen() is called.
+///
+/// \param func The callback to run.
+/// \param userdata Passed to the callback.
+/// \param name The name of the subscriber.
+///
+/// \return A handle for the subscriber.
+///
+size_t doom_misc_subscribe(doom_misc_subscription_func_t func, void* userdata, const char* name);
+
+// Convenience macro for doom_misc_subscribe.
+#define DOOM_MISC_SUBSCRIBE(Func, UserData) doom_misc_subscribe(Func, UserData, #Func)
+
+///
+/// \brief Watch one default.
+///
+/// A name that matches no default is logged as a warning, since the subscriber would never be called for it.
+///
+/// \param id The subscriber.
+/// \param default_name The name of the default, as in the config file.
+///
+void doom_misc_subscribe_default(size_t id, const char* default_name);
+
+///
+/// \brief Watch every default displayed on a setup screen.
+///
+/// \param id The subscriber.
+/// \param screen The setup screen.
+///
+void doom_misc_subscribe_screen(size_t id, doom_misc_setup_screen_t screen);
+
+///
+/// \brief Remove a subscriber. Its callback will not run again.
+///
+void doom_misc_unsubscribe(size_t id);
+
+///
+/// \brief Mark a default as changed.
+///
+/// This is cheap; the subscribers are only called at the next doom_misc_dispatch_subscriptions().
+///
+void doom_misc_default_changed(const doom_misc_default_t* entry);
+
+///
+/// \brief Run the callback of every subscriber whose defaults have changed since the last dispatch.
+///
+/// Each callback runs at most once per dispatch, no matter how many of its defaults changed. The frame limiter calls
+/// this once per frame, in doom_sys_clock_frame_wait().
+///
+void doom_misc_dispatch_subscriptions(void);
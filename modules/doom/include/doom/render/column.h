@@ -0,0 +1,110 @@
+#pragma once
+
+#include "doom/render/draw.h"
+#include "doom/sys/cpu.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The fractional bits of texture coordinates.
+    ///
+    doom_render_column_frac_bits = 16,
+
+    ///
+    /// \brief The iterations of each series of `-benchdraw`.
+    ///
+    doom_render_column_bench_iterations = 20,
+};
+
+///
+/// \brief The thresholds in [0, 256) that the linear filters and filter_z dither with: a 4x4 Bayer matrix.
+///
+extern const uint8_t doom_render_dither[4][4];
+
+///
+/// \brief A vertical run of pixels to draw from a texture column.
+///
+typedef struct {
+    ///
+    /// \brief The top pixel to draw.
+    ///
+    uint8_t* dest;
+
+    ///
+    /// \brief The distance between the rows of the screen, in bytes.
+    ///
+    ptrdiff_t pitch;
+
+    ///
+    /// \brief The screen position of the top pixel, which the dithered filters depend on.
+    ///
+    int32_t x;
+    int32_t y;
+
+    ///
+    /// \brief How many pixels to draw.
+    ///
+    int32_t count;
+
+    ///
+    /// \brief The texture column and its height. Texture coordinates wrap around the height.
+    ///
+    const uint8_t* source;
+    int32_t source_height;
+
+    ///
+    /// \brief The texture coordinate of the top pixel and its increase per pixel, with frac_bits fractional bits.
+    ///
+    uint32_t frac;
+    uint32_t step;
+
+    ///
+    /// \brief The light level to draw with.
+    ///
+    const uint8_t* colormap;
+
+    ///
+    /// \brief The next darker light level, which filter_z blends towards by `z_weight` out of 256.
+    ///
+    /// Must be valid even when `z_weight` is 0; point it at `colormap` then.
+    ///
+    const uint8_t* next_colormap;
+    uint32_t z_weight;
+} doom_render_column_t;
+
+///
+/// \brief Draws a column.
+///
+typedef void (*doom_render_column_func_t)(const doom_render_column_t* column);
+
+///
+/// \brief Get the column drawer for a texture filter and an instruction set.
+///
+/// Point and none both sample the nearest texel. Linear dithers between the two nearest texels with an ordered (Bayer)
+/// pattern, as a paletted screen can't blend. Rounded samples the texel nearest to the pixel center, rather than the
+/// one the pixel starts in. Every variant draws the same pixels as the scalar one.
+///
+/// \param filter The texture filter.
+/// \param isa The instruction set, which the CPU must support.
+///
+/// \return The drawer, or NULL if the instruction set isn't built for this target.
+///
+doom_render_column_func_t doom_render_column_drawer(doom_render_draw_filter_type_t filter, doom_sys_cpu_isa_t isa);
+
+///
+/// \brief Draw a column with the best drawer for this CPU.
+///
+/// \param column The column.
+/// \param filter The texture filter, e.g. filter_wall or filter_sprite.
+///
+void doom_render_draw_column(const doom_render_column_t* column, doom_render_draw_filter_type_t filter);
+
+///
+/// \brief Time every drawer on synthetic full-height columns at 1080p and 4K, and report pixels per second.
+///
+/// The results are reported and written as JSON like the other benchmarks.
+///
+void doom_render_column_bench(void);
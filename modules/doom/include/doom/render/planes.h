@@ -0,0 +1,206 @@
+#pragma once
+
+#include "doom/render/draw.h"
+#include "doom/render/span.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The top row of a column of a visplane that isn't drawn.
+    ///
+    doom_render_planes_unset = UINT16_MAX,
+};
+
+///
+/// \brief The area of the screen covered by one floor or ceiling: its rows in each column of [min_x, max_x].
+///
+typedef struct {
+    ///
+    /// \brief What is drawn: the height of the surface in map units, the flat and the light level in [0, 256).
+    ///
+    int32_t height;
+    int32_t pic;
+    int32_t light;
+
+    ///
+    /// \brief The columns it covers; `min_x > max_x` while it covers none.
+    ///
+    int32_t min_x;
+    int32_t max_x;
+
+    ///
+    /// \brief The offset in the pool's slab of its top rows, one per column of the view; its bottom rows follow them.
+    /// A column is empty while its top is `doom_render_planes_unset`.
+    ///
+    size_t rows;
+
+    ///
+    /// \brief The next visplane in the same hash bucket, or `SIZE_MAX`.
+    ///
+    size_t next;
+} doom_render_visplane_t;
+
+///
+/// \brief The visplanes of a frame. It grows as needed, so a frame can have any number of them.
+///
+/// Visplanes are referred to by index, as growing the pool moves them.
+///
+typedef struct {
+    ///
+    /// \brief The size of the view.
+    ///
+    int32_t width;
+    int32_t height;
+
+    doom_render_visplane_t* planes;
+    size_t plane_count;
+    size_t plane_capacity;
+
+    ///
+    /// \brief The top and bottom rows of every visplane, `2 * width` per visplane.
+    ///
+    uint16_t* slab;
+
+    ///
+    /// \brief The first visplane of each bucket, hashed by (height, pic, light), or `SIZE_MAX`. The bucket count is a
+    /// power of two.
+    ///
+    size_t* buckets;
+    size_t bucket_count;
+
+    ///
+    /// \brief The column each row's open span started in, while drawing.
+    ///
+    int32_t* span_start;
+
+    ///
+    /// \brief The flat being drawn, with the padding the span drawers need.
+    ///
+    uint8_t flat[doom_render_span_flat_size * doom_render_span_flat_size + doom_render_span_source_padding];
+} doom_render_planes_t;
+
+///
+/// \brief Gets the 64x64 texels of a flat, or NULL to leave the plane undrawn.
+///
+typedef const uint8_t* (*doom_render_planes_flat_func_t)(int32_t pic, void* userdata);
+
+///
+/// \brief Where the visplanes are seen from and how they are drawn.
+///
+typedef struct {
+    ///
+    /// \brief The top left pixel of the view and the distance between its rows, in bytes.
+    ///
+    uint8_t* screen;
+    ptrdiff_t pitch;
+
+    ///
+    /// \brief The screen position of the view axis, and the distance of the projection plane in pixels; `center_x`
+    /// for a 90 degree field of view.
+    ///
+    float center_x;
+    float center_y;
+    float projection;
+
+    ///
+    /// \brief The eye position in map units, and the cosine and sine of the view angle.
+    ///
+    float view_x;
+    float view_y;
+    float view_z;
+    float view_cos;
+    float view_sin;
+
+    ///
+    /// \brief Gets the flats.
+    ///
+    doom_render_planes_flat_func_t flat;
+    void* userdata;
+
+    ///
+    /// \brief The light levels, 256 bytes each from the brightest; usually the 32 of COLORMAP.
+    ///
+    const uint8_t* colormaps;
+    int32_t colormap_count;
+
+    ///
+    /// \brief The texture filter, usually filter_floor, and the light filter, usually filter_z. A linear light filter
+    /// dithers between the two nearest light levels.
+    ///
+    doom_render_draw_filter_type_t filter;
+    doom_render_draw_filter_type_t z_filter;
+} doom_render_planes_view_t;
+
+///
+/// \brief Create an empty pool for a view.
+///
+/// \param planes The pool.
+/// \param width The width of the view.
+/// \param height The height of the view.
+///
+void doom_render_planes_init(doom_render_planes_t* planes, int32_t width, int32_t height);
+
+///
+/// \brief Free the pool.
+///
+/// \param planes The pool.
+///
+void doom_render_planes_destroy(doom_render_planes_t* planes);
+
+///
+/// \brief Empty the pool for the next frame, keeping its memory.
+///
+/// \param planes The pool.
+///
+void doom_render_planes_clear(doom_render_planes_t* planes);
+
+///
+/// \brief Find the visplane for a surface, creating an empty one if there is none.
+///
+/// Every floor and ceiling with the same height, flat and light shares it, so their spans are merged where they meet.
+///
+/// \param planes The pool.
+/// \param height The height of the surface.
+/// \param pic The flat.
+/// \param light The light level.
+///
+/// \return The index of the visplane.
+///
+size_t doom_render_planes_find(doom_render_planes_t* planes, int32_t height, int32_t pic, int32_t light);
+
+///
+/// \brief Get a visplane that columns [start, stop] can be marked in.
+///
+/// That is the visplane itself, extended to them, unless it already covers one of them; then it's a new visplane for
+/// the same surface.
+///
+/// \param planes The pool.
+/// \param plane The index of the visplane.
+/// \param start The first column.
+/// \param stop The last column.
+///
+/// \return The index of the visplane to mark.
+///
+size_t doom_render_planes_check(doom_render_planes_t* planes, size_t plane, int32_t start, int32_t stop);
+
+///
+/// \brief Mark rows [top, bottom] of a column as covered by a visplane. Rows outside the view are dropped.
+///
+/// \param planes The pool.
+/// \param plane The index of the visplane.
+/// \param x The column, which `doom_render_planes_check()` gave the visplane.
+/// \param top The first row.
+/// \param bottom The last row.
+///
+void doom_render_planes_mark(doom_render_planes_t* planes, size_t plane, int32_t x, int32_t top, int32_t bottom);
+
+///
+/// \brief Draw every visplane, one span per horizontal run of rows.
+///
+/// \param planes The pool.
+/// \param view The view.
+///
+void doom_render_planes_draw(doom_render_planes_t* planes, const doom_render_planes_view_t* view);
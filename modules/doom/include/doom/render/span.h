@@ -0,0 +1,100 @@
+#pragma once
+
+#include "doom/render/draw.h"
+#include "doom/sys/cpu.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The width and height of a flat.
+    ///
+    doom_render_span_flat_size = 64,
+
+    ///
+    /// \brief How many bytes past its 64x64 texels a flat given to a span drawer must be readable, as the SIMD drawers
+    /// read 4 bytes for each texel they need.
+    ///
+    doom_render_span_source_padding = 4,
+
+    ///
+    /// \brief The shortest span the AVX2 drawer takes; shorter ones don't pay for its setup.
+    ///
+    doom_render_span_min_avx2_count = 32,
+};
+
+///
+/// \brief A horizontal run of pixels to draw from a flat.
+///
+typedef struct {
+    ///
+    /// \brief The leftmost pixel to draw.
+    ///
+    uint8_t* dest;
+
+    ///
+    /// \brief The screen position of the leftmost pixel, which the dithered filters depend on.
+    ///
+    int32_t x;
+    int32_t y;
+
+    ///
+    /// \brief How many pixels to draw.
+    ///
+    int32_t count;
+
+    ///
+    /// \brief The flat: 64 rows of 64 texels, followed by source_padding readable bytes. It repeats in both directions.
+    ///
+    const uint8_t* source;
+
+    ///
+    /// \brief The flat coordinates of the leftmost pixel and their increase per pixel, with column frac_bits fractional
+    /// bits.
+    ///
+    uint32_t xfrac;
+    uint32_t yfrac;
+    uint32_t xstep;
+    uint32_t ystep;
+
+    ///
+    /// \brief The light level to draw with.
+    ///
+    const uint8_t* colormap;
+
+    ///
+    /// \brief The next darker light level, which filter_z blends towards by `z_weight` out of 256.
+    ///
+    /// Must be valid even when `z_weight` is 0; point it at `colormap` then.
+    ///
+    const uint8_t* next_colormap;
+    uint32_t z_weight;
+} doom_render_span_t;
+
+///
+/// \brief Draws a span.
+///
+typedef void (*doom_render_span_func_t)(const doom_render_span_t* span);
+
+///
+/// \brief Get the span drawer for a texture filter and an instruction set.
+///
+/// The filters work like the column drawers', in both directions. Every variant draws the same pixels as the scalar
+/// one.
+///
+/// \param filter The texture filter, e.g. filter_floor.
+/// \param isa The instruction set, which the CPU must support.
+///
+/// \return The drawer, or NULL if the instruction set isn't built for this target.
+///
+doom_render_span_func_t doom_render_span_drawer(doom_render_draw_filter_type_t filter, doom_sys_cpu_isa_t isa);
+
+///
+/// \brief Draw a span with the best drawer for this CPU.
+///
+/// \param span The span.
+/// \param filter The texture filter.
+///
+void doom_render_draw_span(const doom_render_span_t* span, doom_render_draw_filter_type_t filter);
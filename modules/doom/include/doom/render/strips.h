@@ -0,0 +1,109 @@
+#pragma once
+
+#include "doom/state.h"
+
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <threads.h>
+
+enum
+{
+    ///
+    /// \brief The frames of each series of `-benchstrips`.
+    ///
+    doom_render_strips_bench_frames = 60,
+};
+
+///
+/// \brief Renders the columns [first_x, end_x) of the view. Called on several threads at once, for disjoint columns,
+/// so it may only read the shared frame state.
+///
+typedef void (*doom_render_strip_func_t)(int32_t first_x, int32_t end_x, void* userdata);
+
+///
+/// \brief The view split into vertical strips, each rendered by one thread.
+///
+/// The strip boundaries follow the cost of the previous frames: each strip is timed, its time is spread over its
+/// columns, and the next frame splits the columns so every strip costs about the same.
+///
+typedef struct {
+    ///
+    /// \brief The width of the view, in columns.
+    ///
+    int32_t width;
+
+    ///
+    /// \brief How many strips the view is split into; the threads that render a frame.
+    ///
+    size_t strip_count;
+
+    ///
+    /// \brief The first column of each strip, then `width`.
+    ///
+    int32_t* bounds;
+
+    ///
+    /// \brief How long each strip took in the last frame, in nanoseconds.
+    ///
+    uint64_t* strip_ns;
+
+    ///
+    /// \brief The estimated cost of each column, smoothed over frames.
+    ///
+    double* column_cost;
+
+    ///
+    /// \brief The frame being rendered.
+    ///
+    doom_render_strip_func_t func;
+    void* userdata;
+    doom_state_t* state;
+
+    ///
+    /// \brief The next strip for a thread to take.
+    ///
+    atomic_size_t next;
+
+    ///
+    /// \brief The jobs on the worker pool that have not returned.
+    ///
+    size_t jobs_outstanding;
+
+    mtx_t mutex;
+    cnd_t finished;
+} doom_render_strips_t;
+
+///
+/// \brief Split a view into strips of equal width.
+///
+/// \param strips The strips.
+/// \param width The width of the view.
+/// \param strip_count How many threads should render it. The pool must have at least `strip_count - 1` workers for them
+/// all to run at once.
+///
+void doom_render_strips_init(doom_render_strips_t* strips, int32_t width, size_t strip_count);
+
+///
+/// \brief Free the strips.
+///
+/// \param strips The strips.
+///
+void doom_render_strips_destroy(doom_render_strips_t* strips);
+
+///
+/// \brief Render a frame: every strip on the worker pool and this thread, then rebalance the strips by their cost.
+///
+/// \param strips The strips.
+/// \param func Renders a strip.
+/// \param userdata The argument of `func`.
+///
+void doom_render_strips_run(doom_render_strips_t* strips, doom_render_strip_func_t func, void* userdata);
+
+///
+/// \brief Render a synthetic frame of uneven cost at 4K with 1 to N threads, N being the workers plus this thread, and
+/// report the frame times and speedups.
+///
+/// The results are reported and written as JSON like the other benchmarks.
+///
+void doom_render_strips_bench(void);
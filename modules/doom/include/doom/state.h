@@ -1,10 +1,22 @@
 #pragma once
 
+#include "doom/deh/tables.h"
+#include "doom/dsda/input.h"
 #include "doom/misc/argv.h"
 #include "doom/misc/defaults.h"
+#include "doom/misc/subscriptions.h"
+#include "doom/sys/clock.h"
+#include "doom/sys/priority.h"
 #include "doom/sys/system.h"
+#include "doom/video/colormap.h"
+#include "doom/video/tranmap.h"
+#include "doom/wad/cache.h"
+#include "doom/wad/precache.h"
+#include "doom/wad/texture.h"
+#include "doom/wad/wad.h"
 
 #include <phyto/string/string.h>
+#include <setjmp.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -32,6 +44,82 @@ typedef struct {
     /// \brief The runtime configuration options.
     ///
     doom_misc_default_storage_t defaults_storage;
+
+    ///
+    /// \brief The subscribers to changes of the defaults.
+    ///
+    doom_misc_subscription_list_t subscriptions;
+
+    ///
+    /// \brief Whether any subscriber is waiting to be called.
+    ///
+    bool subscriptions_pending;
+
+    ///
+    /// \brief The input bindings.
+    ///
+    doom_dsda_input_state_t input;
+
+    ///
+    /// \brief The game clock and frame limiter.
+    ///
+    doom_sys_clock_state_t clock;
+
+    ///
+    /// \brief What process_priority was granted.
+    ///
+    doom_sys_priority_state_t priority;
+
+    ///
+    /// \brief The mounted WADs and their lump directory.
+    ///
+    doom_wad_state_t wad;
+
+    ///
+    /// \brief Decoded resources, such as composited textures.
+    ///
+    doom_wad_cache_t lump_cache;
+
+    ///
+    /// \brief The textures defined by the mounted WADs.
+    ///
+    doom_wad_textures_t textures;
+
+    ///
+    /// \brief The background precache of the current level.
+    ///
+    doom_wad_precache_t precache;
+
+    ///
+    /// \brief The state, thing and weapon tables, with the DEHACKED patches applied.
+    ///
+    doom_deh_tables_t deh;
+
+    ///
+    /// \brief The translucency table for tran_filter_pct.
+    ///
+    doom_video_tranmap_t tranmap;
+
+    ///
+    /// \brief The colormaps for the lighting settings.
+    ///
+    doom_video_colormap_engine_t colormaps;
+
+    ///
+    /// \brief Whether doom_quit() prints the allocation statistics (`-memstats`).
+    ///
+    bool print_memstats;
+
+    ///
+    /// \brief Where a fatal error unwinds to, set by doom_instance_run(). NULL for an instance that exits the process
+    /// on a fatal error, like the one from doom_init().
+    ///
+    jmp_buf* fatal_jump;
+
+    ///
+    /// \brief The exit code of the fatal error that unwound the instance.
+    ///
+    int32_t fatal_exit_code;
 } doom_state_t;
 
 ///
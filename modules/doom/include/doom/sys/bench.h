@@ -0,0 +1,114 @@
+#pragma once
+
+#include "phyto/collections/dynamic_array.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+PHYTO_COLLECTIONS_DYNAMIC_ARRAY_DECL(doom_sys_bench_samples, uint64_t);
+
+///
+/// \brief The timings of one measured step.
+///
+typedef struct {
+    ///
+    /// \brief The name of the step, e.g. a phase of startup.
+    ///
+    const char* name;
+
+    ///
+    /// \brief The time each run of the step took, in nanoseconds.
+    ///
+    doom_sys_bench_samples_t samples;
+} doom_sys_bench_series_t;
+
+PHYTO_COLLECTIONS_DYNAMIC_ARRAY_DECL(doom_sys_bench_series_list, doom_sys_bench_series_t);
+
+///
+/// \brief A benchmark: named series of timings, reported together.
+///
+typedef struct {
+    ///
+    /// \brief The name of the benchmark, e.g. "init".
+    ///
+    const char* name;
+
+    ///
+    /// \brief How many times the benchmark ran.
+    ///
+    size_t iterations;
+
+    ///
+    /// \brief The series, in the order they were first recorded.
+    ///
+    doom_sys_bench_series_list_t series;
+} doom_sys_bench_t;
+
+///
+/// \brief Summary statistics of a series.
+///
+typedef struct {
+    uint64_t min_ns;
+    uint64_t median_ns;
+    uint64_t p99_ns;
+    uint64_t max_ns;
+    double mean_ns;
+} doom_sys_bench_summary_t;
+
+///
+/// \brief Create an empty benchmark.
+///
+/// \param name The name of the benchmark. Not copied.
+///
+doom_sys_bench_t doom_sys_bench_new(const char* name);
+
+///
+/// \brief Free a benchmark.
+///
+void doom_sys_bench_free(doom_sys_bench_t* bench);
+
+///
+/// \brief Find a series by name, adding it if it is new.
+///
+/// \param name The name of the series. Not copied.
+///
+/// \return The index of the series, to pass to doom_sys_bench_record().
+///
+size_t doom_sys_bench_series(doom_sys_bench_t* bench, const char* name);
+
+///
+/// \brief Record one timing of a series.
+///
+/// \param series The index returned by doom_sys_bench_series().
+/// \param ns The time taken.
+///
+void doom_sys_bench_record(doom_sys_bench_t* bench, size_t series, uint64_t ns);
+
+///
+/// \brief Compute the summary of a series. This sorts its samples.
+///
+doom_sys_bench_summary_t doom_sys_bench_summarize(doom_sys_bench_series_t* series);
+
+///
+/// \brief Log a table with the summary of each series.
+///
+void doom_sys_bench_report(doom_sys_bench_t* bench);
+
+///
+/// \brief Write the summary of each series as JSON.
+///
+/// \param path The file to write.
+///
+/// \return Whether the file was written.
+///
+bool doom_sys_bench_write_json(doom_sys_bench_t* bench, const char* path);
+
+///
+/// \brief Read the `-benchjson` parameter, falling back to a default file name.
+///
+/// \param fallback The file to use if there is no `-benchjson` parameter.
+///
+/// \return The path, to be freed with nonstd_free().
+///
+char* doom_sys_bench_json_path(const char* fallback);
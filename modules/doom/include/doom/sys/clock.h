@@ -0,0 +1,150 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief Game tics per second at 100% speed.
+    ///
+    doom_sys_ticrate = 35,
+
+    ///
+    /// \brief How long before a frame deadline the frame limiter stops sleeping and starts spinning.
+    ///
+    /// Sleeps routinely overshoot by tens of microseconds, and sometimes by far more, so the last stretch is waited out
+    /// by polling the clock instead.
+    ///
+    doom_sys_clock_spin_ns = 500 * 1000,
+};
+
+///
+/// \brief Statistics of how far frames ended from their deadlines.
+///
+typedef struct {
+    ///
+    /// \brief The number of frames measured.
+    ///
+    uint64_t frames;
+
+    ///
+    /// \brief The mean distance from the deadline, in nanoseconds. Positive means late.
+    ///
+    double mean_ns;
+
+    ///
+    /// \brief The sum of squared differences from the mean (Welford's M2). Use doom_sys_clock_jitter_stddev_ns().
+    ///
+    double m2;
+
+    ///
+    /// \brief The earliest a frame ended, relative to its deadline.
+    ///
+    int64_t min_ns;
+
+    ///
+    /// \brief The latest a frame ended, relative to its deadline.
+    ///
+    int64_t max_ns;
+} doom_sys_clock_jitter_t;
+
+///
+/// \brief The game clock and frame limiter.
+///
+typedef struct {
+    ///
+    /// \brief The real time at which the game clock was last rebased.
+    ///
+    uint64_t base_ns;
+
+    ///
+    /// \brief The game time at `base_ns`.
+    ///
+    uint64_t base_game_ns;
+
+    ///
+    /// \brief The game speed in percent, from `realtic_clock_rate`.
+    ///
+    int32_t rate;
+
+    ///
+    /// \brief The frame limit in frames per second, from `dsda_fps_limit`. 0 means unlimited.
+    ///
+    int32_t fps_limit;
+
+    ///
+    /// \brief The deadline of the next frame, or 0 if the limiter has not started.
+    ///
+    uint64_t next_frame_ns;
+
+    ///
+    /// \brief How frames ended relative to their deadlines.
+    ///
+    doom_sys_clock_jitter_t jitter;
+
+    ///
+    /// \brief The subscription to the defaults above.
+    ///
+    size_t subscription;
+} doom_sys_clock_state_t;
+
+///
+/// \brief Read the monotonic clock.
+///
+/// \return Nanoseconds since an arbitrary point in the past.
+///
+uint64_t doom_sys_clock_ns(void);
+
+///
+/// \brief Sleep until the monotonic clock reaches a time. Returns early if interrupted.
+///
+/// \param deadline_ns The time, as returned by doom_sys_clock_ns().
+///
+void doom_sys_clock_sleep_until(uint64_t deadline_ns);
+
+///
+/// \brief Start the game clock and frame limiter, and follow changes to `realtic_clock_rate` and `dsda_fps_limit`.
+///
+void doom_sys_clock_init(void);
+
+///
+/// \brief Read the game clock, which runs at `realtic_clock_rate` percent of real time.
+///
+/// Changing the rate rebases the clock, so it never jumps.
+///
+/// \return Nanoseconds of game time since doom_sys_clock_init().
+///
+uint64_t doom_sys_clock_game_ns(void);
+
+///
+/// \brief Get the current game tic.
+///
+int32_t doom_sys_clock_tic(void);
+
+///
+/// \brief Get the real time until the next game tic starts.
+///
+uint64_t doom_sys_clock_ns_until_next_tic(void);
+
+///
+/// \brief Wait for the end of the current frame, according to `dsda_fps_limit`.
+///
+/// First, the subscribers to the defaults changed during the frame are called.
+///
+/// This sleeps until shortly before the deadline and then spins, so frames end within a few microseconds of it
+/// without keeping a core busy for the whole frame. If the frame ran over by more than a whole period, the schedule
+/// restarts from now instead of trying to catch up. Without a limit, this returns at once.
+///
+void doom_sys_clock_frame_wait(void);
+
+///
+/// \brief Get the standard deviation of the frame deadline misses, in nanoseconds.
+///
+double doom_sys_clock_jitter_stddev_ns(const doom_sys_clock_jitter_t* jitter);
+
+///
+/// \brief Forget the frame jitter measured so far.
+///
+void doom_sys_clock_jitter_reset(void);
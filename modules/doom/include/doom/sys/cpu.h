@@ -0,0 +1,52 @@
+#pragma once
+
+#include <stdbool.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define DOOM_SYS_CPU_X86 1
+#else
+#define DOOM_SYS_CPU_X86 0
+#endif
+
+// Lets a function use an instruction set the rest of the build doesn't assume, so it can be picked at runtime.
+// MSVC allows intrinsics anywhere, so there it expands to nothing.
+#if DOOM_SYS_CPU_X86 && defined(__GNUC__)
+#define DOOM_SYS_CPU_TARGET(isa) __attribute__((target(isa)))
+#else
+#define DOOM_SYS_CPU_TARGET(isa)
+#endif
+
+#define DOOM_SYS_CPU_ISAS_X                                                                                            \
+    X(scalar)                                                                                                          \
+    X(sse2)                                                                                                            \
+    X(avx2)                                                                                                            \
+    X(count)
+
+///
+/// \brief The instruction sets that code paths are specialized for, from the least to the most capable.
+///
+typedef enum
+{
+#define X(x) doom_sys_cpu_isa_##x,
+    DOOM_SYS_CPU_ISAS_X
+#undef X
+} doom_sys_cpu_isa_t;
+
+///
+/// \brief Check whether this CPU (and OS) can run code for an instruction set. Thread-safe.
+///
+/// \param isa The instruction set.
+///
+/// \return Whether it is supported. The scalar path always is.
+///
+bool doom_sys_cpu_supports(doom_sys_cpu_isa_t isa);
+
+///
+/// \brief Get the most capable instruction set to run, or scalar with `-nosimd`.
+///
+doom_sys_cpu_isa_t doom_sys_cpu_best_isa(void);
+
+///
+/// \brief Get the name of an instruction set, e.g. "avx2".
+///
+const char* doom_sys_cpu_isa_name(doom_sys_cpu_isa_t isa);
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+///
+/// \brief Decompress a raw DEFLATE stream (RFC 1951), such as a deflated zip entry.
+///
+/// The whole output is produced in one call, so no window is kept beyond the output buffer. Thread-safe.
+///
+/// \param in The compressed data.
+/// \param in_size The size of the compressed data.
+/// \param out Where to decompress to.
+/// \param out_size The size the data decompresses to.
+///
+/// \return Whether the stream was valid and decompressed to exactly `out_size` bytes.
+///
+bool doom_sys_inflate(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size);
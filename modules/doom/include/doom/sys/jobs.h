@@ -0,0 +1,228 @@
+#pragma once
+
+#include "doom/state.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <threads.h>
+
+enum
+{
+    ///
+    /// \brief The most tasks a task graph can hold.
+    ///
+    doom_sys_task_graph_max_tasks = 64,
+
+    ///
+    /// \brief The most jobs that can wait for a worker. Jobs submitted beyond that run on the submitting thread.
+    ///
+    doom_sys_jobs_queue_capacity = 256,
+
+    ///
+    /// \brief The most worker threads in the pool.
+    ///
+    doom_sys_jobs_max_workers = 32,
+};
+
+///
+/// \brief A job for the worker pool.
+///
+typedef void (*doom_sys_job_func_t)(void* userdata);
+
+///
+/// \brief A step in a task graph.
+///
+typedef struct {
+    ///
+    /// \brief The name of the task, for the timeline.
+    ///
+    const char* name;
+
+    ///
+    /// \brief What the task does.
+    ///
+    doom_sys_job_func_t func;
+
+    ///
+    /// \brief The argument of `func`.
+    ///
+    void* userdata;
+
+    ///
+    /// \brief The tasks this one waits for, as a bit mask of task indices.
+    ///
+    uint64_t dependencies;
+
+    ///
+    /// \brief How many of the dependencies have not finished yet.
+    ///
+    uint32_t remaining;
+
+    ///
+    /// \brief When the task started and finished, from doom_sys_clock_ns().
+    ///
+    uint64_t start_ns;
+    uint64_t end_ns;
+
+    ///
+    /// \brief The worker that ran the task, or 0 for a thread outside of the pool.
+    ///
+    uint32_t worker;
+} doom_sys_task_t;
+
+///
+/// \brief A set of tasks with dependencies between them.
+///
+/// Tasks run on the worker pool as soon as their dependencies have finished, with the instance that created the graph
+/// made current. Threads waiting on the graph run ready tasks, or else queued jobs, themselves instead of idling, so a
+/// graph finishes even without workers.
+///
+typedef struct {
+    ///
+    /// \brief The tasks, in the order they were added.
+    ///
+    doom_sys_task_t tasks[doom_sys_task_graph_max_tasks];
+
+    ///
+    /// \brief The number of tasks.
+    ///
+    size_t task_count;
+
+    ///
+    /// \brief The tasks whose dependencies have finished but that haven't started, oldest first.
+    ///
+    size_t ready[doom_sys_task_graph_max_tasks];
+    size_t ready_head;
+    size_t ready_tail;
+
+    ///
+    /// \brief The finished tasks, as a bit mask of task indices.
+    ///
+    uint64_t done;
+
+    ///
+    /// \brief Jobs on the worker pool that still refer to the graph.
+    ///
+    size_t jobs_outstanding;
+
+    ///
+    /// \brief The instance that the tasks run with.
+    ///
+    doom_state_t* state;
+
+    ///
+    /// \brief When the graph started running.
+    ///
+    uint64_t start_ns;
+
+    ///
+    /// \brief Whether a task hit a fatal error, and the code to exit with. The waiting thread exits, and no more tasks
+    /// start.
+    ///
+    bool failed;
+    int32_t exit_code;
+
+    mtx_t mutex;
+    cnd_t changed;
+} doom_sys_task_graph_t;
+
+///
+/// \brief Start the worker pool.
+///
+/// \param workers The number of worker threads. With 0, jobs run on the thread that submits or waits for them.
+///
+/// \return Whether every worker was started.
+///
+bool doom_sys_jobs_start(size_t workers);
+
+///
+/// \brief Finish the queued jobs and stop the worker pool.
+///
+void doom_sys_jobs_stop(void);
+
+///
+/// \brief Get the number of running workers.
+///
+size_t doom_sys_jobs_worker_count(void);
+
+///
+/// \brief Get the number of workers to use by default: one less than the number of CPUs, or `-workers N`.
+///
+size_t doom_sys_jobs_default_worker_count(void);
+
+///
+/// \brief Run a function on a worker.
+///
+/// If there are no workers or the queue is full, the function runs right away on the calling thread.
+///
+void doom_sys_jobs_submit(doom_sys_job_func_t func, void* userdata);
+
+///
+/// \brief Wait for submitted jobs to count themselves out, running queued jobs on this thread in the meantime.
+///
+/// Since the waiting thread takes jobs from the queue itself, the jobs finish even when it is the only worker, such as
+/// when a graph task on a worker splits its work into jobs.
+///
+/// \param outstanding The number of jobs that haven't finished. Each job decrements it under `mutex` and signals
+///                    `finished`.
+/// \param mutex The lock of `outstanding`.
+/// \param finished Signaled when a job finishes.
+///
+void doom_sys_jobs_wait(const size_t* outstanding, mtx_t* mutex, cnd_t* finished);
+
+///
+/// \brief Set up an empty task graph for the current instance.
+///
+void doom_sys_task_graph_init(doom_sys_task_graph_t* graph);
+
+///
+/// \brief Free a task graph, once no worker refers to it any more. Its tasks must have finished.
+///
+void doom_sys_task_graph_free(doom_sys_task_graph_t* graph);
+
+///
+/// \brief Add a task to a graph that is not running yet.
+///
+/// \param name The name of the task. Not copied.
+/// \param func What the task does.
+/// \param userdata The argument of `func`.
+/// \param dependencies The tasks to wait for, as a mask of the indices returned by earlier calls. Since a task can
+///                     only depend on earlier ones, the graph has no cycles.
+///
+/// \return The index of the task.
+///
+size_t doom_sys_task_graph_add(doom_sys_task_graph_t* graph, const char* name, doom_sys_job_func_t func,
+                               void* userdata, uint64_t dependencies);
+
+///
+/// \brief Start running the tasks that have no dependencies. The others follow as their dependencies finish.
+///
+void doom_sys_task_graph_run(doom_sys_task_graph_t* graph);
+
+///
+/// \brief Wait for one task, running ready tasks on this thread in the meantime.
+///
+void doom_sys_task_graph_wait(doom_sys_task_graph_t* graph, size_t task);
+
+///
+/// \brief Wait for every task, running ready tasks on this thread in the meantime.
+///
+void doom_sys_task_graph_wait_all(doom_sys_task_graph_t* graph);
+
+///
+/// \brief Hand a fatal error in a graph task over to the thread waiting for the graph.
+///
+/// Called by doom_sys_safe_exit(), since exiting in the middle of a task would free what the other tasks are still
+/// using. The failed task never finishes, and the thread that ran it goes on; on a worker, it takes the next job. The
+/// waiting thread exits with the code once no job refers to the graph any more. Returns if the calling thread isn't
+/// running a graph task.
+///
+/// \param exit_code The exit code.
+///
+void doom_sys_task_graph_fail_task(int32_t exit_code);
+
+///
+/// \brief Log when each task ran and on which thread, and the critical path, on the system channel at debug level.
+///
+void doom_sys_task_graph_report(const doom_sys_task_graph_t* graph);
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+
+///
+/// \brief A file mapped into memory.
+///
+typedef struct {
+    ///
+    /// \brief The start of the mapping, or NULL if nothing is mapped.
+    ///
+    void* data;
+
+    ///
+    /// \brief The size of the mapping in bytes.
+    ///
+    size_t size;
+
+    ///
+    /// \brief Whether the mapping is writable. Writes go to the file.
+    ///
+    bool writable;
+
+#ifdef _WIN32
+    void* file_handle;
+    void* mapping_handle;
+#endif
+} doom_sys_mapped_file_t;
+
+///
+/// \brief Map a whole file into memory, read-only.
+///
+/// \param mapped The mapping to fill in.
+/// \param path The file to map.
+///
+/// \return Whether the file was mapped. Empty files cannot be mapped.
+///
+bool doom_sys_map_file(doom_sys_mapped_file_t* mapped, const char* path);
+
+///
+/// \brief Create a file of the given size and map it read-write.
+///
+/// An existing file is truncated first. Since the mapping is shared, whatever is written to it reaches the file even if
+/// the process dies without unmapping it.
+///
+/// \param mapped The mapping to fill in.
+/// \param path The file to create.
+/// \param size The size of the file.
+///
+/// \return Whether the file was created and mapped.
+///
+bool doom_sys_map_file_create(doom_sys_mapped_file_t* mapped, const char* path, size_t size);
+
+///
+/// \brief Create a file of the given size beside another and map it read-write, to replace that one once it's written.
+///
+/// The new file is `path` with ".tmp" appended. Until doom_sys_map_file_replace_commit() moves it, readers of `path`
+/// (including other processes that have it mapped) see the old contents in full.
+///
+/// \param mapped The mapping to fill in.
+/// \param path The file to replace. It needn't exist.
+/// \param size The size of the new file.
+///
+/// \return Whether the file was created and mapped.
+///
+bool doom_sys_map_file_replace(doom_sys_mapped_file_t* mapped, const char* path, size_t size);
+
+///
+/// \brief Unmap a file from doom_sys_map_file_replace() and move it over the file it replaces.
+///
+/// \param mapped The mapping.
+/// \param path The file to replace, as given to doom_sys_map_file_replace().
+///
+/// \return Whether the file was replaced. If not, the new file is removed and the old one is left as it was.
+///
+bool doom_sys_map_file_replace_commit(doom_sys_mapped_file_t* mapped, const char* path);
+
+///
+/// \brief Unmap a file. Does nothing if nothing is mapped.
+///
+void doom_sys_unmap_file(doom_sys_mapped_file_t* mapped);
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define DOOM_SYS_THREAD_ROLES_X                                                                                        \
+    X(main)                                                                                                            \
+    X(render)                                                                                                          \
+    X(audio)                                                                                                           \
+    X(count)
+
+///
+/// \brief The threads that process_priority applies to.
+///
+typedef enum
+{
+#define X(x) doom_sys_thread_role_##x,
+    DOOM_SYS_THREAD_ROLES_X
+#undef X
+} doom_sys_thread_role_t;
+
+enum
+{
+    ///
+    /// \brief How much of the heap is touched up front when memory is locked.
+    ///
+    doom_sys_priority_prefault_bytes = 32 * 1024 * 1024,
+};
+
+///
+/// \brief What process_priority actually got from the system.
+///
+typedef struct {
+    ///
+    /// \brief The process_priority value that was applied.
+    ///
+    int32_t level;
+
+    ///
+    /// \brief The CPU each thread role is pinned to, or -1 if it is not pinned.
+    ///
+    int32_t cpus[doom_sys_thread_role_count];
+
+    ///
+    /// \brief Whether each thread role got a real-time (`SCHED_FIFO`) policy.
+    ///
+    bool realtime[doom_sys_thread_role_count];
+
+    ///
+    /// \brief The nice value of the process after applying.
+    ///
+    int32_t nice;
+
+    ///
+    /// \brief Whether all memory is locked into RAM.
+    ///
+    bool memory_locked;
+} doom_sys_priority_state_t;
+
+///
+/// \brief Apply process_priority to the process and the calling thread, which becomes the main thread.
+///
+/// - 0 leaves everything alone.
+/// - 1 lowers the nice value and pins each thread role to its own core.
+/// - 2 also asks for `SCHED_FIFO`, falling back to a lower nice value, and locks all memory with the heap prefaulted.
+///
+/// Only Linux is supported. Whatever was granted is logged on the system channel; anything refused is skipped.
+/// Changes to process_priority take effect at the next start.
+///
+void doom_sys_priority_apply(void);
+
+///
+/// \brief Apply process_priority to the calling thread, according to its role.
+///
+/// Threads other than the main thread call this when they start. So far only the main thread exists: rendering runs
+/// on the worker pool, which is left unpinned since its threads share the strips, and there is no audio thread yet.
+/// The render and audio CPUs are chosen anyway, so those threads only need to make this call once they exist.
+///
+/// \param role The role of the thread.
+///
+void doom_sys_priority_enter_thread(doom_sys_thread_role_t role);
@@ -62,6 +62,16 @@ typedef struct doom_sys_atexit_list_entry_s {
 void doom_sys_atexit(doom_sys_atexit_func_t func, bool run_if_error, const char* name,
                      doom_sys_exit_priority_t priority);
 
+///
+/// \brief Run a function when an explicit instance exits.
+///
+/// \param exit_funcs The instance's `exit_funcs`.
+///
+/// \see doom_sys_atexit
+///
+void doom_sys_atexit_ex(doom_sys_atexit_func_t func, bool run_if_error, const char* name,
+                        doom_sys_exit_priority_t priority, doom_sys_atexit_list_entry_t* exit_funcs[]);
+
 // Convenience macro for doom_sys_atexit.
 #define DOOM_SYS_ATEXIT(Func, RunIfError, Priority) doom_sys_atexit(Func, RunIfError, #Func, Priority)
 
@@ -75,9 +85,47 @@ void doom_sys_atexit(doom_sys_atexit_func_t func, bool run_if_error, const char*
 ///
 const char* doom_sys_get_version_string(char* buffer, size_t buffer_len);
 
+///
+/// \brief Get the path of a cache file, creating the directory it goes in if needed.
+///
+/// The directory is the one after `-cachedir`, or else the user's cache directory: `%LOCALAPPDATA%\cute-doom` on
+/// Windows, `$XDG_CACHE_HOME/cute-doom` or `~/.cache/cute-doom` elsewhere. If there is none, it's the working
+/// directory.
+///
+/// \param name The name of the file.
+///
+/// \return The path, to be freed with nonstd_free().
+///
+char* doom_sys_cache_path(const char* name);
+
+///
+/// \brief Log a table of the memory allocated through nonstd_malloc(), by tag.
+///
+void doom_sys_print_memstats(void);
+
+///
+/// \brief Run through the exit hooks, in priority order.
+///
+/// Each hook runs at most once; hooks with `run_if_error` unset are skipped for a non-zero exit code.
+///
+/// \param exit_code The exit code that will be exited with.
+///
+void doom_sys_run_atexit(int32_t exit_code);
+
+///
+/// \brief Run through the exit hooks of an explicit instance, in priority order.
+///
+/// \param exit_code The exit code that will be exited with.
+/// \param exit_funcs The instance's `exit_funcs`.
+///
+void doom_sys_run_atexit_ex(int32_t exit_code, doom_sys_atexit_list_entry_t* exit_funcs[]);
+
 ///
 /// \brief Run through the exit hooks and quit with the given exit code.
 ///
+/// In a graph task, the thread waiting for the graph does this instead. If the current instance runs under
+/// doom_instance_run(), only that instance quits: its exit hooks run and doom_instance_run() returns the exit code.
+///
 /// \param exit_code The exit code to exit with.
 ///
 noreturn void doom_sys_safe_exit(int32_t exit_code);
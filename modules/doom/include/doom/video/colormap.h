@@ -0,0 +1,204 @@
+#pragma once
+
+#include "doom/video/palette.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <threads.h>
+
+enum
+{
+    ///
+    /// \brief The light levels and colormaps of vanilla's COLORMAP, used with render_doom_lightmaps.
+    ///
+    doom_video_colormap_doom_levels = 16,
+    doom_video_colormap_doom_maps = 32,
+
+    ///
+    /// \brief The light levels and colormaps generated for smooth lighting.
+    ///
+    doom_video_colormap_smooth_levels = 64,
+    doom_video_colormap_smooth_maps = 64,
+
+    ///
+    /// \brief The distances a light level is diminished over, each 16 map units farther than the last.
+    ///
+    doom_video_colormap_max_light_z = 128,
+
+    ///
+    /// \brief The steps of usegamma.
+    ///
+    doom_video_colormap_gamma_levels = 5,
+};
+
+#define DOOM_VIDEO_COLORMAP_WALLS_X                                                                                    \
+    X(none)                                                                                                            \
+    X(along_x)                                                                                                         \
+    X(along_y)
+
+///
+/// \brief Which way a wall runs, for fake_contrast.
+///
+typedef enum
+{
+#define X(x) doom_video_colormap_wall_##x,
+    DOOM_VIDEO_COLORMAP_WALLS_X
+#undef X
+} doom_video_colormap_wall_t;
+
+///
+/// \brief What a set of colormaps is made from.
+///
+typedef struct {
+    uint64_t palette_hash;
+
+    ///
+    /// \brief A hash of the COLORMAP lump, or 0 if the maps are generated.
+    ///
+    uint64_t lump_hash;
+
+    bool doom_lightmaps;
+    bool fake_contrast;
+    int32_t gamma;
+} doom_video_colormap_key_t;
+
+///
+/// \brief The colormaps and light tables for one combination of settings. Read-only once built.
+///
+typedef struct {
+    doom_video_colormap_key_t key;
+
+    ///
+    /// \brief The sector light levels and the colormaps they pick from, the brightest first.
+    ///
+    int32_t level_count;
+    int32_t map_count;
+
+    ///
+    /// \brief The colormaps, 256 bytes each.
+    ///
+    uint8_t* maps;
+
+    ///
+    /// \brief The colormap of each light level at each distance, `[level * max_light_z + distance]`.
+    ///
+    uint8_t* zlight;
+
+    ///
+    /// \brief How many light levels fake_contrast moves walls by.
+    ///
+    int32_t contrast;
+
+    ///
+    /// \brief The palette to display, with usegamma applied.
+    ///
+    uint8_t palette[doom_video_palette_bytes];
+} doom_video_colormaps_t;
+
+///
+/// \brief Every set of colormaps built so far, and the one in use.
+///
+typedef struct {
+    ///
+    /// \brief The sets built so far. They are kept until the instance is freed, so switching back is free.
+    ///
+    doom_video_colormaps_t** sets;
+    size_t set_count;
+    size_t set_capacity;
+
+    ///
+    /// \brief The set in use, or NULL if there is no palette.
+    ///
+    const doom_video_colormaps_t* current;
+
+    ///
+    /// \brief The set being built on the worker pool, or NULL.
+    ///
+    doom_video_colormaps_t* building;
+    doom_video_palette_t building_palette;
+    const uint8_t* building_lump;
+
+    ///
+    /// \brief Set by the worker when `building` is done.
+    ///
+    atomic_bool built;
+
+    ///
+    /// \brief Whether the settings changed again while `building` was being built.
+    ///
+    bool stale;
+
+    mtx_t mutex;
+    cnd_t finished;
+    bool initialized;
+
+    ///
+    /// \brief The subscription to the lighting settings.
+    ///
+    size_t subscription;
+} doom_video_colormap_engine_t;
+
+///
+/// \brief Build the colormaps for the current settings and follow render_doom_lightmaps, fake_contrast and usegamma.
+///
+void doom_video_colormap_init(void);
+
+///
+/// \brief Free every set of colormaps, after waiting for the one being built.
+///
+/// \param engine The engine.
+///
+void doom_video_colormap_destroy(doom_video_colormap_engine_t* engine);
+
+///
+/// \brief Get the colormaps to draw the next frame with. Never waits.
+///
+/// After the settings change, this keeps returning the previous set until the new one has been built on the worker
+/// pool, unless the new one was built before. It only allocates when it starts another build, because the settings
+/// changed again during the last one.
+///
+/// \return The colormaps, or NULL if there is no palette.
+///
+const doom_video_colormaps_t* doom_video_colormaps(void);
+
+///
+/// \brief Build a set of colormaps.
+///
+/// \param colormaps The set, whose key is filled in.
+/// \param palette The palette, whose hash is in the key.
+/// \param lump The 32 colormaps of the COLORMAP lump, or NULL to generate them. Only used with doom_lightmaps.
+///
+void doom_video_colormap_build(doom_video_colormaps_t* colormaps, const doom_video_palette_t* palette,
+                               const uint8_t* lump);
+
+///
+/// \brief Free a set of colormaps.
+///
+/// \param colormaps The set.
+///
+void doom_video_colormap_free(doom_video_colormaps_t* colormaps);
+
+///
+/// \brief Get the light level of a sector light, with fake_contrast applied to walls.
+///
+/// \param colormaps The set.
+/// \param light The sector light in [0, 256).
+/// \param wall Which way the wall runs, or none for floors, ceilings and sprites.
+///
+/// \return The light level in [0, level_count).
+///
+int32_t doom_video_colormap_level(const doom_video_colormaps_t* colormaps, int32_t light,
+                                  doom_video_colormap_wall_t wall);
+
+///
+/// \brief Get the colormap of a light level at a distance.
+///
+/// \param colormaps The set.
+/// \param level The light level.
+/// \param distance The distance in map units.
+///
+/// \return The colormap.
+///
+const uint8_t* doom_video_colormap_z(const doom_video_colormaps_t* colormaps, int32_t level, float distance);
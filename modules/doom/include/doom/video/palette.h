@@ -0,0 +1,89 @@
+#pragma once
+
+#include "doom/sys/cpu.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The colors of a palette.
+    ///
+    doom_video_palette_colors = 256,
+
+    ///
+    /// \brief The size of a palette in PLAYPAL: a red, green and blue byte per color.
+    ///
+    doom_video_palette_bytes = 3 * doom_video_palette_colors,
+};
+
+///
+/// \brief A palette, laid out for searching.
+///
+typedef struct {
+    ///
+    /// \brief The colors as in PLAYPAL.
+    ///
+    uint8_t rgb[doom_video_palette_bytes];
+
+    ///
+    /// \brief The colors as (red, green) and (blue, 0) pairs, so a SIMD search can square and sum a pair per lane.
+    ///
+    int16_t red_green[doom_video_palette_colors][2];
+    int16_t blue[doom_video_palette_colors][2];
+
+    ///
+    /// \brief A hash of `rgb`, for keying what is derived from the palette.
+    ///
+    uint64_t hash;
+} doom_video_palette_t;
+
+///
+/// \brief Finds the palette color nearest to a color.
+///
+typedef uint8_t (*doom_video_palette_nearest_func_t)(const doom_video_palette_t* palette, int32_t red, int32_t green,
+                                                     int32_t blue);
+
+///
+/// \brief Set up a palette.
+///
+/// \param palette The palette.
+/// \param rgb The colors as in PLAYPAL.
+///
+void doom_video_palette_init(doom_video_palette_t* palette, const uint8_t rgb[doom_video_palette_bytes]);
+
+///
+/// \brief Set up one of the palettes of the PLAYPAL lump.
+///
+/// \param palette The palette.
+/// \param index Which palette; 0 is the normal one.
+///
+/// \return false if there is no PLAYPAL or it's too short.
+///
+bool doom_video_palette_load(doom_video_palette_t* palette, size_t index);
+
+///
+/// \brief Get the nearest color search for an instruction set.
+///
+/// Colors are compared by squared distance in RGB; of equally near colors, the lowest index wins. Every variant finds
+/// the same color as the scalar one.
+///
+/// \param isa The instruction set, which the CPU must support.
+///
+/// \return The search, or NULL if the instruction set isn't built for this target.
+///
+doom_video_palette_nearest_func_t doom_video_palette_nearest_func(doom_sys_cpu_isa_t isa);
+
+///
+/// \brief Find the palette color nearest to a color with the best search for this CPU.
+///
+/// \param palette The palette.
+/// \param red The red component in [0, 256).
+/// \param green The green component in [0, 256).
+/// \param blue The blue component in [0, 256).
+///
+/// \return The index of the color.
+///
+uint8_t doom_video_palette_nearest(const doom_video_palette_t* palette, int32_t red, int32_t green, int32_t blue);
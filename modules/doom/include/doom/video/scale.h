@@ -0,0 +1,136 @@
+#pragma once
+
+#include "doom/sys/cpu.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The integer factors the SIMD scalers replicate columns by directly; other factors use the column map.
+    ///
+    doom_video_scale_min_simd_factor = 2,
+    doom_video_scale_max_simd_factor = 5,
+
+    ///
+    /// \brief The iterations of each series of `-benchscale`.
+    ///
+    doom_video_scale_bench_iterations = 20,
+};
+
+typedef struct doom_video_scaler_s doom_video_scaler_t;
+
+///
+/// \brief Scales one row of the framebuffer into the output.
+///
+typedef void (*doom_video_scale_row_func_t)(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler);
+
+///
+/// \brief The final pass from the framebuffer to the output, by nearest neighbor, for one pair of sizes.
+///
+struct doom_video_scaler_s {
+    ///
+    /// \brief The size of the framebuffer and of the scaled image.
+    ///
+    int32_t source_width;
+    int32_t source_height;
+    int32_t dest_width;
+    int32_t dest_height;
+
+    ///
+    /// \brief The factor of the width, if it's a whole number, or 0.
+    ///
+    int32_t factor;
+
+    ///
+    /// \brief The source column of each output column.
+    ///
+    int32_t* columns;
+
+    ///
+    /// \brief The first output row of each source row, then `dest_height`. Source rows whose first row is also the next
+    /// one's aren't shown.
+    ///
+    int32_t* rows;
+
+    ///
+    /// \brief Scales a row.
+    ///
+    doom_video_scale_row_func_t row;
+};
+
+///
+/// \brief Get the size to scale the framebuffer to.
+///
+/// The framebuffer is shown at the render_aspect ratio. On auto, that is 4:3 for the 16:10 sizes of vanilla (320x200
+/// and its multiples), so its pixels are as tall as on a CRT, and square pixels for the others.
+///
+/// \param source_width The width of the framebuffer.
+/// \param source_height The height of the framebuffer.
+/// \param output_width The width of the output.
+/// \param output_height The height of the output.
+/// \param multiply render_screen_multiply: if above 1, the width is exactly this many times the framebuffer's,
+/// regardless of the output.
+/// \param integer_scaling integer_scaling: the width is the largest whole multiple of the framebuffer's that fits.
+/// \param aspect render_aspect: 0 for auto, then 16:9, 16:10, 4:3 and 5:4.
+/// \param dest_width Where to put the width to scale to.
+/// \param dest_height Where to put the height to scale to.
+///
+void doom_video_scale_fit(int32_t source_width, int32_t source_height, int32_t output_width, int32_t output_height,
+                          int32_t multiply, bool integer_scaling, int32_t aspect, int32_t* dest_width,
+                          int32_t* dest_height);
+
+///
+/// \brief Set up a scaler with the best row scaler for this CPU.
+///
+/// \param scaler The scaler.
+/// \param source_width The width of the framebuffer.
+/// \param source_height The height of the framebuffer.
+/// \param dest_width The width to scale to.
+/// \param dest_height The height to scale to.
+///
+void doom_video_scaler_init(doom_video_scaler_t* scaler, int32_t source_width, int32_t source_height,
+                            int32_t dest_width, int32_t dest_height);
+
+///
+/// \brief Free a scaler.
+///
+/// \param scaler The scaler.
+///
+void doom_video_scaler_destroy(doom_video_scaler_t* scaler);
+
+///
+/// \brief Get the row scaler of a scaler for an instruction set.
+///
+/// Every variant makes the same rows as the scalar one.
+///
+/// \param scaler The scaler.
+/// \param isa The instruction set, which the CPU must support.
+///
+/// \return The row scaler, or NULL if the instruction set isn't built for this target.
+///
+doom_video_scale_row_func_t doom_video_scaler_row_func(const doom_video_scaler_t* scaler, doom_sys_cpu_isa_t isa);
+
+///
+/// \brief Scale the framebuffer straight into the output.
+///
+/// Each shown source row is scaled once, into its first output row, and the rows that repeat it are copied from
+/// there.
+///
+/// \param scaler The scaler.
+/// \param source The framebuffer.
+/// \param source_pitch The distance between the rows of the framebuffer, in bytes.
+/// \param dest The top left pixel of the scaled image in the output.
+/// \param dest_pitch The distance between the rows of the output, in bytes.
+///
+void doom_video_scale(const doom_video_scaler_t* scaler, const uint8_t* source, ptrdiff_t source_pitch, uint8_t* dest,
+                      ptrdiff_t dest_pitch);
+
+///
+/// \brief Time every scaler from 320x200 up to 4K, and report output pixels per second.
+///
+/// The results are reported and written as JSON like the other benchmarks.
+///
+void doom_video_scale_bench(void);
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "doom/sys/mapped_file.h"
+#include "doom/video/palette.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The entries of a translucency table: one per (background, foreground) pair of colors.
+    ///
+    doom_video_tranmap_size = doom_video_palette_colors * doom_video_palette_colors,
+
+    ///
+    /// \brief The version of the tranmap cache format. Bump it when the generated table changes.
+    ///
+    doom_video_tranmap_cache_version = 1,
+};
+
+///
+/// \brief The translucency table of the palette for tran_filter_pct.
+///
+typedef struct {
+    ///
+    /// \brief The color of `foreground` drawn over `background` at `[background * 256 + foreground]`, or NULL if there
+    /// is no palette.
+    ///
+    const uint8_t* table;
+
+    ///
+    /// \brief What `table` was made for.
+    ///
+    int32_t pct;
+    uint64_t palette_hash;
+
+    ///
+    /// \brief Where `table` lives: the cache file, or a buffer it was generated in.
+    ///
+    doom_sys_mapped_file_t mapped;
+    uint8_t* buffer;
+
+    ///
+    /// \brief Whether tran_filter_pct has changed since `table` was made.
+    ///
+    bool stale;
+
+    ///
+    /// \brief The subscription to tran_filter_pct.
+    ///
+    size_t subscription;
+} doom_video_tranmap_t;
+
+///
+/// \brief Make the translucency table of the default palette, from the cache if it has it, and follow
+/// tran_filter_pct.
+///
+/// Each palette and percentage has its own cache file in the cache directory (see doom_sys_cache_path()).
+/// `-notranmapcache` disables the cache.
+///
+void doom_video_tranmap_init(void);
+
+///
+/// \brief Free a translucency table.
+///
+/// \param tranmap The table.
+///
+void doom_video_tranmap_destroy(doom_video_tranmap_t* tranmap);
+
+///
+/// \brief Get the translucency table for the current tran_filter_pct, remaking it first if the setting has changed.
+///
+/// \return The table, as in `doom_video_tranmap_t`, or NULL if there is no palette.
+///
+const uint8_t* doom_video_tranmap(void);
+
+///
+/// \brief Generate a translucency table on the worker pool and this thread.
+///
+/// Each entry is the palette color nearest to `pct` percent of the foreground over the rest of the background, as in
+/// Boom.
+///
+/// \param table Where to put the `doom_video_tranmap_size` entries.
+/// \param palette The palette.
+/// \param pct The opacity of the foreground, in [0, 100].
+///
+void doom_video_tranmap_generate(uint8_t* table, const doom_video_palette_t* palette, int32_t pct);
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <threads.h>
+
+enum
+{
+    ///
+    /// \brief The budget of the resource cache when `-resourcemem` is not given, in MiB.
+    ///
+    doom_wad_cache_default_budget_mib = 64,
+};
+
+///
+/// \brief Decode a lump into a resource.
+///
+/// \param lump The lump.
+/// \param variant Which decoding of the lump to make, as defined by the caller (e.g. a texture vs. a flat).
+/// \param size Set to the size of the resource.
+/// \param userdata Passed through from the caller.
+///
+/// \return The resource, allocated with nonstd_malloc(); the cache frees it with nonstd_free(). NULL on failure.
+///
+typedef void* (*doom_wad_cache_decode_t)(int32_t lump, uint32_t variant, size_t* size, void* userdata);
+
+///
+/// \brief A decoded resource in the cache.
+///
+typedef struct {
+    ///
+    /// \brief The lump and variant, as `lump << 32 | variant`.
+    ///
+    uint64_t key;
+
+    ///
+    /// \brief The resource, or NULL if the entry is free.
+    ///
+    void* data;
+    size_t size;
+
+    ///
+    /// \brief How many users hold the entry. Pinned entries are never evicted.
+    ///
+    uint32_t pins;
+
+    ///
+    /// \brief Whether the entry was used since the clock hand last passed it.
+    ///
+    bool referenced;
+
+    ///
+    /// \brief The next entry in the same hash bucket, or in the free list.
+    ///
+    uint32_t next;
+} doom_wad_cache_entry_t;
+
+///
+/// \brief Counters for tuning the cache budget.
+///
+typedef struct {
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+
+    ///
+    /// \brief The bytes of the resources held.
+    ///
+    size_t bytes;
+
+    ///
+    /// \brief The number of resources held.
+    ///
+    size_t entries;
+
+    ///
+    /// \brief The most the cache holds before unpinned resources are evicted.
+    ///
+    size_t budget;
+} doom_wad_cache_stats_t;
+
+///
+/// \brief A cache of decoded lumps, such as composited textures or converted sounds, within a byte budget.
+///
+/// Unpinned resources are evicted with the CLOCK algorithm: the hand sweeps the entries, giving those used since its
+/// last pass a second chance. The cache is thread-safe, so resources can be decoded on workers.
+///
+typedef struct {
+    ///
+    /// \brief Every entry, including free ones. The clock hand sweeps this array.
+    ///
+    doom_wad_cache_entry_t* entries;
+    size_t entry_capacity;
+
+    ///
+    /// \brief The first free entry, or `UINT32_MAX`.
+    ///
+    uint32_t free_entry;
+
+    ///
+    /// \brief The first entry of each bucket, or `UINT32_MAX`. The bucket count is a power of two.
+    ///
+    uint32_t* buckets;
+    size_t bucket_count;
+
+    ///
+    /// \brief The entry the clock hand points at.
+    ///
+    size_t hand;
+
+    doom_wad_cache_stats_t stats;
+
+    ///
+    /// \brief Whether doom_wad_cache_init() ran.
+    ///
+    bool initialized;
+
+    mtx_t mutex;
+} doom_wad_cache_t;
+
+///
+/// \brief Set up the resource cache of the current instance, taking its budget in MiB from `-resourcemem`.
+///
+void doom_wad_cache_init(void);
+
+///
+/// \brief Free every resource of a cache, pinned or not, and log its statistics on the wad channel at debug level.
+///
+/// \param cache The cache.
+///
+void doom_wad_cache_destroy(doom_wad_cache_t* cache);
+
+///
+/// \brief Get a resource, decoding and adding it if it isn't cached, and pin it.
+///
+/// The decoding runs without holding the cache lock. If another thread adds the same resource meanwhile, its copy
+/// is used and this one is dropped.
+///
+/// \param lump The lump.
+/// \param variant Which decoding of the lump.
+/// \param decode How to decode the lump on a miss.
+/// \param userdata Passed to `decode`.
+/// \param size Set to the size of the resource, if not NULL.
+///
+/// \return The resource, valid until doom_wad_cache_release(), or NULL if it could not be decoded.
+///
+const void* doom_wad_cache_get(int32_t lump, uint32_t variant, doom_wad_cache_decode_t decode, void* userdata,
+                               size_t* size);
+
+///
+/// \brief Get a resource and pin it, if it is cached. Counts as a hit or a miss.
+///
+/// \return The resource, or NULL.
+///
+const void* doom_wad_cache_find(int32_t lump, uint32_t variant, size_t* size);
+
+///
+/// \brief Check whether a resource is cached, without pinning it or touching the statistics.
+///
+bool doom_wad_cache_contains(int32_t lump, uint32_t variant);
+
+///
+/// \brief Add a decoded resource, unpinned. If it is already cached, `data` is freed instead.
+///
+/// \param data The resource, allocated with nonstd_malloc(). The cache takes ownership.
+///
+void doom_wad_cache_insert(int32_t lump, uint32_t variant, void* data, size_t size);
+
+///
+/// \brief Undo one pin from doom_wad_cache_get() or doom_wad_cache_find().
+///
+void doom_wad_cache_release(int32_t lump, uint32_t variant);
+
+///
+/// \brief Change the budget, evicting unpinned resources until the cache fits if it can.
+///
+/// \param bytes The new budget.
+///
+void doom_wad_cache_set_budget(size_t bytes);
+
+///
+/// \brief Get a snapshot of the statistics.
+///
+doom_wad_cache_stats_t doom_wad_cache_stats(void);
@@ -0,0 +1,119 @@
+#pragma once
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <threads.h>
+
+#define DOOM_WAD_PRECACHE_KINDS_X                                                                                      \
+    X(texture)                                                                                                         \
+    X(flat)
+
+///
+/// \brief The kinds of resources a level is precached for.
+///
+typedef enum
+{
+#define X(x) doom_wad_precache_kind_##x,
+    DOOM_WAD_PRECACHE_KINDS_X
+#undef X
+} doom_wad_precache_kind_t;
+
+enum
+{
+    ///
+    /// \brief The iterations of each series of `-benchprecache`.
+    ///
+    doom_wad_precache_bench_iterations = 10,
+};
+
+///
+/// \brief A resource a level uses.
+///
+typedef struct {
+    doom_wad_precache_kind_t kind;
+
+    ///
+    /// \brief The texture number, or the lump of the flat.
+    ///
+    int32_t index;
+} doom_wad_precache_item_t;
+
+///
+/// \brief The background precache of the current level.
+///
+typedef struct {
+    ///
+    /// \brief What the level uses, each resource once.
+    ///
+    doom_wad_precache_item_t* items;
+    size_t item_count;
+    size_t item_capacity;
+
+    ///
+    /// \brief The next item for a worker to take.
+    ///
+    atomic_size_t next;
+
+    ///
+    /// \brief Set once the level starts, so the workers stop taking items.
+    ///
+    atomic_bool stopping;
+
+    ///
+    /// \brief The jobs on the worker pool that have not returned.
+    ///
+    size_t jobs_outstanding;
+
+    ///
+    /// \brief Whether the synchronization objects are set up.
+    ///
+    bool initialized;
+
+    mtx_t mutex;
+    cnd_t finished;
+} doom_wad_precache_t;
+
+///
+/// \brief Start precaching the resources of a map in the background, if `level_precache` is on.
+///
+/// This is meant to be called when the level is loaded, so the workers decode during the wipe and intermission. It
+/// collects the textures of the SIDEDEFS and the flats of the SECTORS, then composites the textures into the resource
+/// cache and pages in the flats on the worker pool. Without workers, they are precached on this thread before it
+/// returns.
+///
+/// \param map The name of the map marker, e.g. "MAP01".
+///
+/// \return The number of resources queued.
+///
+size_t doom_wad_precache_level(const char* map);
+
+///
+/// \brief Stop the background precache when the first tic runs.
+///
+/// Resources that are still missing are decoded on demand by whoever needs them, which doesn't wait behind the queue.
+///
+void doom_wad_precache_stop(void);
+
+///
+/// \brief Wait until the workers have returned.
+///
+void doom_wad_precache_wait(void);
+
+///
+/// \brief Stop the precache and free it.
+///
+/// \param precache The precache.
+///
+void doom_wad_precache_destroy(doom_wad_precache_t* precache);
+
+///
+/// \brief Time collecting the resources of a map, precaching them on the workers, and decoding them on demand.
+///
+/// The results are reported and written as JSON like the other benchmarks. Without workers, the precaching happens
+/// before doom_wad_precache_level() returns, so it's counted in the collect series.
+///
+/// \param map The name of the map marker.
+///
+void doom_wad_precache_bench(const char* map);
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The resource cache variant of composited textures. Their `lump` in the cache is the texture number.
+    ///
+    doom_wad_texture_cache_variant = 1,
+};
+
+///
+/// \brief A texture defined in TEXTURE1 or TEXTURE2.
+///
+typedef struct {
+    ///
+    /// \brief The name, as from doom_wad_name_key().
+    ///
+    uint64_t key;
+
+    ///
+    /// \brief The definition inside the TEXTUREx lump, in the mapping.
+    ///
+    const uint8_t* definition;
+
+    ///
+    /// \brief The bytes of the definition that are inside the lump.
+    ///
+    size_t definition_size;
+
+    int16_t width;
+    int16_t height;
+} doom_wad_texture_t;
+
+///
+/// \brief The textures of the mounted WADs.
+///
+typedef struct {
+    ///
+    /// \brief The textures by number, TEXTURE1's first.
+    ///
+    doom_wad_texture_t* textures;
+    size_t texture_count;
+
+    ///
+    /// \brief The texture numbers, sorted by key for lookups.
+    ///
+    uint32_t* by_name;
+
+    ///
+    /// \brief The lump of each patch in PNAMES, or -1 if it is missing.
+    ///
+    int32_t* patch_lumps;
+    size_t patch_count;
+} doom_wad_textures_t;
+
+///
+/// \brief A composited texture: the patches of a texture drawn into one image.
+///
+typedef struct {
+    int16_t width;
+    int16_t height;
+
+    ///
+    /// \brief The pixels, column by column. Pixels that no patch covers are 0.
+    ///
+    uint8_t pixels[];
+} doom_wad_composite_t;
+
+///
+/// \brief Index the textures of the mounted WADs from PNAMES, TEXTURE1 and TEXTURE2.
+///
+/// Does nothing if there are no textures. Textures with bad definitions are skipped with a warning.
+///
+void doom_wad_textures_init(void);
+
+///
+/// \brief Free the texture index.
+///
+/// \param textures The index.
+///
+void doom_wad_textures_destroy(doom_wad_textures_t* textures);
+
+///
+/// \brief Find a texture by name, ignoring case.
+///
+/// \param name The name. Only the first 8 characters count.
+///
+/// \return The texture number, or -1 if there is none. The name "-" means no texture, and is never found.
+///
+int32_t doom_wad_texture_find(const char* name);
+
+///
+/// \brief Composite a texture. This is the decoder of the resource cache for textures.
+///
+/// \param texture The texture number.
+/// \param size Set to the size of the composite.
+///
+/// \return The composite, allocated with nonstd_malloc().
+///
+doom_wad_composite_t* doom_wad_texture_composite(int32_t texture, size_t* size);
+
+///
+/// \brief Get the composite of a texture from the resource cache, compositing it right away if it's missing.
+///
+/// \param texture The texture number.
+///
+/// \return The composite, pinned until doom_wad_texture_release().
+///
+const doom_wad_composite_t* doom_wad_texture_get(int32_t texture);
+
+///
+/// \brief Unpin the composite from doom_wad_texture_get().
+///
+void doom_wad_texture_release(int32_t texture);
@@ -0,0 +1,227 @@
+#pragma once
+
+#include "doom/sys/mapped_file.h"
+
+#include <phyto/span/span.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    ///
+    /// \brief The length of a lump name. Shorter names are padded with NUL bytes.
+    ///
+    doom_wad_lump_name_length = 8,
+
+    ///
+    /// \brief The size of a WAD header: the magic, the lump count and the directory offset.
+    ///
+    doom_wad_header_size = 12,
+
+    ///
+    /// \brief The size of a directory entry: the offset, the size and the name of a lump.
+    ///
+    doom_wad_entry_size = 16,
+};
+
+#define DOOM_WAD_FORMATS_X                                                                                             \
+    X(wad)                                                                                                             \
+    X(zip)
+
+///
+/// \brief The kinds of archive that can be mounted. PK3s are zip archives.
+///
+typedef enum
+{
+#define X(x) doom_wad_format_##x,
+    DOOM_WAD_FORMATS_X
+#undef X
+} doom_wad_format_t;
+
+///
+/// \brief The contents of a lump, pointing straight into the mapped WAD, or into its inflated copy for a compressed zip
+/// entry.
+///
+typedef PHYTO_SPAN_TYPE(uint8_t) doom_wad_lump_data_t;
+
+///
+/// \brief A lump of a mounted WAD.
+///
+typedef struct {
+    ///
+    /// \brief The name in upper case, padded with NUL bytes, as one word for hashing and comparing.
+    ///
+    uint64_t key;
+
+    ///
+    /// \brief The directory entry of the lump, inside the mapping: a WAD directory entry, or a zip central directory
+    /// header.
+    ///
+    const uint8_t* entry;
+
+    ///
+    /// \brief The index of the WAD the lump is in.
+    ///
+    uint32_t file;
+
+    ///
+    /// \brief Whether it's a flat: between F_START and F_END (or FF_START and FF_END) in a WAD, or under flats/ in a
+    /// zip archive.
+    ///
+    bool flat;
+} doom_wad_lump_t;
+
+///
+/// \brief A mounted WAD.
+///
+typedef struct {
+    ///
+    /// \brief The mapping of the whole file.
+    ///
+    doom_sys_mapped_file_t mapped;
+
+    ///
+    /// \brief The path it was mounted from.
+    ///
+    char* path;
+
+    ///
+    /// \brief What kind of archive it is.
+    ///
+    doom_wad_format_t format;
+
+    ///
+    /// \brief Whether it's an IWAD rather than a PWAD.
+    ///
+    bool iwad;
+
+    ///
+    /// \brief For zip archives, the inflated copy of each compressed lump once it's needed, or NULL.
+    ///
+    _Atomic(uint8_t*)* inflated;
+
+    ///
+    /// \brief The index of its first lump among all mounted lumps.
+    ///
+    uint32_t first_lump;
+
+    ///
+    /// \brief The number of its lumps.
+    ///
+    uint32_t lump_count;
+} doom_wad_file_t;
+
+///
+/// \brief The mounted WADs and the directory of all of their lumps.
+///
+typedef struct {
+    ///
+    /// \brief The mounted WADs, in the order they were mounted.
+    ///
+    doom_wad_file_t* files;
+    size_t file_count;
+    size_t file_capacity;
+
+    ///
+    /// \brief The lumps of every WAD, in the order they were mounted.
+    ///
+    doom_wad_lump_t* lumps;
+    size_t lump_count;
+    size_t lump_capacity;
+
+    ///
+    /// \brief An open-addressed hash table from lump names to the index of the last lump with that name, or
+    /// `UINT32_MAX` for empty slots. The capacity is a power of two.
+    ///
+    uint32_t* hash;
+    size_t hash_capacity;
+} doom_wad_state_t;
+
+///
+/// \brief Mount the WADs of the current instance: `-iwad`, then `wadfile_1` and `wadfile_2`, then the files after
+/// `-file`.
+///
+/// A missing IWAD is an error; other WADs that can't be mounted are skipped with a warning.
+///
+void doom_wad_init(void);
+
+///
+/// \brief Unmount every WAD and free the directory.
+///
+/// \param wad The WAD state.
+///
+void doom_wad_destroy(doom_wad_state_t* wad);
+
+///
+/// \brief Map a WAD or zip archive and add its lumps to the directory.
+///
+/// Lumps of later WADs override earlier lumps with the same name. Nothing is copied; the directory entries and lump
+/// data stay in the mapping. The lumps of a zip archive are its files, named after the first 8 characters of the file
+/// name without directories and extension. Stored files are served from the mapping; deflated ones are inflated the
+/// first time they are read, which for a level's textures and flats is on the precache workers. Deflated files that
+/// claim an impossible or huge inflated size are skipped.
+///
+/// \param path The file to mount.
+///
+/// \return Whether the WAD was mounted. If not, the reason is logged on the wad channel.
+///
+bool doom_wad_mount(const char* path);
+
+///
+/// \brief Find the last mounted lump with a name, ignoring case.
+///
+/// \param name The name. Only the first 8 characters count.
+///
+/// \return The index of the lump, or -1 if there is none.
+///
+int32_t doom_wad_find(const char* name);
+
+///
+/// \brief Find a lump that must exist.
+///
+/// \return The index of the lump. Errors out if there is none.
+///
+int32_t doom_wad_find_required(const char* name);
+
+///
+/// \brief Find the last mounted flat with a name, ignoring case. Lumps outside the flat namespace don't count, so a
+/// sound or a patch with the same name doesn't hide a flat.
+///
+/// \param name The name. Only the first 8 characters count.
+///
+/// \return The index of the lump, or -1 if there is none.
+///
+int32_t doom_wad_find_flat(const char* name);
+
+///
+/// \brief Get the number of mounted lumps.
+///
+size_t doom_wad_lump_count(void);
+
+///
+/// \brief Get the contents of a lump, inflating it first if it's compressed. Thread-safe.
+///
+/// \param lump The index of the lump.
+///
+/// \return The contents, valid until the WAD is unmounted. Empty if a zip entry is damaged.
+///
+doom_wad_lump_data_t doom_wad_lump_data(int32_t lump);
+
+///
+/// \brief Get the name of a lump, as it is in the WAD.
+///
+/// \param lump The index of the lump.
+/// \param name Where to put the name, NUL-terminated.
+///
+void doom_wad_lump_name(int32_t lump, char name[doom_wad_lump_name_length + 1]);
+
+///
+/// \brief Turn a lump name into the key used by the directory: upper case, padded with NUL bytes, as one word.
+///
+/// \param name The name. Only the first 8 characters count, so names inside lumps needn't be NUL-terminated.
+///
+/// \return The key.
+///
+uint64_t doom_wad_name_key(const char* name);
@@ -0,0 +1,541 @@
+#include "doom/deh/deh.h"
+
+#include "doom/deh/tables.h"
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/misc/argv.h"
+#include "doom/misc/hash.h"
+#include "doom/state.h"
+#include "doom/sys/mapped_file.h"
+#include "doom/sys/system.h"
+
+#include <nonstd/alloc.h>
+#include <nonstd/ctype.h>
+#include <nonstd/strdup.h>
+#include <phyto/string/string.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+typedef enum
+{
+    block_none,
+    // Something that has no table yet, or a BEX section; its lines are ignored.
+    block_skip,
+    block_thing,
+    block_frame,
+    block_weapon,
+    block_pointer,
+} s_block_t;
+
+typedef struct {
+    doom_deh_patch_t* patch;
+    const char* name;
+    size_t line;
+    s_block_t block;
+    uint32_t index;
+    // The characters of a Text block that are still to be skipped.
+    size_t text_remaining;
+} s_parser_t;
+
+typedef struct {
+    doom_sys_mapped_file_t mapped;
+    char* path;
+} s_patch_file_t;
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint64_t key;
+    uint64_t op_count;
+} s_cache_header_t;
+
+typedef struct {
+    const char* name;
+    uint32_t bit;
+} s_flag_t;
+
+static const char* const sc_state_field_names[] = {
+#define X(field, name) name,
+    DOOM_DEH_STATE_FIELDS_X
+#undef X
+};
+
+static const char* const sc_thing_field_names[] = {
+#define X(field, name) name,
+    DOOM_DEH_THING_FIELDS_X
+#undef X
+};
+
+static const char* const sc_weapon_field_names[] = {
+#define X(field, name) name,
+    DOOM_DEH_WEAPON_FIELDS_X
+#undef X
+};
+
+// The mnemonics a Bits field may use instead of a number, with the Boom and MBF additions.
+static const s_flag_t sc_thing_flags[] = {
+    {"SPECIAL", 0x00000001},      {"SOLID", 0x00000002},       {"SHOOTABLE", 0x00000004},
+    {"NOSECTOR", 0x00000008},     {"NOBLOCKMAP", 0x00000010},  {"AMBUSH", 0x00000020},
+    {"JUSTHIT", 0x00000040},      {"JUSTATTACKED", 0x00000080}, {"SPAWNCEILING", 0x00000100},
+    {"NOGRAVITY", 0x00000200},    {"DROPOFF", 0x00000400},     {"PICKUP", 0x00000800},
+    {"NOCLIP", 0x00001000},       {"SLIDE", 0x00002000},       {"FLOAT", 0x00004000},
+    {"TELEPORT", 0x00008000},     {"MISSILE", 0x00010000},     {"DROPPED", 0x00020000},
+    {"SHADOW", 0x00040000},       {"NOBLOOD", 0x00080000},     {"CORPSE", 0x00100000},
+    {"INFLOAT", 0x00200000},      {"COUNTKILL", 0x00400000},   {"COUNTITEM", 0x00800000},
+    {"SKULLFLY", 0x01000000},     {"NOTDMATCH", 0x02000000},   {"TRANSLATION", 0x04000000},
+    {"TRANSLATION1", 0x04000000}, {"TRANSLATION2", 0x08000000}, {"TOUCHY", 0x10000000},
+    {"BOUNCES", 0x20000000},      {"FRIEND", 0x40000000},      {"TRANSLUCENT", 0x80000000},
+};
+
+// "DEHC", read as a native integer, so a cache from a machine of the other byte order is rejected.
+static const uint32_t sc_cache_magic = 0x43484544;
+
+static void s_parse_line(s_parser_t* parser, phyto_string_span_t line);
+static void s_begin_block(s_parser_t* parser, phyto_string_span_t line);
+static void s_parse_assignment(s_parser_t* parser, phyto_string_span_t key, phyto_string_span_t value);
+static bool s_parse_flags(phyto_string_span_t value, int32_t* flags);
+static bool s_parse_number(phyto_string_span_t text, int32_t* number);
+static void s_emit(s_parser_t* parser, doom_deh_table_t table, uint32_t field, int32_t value);
+static phyto_string_span_t s_trim(const char* begin, const char* end);
+static phyto_string_span_t s_next_word(phyto_string_span_t* text);
+static bool s_equals(phyto_string_span_t text, const char* c);
+static void s_add_patch_file(s_patch_file_t** files, size_t* count, char* path);
+static bool s_load_cache(const char* path, uint64_t key, doom_deh_patch_t* patch);
+static bool s_save_cache(const char* path, uint64_t key, const doom_deh_patch_t* patch);
+
+void doom_deh_init(void) {
+    doom_deh_tables_init(&doom_state->deh);
+
+    s_patch_file_t* files = NULL;
+    size_t file_count = 0;
+    for (size_t i = 0; i < doom_maxloadfiles; i++) {
+        phyto_string_span_t path = doom_state->defaults_storage.deh_files[i];
+        if (path.size > 0) {
+            s_add_patch_file(&files, &file_count, nonstd_strndup(path.begin, path.size));
+        }
+    }
+    int32_t deh_index = doom_misc_check_parameter("-deh");
+    if (deh_index > 0) {
+        doom_misc_parameters_t params = doom_state->params;
+        // Every argument up to the next parameter is a patch.
+        for (size_t i = (size_t)deh_index + 1;
+             i < params.size && params.data[i].size > 0 && params.data[i].data[0] != '-'; i++) {
+            s_add_patch_file(&files, &file_count, nonstd_strndup(params.data[i].data, params.data[i].size));
+        }
+    }
+    if (file_count == 0) {
+        nonstd_free(files);
+        return;
+    }
+
+    // The key covers everything the compiled patch depends on: the format, the table sizes and every byte of input.
+    uint64_t key = doom_misc_hash(&(uint32_t){doom_deh_cache_version}, sizeof(uint32_t));
+    key = doom_misc_hash_continue(key, &doom_state->deh.state_count, sizeof(size_t));
+    key = doom_misc_hash_continue(key, &doom_state->deh.thing_count, sizeof(size_t));
+    for (size_t i = 0; i < file_count; i++) {
+        key = doom_misc_hash_continue(key, &files[i].mapped.size, sizeof(size_t));
+        key = doom_misc_hash_continue(key, files[i].mapped.data, files[i].mapped.size);
+    }
+
+    bool use_cache = doom_misc_check_parameter("-nodehcache") <= 0;
+    char* cache_path = doom_misc_parameter_argument("-dehcache");
+    if (cache_path == NULL) {
+        cache_path = doom_sys_cache_path("deh.cache");
+    }
+    doom_deh_patch_t patch = {0};
+    bool cached = use_cache && s_load_cache(cache_path, key, &patch);
+    if (!cached) {
+        for (size_t i = 0; i < file_count; i++) {
+            const char* text = files[i].mapped.data;
+            phyto_string_span_t span = PHYTO_SPAN_NEW(text, text + files[i].mapped.size);
+            doom_deh_compile(&patch, span, files[i].path);
+        }
+        if (use_cache && !s_save_cache(cache_path, key, &patch)) {
+            DOOM_LOG(wad, warn, "Could not write the DEHACKED cache %s.\n", cache_path);
+        }
+    }
+
+    doom_deh_apply(&patch, &doom_state->deh);
+    DOOM_LOG(wad, info, "Applied %zu changes from %zu DEHACKED patches%s.\n", patch.op_count, file_count,
+             cached ? " (cached)" : "");
+
+    doom_deh_patch_free(&patch);
+    nonstd_free(cache_path);
+    for (size_t i = 0; i < file_count; i++) {
+        doom_sys_unmap_file(&files[i].mapped);
+        nonstd_free(files[i].path);
+    }
+    nonstd_free(files);
+}
+
+bool doom_deh_compile(doom_deh_patch_t* patch, phyto_string_span_t text, const char* name) {
+    size_t first_op = patch->op_count;
+    s_parser_t parser = {.patch = patch, .name = name, .block = block_none};
+    const char* cursor = text.begin;
+    while (cursor < text.end) {
+        if (parser.text_remaining > 0) {
+            // The old and new text of a Text block may contain anything, including newlines. Only carriage returns
+            // aren't counted, so the lengths are the same with either line ending.
+            if (*cursor == '\n') {
+                parser.line++;
+            }
+            parser.text_remaining -= *cursor != '\r';
+            cursor++;
+            continue;
+        }
+        const char* line_end = memchr(cursor, '\n', (size_t)(text.end - cursor));
+        if (line_end == NULL) {
+            line_end = text.end;
+        }
+        parser.line++;
+        phyto_string_span_t line = s_trim(cursor, line_end);
+        cursor = line_end < text.end ? line_end + 1 : text.end;
+        if (line.size > 0 && line.begin[0] != '#') {
+            s_parse_line(&parser, line);
+        }
+    }
+
+    size_t compiled = patch->op_count - first_op;
+    DOOM_LOG(wad, debug, "Compiled %zu changes from %s.\n", compiled, name);
+    return compiled > 0;
+}
+
+void doom_deh_apply(const doom_deh_patch_t* patch, doom_deh_tables_t* tables) {
+    // Pointer blocks copy code pointers as they were before the patch, so those are kept before anything changes.
+    int32_t* actions = NULL;
+    for (size_t i = 0; i < patch->op_count && actions == NULL; i++) {
+        const doom_deh_op_t* op = &patch->ops[i];
+        if (op->table == doom_deh_table_state && op->field == doom_deh_state_field_action) {
+            actions = nonstd_malloc((tables->state_count + 1) * sizeof(int32_t), nonstd_alloc_tag_deh);
+            for (size_t state = 0; state < tables->state_count; state++) {
+                actions[state] = tables->states[state].action;
+            }
+        }
+    }
+
+    size_t ignored = 0;
+    for (size_t i = 0; i < patch->op_count; i++) {
+        const doom_deh_op_t* op = &patch->ops[i];
+        int32_t* field = doom_deh_tables_field(tables, op->table, op->index, op->field);
+        int32_t value = op->value;
+        if (op->table == doom_deh_table_state && op->field == doom_deh_state_field_action) {
+            if (value < 0 || (size_t)value >= tables->state_count) {
+                field = NULL;
+            } else {
+                value = actions[value];
+            }
+        }
+        if (field == NULL) {
+            ignored++;
+            continue;
+        }
+        *field = value;
+    }
+    nonstd_free(actions);
+
+    if (ignored > 0) {
+        DOOM_LOG(wad, warn, "Ignored %zu DEHACKED changes to entries that don't exist.\n", ignored);
+    }
+}
+
+void doom_deh_patch_free(doom_deh_patch_t* patch) {
+    nonstd_free(patch->ops);
+    *patch = (doom_deh_patch_t){0};
+}
+
+void s_parse_line(s_parser_t* parser, phyto_string_span_t line) {
+    if (line.begin[0] == '[') {
+        // A BEX section. None of them have a table yet.
+        const char* close = memchr(line.begin, ']', line.size);
+        int length = close != NULL ? (int)(close - line.begin + 1) : (int)line.size;
+        DOOM_LOG(wad, debug, "%s:%zu: skipping %.*s.\n", parser->name, parser->line, length, line.begin);
+        parser->block = block_skip;
+        return;
+    }
+    const char* equals = memchr(line.begin, '=', line.size);
+    if (equals != NULL) {
+        s_parse_assignment(parser, s_trim(line.begin, equals), s_trim(equals + 1, line.end));
+        return;
+    }
+    s_begin_block(parser, line);
+}
+
+void s_begin_block(s_parser_t* parser, phyto_string_span_t line) {
+    phyto_string_span_t rest = line;
+    phyto_string_span_t keyword = s_next_word(&rest);
+    int32_t number = 0;
+    bool has_number = s_parse_number(s_next_word(&rest), &number);
+
+    if (s_equals(keyword, "Thing") && has_number && number >= 1) {
+        // Things are numbered from 1.
+        parser->block = block_thing;
+        parser->index = (uint32_t)number - 1;
+    } else if (s_equals(keyword, "Frame") && has_number && number >= 0) {
+        parser->block = block_frame;
+        parser->index = (uint32_t)number;
+    } else if (s_equals(keyword, "Weapon") && has_number && number >= 0) {
+        parser->block = block_weapon;
+        parser->index = (uint32_t)number;
+    } else if (s_equals(keyword, "Pointer") && has_number) {
+        // "Pointer 0 (Frame 1)": the number that matters is the frame.
+        const char* open = memchr(rest.begin, '(', rest.size);
+        phyto_string_span_t frame = open != NULL ? s_trim(open + 1, rest.end) : rest;
+        phyto_string_span_t frame_keyword = s_next_word(&frame);
+        phyto_string_span_t frame_number = s_next_word(&frame);
+        if (frame_number.size > 0 && frame_number.end[-1] == ')') {
+            frame_number = s_trim(frame_number.begin, frame_number.end - 1);
+        }
+        int32_t state;
+        if (s_equals(frame_keyword, "Frame") && s_parse_number(frame_number, &state) && state >= 0) {
+            parser->block = block_pointer;
+            parser->index = (uint32_t)state;
+        } else {
+            DOOM_LOG(wad, warn, "%s:%zu: malformed Pointer block.\n", parser->name, parser->line);
+            parser->block = block_skip;
+        }
+    } else if (s_equals(keyword, "Text")) {
+        int32_t new_length;
+        if (has_number && number >= 0 && s_parse_number(s_next_word(&rest), &new_length) && new_length >= 0) {
+            parser->text_remaining = (size_t)number + (size_t)new_length;
+        } else {
+            DOOM_LOG(wad, warn, "%s:%zu: malformed Text block.\n", parser->name, parser->line);
+        }
+        parser->block = block_skip;
+    } else if (s_equals(keyword, "Ammo") || s_equals(keyword, "Sound") || s_equals(keyword, "Sprite") ||
+               s_equals(keyword, "Misc") || s_equals(keyword, "Cheat")) {
+        DOOM_LOG(wad, debug, "%s:%zu: skipping %.*s.\n", parser->name, parser->line, (int)line.size, line.begin);
+        parser->block = block_skip;
+    } else if (s_equals(keyword, "Patch")) {
+        // "Patch File for DeHackEd v3.0".
+        parser->block = block_none;
+    } else if (s_equals(keyword, "Include")) {
+        DOOM_LOG(wad, warn, "%s:%zu: Include is not supported.\n", parser->name, parser->line);
+        parser->block = block_none;
+    } else if (parser->block != block_skip) {
+        // Lines of skipped blocks and sections can be anything, but elsewhere this is a mistake.
+        DOOM_LOG(wad, warn, "%s:%zu: unknown line %.*s.\n", parser->name, parser->line, (int)line.size, line.begin);
+        parser->block = block_skip;
+    }
+}
+
+void s_parse_assignment(s_parser_t* parser, phyto_string_span_t key, phyto_string_span_t value) {
+    doom_deh_table_t table;
+    const char* const* names;
+    size_t name_count;
+    switch (parser->block) {
+        case block_thing:
+            table = doom_deh_table_thing;
+            names = sc_thing_field_names;
+            name_count = doom_deh_thing_field_count;
+            break;
+        case block_frame:
+        case block_pointer:
+            table = doom_deh_table_state;
+            names = sc_state_field_names;
+            name_count = doom_deh_state_field_count;
+            break;
+        case block_weapon:
+            table = doom_deh_table_weapon;
+            names = sc_weapon_field_names;
+            name_count = doom_deh_weapon_field_count;
+            break;
+        case block_none:
+        case block_skip:
+        default:
+            // The header ("Doom version", "Patch format") and the blocks without a table.
+            return;
+    }
+
+    uint32_t field = 0;
+    while (field < name_count && !s_equals(key, names[field])) {
+        field++;
+    }
+    if (field == name_count) {
+        DOOM_LOG(wad, warn, "%s:%zu: unknown field %.*s.\n", parser->name, parser->line, (int)key.size, key.begin);
+        return;
+    }
+    int32_t number;
+    bool valid = table == doom_deh_table_thing && field == doom_deh_thing_field_flags ? s_parse_flags(value, &number)
+                                                                                      : s_parse_number(value, &number);
+    if (!valid) {
+        DOOM_LOG(wad, warn, "%s:%zu: bad value %.*s.\n", parser->name, parser->line, (int)value.size, value.begin);
+        return;
+    }
+    s_emit(parser, table, field, number);
+}
+
+bool s_parse_flags(phyto_string_span_t value, int32_t* flags) {
+    if (value.size > 0 && (nonstd_isdigit(value.begin[0]) || value.begin[0] == '-')) {
+        return s_parse_number(value, flags);
+    }
+    // Mnemonics, separated by any of " +|,".
+    uint32_t bits = 0;
+    const char* cursor = value.begin;
+    while (cursor < value.end) {
+        if (*cursor == ' ' || *cursor == '\t' || *cursor == '+' || *cursor == '|' || *cursor == ',') {
+            cursor++;
+            continue;
+        }
+        const char* start = cursor;
+        while (cursor < value.end && *cursor != ' ' && *cursor != '\t' && *cursor != '+' && *cursor != '|' &&
+               *cursor != ',') {
+            cursor++;
+        }
+        phyto_string_span_t mnemonic = PHYTO_SPAN_NEW(start, cursor);
+        size_t i = 0;
+        while (i < sizeof(sc_thing_flags) / sizeof(sc_thing_flags[0]) && !s_equals(mnemonic, sc_thing_flags[i].name)) {
+            i++;
+        }
+        if (i == sizeof(sc_thing_flags) / sizeof(sc_thing_flags[0])) {
+            return false;
+        }
+        bits |= sc_thing_flags[i].bit;
+    }
+    *flags = (int32_t)bits;
+    return true;
+}
+
+bool s_parse_number(phyto_string_span_t text, int32_t* number) {
+    const char* cursor = text.begin;
+    bool negative = cursor < text.end && *cursor == '-';
+    if (cursor < text.end && (*cursor == '-' || *cursor == '+')) {
+        cursor++;
+    }
+    if (cursor == text.end) {
+        return false;
+    }
+    // Bits are often written as unsigned, so anything that fits in 32 bits either way is accepted.
+    uint64_t magnitude = 0;
+    for (; cursor < text.end; cursor++) {
+        if (!nonstd_isdigit(*cursor)) {
+            return false;
+        }
+        magnitude = magnitude * 10 + (uint64_t)(*cursor - '0');
+        if (magnitude > UINT32_MAX) {
+            return false;
+        }
+    }
+    if (negative && magnitude > (uint64_t)INT32_MAX + 1) {
+        return false;
+    }
+    *number = negative ? (int32_t)(0 - (uint32_t)magnitude) : (int32_t)(uint32_t)magnitude;
+    return true;
+}
+
+void s_emit(s_parser_t* parser, doom_deh_table_t table, uint32_t field, int32_t value) {
+    doom_deh_patch_t* patch = parser->patch;
+    if (patch->op_count == patch->op_capacity) {
+        patch->op_capacity = patch->op_capacity == 0 ? 256 : patch->op_capacity * 2;
+        patch->ops = nonstd_realloc(patch->ops, patch->op_capacity * sizeof(doom_deh_op_t), nonstd_alloc_tag_deh);
+    }
+    patch->ops[patch->op_count++] = (doom_deh_op_t){
+        .table = (uint8_t)table,
+        .field = (uint8_t)field,
+        .index = parser->index,
+        .value = value,
+    };
+}
+
+phyto_string_span_t s_trim(const char* begin, const char* end) {
+    while (begin < end && nonstd_isspace(*begin)) {
+        begin++;
+    }
+    while (end > begin && nonstd_isspace(end[-1])) {
+        end--;
+    }
+    phyto_string_span_t span = PHYTO_SPAN_NEW(begin, end);
+    return span;
+}
+
+phyto_string_span_t s_next_word(phyto_string_span_t* text) {
+    const char* begin = text->begin;
+    while (begin < text->end && nonstd_isspace(*begin)) {
+        begin++;
+    }
+    const char* end = begin;
+    while (end < text->end && !nonstd_isspace(*end)) {
+        end++;
+    }
+    PHYTO_SPAN_INIT(text, end, text->end);
+    phyto_string_span_t word = PHYTO_SPAN_NEW(begin, end);
+    return word;
+}
+
+bool s_equals(phyto_string_span_t text, const char* c) {
+    // Case-insensitive, and runs of spaces in the text match one space, as DEHACKED editors aren't consistent.
+    const char* cursor = text.begin;
+    for (; *c != '\0'; c++) {
+        if (cursor == text.end) {
+            return false;
+        }
+        if (*c == ' ') {
+            if (!nonstd_isspace(*cursor)) {
+                return false;
+            }
+            while (cursor < text.end && nonstd_isspace(*cursor)) {
+                cursor++;
+            }
+            continue;
+        }
+        if (nonstd_toupper(*cursor) != nonstd_toupper(*c)) {
+            return false;
+        }
+        cursor++;
+    }
+    return cursor == text.end;
+}
+
+void s_add_patch_file(s_patch_file_t** files, size_t* count, char* path) {
+    doom_sys_mapped_file_t mapped;
+    if (!doom_sys_map_file(&mapped, path)) {
+        DOOM_LOG(wad, warn, "Could not open the DEHACKED patch %s.\n", path);
+        nonstd_free(path);
+        return;
+    }
+    *files = nonstd_realloc(*files, (*count + 1) * sizeof(s_patch_file_t), nonstd_alloc_tag_deh);
+    (*files)[(*count)++] = (s_patch_file_t){.mapped = mapped, .path = path};
+}
+
+bool s_load_cache(const char* path, uint64_t key, doom_deh_patch_t* patch) {
+    doom_sys_mapped_file_t mapped;
+    if (!doom_sys_map_file(&mapped, path)) {
+        return false;
+    }
+    s_cache_header_t header = {0};
+    if (mapped.size >= sizeof(header)) {
+        memcpy(&header, mapped.data, sizeof(header));
+    }
+    bool valid = header.magic == sc_cache_magic && header.version == doom_deh_cache_version && header.key == key &&
+                 header.op_count == (mapped.size - sizeof(header)) / sizeof(doom_deh_op_t) &&
+                 (mapped.size - sizeof(header)) % sizeof(doom_deh_op_t) == 0;
+    if (valid) {
+        patch->op_count = (size_t)header.op_count;
+        patch->op_capacity = patch->op_count;
+        patch->ops = nonstd_malloc((patch->op_count + 1) * sizeof(doom_deh_op_t), nonstd_alloc_tag_deh);
+        memcpy(patch->ops, (const uint8_t*)mapped.data + sizeof(header), patch->op_count * sizeof(doom_deh_op_t));
+    }
+    doom_sys_unmap_file(&mapped);
+    return valid;
+}
+
+bool s_save_cache(const char* path, uint64_t key, const doom_deh_patch_t* patch) {
+    // Written aside and renamed over the cache, so another instance loading the old one never sees it change.
+    doom_sys_mapped_file_t mapped;
+    if (!doom_sys_map_file_replace(&mapped, path, sizeof(s_cache_header_t) + patch->op_count * sizeof(doom_deh_op_t))) {
+        return false;
+    }
+    s_cache_header_t header = {
+        .magic = sc_cache_magic,
+        .version = doom_deh_cache_version,
+        .key = key,
+        .op_count = patch->op_count,
+    };
+    if (patch->op_count > 0) {
+        memcpy((uint8_t*)mapped.data + sizeof(header), patch->ops, patch->op_count * sizeof(doom_deh_op_t));
+    }
+    // The header goes last, so a cache that was cut short doesn't match.
+    memcpy(mapped.data, &header, sizeof(header));
+    return doom_sys_map_file_replace_commit(&mapped, path);
+}
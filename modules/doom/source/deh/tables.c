@@ -0,0 +1,72 @@
+#include "doom/deh/tables.h"
+
+#include "doom/weapons.h"
+
+#include <nonstd/alloc.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    // The ammo types, as numbered in a patch.
+    ammo_clip = 0,
+    ammo_shell = 1,
+    ammo_cell = 2,
+    ammo_missile = 3,
+    ammo_none = 5,
+};
+
+// The weapons of Doom 2 v1.9. The states are numbered as in its state table.
+static const doom_deh_weapon_t sc_vanilla_weapons[doom_weapon_type_count] = {
+    [doom_weapon_type_fist] = {ammo_none, 4, 3, 2, 5, 0},
+    [doom_weapon_type_pistol] = {ammo_clip, 12, 11, 10, 13, 17},
+    [doom_weapon_type_shotgun] = {ammo_shell, 20, 19, 18, 21, 30},
+    [doom_weapon_type_chaingun] = {ammo_clip, 51, 50, 49, 52, 55},
+    [doom_weapon_type_missile] = {ammo_missile, 59, 58, 57, 60, 63},
+    [doom_weapon_type_plasma] = {ammo_cell, 76, 75, 74, 77, 79},
+    [doom_weapon_type_bfg] = {ammo_cell, 83, 82, 81, 84, 88},
+    [doom_weapon_type_chainsaw] = {ammo_none, 70, 69, 67, 71, 0},
+    [doom_weapon_type_supershotgun] = {ammo_shell, 34, 33, 32, 35, 47},
+};
+
+void doom_deh_tables_init(doom_deh_tables_t* tables) {
+    // The states and things are filled in from the info tables once the playsim has them; until then, the entries
+    // exist so patches can be applied to them.
+    tables->states = nonstd_calloc(doom_deh_vanilla_state_count, sizeof(doom_deh_state_t), nonstd_alloc_tag_deh);
+    tables->state_count = doom_deh_vanilla_state_count;
+    tables->things = nonstd_calloc(doom_deh_vanilla_thing_count, sizeof(doom_deh_thing_t), nonstd_alloc_tag_deh);
+    tables->thing_count = doom_deh_vanilla_thing_count;
+    for (size_t i = 0; i < doom_weapon_type_count; i++) {
+        tables->weapons[i] = sc_vanilla_weapons[i];
+    }
+}
+
+void doom_deh_tables_destroy(doom_deh_tables_t* tables) {
+    nonstd_free(tables->states);
+    nonstd_free(tables->things);
+    *tables = (doom_deh_tables_t){0};
+}
+
+int32_t* doom_deh_tables_field(doom_deh_tables_t* tables, doom_deh_table_t table, size_t index, uint32_t field) {
+    // Every field is an int32_t, in the order of its enum.
+    switch (table) {
+        case doom_deh_table_state:
+            if (index >= tables->state_count || field >= doom_deh_state_field_count) {
+                return NULL;
+            }
+            return (int32_t*)&tables->states[index] + field;
+        case doom_deh_table_thing:
+            if (index >= tables->thing_count || field >= doom_deh_thing_field_count) {
+                return NULL;
+            }
+            return (int32_t*)&tables->things[index] + field;
+        case doom_deh_table_weapon:
+            if (index >= doom_weapon_type_count || field >= doom_deh_weapon_field_count) {
+                return NULL;
+            }
+            return (int32_t*)&tables->weapons[index] + field;
+        case doom_deh_table_count:
+            break;
+    }
+    return NULL;
+}
@@ -0,0 +1,132 @@
+#include "doom/dsda/input.h"
+
+#include "doom/init.h"
+#include "doom/misc/defaults.h"
+#include "doom/misc/subscriptions.h"
+#include "doom/state.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+static const doom_dsda_input_set_t sc_empty_set;
+
+static void s_set_add(doom_dsda_input_set_t* set, doom_dsda_input_identifier_t identifier);
+static void s_set_remove(doom_dsda_input_set_t* set, doom_dsda_input_identifier_t identifier);
+static void s_link(doom_dsda_input_profile_t* profile, doom_dsda_input_identifier_t identifier);
+static void s_unlink(doom_dsda_input_profile_t* profile, doom_dsda_input_identifier_t identifier);
+static void s_select_profile(void* userdata);
+
+void doom_dsda_input_init(void) {
+    doom_dsda_input_state_t* input = &doom_state->input;
+
+    for (int32_t profile = 0; profile < doom_dsda_input_profile_count; profile++) {
+        for (doom_dsda_input_identifier_t identifier = 0; identifier < doom_dsda_input_count; identifier++) {
+            input->profiles[profile].bindings[identifier] =
+                (doom_dsda_input_default_t){.key = -1, .mouse_button = -1, .joystick_button = -1};
+        }
+    }
+    for (size_t i = 0; i < doom_state->defaults.size; i++) {
+        const doom_misc_default_t* entry = &doom_state->defaults.data[i];
+        if (entry->type != doom_misc_default_type_input) {
+            continue;
+        }
+        for (int32_t profile = 0; profile < doom_dsda_input_profile_count; profile++) {
+            input->profiles[profile].bindings[entry->identifier] = entry->input;
+        }
+    }
+    for (int32_t profile = 0; profile < doom_dsda_input_profile_count; profile++) {
+        doom_dsda_input_rebuild(profile);
+    }
+
+    input->profile_default_index = (size_t)(doom_misc_default_find("input_profile") - doom_state->defaults.data);
+    input->profile_subscription = DOOM_MISC_SUBSCRIBE(s_select_profile, input);
+    doom_misc_subscribe_default(input->profile_subscription, "input_profile");
+    s_select_profile(input);
+}
+
+void doom_dsda_input_bind(int32_t profile, doom_dsda_input_identifier_t identifier, doom_dsda_input_default_t binding) {
+    doom_dsda_input_profile_t* p = &doom_state->input.profiles[profile];
+    s_unlink(p, identifier);
+    p->bindings[identifier] = binding;
+    s_link(p, identifier);
+}
+
+void doom_dsda_input_rebuild(int32_t profile) {
+    doom_dsda_input_profile_t* p = &doom_state->input.profiles[profile];
+    memset(p->by_key, 0, sizeof(p->by_key));
+    memset(p->by_mouse_button, 0, sizeof(p->by_mouse_button));
+    memset(p->by_joystick_button, 0, sizeof(p->by_joystick_button));
+    for (doom_dsda_input_identifier_t identifier = 0; identifier < doom_dsda_input_count; identifier++) {
+        s_link(p, identifier);
+    }
+}
+
+void doom_dsda_input_profile_cycle(void) {
+    int32_t next = (doom_state->defaults_storage.input_profile + 1) % doom_dsda_input_profile_count;
+    doom_state->input.active = &doom_state->input.profiles[next];
+
+    // Keep the default in sync; the subscription will select the same profile again at the next dispatch.
+    doom_misc_default_set_integer(&doom_state->defaults.data[doom_state->input.profile_default_index], next);
+}
+
+const doom_dsda_input_set_t* doom_dsda_input_actions_for_key(int32_t key) {
+    if (key <= 0 || key >= doom_dsda_input_key_count) {
+        return &sc_empty_set;
+    }
+    return &doom_state->input.active->by_key[key];
+}
+
+const doom_dsda_input_set_t* doom_dsda_input_actions_for_mouse_button(int32_t button) {
+    if (button < 0 || button >= doom_dsda_input_mouse_button_count) {
+        return &sc_empty_set;
+    }
+    return &doom_state->input.active->by_mouse_button[button];
+}
+
+const doom_dsda_input_set_t* doom_dsda_input_actions_for_joystick_button(int32_t button) {
+    if (button < 0 || button >= doom_dsda_input_joystick_button_count) {
+        return &sc_empty_set;
+    }
+    return &doom_state->input.active->by_joystick_button[button];
+}
+
+void s_set_add(doom_dsda_input_set_t* set, doom_dsda_input_identifier_t identifier) {
+    set->words[identifier / 64] |= UINT64_C(1) << (identifier % 64);
+}
+
+void s_set_remove(doom_dsda_input_set_t* set, doom_dsda_input_identifier_t identifier) {
+    set->words[identifier / 64] &= ~(UINT64_C(1) << (identifier % 64));
+}
+
+void s_link(doom_dsda_input_profile_t* profile, doom_dsda_input_identifier_t identifier) {
+    doom_dsda_input_default_t binding = profile->bindings[identifier];
+    if (binding.key > 0 && binding.key < doom_dsda_input_key_count) {
+        s_set_add(&profile->by_key[binding.key], identifier);
+    }
+    if (binding.mouse_button >= 0 && binding.mouse_button < doom_dsda_input_mouse_button_count) {
+        s_set_add(&profile->by_mouse_button[binding.mouse_button], identifier);
+    }
+    if (binding.joystick_button >= 0 && binding.joystick_button < doom_dsda_input_joystick_button_count) {
+        s_set_add(&profile->by_joystick_button[binding.joystick_button], identifier);
+    }
+}
+
+void s_unlink(doom_dsda_input_profile_t* profile, doom_dsda_input_identifier_t identifier) {
+    doom_dsda_input_default_t binding = profile->bindings[identifier];
+    if (binding.key > 0 && binding.key < doom_dsda_input_key_count) {
+        s_set_remove(&profile->by_key[binding.key], identifier);
+    }
+    if (binding.mouse_button >= 0 && binding.mouse_button < doom_dsda_input_mouse_button_count) {
+        s_set_remove(&profile->by_mouse_button[binding.mouse_button], identifier);
+    }
+    if (binding.joystick_button >= 0 && binding.joystick_button < doom_dsda_input_joystick_button_count) {
+        s_set_remove(&profile->by_joystick_button[binding.joystick_button], identifier);
+    }
+}
+
+void s_select_profile(void* userdata) {
+    doom_dsda_input_state_t* input = userdata;
+    input->active = &input->profiles[doom_state->defaults_storage.input_profile];
+}
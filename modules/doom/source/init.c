@@ -1,37 +1,356 @@
 #include "doom/init.h"
 
+#include "doom/deh/deh.h"
+#include "doom/dsda/input.h"
+#include "doom/log/async.h"
+#include "doom/log/flight.h"
 #include "doom/log/printf.h"
+#include "doom/log/trace.h"
 #include "doom/misc/argv.h"
 #include "doom/misc/defaults.h"
+#include "doom/render/column.h"
+#include "doom/render/strips.h"
 #include "doom/state.h"
+#include "doom/sys/bench.h"
+#include "doom/sys/clock.h"
+#include "doom/sys/jobs.h"
+#include "doom/sys/priority.h"
 #include "doom/sys/system.h"
+#include "doom/video/colormap.h"
+#include "doom/video/scale.h"
+#include "doom/video/tranmap.h"
+#include "doom/wad/cache.h"
+#include "doom/wad/precache.h"
+#include "doom/wad/texture.h"
+#include "doom/wad/wad.h"
 
+#include <nonstd/alloc.h>
+#include <nonstd/stricmp.h>
+#include <nonstd/strtok.h>
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdint.h>
 #include <stdlib.h>
 
-doom_state_t* doom_state;
+_Thread_local doom_state_t* doom_state;
 
+typedef struct {
+    const char* name;
+    void (*run)(void);
+    // The phases that must finish first, as a mask of indices into sc_instance_phases.
+    uint64_t dependencies;
+} s_init_phase_t;
+
+enum
+{
+    phase_defaults_table,
+    phase_config_load,
+    phase_input,
+    phase_clock,
+    phase_wad_mount,
+    phase_resource_cache,
+    phase_textures,
+    phase_dehacked,
+    phase_tranmap,
+    phase_colormaps,
+    phase_count,
+};
+
+static void s_build_defaults(void);
+static void s_init_instance(void* userdata);
+static void s_add_instance_phases(doom_sys_task_graph_t* graph);
+static void s_run_phase(void* userdata);
+static void s_init_logging(void);
+static void s_start_workers(void);
+static void s_bench_init(int argc, char** argv);
 static void s_print_version(void);
 
+// The setup of an instance after its parameters are parsed. Phases run on the worker pool as soon as their
+// dependencies are done; -benchinit runs them in order instead, to time each one separately. Every dependency must
+// come earlier in the table.
+static const s_init_phase_t sc_instance_phases[phase_count] = {
+    [phase_defaults_table] = {"defaults_table", s_build_defaults, 0},
+    [phase_config_load] = {"config_load", doom_misc_load_defaults, UINT64_C(1) << phase_defaults_table},
+    [phase_input] = {"input", doom_dsda_input_init, UINT64_C(1) << phase_config_load},
+    // The subscription list isn't thread-safe, so the phases that subscribe to defaults run one after another.
+    [phase_clock] = {"clock", doom_sys_clock_init, (UINT64_C(1) << phase_config_load) | (UINT64_C(1) << phase_input)},
+    [phase_wad_mount] = {"wad_mount", doom_wad_init, UINT64_C(1) << phase_config_load},
+    [phase_resource_cache] = {"resource_cache", doom_wad_cache_init, 0},
+    [phase_textures] = {"textures", doom_wad_textures_init, UINT64_C(1) << phase_wad_mount},
+    [phase_dehacked] = {"dehacked", doom_deh_init, UINT64_C(1) << phase_config_load},
+    [phase_tranmap] = {"tranmap", doom_video_tranmap_init,
+                       (UINT64_C(1) << phase_clock) | (UINT64_C(1) << phase_wad_mount)},
+    [phase_colormaps] = {"colormaps", doom_video_colormap_init, UINT64_C(1) << phase_tranmap},
+};
+
 void doom_init(int argc, char** argv) {
     doom_state = doom_state_new(argc, argv);
-    doom_state->defaults = doom_misc_default_dyarray_new();
+
+    s_init_logging();
+    doom_state->print_memstats = doom_misc_check_parameter("-memstats") > 0;
+
+    s_start_workers();
+
+    if (doom_misc_check_parameter("-benchinit") > 0) {
+        s_bench_init(argc, argv);
+        doom_quit(0);
+    }
 
     if (doom_misc_check_parameter("-v") > 0) {
         s_print_version();
         doom_quit(0);
     }
 
+    doom_sys_task_graph_t graph;
+    doom_sys_task_graph_init(&graph);
+    s_add_instance_phases(&graph);
+    doom_sys_task_graph_run(&graph);
+
+    // The priority only needs the config; it has to be applied here since it also pins the main thread.
+    doom_sys_task_graph_wait(&graph, phase_config_load);
+    doom_sys_priority_apply();
+
+    doom_sys_task_graph_wait_all(&graph);
+    doom_sys_task_graph_report(&graph);
+    doom_sys_task_graph_free(&graph);
+
+    // Not a task: a clash is fatal, and doom_log_error() must run the exit hooks (which stop the workers) on this
+    // thread, once nothing else is running.
     doom_misc_detect_clashing_parameters();
 
+    char* precache_map = doom_misc_parameter_argument("-benchprecache");
+    if (precache_map != NULL) {
+        doom_wad_precache_bench(precache_map);
+        nonstd_free(precache_map);
+        doom_quit(0);
+    }
+
+    if (doom_misc_check_parameter("-benchdraw") > 0) {
+        doom_render_column_bench();
+        doom_quit(0);
+    }
+
+    if (doom_misc_check_parameter("-benchstrips") > 0) {
+        doom_render_strips_bench();
+        doom_quit(0);
+    }
+
+    if (doom_misc_check_parameter("-benchscale") > 0) {
+        doom_video_scale_bench();
+        doom_quit(0);
+    }
+
     doom_log_printf(doom_log_level_info, "\n");
     s_print_version();
 }
 
 noreturn void doom_quit(int32_t exit_code) {
+    bool print_memstats = doom_state->print_memstats;
+    doom_sys_run_atexit(exit_code);
     doom_state_free(&doom_state);
+    if (print_memstats) {
+        // Whatever is still live here has leaked.
+        doom_sys_print_memstats();
+    }
     exit(exit_code);
 }
 
+doom_state_t* doom_instance_new(int argc, char** argv) {
+    doom_state_t* state = doom_state_new(argc, argv);
+    if (doom_instance_run(state, s_init_instance, NULL) != 0) {
+        doom_instance_free(&state);
+    }
+    return state;
+}
+
+int32_t doom_instance_run(doom_state_t* state, doom_instance_func_t func, void* userdata) {
+    doom_state = state;
+    jmp_buf jump;
+    jmp_buf* previous = state->fatal_jump;
+    state->fatal_jump = &jump;
+    if (setjmp(jump) != 0) {
+        // doom_sys_safe_exit() ran the exit hooks already.
+        state->fatal_jump = previous;
+        doom_state = state;
+        return state->fatal_exit_code;
+    }
+    func(userdata);
+    state->fatal_jump = previous;
+    return 0;
+}
+
+void doom_instance_make_current(doom_state_t* state) {
+    doom_state = state;
+}
+
+void doom_instance_free(doom_state_t** p_state) {
+    doom_state_t* state = *p_state;
+    if (state == NULL) {
+        return;
+    }
+    // The hooks may use the current instance.
+    doom_state_t* previous = doom_state;
+    doom_state = state;
+    doom_sys_run_atexit_ex(0, state->exit_funcs);
+    doom_state = previous == state ? NULL : previous;
+    doom_state_free(p_state);
+}
+
+void s_build_defaults(void) {
+    doom_state->defaults = doom_misc_default_dyarray_new_ex(&doom_state->defaults_storage);
+}
+
+void s_init_instance(void* userdata) {
+    (void)userdata;
+    doom_sys_task_graph_t graph;
+    doom_sys_task_graph_init(&graph);
+    s_add_instance_phases(&graph);
+    doom_sys_task_graph_run(&graph);
+    doom_sys_task_graph_wait_all(&graph);
+    doom_sys_task_graph_free(&graph);
+}
+
+void s_add_instance_phases(doom_sys_task_graph_t* graph) {
+    for (size_t i = 0; i < phase_count; i++) {
+        const s_init_phase_t* phase = &sc_instance_phases[i];
+        doom_sys_task_graph_add(graph, phase->name, s_run_phase, (void*)phase, phase->dependencies);
+    }
+}
+
+void s_run_phase(void* userdata) {
+    const s_init_phase_t* phase = userdata;
+    phase->run();
+}
+
+void s_bench_init(int argc, char** argv) {
+    char* iterations_argument = doom_misc_parameter_argument("-benchinit");
+    long iterations = iterations_argument != NULL ? strtol(iterations_argument, NULL, 10) : 0;
+    nonstd_free(iterations_argument);
+    if (iterations <= 0) {
+        doom_log_error("-benchinit needs a positive number of iterations");
+    }
+
+    doom_sys_bench_t bench = doom_sys_bench_new("init");
+    size_t params_series = doom_sys_bench_series(&bench, "params");
+    size_t phase_series[phase_count];
+    for (size_t i = 0; i < phase_count; i++) {
+        phase_series[i] = doom_sys_bench_series(&bench, sc_instance_phases[i].name);
+    }
+    size_t clash_series = doom_sys_bench_series(&bench, "clash_detection");
+    size_t free_series = doom_sys_bench_series(&bench, "free");
+    size_t total_series = doom_sys_bench_series(&bench, "total");
+
+    // Each iteration builds a fresh instance from the same parameters, then frees it, like a short-lived job would.
+    doom_state_t* main_state = doom_state;
+    for (long iteration = 0; iteration < iterations; iteration++) {
+        uint64_t start = doom_sys_clock_ns();
+        doom_state = doom_state_new(argc, argv);
+        uint64_t previous = doom_sys_clock_ns();
+        doom_sys_bench_record(&bench, params_series, previous - start);
+
+        for (size_t i = 0; i < phase_count; i++) {
+            sc_instance_phases[i].run();
+            uint64_t now = doom_sys_clock_ns();
+            doom_sys_bench_record(&bench, phase_series[i], now - previous);
+            previous = now;
+        }
+
+        doom_misc_detect_clashing_parameters();
+        uint64_t now = doom_sys_clock_ns();
+        doom_sys_bench_record(&bench, clash_series, now - previous);
+        previous = now;
+
+        doom_state_t* state = doom_state;
+        doom_instance_free(&state);
+        now = doom_sys_clock_ns();
+        doom_sys_bench_record(&bench, free_series, now - previous);
+        doom_sys_bench_record(&bench, total_series, now - start);
+    }
+    doom_state = main_state;
+    bench.iterations = (size_t)iterations;
+
+    doom_sys_bench_report(&bench);
+    char* json_path = doom_sys_bench_json_path("benchinit.json");
+    if (doom_sys_bench_write_json(&bench, json_path)) {
+        doom_log_printf(doom_log_level_info, "Wrote %s.\n", json_path);
+    } else {
+        DOOM_LOG(system, warn, "Could not write %s.\n", json_path);
+    }
+    nonstd_free(json_path);
+    doom_sys_bench_free(&bench);
+}
+
+void s_init_logging(void) {
+    char* debug_channels = doom_misc_parameter_argument("-logdebug");
+    if (debug_channels != NULL) {
+        // A comma-separated list of channels, or "all".
+        char* save = NULL;
+        for (char* name = nonstd_strtok_r(debug_channels, ",", &save); name != NULL;
+             name = nonstd_strtok_r(NULL, ",", &save)) {
+            bool all = nonstd_stricmp(name, "all") == 0;
+            doom_log_channel_t channel = doom_log_channel_from_name(name);
+            if (!all && channel == doom_log_channel_count) {
+                DOOM_LOG(system, warn, "Unknown log channel %s.\n", name);
+                continue;
+            }
+            for (doom_log_channel_t c = 0; c < doom_log_channel_count; c++) {
+                if (all || c == channel) {
+                    doom_log_set_channel_mask(c, atomic_load(&doom_log_channel_masks[c]) | doom_log_level_debug);
+                }
+            }
+        }
+        nonstd_free(debug_channels);
+    }
+
+    char* flight_path = doom_misc_parameter_argument("-flightrec");
+    if (flight_path != NULL) {
+        size_t capacity = doom_log_flight_default_capacity;
+        char* size_kib = doom_misc_parameter_argument("-flightsize");
+        if (size_kib != NULL) {
+            long kib = strtol(size_kib, NULL, 10);
+            if (kib > 0) {
+                capacity = (size_t)kib * 1024;
+            }
+            nonstd_free(size_kib);
+        }
+        if (doom_log_flight_start(flight_path, capacity)) {
+            DOOM_SYS_ATEXIT(doom_log_flight_stop, true, doom_sys_exit_priority_last);
+        } else {
+            DOOM_LOG(system, warn, "Could not start the flight recorder at %s.\n", flight_path);
+        }
+        nonstd_free(flight_path);
+    }
+
+    if (doom_misc_check_parameter("-asynclog") > 0) {
+        if (doom_log_async_start()) {
+            DOOM_SYS_ATEXIT(doom_log_async_stop, true, doom_sys_exit_priority_last);
+        } else {
+            DOOM_LOG(system, warn, "Could not start the log writer thread; logging synchronously.\n");
+        }
+    }
+
+    char* trace_path = doom_misc_parameter_argument("-tracelog");
+    if (trace_path != NULL) {
+        if (doom_log_trace_start(trace_path)) {
+            DOOM_SYS_ATEXIT(doom_log_trace_stop, true, doom_sys_exit_priority_last);
+        } else {
+            DOOM_LOG(system, warn, "Could not start tracing to %s.\n", trace_path);
+        }
+        nonstd_free(trace_path);
+    }
+}
+
+void s_start_workers(void) {
+    size_t workers = doom_sys_jobs_default_worker_count();
+    if (doom_sys_jobs_start(workers)) {
+        DOOM_LOG(system, debug, "Started %zu worker threads.\n", workers);
+    } else {
+        DOOM_LOG(system, warn, "Could only start %zu of %zu worker threads.\n", doom_sys_jobs_worker_count(), workers);
+    }
+    DOOM_SYS_ATEXIT(doom_sys_jobs_stop, true, doom_sys_exit_priority_last);
+}
+
 void s_print_version(void) {
     char version_buffer[200];
     doom_log_printf(doom_log_level_info, "%s\n", doom_sys_get_version_string(version_buffer, sizeof(version_buffer)));
@@ -0,0 +1,254 @@
+#include "doom/log/async.h"
+
+#include "doom/log/printf.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+enum
+{
+    // Must be a power of two.
+    ring_capacity = 256,
+    batch_capacity = 64 * 1024,
+};
+
+typedef struct {
+    // The position this slot may next be claimed at (empty), or that position plus one (full).
+    atomic_size_t sequence;
+    uint32_t streams;
+    size_t length;
+    char text[doom_log_max_message_length];
+} s_record_t;
+
+static s_record_t s_ring[ring_capacity];
+static atomic_size_t s_enqueue_position;
+// Only touched by the writer thread.
+static size_t s_dequeue_position;
+static atomic_size_t s_written;
+
+static atomic_bool s_running;
+// Producers between their check of s_running and their last touch of the ring or the wake objects. Stopping waits for
+// this to drop to 0, so nothing still in flight can use the objects after they're destroyed.
+static atomic_size_t s_producers;
+static atomic_bool s_stopping;
+static atomic_bool s_writer_sleeping;
+static thrd_t s_writer;
+static mtx_t s_wake_mutex;
+static cnd_t s_wake_cond;
+
+static bool s_enter(void);
+static void s_leave(void);
+static int s_writer_main(void* arg);
+static bool s_ring_empty(void);
+static void s_wake_writer(void);
+
+bool doom_log_async_start(void) {
+    if (atomic_load(&s_running)) {
+        return true;
+    }
+
+    for (size_t i = 0; i < ring_capacity; i++) {
+        atomic_init(&s_ring[i].sequence, i);
+    }
+    atomic_store(&s_enqueue_position, 0);
+    s_dequeue_position = 0;
+    atomic_store(&s_written, 0);
+    atomic_store(&s_stopping, false);
+    atomic_store(&s_writer_sleeping, false);
+
+    if (mtx_init(&s_wake_mutex, mtx_plain) != thrd_success) {
+        return false;
+    }
+    if (cnd_init(&s_wake_cond) != thrd_success) {
+        mtx_destroy(&s_wake_mutex);
+        return false;
+    }
+    if (thrd_create(&s_writer, s_writer_main, NULL) != thrd_success) {
+        cnd_destroy(&s_wake_cond);
+        mtx_destroy(&s_wake_mutex);
+        return false;
+    }
+    atomic_store(&s_running, true);
+    return true;
+}
+
+bool doom_log_async_running(void) {
+    return atomic_load_explicit(&s_running, memory_order_acquire);
+}
+
+bool doom_log_async_push(uint32_t streams, const char* message, size_t length) {
+    if (!s_enter()) {
+        return false;
+    }
+
+    size_t position = atomic_load_explicit(&s_enqueue_position, memory_order_relaxed);
+    s_record_t* record;
+    while (true) {
+        record = &s_ring[position & (ring_capacity - 1)];
+        size_t sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+        intptr_t difference = (intptr_t)sequence - (intptr_t)position;
+        if (difference == 0) {
+            if (atomic_compare_exchange_weak_explicit(&s_enqueue_position, &position, position + 1,
+                                                      memory_order_relaxed, memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            // The ring is full; let the writer catch up.
+            s_wake_writer();
+            thrd_yield();
+            position = atomic_load_explicit(&s_enqueue_position, memory_order_relaxed);
+        } else {
+            position = atomic_load_explicit(&s_enqueue_position, memory_order_relaxed);
+        }
+    }
+
+    if (length >= doom_log_max_message_length) {
+        length = doom_log_max_message_length - 1;
+    }
+    record->streams = streams;
+    record->length = length;
+    memcpy(record->text, message, length);
+    atomic_store_explicit(&record->sequence, position + 1, memory_order_release);
+
+    atomic_thread_fence(memory_order_seq_cst);
+    if (atomic_load_explicit(&s_writer_sleeping, memory_order_relaxed)) {
+        s_wake_writer();
+    }
+    s_leave();
+    return true;
+}
+
+void doom_log_async_flush(void) {
+    if (!s_enter()) {
+        return;
+    }
+    size_t target = atomic_load(&s_enqueue_position);
+    while (atomic_load(&s_written) < target) {
+        s_wake_writer();
+        thrd_yield();
+    }
+    s_leave();
+}
+
+void doom_log_async_stop(void) {
+    if (!atomic_load(&s_running)) {
+        return;
+    }
+    // New messages are written synchronously from here on. The producers already past the check finish claiming and
+    // publishing their slots first; one may be waiting for room, so the writer keeps draining meanwhile.
+    atomic_store(&s_running, false);
+    while (atomic_load(&s_producers) > 0) {
+        s_wake_writer();
+        thrd_yield();
+    }
+    // Every claimed slot is published now, so the writer can stop once it has caught up with the enqueue position.
+    atomic_store(&s_stopping, true);
+    s_wake_writer();
+    thrd_join(s_writer, NULL);
+
+    cnd_destroy(&s_wake_cond);
+    mtx_destroy(&s_wake_mutex);
+}
+
+int s_writer_main(void* arg) {
+    (void)arg;
+    static char batch[batch_capacity];
+    size_t batch_length = 0;
+    FILE* batch_stream = NULL;
+
+    while (true) {
+        size_t drained = 0;
+        while (true) {
+            s_record_t* record = &s_ring[s_dequeue_position & (ring_capacity - 1)];
+            size_t sequence = atomic_load_explicit(&record->sequence, memory_order_acquire);
+            if (sequence != s_dequeue_position + 1) {
+                break;
+            }
+
+            // Consecutive records for the same stream are written with one call; switching streams writes out what
+            // is pending first, so the relative order of stdout and stderr is kept.
+            for (uint32_t stream = doom_log_stream_stdout; stream <= doom_log_stream_stderr; stream <<= 1) {
+                if ((record->streams & stream) == 0) {
+                    continue;
+                }
+                FILE* fp = stream == doom_log_stream_stdout ? stdout : stderr;
+                if (batch_length > 0 && (fp != batch_stream || batch_length + record->length > sizeof(batch))) {
+                    fwrite(batch, 1, batch_length, batch_stream);
+                    batch_length = 0;
+                }
+                batch_stream = fp;
+                memcpy(batch + batch_length, record->text, record->length);
+                batch_length += record->length;
+            }
+
+            atomic_store_explicit(&record->sequence, s_dequeue_position + ring_capacity, memory_order_release);
+            s_dequeue_position++;
+            drained++;
+        }
+
+        if (drained > 0) {
+            if (batch_length > 0) {
+                fwrite(batch, 1, batch_length, batch_stream);
+                batch_length = 0;
+            }
+            fflush(stdout);
+            fflush(stderr);
+            atomic_store(&s_written, s_dequeue_position);
+            continue;
+        }
+
+        if (atomic_load(&s_stopping) && s_dequeue_position == atomic_load(&s_enqueue_position)) {
+            break;
+        }
+
+        mtx_lock(&s_wake_mutex);
+        atomic_store(&s_writer_sleeping, true);
+        atomic_thread_fence(memory_order_seq_cst);
+        if (s_ring_empty() && !atomic_load(&s_stopping)) {
+            // The timeout is only a safety net; producers wake the writer when it is asleep.
+            struct timespec deadline;
+            timespec_get(&deadline, TIME_UTC);
+            deadline.tv_nsec += 50 * 1000 * 1000;
+            if (deadline.tv_nsec >= 1000 * 1000 * 1000) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000 * 1000 * 1000;
+            }
+            cnd_timedwait(&s_wake_cond, &s_wake_mutex, &deadline);
+        }
+        atomic_store(&s_writer_sleeping, false);
+        mtx_unlock(&s_wake_mutex);
+    }
+    return 0;
+}
+
+bool s_enter(void) {
+    // Counted before s_running is checked, and both sequentially consistent, so either doom_log_async_stop() sees this
+    // producer or this producer sees the writer stopping.
+    atomic_fetch_add(&s_producers, 1);
+    if (!atomic_load(&s_running)) {
+        atomic_fetch_sub(&s_producers, 1);
+        return false;
+    }
+    return true;
+}
+
+void s_leave(void) {
+    atomic_fetch_sub_explicit(&s_producers, 1, memory_order_release);
+}
+
+bool s_ring_empty(void) {
+    s_record_t* record = &s_ring[s_dequeue_position & (ring_capacity - 1)];
+    return atomic_load_explicit(&record->sequence, memory_order_acquire) != s_dequeue_position + 1;
+}
+
+void s_wake_writer(void) {
+    mtx_lock(&s_wake_mutex);
+    cnd_signal(&s_wake_cond);
+    mtx_unlock(&s_wake_mutex);
+}
@@ -0,0 +1,145 @@
+#include "doom/log/flight.h"
+
+#include "doom/log/printf.h"
+#include "doom/sys/mapped_file.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+enum
+{
+    // Keeps the message area cache-line aligned.
+    header_size = 64,
+};
+
+_Static_assert(sizeof(doom_log_flight_header_t) <= header_size, "the header must fit in header_size");
+
+static const char sc_magic[8] = {'C', 'D', 'F', 'L', 'I', 'G', 'H', 'T'};
+
+static doom_sys_mapped_file_t s_file;
+static doom_log_flight_header_t* s_header;
+static char* s_data;
+static uint64_t s_mask;
+static size_t s_sink = doom_log_max_sinks;
+
+static void s_write(doom_log_level_t level, const char* message, size_t length);
+static void s_dump_range(const char* begin, const char* end, FILE* out);
+
+bool doom_log_flight_start(const char* path, size_t capacity) {
+    if (s_header != NULL) {
+        return true;
+    }
+
+    size_t rounded = 1;
+    while (rounded < capacity) {
+        rounded <<= 1;
+    }
+
+    if (!doom_sys_map_file_create(&s_file, path, header_size + rounded)) {
+        return false;
+    }
+
+    doom_log_flight_header_t* header = s_file.data;
+    memcpy(header->magic, sc_magic, sizeof(header->magic));
+    header->version = doom_log_flight_version;
+    header->header_size = header_size;
+    header->capacity = rounded;
+    atomic_init(&header->cursor, 0);
+
+    s_header = header;
+    s_data = (char*)s_file.data + header_size;
+    s_mask = rounded - 1;
+    s_sink = doom_log_add_sink(s_write, doom_log_level_info | doom_log_level_warn | doom_log_level_error |
+                                            doom_log_level_debug);
+    if (s_sink == doom_log_max_sinks) {
+        doom_log_flight_stop();
+        return false;
+    }
+    return true;
+}
+
+void doom_log_flight_stop(void) {
+    if (s_header == NULL) {
+        return;
+    }
+    doom_log_remove_sink(s_sink);
+    s_sink = doom_log_max_sinks;
+    s_header = NULL;
+    s_data = NULL;
+    doom_sys_unmap_file(&s_file);
+}
+
+bool doom_log_flight_dump(const char* path, FILE* out) {
+    doom_sys_mapped_file_t file;
+    if (!doom_sys_map_file(&file, path)) {
+        return false;
+    }
+
+    // The file may be truncated or corrupt, so nothing in the header is trusted: the writer only ever uses its own
+    // header size, and the message area must fit in what follows it.
+    const doom_log_flight_header_t* header = file.data;
+    if (file.size < header_size || memcmp(header->magic, sc_magic, sizeof(sc_magic)) != 0 ||
+        header->version != doom_log_flight_version || header->header_size != header_size || header->capacity == 0 ||
+        (header->capacity & (header->capacity - 1)) != 0 || header->capacity > file.size - header_size) {
+        doom_sys_unmap_file(&file);
+        return false;
+    }
+
+    const char* data = (const char*)file.data + header_size;
+    uint64_t capacity = header->capacity;
+    uint64_t cursor = atomic_load(&header->cursor);
+
+    if (cursor <= capacity) {
+        s_dump_range(data, data + cursor, out);
+    } else {
+        // The oldest byte still in the file is at the cursor; the line it belongs to may have started before it.
+        size_t start = (size_t)(cursor & (capacity - 1));
+        const char* tail_begin = data + start;
+        const char* tail_end = data + capacity;
+        const char* newline = memchr(tail_begin, '\n', (size_t)(tail_end - tail_begin));
+        if (newline != NULL) {
+            s_dump_range(newline + 1, tail_end, out);
+            s_dump_range(data, data + start, out);
+        } else {
+            newline = memchr(data, '\n', start);
+            if (newline != NULL) {
+                s_dump_range(newline + 1, data + start, out);
+            }
+        }
+    }
+
+    doom_sys_unmap_file(&file);
+    return true;
+}
+
+void s_write(doom_log_level_t level, const char* message, size_t length) {
+    (void)level;
+    uint64_t capacity = s_mask + 1;
+    if (length > capacity) {
+        message += length - capacity;
+        length = (size_t)capacity;
+    }
+
+    // Writers reserve disjoint ranges, so they never wait for each other. A writer lapped by a full turn of the ring
+    // while copying can leave a torn line, which only matters for messages that are being overwritten anyway.
+    uint64_t start = atomic_fetch_add_explicit(&s_header->cursor, length, memory_order_relaxed);
+    size_t offset = (size_t)(start & s_mask);
+    size_t first = length < capacity - offset ? length : (size_t)(capacity - offset);
+    memcpy(s_data + offset, message, first);
+    memcpy(s_data, message + first, length - first);
+}
+
+void s_dump_range(const char* begin, const char* end, FILE* out) {
+    // Until the file wraps around, space that was reserved but never written (e.g. by a thread that crashed mid-copy)
+    // is still zero.
+    while (begin < end) {
+        const char* zero = memchr(begin, '\0', (size_t)(end - begin));
+        const char* stop = zero != NULL ? zero : end;
+        fwrite(begin, 1, (size_t)(stop - begin), out);
+        begin = stop < end ? stop + 1 : end;
+    }
+}
@@ -1,42 +1,112 @@
 #include "doom/log/printf.h"
 
+#include "doom/log/async.h"
 #include "doom/sys/system.h"
 
 #include <assert.h>
+#include <nonstd/alloc.h>
+#include <nonstd/stricmp.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
-static const doom_log_level_t console_stdout_mask = doom_log_level_info;
-static const doom_log_level_t console_stderr_mask = doom_log_level_warn | doom_log_level_error;
+#define CHANNEL_DEFAULT_MASK (doom_log_level_info | doom_log_level_warn | doom_log_level_error)
 
-#define MAX_MESSAGE_LENGTH 2048
+// Debug messages are opt-in per channel.
+atomic_uint doom_log_channel_masks[doom_log_channel_count] = {
+    [doom_log_channel_general] = CHANNEL_DEFAULT_MASK,
+    [doom_log_channel_system] = CHANNEL_DEFAULT_MASK,
+    [doom_log_channel_config] = CHANNEL_DEFAULT_MASK,
+    [doom_log_channel_input] = CHANNEL_DEFAULT_MASK,
+    [doom_log_channel_render] = CHANNEL_DEFAULT_MASK,
+    [doom_log_channel_sound] = CHANNEL_DEFAULT_MASK,
+    [doom_log_channel_wad] = CHANNEL_DEFAULT_MASK,
+};
+_Static_assert(doom_log_channel_count == 7, "A new log channel needs its default mask in doom_log_channel_masks");
+
+// Until a channel opts into debug or a sink is added, only the console masks.
+atomic_uint doom_log_sink_mask = doom_log_level_info | doom_log_level_warn | doom_log_level_error;
+
+static atomic_uint console_stdout_mask = doom_log_level_info;
+static atomic_uint console_stderr_mask = doom_log_level_warn | doom_log_level_error;
+
+static _Atomic(doom_log_sink_func_t) s_sink_funcs[doom_log_max_sinks];
+static atomic_uint s_sink_levels[doom_log_max_sinks];
+
+static const char* const sc_channel_names[] = {
+#define X(x) #x,
+    DOOM_LOG_CHANNELS_X
+#undef X
+};
+
+static int32_t s_vprintf(doom_log_level_t level, uint32_t stdout_levels, const char* format, va_list args);
+static void s_update_sink_mask(void);
 
 int32_t doom_log_printf(doom_log_level_t level, const char* format, ...) {
-    char message[MAX_MESSAGE_LENGTH];
+    va_list args;
+    va_start(args, format);
+    int32_t result = s_vprintf(level, 0, format, args);
+    va_end(args);
+    return result;
+}
 
+int32_t doom_log_channel_printf(doom_log_channel_t channel, doom_log_level_t level, const char* format, ...) {
+    uint32_t debug =
+        atomic_load_explicit(&doom_log_channel_masks[channel], memory_order_relaxed) & doom_log_level_debug;
     va_list args;
     va_start(args, format);
-    doom_vsnprintf(message, sizeof(message), format, args);
+    int32_t result = s_vprintf(level, debug, format, args);
     va_end(args);
+    return result;
+}
 
-    int32_t result = 0;
+void doom_log_set_channel_mask(doom_log_channel_t channel, uint32_t levels) {
+    atomic_store_explicit(&doom_log_channel_masks[channel], levels, memory_order_relaxed);
+    s_update_sink_mask();
+}
 
-    if (level & console_stdout_mask) {
-        result = fprintf(stdout, "%s", message);
+void doom_log_set_console_masks(uint32_t stdout_levels, uint32_t stderr_levels) {
+    atomic_store_explicit(&console_stdout_mask, stdout_levels, memory_order_relaxed);
+    atomic_store_explicit(&console_stderr_mask, stderr_levels, memory_order_relaxed);
+    s_update_sink_mask();
+}
+
+size_t doom_log_add_sink(doom_log_sink_func_t func, uint32_t levels) {
+    for (size_t i = 0; i < doom_log_max_sinks; i++) {
+        if (atomic_load_explicit(&s_sink_funcs[i], memory_order_relaxed) == NULL) {
+            atomic_store_explicit(&s_sink_funcs[i], func, memory_order_relaxed);
+            // Publishes the function to doom_log_printf().
+            atomic_store_explicit(&s_sink_levels[i], levels, memory_order_release);
+            s_update_sink_mask();
+            return i;
+        }
     }
+    return doom_log_max_sinks;
+}
 
-    if (level & console_stderr_mask) {
-        result = fprintf(stderr, "%s", message);
+void doom_log_remove_sink(size_t sink) {
+    if (sink >= doom_log_max_sinks) {
+        return;
     }
+    atomic_store_explicit(&s_sink_levels[sink], 0, memory_order_release);
+    atomic_store_explicit(&s_sink_funcs[sink], NULL, memory_order_relaxed);
+    s_update_sink_mask();
+}
 
-    return result;
+doom_log_channel_t doom_log_channel_from_name(const char* name) {
+    for (doom_log_channel_t channel = 0; channel < doom_log_channel_count; channel++) {
+        if (nonstd_stricmp(sc_channel_names[channel], name) == 0) {
+            return channel;
+        }
+    }
+    return doom_log_channel_count;
 }
 
 void doom_log_error(const char* format, ...) {
-    char error_message[MAX_MESSAGE_LENGTH];
+    char error_message[doom_log_max_message_length];
 
     va_list args;
     va_start(args, format);
@@ -44,6 +114,7 @@ void doom_log_error(const char* format, ...) {
     va_end(args);
 
     doom_log_printf(doom_log_level_error, "%s\n", error_message);
+    doom_log_async_flush();
     doom_sys_safe_exit(-1);
 }
 
@@ -65,14 +136,14 @@ int32_t doom_vsnprintf(char* buffer, size_t buffer_len, const char* format, va_l
             return len;
         }
 
-        char* backbuffer = malloc((size_t)len + 1);
+        char* backbuffer = nonstd_malloc((size_t)len + 1, nonstd_alloc_tag_log);
         if (backbuffer == NULL) {
             return -1;
         }
 
         result = vsnprintf(backbuffer, (size_t)len + 1, format, args);
         if (result < 0) {
-            free(backbuffer);
+            nonstd_free(backbuffer);
             return result;
         }
 
@@ -83,9 +154,76 @@ int32_t doom_vsnprintf(char* buffer, size_t buffer_len, const char* format, va_l
             memcpy(buffer, backbuffer, buffer_len - 1);
             buffer[buffer_len - 1] = '\0';
         }
-        free(backbuffer);
+        nonstd_free(backbuffer);
     } else if ((size_t)result >= buffer_len && buffer_len > 0 && buffer[buffer_len - 1] != '\0') {
         buffer[buffer_len - 1] = '\0';
     }
     return result;
 }
+
+int32_t s_vprintf(doom_log_level_t level, uint32_t stdout_levels, const char* format, va_list args) {
+    if ((level & atomic_load_explicit(&doom_log_sink_mask, memory_order_relaxed)) == 0) {
+        // Don't format what nobody will read.
+        return 0;
+    }
+
+    uint32_t streams = 0;
+    if (level & (atomic_load_explicit(&console_stdout_mask, memory_order_relaxed) | stdout_levels)) {
+        streams |= doom_log_stream_stdout;
+    }
+    if (level & atomic_load_explicit(&console_stderr_mask, memory_order_relaxed)) {
+        streams |= doom_log_stream_stderr;
+    }
+
+    char message[doom_log_max_message_length];
+    int32_t length = doom_vsnprintf(message, sizeof(message), format, args);
+
+    if (length < 0) {
+        return 0;
+    }
+    if ((size_t)length >= sizeof(message)) {
+        length = sizeof(message) - 1;
+    }
+
+    for (size_t i = 0; i < doom_log_max_sinks; i++) {
+        if ((level & atomic_load_explicit(&s_sink_levels[i], memory_order_acquire)) == 0) {
+            continue;
+        }
+        doom_log_sink_func_t func = atomic_load_explicit(&s_sink_funcs[i], memory_order_relaxed);
+        if (func != NULL) {
+            func(level, message, (size_t)length);
+        }
+    }
+
+    if (streams == 0) {
+        return length;
+    }
+    if (doom_log_async_push(streams, message, (size_t)length)) {
+        return length;
+    }
+
+    int32_t result = 0;
+
+    if (streams & doom_log_stream_stdout) {
+        result = fprintf(stdout, "%s", message);
+    }
+
+    if (streams & doom_log_stream_stderr) {
+        result = fprintf(stderr, "%s", message);
+    }
+
+    return result;
+}
+
+void s_update_sink_mask(void) {
+    uint32_t mask = atomic_load_explicit(&console_stdout_mask, memory_order_relaxed) |
+                    atomic_load_explicit(&console_stderr_mask, memory_order_relaxed);
+    // A channel that opted into debug writes it to stdout.
+    for (doom_log_channel_t channel = 0; channel < doom_log_channel_count; channel++) {
+        mask |= atomic_load_explicit(&doom_log_channel_masks[channel], memory_order_relaxed) & doom_log_level_debug;
+    }
+    for (size_t i = 0; i < doom_log_max_sinks; i++) {
+        mask |= atomic_load_explicit(&s_sink_levels[i], memory_order_relaxed);
+    }
+    atomic_store_explicit(&doom_log_sink_mask, mask, memory_order_relaxed);
+}
@@ -0,0 +1,572 @@
+#include "doom/log/trace.h"
+
+#include "doom/log/printf.h"
+#include "doom/sys/clock.h"
+
+#include <nonstd/alloc.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <threads.h>
+#include <time.h>
+
+enum
+{
+    // Must be a power of two.
+    buffer_capacity = 4096,
+    decode_interval_ms = 100,
+    min_drain_capacity = 16,
+    // doom_log_trace_site_t::state.
+    site_unparsed = 0,
+    site_parsing,
+    site_parsed,
+};
+
+typedef struct {
+    const doom_log_trace_site_t* site;
+    const char* format;
+    uint64_t timestamp;
+    uint64_t args[doom_log_trace_max_args];
+} s_record_t;
+
+// Single producer (the owning thread), single consumer (whoever holds s_decode_mutex).
+typedef struct s_buffer_s {
+    s_record_t records[buffer_capacity];
+    atomic_size_t head;
+    atomic_size_t tail;
+    atomic_size_t dropped;
+    // Set when the owning thread exits; the buffer is freed once it has been drained.
+    atomic_bool retired;
+    uint32_t thread_index;
+    struct s_buffer_s* next;
+} s_buffer_t;
+
+// A parsed conversion specification.
+typedef struct {
+    const char* begin;
+    const char* end;
+    bool star_width;
+    bool star_precision;
+    bool consumes_arg;
+    char conversion;
+    doom_log_trace_arg_kind_t kind;
+} s_spec_t;
+
+atomic_bool doom_log_trace_active;
+
+static _Thread_local s_buffer_t* s_thread_buffer;
+static _Atomic(s_buffer_t*) s_buffers;
+static atomic_uint s_thread_count;
+// Retires the buffer of a thread when it exits.
+static tss_t s_buffer_key;
+static bool s_buffer_key_created;
+static once_flag s_buffer_key_once = ONCE_FLAG_INIT;
+
+// The buffers being merged and where each one's drain ends. Only touched under s_decode_mutex.
+static s_buffer_t** s_drain_buffers;
+static size_t* s_drain_ends;
+static size_t s_drain_capacity;
+
+static FILE* s_output;
+static thrd_t s_decoder;
+static atomic_bool s_decoder_stopping;
+static mtx_t s_decode_mutex;
+
+static s_buffer_t* s_register_thread(void);
+static void s_create_buffer_key(void);
+static void s_retire_buffer(void* buffer);
+static void s_free_retired(void);
+static void s_parse_site(doom_log_trace_site_t* site, const char* format);
+static const char* s_next_spec(const char* p, s_spec_t* spec);
+static void s_decode(const s_record_t* record, char* buffer, size_t buffer_len);
+static void s_append_text(char* buffer, size_t buffer_len, size_t* length, const char* begin, const char* end);
+static int s_decoder_main(void* arg);
+static void s_drain(void);
+
+void doom_log_trace_write(doom_log_trace_site_t* site, const char* format, ...) {
+    uint64_t timestamp = doom_sys_clock_ns();
+
+    if (atomic_load_explicit(&site->state, memory_order_acquire) != site_parsed) {
+        // One thread parses the site; any other that hits it meanwhile waits, since it can't read the kinds yet.
+        unsigned int expected = site_unparsed;
+        if (atomic_compare_exchange_strong_explicit(&site->state, &expected, site_parsing, memory_order_acquire,
+                                                    memory_order_acquire)) {
+            s_parse_site(site, format);
+            atomic_store_explicit(&site->state, site_parsed, memory_order_release);
+        } else {
+            while (atomic_load_explicit(&site->state, memory_order_acquire) != site_parsed) {
+                thrd_yield();
+            }
+        }
+    }
+
+    s_buffer_t* buffer = s_thread_buffer;
+    if (buffer == NULL) {
+        buffer = s_register_thread();
+        if (buffer == NULL) {
+            return;
+        }
+    }
+
+    size_t head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+    if (head - atomic_load_explicit(&buffer->tail, memory_order_acquire) >= buffer_capacity) {
+        atomic_fetch_add_explicit(&buffer->dropped, 1, memory_order_relaxed);
+        return;
+    }
+
+    s_record_t* record = &buffer->records[head & (buffer_capacity - 1)];
+    record->site = site;
+    record->format = format;
+    record->timestamp = timestamp;
+
+    va_list args;
+    va_start(args, format);
+    for (uint32_t i = 0; i < site->arg_count; i++) {
+        switch (site->arg_kinds[i]) {
+        case doom_log_trace_arg_kind_int:
+            record->args[i] = (uint64_t)(int64_t)va_arg(args, int);
+            break;
+        case doom_log_trace_arg_kind_long:
+            record->args[i] = (uint64_t)(int64_t)va_arg(args, long);
+            break;
+        case doom_log_trace_arg_kind_long_long:
+            record->args[i] = (uint64_t)va_arg(args, long long);
+            break;
+        case doom_log_trace_arg_kind_intmax:
+            record->args[i] = (uint64_t)va_arg(args, intmax_t);
+            break;
+        case doom_log_trace_arg_kind_size:
+            record->args[i] = (uint64_t)va_arg(args, size_t);
+            break;
+        case doom_log_trace_arg_kind_ptrdiff:
+            record->args[i] = (uint64_t)va_arg(args, ptrdiff_t);
+            break;
+        case doom_log_trace_arg_kind_double: {
+            double value = va_arg(args, double);
+            memcpy(&record->args[i], &value, sizeof(value));
+            break;
+        }
+        case doom_log_trace_arg_kind_long_double: {
+            // Narrowed to fit in one word.
+            double value = (double)va_arg(args, long double);
+            memcpy(&record->args[i], &value, sizeof(value));
+            break;
+        }
+        case doom_log_trace_arg_kind_pointer:
+            record->args[i] = (uint64_t)(uintptr_t)va_arg(args, void*);
+            break;
+        }
+    }
+    va_end(args);
+
+    atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+bool doom_log_trace_start(const char* path) {
+    if (doom_log_trace_enabled()) {
+        return true;
+    }
+    s_output = fopen(path, "w");
+    if (s_output == NULL) {
+        return false;
+    }
+    if (mtx_init(&s_decode_mutex, mtx_plain) != thrd_success) {
+        fclose(s_output);
+        s_output = NULL;
+        return false;
+    }
+    atomic_store(&s_decoder_stopping, false);
+    if (thrd_create(&s_decoder, s_decoder_main, NULL) != thrd_success) {
+        mtx_destroy(&s_decode_mutex);
+        fclose(s_output);
+        s_output = NULL;
+        return false;
+    }
+    atomic_store(&doom_log_trace_active, true);
+    return true;
+}
+
+void doom_log_trace_flush(void) {
+    if (s_output == NULL) {
+        return;
+    }
+    mtx_lock(&s_decode_mutex);
+    s_drain();
+    mtx_unlock(&s_decode_mutex);
+}
+
+void doom_log_trace_stop(void) {
+    if (!doom_log_trace_enabled()) {
+        return;
+    }
+    atomic_store(&doom_log_trace_active, false);
+    atomic_store(&s_decoder_stopping, true);
+    thrd_join(s_decoder, NULL);
+
+    doom_log_trace_flush();
+    mtx_destroy(&s_decode_mutex);
+    fclose(s_output);
+    s_output = NULL;
+    nonstd_free(s_drain_buffers);
+    nonstd_free(s_drain_ends);
+    s_drain_buffers = NULL;
+    s_drain_ends = NULL;
+    s_drain_capacity = 0;
+}
+
+s_buffer_t* s_register_thread(void) {
+    s_buffer_t* buffer = nonstd_calloc(1, sizeof(s_buffer_t), nonstd_alloc_tag_log);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    buffer->thread_index = atomic_fetch_add(&s_thread_count, 1);
+
+    // Buffers are pushed at the head and only unlinked by the decoder, after their thread has exited and they've been
+    // drained, so the decoder still sees everything a thread wrote before exiting.
+    s_buffer_t* next = atomic_load(&s_buffers);
+    do {
+        buffer->next = next;
+    } while (!atomic_compare_exchange_weak(&s_buffers, &next, buffer));
+
+    call_once(&s_buffer_key_once, s_create_buffer_key);
+    if (s_buffer_key_created) {
+        tss_set(s_buffer_key, buffer);
+    }
+    s_thread_buffer = buffer;
+    return buffer;
+}
+
+void s_create_buffer_key(void) {
+    s_buffer_key_created = tss_create(&s_buffer_key, s_retire_buffer) == thrd_success;
+}
+
+void s_retire_buffer(void* buffer) {
+    atomic_store_explicit(&((s_buffer_t*)buffer)->retired, true, memory_order_release);
+}
+
+void s_free_retired(void) {
+    // Pushes only ever replace the head, so a buffer behind it can be unlinked in place; the head itself is
+    // unlinked with a CAS, which fails if a thread registered in the meantime.
+    s_buffer_t* previous = NULL;
+    s_buffer_t* buffer = atomic_load(&s_buffers);
+    while (buffer != NULL) {
+        s_buffer_t* next = buffer->next;
+        bool drained = atomic_load_explicit(&buffer->retired, memory_order_acquire) &&
+                       atomic_load_explicit(&buffer->tail, memory_order_relaxed) ==
+                           atomic_load_explicit(&buffer->head, memory_order_acquire) &&
+                       atomic_load_explicit(&buffer->dropped, memory_order_relaxed) == 0;
+        if (!drained) {
+            previous = buffer;
+        } else if (previous != NULL) {
+            previous->next = next;
+            nonstd_free(buffer);
+        } else {
+            s_buffer_t* expected = buffer;
+            if (atomic_compare_exchange_strong(&s_buffers, &expected, next)) {
+                nonstd_free(buffer);
+            } else {
+                // A buffer was pushed in front; find this one's new predecessor.
+                previous = expected;
+                while (previous->next != buffer) {
+                    previous = previous->next;
+                }
+                previous->next = next;
+                nonstd_free(buffer);
+            }
+        }
+        buffer = next;
+    }
+}
+
+void s_parse_site(doom_log_trace_site_t* site, const char* format) {
+    uint32_t count = 0;
+    s_spec_t spec;
+    const char* p = format;
+    while ((p = s_next_spec(p, &spec)) != NULL) {
+        if (spec.star_width && count < doom_log_trace_max_args) {
+            site->arg_kinds[count++] = doom_log_trace_arg_kind_int;
+        }
+        if (spec.star_precision && count < doom_log_trace_max_args) {
+            site->arg_kinds[count++] = doom_log_trace_arg_kind_int;
+        }
+        if (spec.consumes_arg && count < doom_log_trace_max_args) {
+            site->arg_kinds[count++] = spec.kind;
+        }
+    }
+    site->arg_count = count;
+}
+
+const char* s_next_spec(const char* p, s_spec_t* spec) {
+    while (true) {
+        p = strchr(p, '%');
+        if (p == NULL) {
+            return NULL;
+        }
+        if (p[1] == '%') {
+            p += 2;
+            continue;
+        }
+        break;
+    }
+
+    *spec = (s_spec_t){.begin = p, .kind = doom_log_trace_arg_kind_int, .consumes_arg = true};
+    ++p;
+    while (*p != '\0' && strchr("-+ #0'", *p) != NULL) {
+        ++p;
+    }
+    if (*p == '*') {
+        spec->star_width = true;
+        ++p;
+    } else {
+        while (*p >= '0' && *p <= '9') {
+            ++p;
+        }
+    }
+    if (*p == '.') {
+        ++p;
+        if (*p == '*') {
+            spec->star_precision = true;
+            ++p;
+        } else {
+            while (*p >= '0' && *p <= '9') {
+                ++p;
+            }
+        }
+    }
+
+    doom_log_trace_arg_kind_t integer_kind = doom_log_trace_arg_kind_int;
+    bool long_double = false;
+    switch (*p) {
+    case 'h':
+        p += p[1] == 'h' ? 2 : 1;
+        break;
+    case 'l':
+        if (p[1] == 'l') {
+            integer_kind = doom_log_trace_arg_kind_long_long;
+            p += 2;
+        } else {
+            integer_kind = doom_log_trace_arg_kind_long;
+            ++p;
+        }
+        break;
+    case 'j':
+        integer_kind = doom_log_trace_arg_kind_intmax;
+        ++p;
+        break;
+    case 'z':
+        integer_kind = doom_log_trace_arg_kind_size;
+        ++p;
+        break;
+    case 't':
+        integer_kind = doom_log_trace_arg_kind_ptrdiff;
+        ++p;
+        break;
+    case 'L':
+        long_double = true;
+        ++p;
+        break;
+    default:
+        break;
+    }
+
+    spec->conversion = *p;
+    switch (*p) {
+    case 'd':
+    case 'i':
+    case 'u':
+    case 'o':
+    case 'x':
+    case 'X':
+    case 'c':
+        spec->kind = integer_kind;
+        break;
+    case 'f':
+    case 'F':
+    case 'e':
+    case 'E':
+    case 'g':
+    case 'G':
+    case 'a':
+    case 'A':
+        spec->kind = long_double ? doom_log_trace_arg_kind_long_double : doom_log_trace_arg_kind_double;
+        break;
+    case 's':
+    case 'p':
+    case 'n':
+        spec->kind = doom_log_trace_arg_kind_pointer;
+        break;
+    case '\0':
+        // A dangling '%'; treat it as text.
+        spec->consumes_arg = false;
+        spec->end = p;
+        return p;
+    default:
+        spec->consumes_arg = false;
+        break;
+    }
+    spec->end = p + 1;
+    return spec->end;
+}
+
+void s_decode(const s_record_t* record, char* buffer, size_t buffer_len) {
+    const doom_log_trace_site_t* site = record->site;
+    size_t length = 0;
+    uint32_t arg = 0;
+    const char* text = record->format;
+    s_spec_t spec;
+    const char* p = record->format;
+
+#define APPEND(...)                                                                                                    \
+    do {                                                                                                               \
+        if (length < buffer_len) {                                                                                     \
+            int written_ = snprintf(buffer + length, buffer_len - length, __VA_ARGS__);                               \
+            length += written_ > 0 ? (size_t)written_ : 0;                                                             \
+        }                                                                                                              \
+    } while (0)
+
+    while ((p = s_next_spec(p, &spec)) != NULL) {
+        s_append_text(buffer, buffer_len, &length, text, spec.begin);
+        text = spec.end;
+        if (!spec.consumes_arg && !spec.star_width && !spec.star_precision) {
+            APPEND("%.*s", (int)(spec.end - spec.begin), spec.begin);
+            continue;
+        }
+
+        // Rebuild the conversion with any '*' replaced by the recorded value, so it can be formatted on its own.
+        char conversion[64];
+        size_t conversion_length = 0;
+        for (const char* c = spec.begin; c < spec.end && conversion_length + 12 < sizeof(conversion); c++) {
+            if (*c == '*') {
+                int32_t value = arg < site->arg_count ? (int32_t)record->args[arg] : 0;
+                arg++;
+                conversion_length += (size_t)snprintf(conversion + conversion_length,
+                                                      sizeof(conversion) - conversion_length, "%d", value);
+            } else {
+                conversion[conversion_length++] = *c;
+            }
+        }
+        conversion[conversion_length] = '\0';
+
+        if (!spec.consumes_arg) {
+            APPEND("%s", conversion);
+            continue;
+        }
+        if (arg >= site->arg_count) {
+            break;
+        }
+        uint64_t word = record->args[arg++];
+        double real;
+        memcpy(&real, &word, sizeof(real));
+
+        switch (spec.kind) {
+        case doom_log_trace_arg_kind_int:
+            APPEND(conversion, (int)word);
+            break;
+        case doom_log_trace_arg_kind_long:
+            APPEND(conversion, (long)word);
+            break;
+        case doom_log_trace_arg_kind_long_long:
+            APPEND(conversion, (long long)word);
+            break;
+        case doom_log_trace_arg_kind_intmax:
+            APPEND(conversion, (intmax_t)word);
+            break;
+        case doom_log_trace_arg_kind_size:
+            APPEND(conversion, (size_t)word);
+            break;
+        case doom_log_trace_arg_kind_ptrdiff:
+            APPEND(conversion, (ptrdiff_t)word);
+            break;
+        case doom_log_trace_arg_kind_double:
+            APPEND(conversion, real);
+            break;
+        case doom_log_trace_arg_kind_long_double:
+            APPEND(conversion, (long double)real);
+            break;
+        case doom_log_trace_arg_kind_pointer:
+            if (spec.conversion != 'n') {
+                APPEND(conversion, (void*)(uintptr_t)word);
+            }
+            break;
+        }
+    }
+    s_append_text(buffer, buffer_len, &length, text, text + strlen(text));
+
+#undef APPEND
+}
+
+void s_append_text(char* buffer, size_t buffer_len, size_t* length, const char* begin, const char* end) {
+    for (const char* c = begin; c < end && *length + 1 < buffer_len; c++) {
+        buffer[(*length)++] = *c;
+        if (c[0] == '%' && c + 1 < end && c[1] == '%') {
+            c++;
+        }
+    }
+    if (*length < buffer_len) {
+        buffer[*length] = '\0';
+    }
+}
+
+int s_decoder_main(void* arg) {
+    (void)arg;
+    while (!atomic_load(&s_decoder_stopping)) {
+        doom_log_trace_flush();
+        thrd_sleep(&(struct timespec){.tv_nsec = decode_interval_ms * 1000 * 1000}, NULL);
+    }
+    return 0;
+}
+
+void s_drain(void) {
+    char message[doom_log_max_message_length];
+
+    // Merge the thread buffers by timestamp. Only what was recorded before the drain started is taken, so a busy
+    // thread cannot keep the decoder here forever.
+    size_t buffer_count = 0;
+    for (s_buffer_t* buffer = atomic_load(&s_buffers); buffer != NULL; buffer = buffer->next) {
+        if (buffer_count == s_drain_capacity) {
+            s_drain_capacity = s_drain_capacity == 0 ? min_drain_capacity : s_drain_capacity * 2;
+            s_drain_buffers =
+                nonstd_realloc(s_drain_buffers, s_drain_capacity * sizeof(s_buffer_t*), nonstd_alloc_tag_log);
+            s_drain_ends = nonstd_realloc(s_drain_ends, s_drain_capacity * sizeof(size_t), nonstd_alloc_tag_log);
+        }
+        s_drain_buffers[buffer_count] = buffer;
+        s_drain_ends[buffer_count] = atomic_load_explicit(&buffer->head, memory_order_acquire);
+        buffer_count++;
+
+        size_t dropped = atomic_exchange_explicit(&buffer->dropped, 0, memory_order_relaxed);
+        if (dropped > 0) {
+            fprintf(s_output, "[thread %u] %zu trace messages dropped\n", buffer->thread_index, dropped);
+        }
+    }
+
+    while (true) {
+        s_buffer_t* earliest = NULL;
+        const s_record_t* earliest_record = NULL;
+        for (size_t i = 0; i < buffer_count; i++) {
+            size_t tail = atomic_load_explicit(&s_drain_buffers[i]->tail, memory_order_relaxed);
+            if (tail == s_drain_ends[i]) {
+                continue;
+            }
+            const s_record_t* record = &s_drain_buffers[i]->records[tail & (buffer_capacity - 1)];
+            if (earliest_record == NULL || record->timestamp < earliest_record->timestamp) {
+                earliest = s_drain_buffers[i];
+                earliest_record = record;
+            }
+        }
+        if (earliest == NULL) {
+            break;
+        }
+
+        s_decode(earliest_record, message, sizeof(message));
+        fprintf(s_output, "%llu.%09llu [thread %u] %s", (unsigned long long)(earliest_record->timestamp / 1000000000U),
+                (unsigned long long)(earliest_record->timestamp % 1000000000U), earliest->thread_index, message);
+        atomic_fetch_add_explicit(&earliest->tail, 1, memory_order_release);
+    }
+    fflush(s_output);
+    s_free_retired();
+}
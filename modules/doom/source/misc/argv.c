@@ -4,15 +4,15 @@
 #include "doom/log/printf.h"
 #include "phyto/string/string.h"
 
+#include <nonstd/alloc.h>
 #include <nonstd/ctype.h>
 #include <nonstd/strdup.h>
 #include <nonstd/stricmp.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
-#include <stdlib.h>
 
-PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL(doom_misc_parameters, phyto_string_t);
+PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL_TAGGED(doom_misc_parameters, phyto_string_t, nonstd_alloc_tag_params);
 
 static const doom_misc_parameters_callbacks_t doom_misc_parameters_callbacks = {
     .free_cb = phyto_string_free,
@@ -33,16 +33,33 @@ int32_t doom_misc_check_parameter_ex(const char* parameter, doom_misc_parameters
     for (size_t i = 0; i < params.size; i++) {
         char* nt = nonstd_strndup(params.data[i].data, params.data[i].size);
         if (nonstd_stricmp(nt, parameter) == 0) {
-            free(nt);
+            nonstd_free(nt);
             return (int32_t)i;
         }
-        free(nt);
+        nonstd_free(nt);
     }
     return -1;
 }
 
+char* doom_misc_parameter_argument(const char* parameter) {
+    return doom_misc_parameter_argument_ex(parameter, doom_state->params);
+}
+
+char* doom_misc_parameter_argument_ex(const char* parameter, doom_misc_parameters_t params) {
+    int32_t index = doom_misc_check_parameter_ex(parameter, params);
+    if (index <= 0 || (size_t)index + 1 >= params.size) {
+        return NULL;
+    }
+    phyto_string_t argument = params.data[index + 1];
+    return nonstd_strndup(argument.data, argument.size);
+}
+
 void doom_misc_add_parameter(const char* parameter) {
-    doom_misc_parameters_append(&doom_state->params, phyto_string_from_c(parameter));
+    doom_misc_add_parameter_ex(parameter, &doom_state->params);
+}
+
+void doom_misc_add_parameter_ex(const char* parameter, doom_misc_parameters_t* params) {
+    doom_misc_parameters_append(params, phyto_string_from_c(parameter));
 }
 
 void doom_misc_parse_command_line(char* cmd_start, doom_misc_parameters_t* out_params) {
@@ -7,6 +7,7 @@
 #include "doom/hud/strings.h"
 #include "doom/init.h"
 #include "doom/keys.h"
+#include "doom/misc/subscriptions.h"
 #include "doom/render/demo.h"
 #include "doom/render/draw.h"
 #include "doom/render/things.h"
@@ -18,9 +19,11 @@
 
 #include <assert.h>
 #include <config.h>
+#include <nonstd/stricmp.h>
 #include <stdint.h>
+#include <string.h>
 
-PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL(doom_misc_default_dyarray, doom_misc_default_t);
+PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL_TAGGED(doom_misc_default_dyarray, doom_misc_default_t, nonstd_alloc_tag_config);
 
 static const doom_misc_default_dyarray_callbacks_t sc_default_dyarray_callbacks = {
     .free_cb = NULL,
@@ -91,6 +94,10 @@ static doom_misc_default_t s_input_default(input_default_t value);
 static doom_misc_default_t s_owning_string_default(owning_string_default_t value);
 
 doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
+    return doom_misc_default_dyarray_new_ex(&doom_state->defaults_storage);
+}
+
+doom_misc_default_dyarray_t doom_misc_default_dyarray_new_ex(doom_misc_default_storage_t* storage) {
     static_assert(sizeof(doom_compatibility_level_t) == sizeof(int), "i can't cast enums to ints");
 
     doom_misc_default_dyarray_t defaults = doom_misc_default_dyarray_init(&sc_default_dyarray_callbacks);
@@ -98,7 +105,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("System settings"));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "process_priority",
-                                                    .location = &doom_state->defaults_storage.process_priority,
+                                                    .location = &storage->process_priority,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 2,
@@ -109,7 +116,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "default_compatibility_level",
-                                         .location = (int*)&doom_state->defaults_storage.default_compatibility_level,
+                                         .location = (int*)&storage->default_compatibility_level,
                                          .default_value = -1,
                                          .min_value = -1,
                                          .max_value = doom_compatibility_level_max - 1,
@@ -117,7 +124,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "realtic_clock_rate",
-                                                    .location = &doom_state->defaults_storage.realtic_clock_rate,
+                                                    .location = &storage->realtic_clock_rate,
                                                     .default_value = 100,
                                                     .min_value = 0,
                                                     .max_value = max_unset,
@@ -125,13 +132,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "menu_background",
-                                                    .location = &doom_state->defaults_storage.menu_background,
+                                                    .location = &storage->menu_background,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "max_player_corpse",
-                                                    .location = &doom_state->defaults_storage.max_player_corpse,
+                                                    .location = &storage->max_player_corpse,
                                                     .default_value = 32,
                                                     .min_value = -1,
                                                     .max_value = max_unset,
@@ -139,13 +146,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "flashing_hom",
-                                                    .location = &doom_state->defaults_storage.flashing_hom,
+                                                    .location = &storage->flashing_hom,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_hexint_default((hexint_default_t){
                                                     .name = "endoom_mode",
-                                                    .location = &doom_state->defaults_storage.endoom_mode,
+                                                    .location = &storage->endoom_mode,
                                                     .default_value = 5,
                                                     .min_value = 0,
                                                     .max_value = 7,
@@ -153,19 +160,19 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "level_precache",
-                                                    .location = &doom_state->defaults_storage.level_precache,
+                                                    .location = &storage->level_precache,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "demo_smoothturns",
-                                                    .location = &doom_state->defaults_storage.demo_smoothturns,
+                                                    .location = &storage->demo_smoothturns,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "demo_smoothturnsfactor",
-                                                    .location = &doom_state->defaults_storage.demo_smoothturnsfactor,
+                                                    .location = &storage->demo_smoothturnsfactor,
                                                     .default_value = 6,
                                                     .min_value = 1,
                                                     .max_value = doom_demo_smoothturnsfactor_max,
@@ -175,25 +182,25 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Files"));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "wadfile_1",
-                                                    .location = &doom_state->defaults_storage.wad_files[1],
+                                                    .location = &storage->wad_files[1],
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "wadfile_2",
-                                                    .location = &doom_state->defaults_storage.wad_files[2],
+                                                    .location = &storage->wad_files[2],
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "dehfile_1",
-                                                    .location = &doom_state->defaults_storage.deh_files[0],
+                                                    .location = &storage->deh_files[0],
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "dehfile_2",
-                                                    .location = &doom_state->defaults_storage.deh_files[1],
+                                                    .location = &storage->deh_files[1],
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
@@ -201,7 +208,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Game settings"));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "default_skill",
-                                                    .location = &doom_state->defaults_storage.default_skill,
+                                                    .location = &storage->default_skill,
                                                     .default_value = 4,
                                                     .min_value = 0,
                                                     .max_value = 5,
@@ -210,7 +217,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "weapon_attack_alignment",
-                                         .location = (int*)&doom_state->defaults_storage.weapon_attack_alignment,
+                                         .location = (int*)&storage->weapon_attack_alignment,
                                          .default_value = doom_centerweapon_off,
                                          .min_value = doom_centerweapon_off,
                                          .max_value = doom_centerweapon_bob,
@@ -218,25 +225,25 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "sts_always_red",
-                                                    .location = &doom_state->defaults_storage.sts_always_red,
+                                                    .location = &storage->sts_always_red,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "sts_pct_always_gray",
-                                                    .location = &doom_state->defaults_storage.sts_pct_always_gray,
+                                                    .location = &storage->sts_pct_always_gray,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "sts_traditional_keys",
-                                                    .location = &doom_state->defaults_storage.sts_traditional_keys,
+                                                    .location = &storage->sts_traditional_keys,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "sts_armorcolor_type",
-                                                    .location = (int*)&doom_state->defaults_storage.sts_armorcolor_type,
+                                                    .location = (int*)&storage->sts_armorcolor_type,
                                                     .default_value = doom_armor_color_type_strength,
                                                     .min_value = doom_armor_color_type_strength,
                                                     .max_value = doom_armor_color_type_amount,
@@ -244,13 +251,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "show_messages",
-                                                    .location = &doom_state->defaults_storage.dsda.show_messages,
+                                                    .location = &storage->dsda.show_messages,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "autorun",
-                                                    .location = &doom_state->defaults_storage.dsda.autorun,
+                                                    .location = &storage->dsda.autorun,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
@@ -258,7 +265,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Dehacked settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "deh_apply_cheats",
-                                                    .location = &doom_state->defaults_storage.deh_apply_cheats,
+                                                    .location = &storage->deh_apply_cheats,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
@@ -266,13 +273,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Sound settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "snd_pcspeaker",
-                                                    .location = &doom_state->defaults_storage.snd_pcspeaker,
+                                                    .location = &storage->snd_pcspeaker,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "sound_card",
-                                                    .location = &doom_state->defaults_storage.sound_card,
+                                                    .location = &storage->sound_card,
                                                     .default_value = -1,
                                                     .min_value = -1,
                                                     .max_value = 7,
@@ -280,7 +287,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "music_card",
-                                                    .location = &doom_state->defaults_storage.music_card,
+                                                    .location = &storage->music_card,
                                                     .default_value = -1,
                                                     .min_value = -1,
                                                     .max_value = 7,
@@ -288,13 +295,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "pitched_sounds",
-                                                    .location = &doom_state->defaults_storage.pitched_sounds,
+                                                    .location = &storage->pitched_sounds,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "samplerate",
-                                                    .location = &doom_state->defaults_storage.samplerate,
+                                                    .location = &storage->samplerate,
                                                     .default_value = 44100,
                                                     .min_value = 11025,
                                                     .max_value = 48000,
@@ -302,7 +309,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "slice_samplecount",
-                                                    .location = &doom_state->defaults_storage.slice_samplecount,
+                                                    .location = &storage->slice_samplecount,
                                                     .default_value = 512,
                                                     .min_value = 32,
                                                     .max_value = 8192,
@@ -310,7 +317,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "sfx_volume",
-                                                    .location = &doom_state->defaults_storage.sfx_volume,
+                                                    .location = &storage->sfx_volume,
                                                     .default_value = 8,
                                                     .min_value = 0,
                                                     .max_value = 15,
@@ -318,7 +325,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "music_volume",
-                                                    .location = &doom_state->defaults_storage.music_volume,
+                                                    .location = &storage->music_volume,
                                                     .default_value = 8,
                                                     .min_value = 0,
                                                     .max_value = 15,
@@ -326,7 +333,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mus_pause_opt",
-                                                    .location = (int*)&doom_state->defaults_storage.mus_pause_opt,
+                                                    .location = (int*)&storage->mus_pause_opt,
                                                     .default_value = doom_mus_pause_opt_pause,
                                                     .min_value = doom_mus_pause_opt_kill,
                                                     .max_value = doom_mus_pause_opt_continue_playing,
@@ -334,7 +341,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "snd_channels",
-                                                    .location = &doom_state->defaults_storage.snd_channels,
+                                                    .location = &storage->snd_channels,
                                                     .default_value = 32,
                                                     .min_value = 1,
                                                     .max_value = 32,
@@ -342,44 +349,44 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "snd_midiplayer",
-                                                    .location = &doom_state->defaults_storage.snd_midiplayer,
+                                                    .location = &storage->snd_midiplayer,
                                                     .default_value = phyto_string_span_from_c("fluidsynth"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_string_default((string_default_t){
                                          .name = "snd_soundfont",
-                                         .location = &doom_state->defaults_storage.snd_soundfont,
+                                         .location = &storage->snd_soundfont,
                                          .default_value = phyto_string_span_from_c("soundfonts/" PROJECT_NAME ".sf2"),
                                          .setup_screen = doom_misc_setup_screen_none,
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "snd_mididev",
-                                                    .location = &doom_state->defaults_storage.snd_mididev,
+                                                    .location = &storage->snd_mididev,
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "full_sounds",
-                                                    .location = &doom_state->defaults_storage.full_sounds,
+                                                    .location = &storage->full_sounds,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "mus_fluidsynth_chorus",
-                                                    .location = &doom_state->defaults_storage.mus_fluidsynth_chorus,
+                                                    .location = &storage->mus_fluidsynth_chorus,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "mus_fluidsynth_reverb",
-                                                    .location = &doom_state->defaults_storage.mus_fluidsynth_reverb,
+                                                    .location = &storage->mus_fluidsynth_reverb,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mus_fluidsynth_gain",
-                                                    .location = &doom_state->defaults_storage.mus_fluidsynth_gain,
+                                                    .location = &storage->mus_fluidsynth_gain,
                                                     .default_value = 50,
                                                     .min_value = 0,
                                                     .max_value = 1000,
@@ -387,7 +394,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mus_opl_gain",
-                                                    .location = &doom_state->defaults_storage.mus_opl_gain,
+                                                    .location = &storage->mus_opl_gain,
                                                     .default_value = 50,
                                                     .min_value = 0,
                                                     .max_value = 1000,
@@ -397,49 +404,49 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Video settings"));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "videomode",
-                                                    .location = &doom_state->defaults_storage.videomode,
+                                                    .location = &storage->videomode,
                                                     .default_value = phyto_string_span_from_c("Software"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "screen_resolution",
-                                                    .location = &doom_state->defaults_storage.screen_resolution,
+                                                    .location = &storage->screen_resolution,
                                                     .default_value = phyto_string_span_from_c("640x480"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "custom_resoltuion",
-                                                    .location = &doom_state->defaults_storage.custom_resolution,
+                                                    .location = &storage->custom_resolution,
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "use_fullscreen",
-                                                    .location = &doom_state->defaults_storage.use_fullscreen,
+                                                    .location = &storage->use_fullscreen,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "exclusive_fullscreen",
-                                                    .location = &doom_state->defaults_storage.exclusive_fullscreen,
+                                                    .location = &storage->exclusive_fullscreen,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_exclusive_fullscreen",
-                                                    .location = &doom_state->defaults_storage.gl_exclusive_fullscreen,
+                                                    .location = &storage->gl_exclusive_fullscreen,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "render_vsync",
-                                                    .location = &doom_state->defaults_storage.render_vsync,
+                                                    .location = &storage->render_vsync,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "tran_filter_pct",
-                                                    .location = &doom_state->defaults_storage.tran_filter_pct,
+                                                    .location = &storage->tran_filter_pct,
                                                     .default_value = 66,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -447,7 +454,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "screenblocks",
-                                                    .location = &doom_state->defaults_storage.screenblocks,
+                                                    .location = &storage->screenblocks,
                                                     .default_value = 10,
                                                     .min_value = 3,
                                                     .max_value = 11,
@@ -455,7 +462,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "usegamma",
-                                                    .location = &doom_state->defaults_storage.usegamma,
+                                                    .location = &storage->usegamma,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 4,
@@ -463,13 +470,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "uncapped_framerate",
-                                                    .location = &doom_state->defaults_storage.uncapped_framerate,
+                                                    .location = &storage->uncapped_framerate,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "dsda_fps_limit",
-                                                    .location = &doom_state->defaults_storage.dsda.fps_limit,
+                                                    .location = &storage->dsda.fps_limit,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 1000,
@@ -477,7 +484,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "filter_wall",
-                                                    .location = (int*)&doom_state->defaults_storage.filter_wall,
+                                                    .location = (int*)&storage->filter_wall,
                                                     .default_value = doom_render_draw_filter_type_point,
                                                     .min_value = doom_render_draw_filter_type_point,
                                                     .max_value = doom_render_draw_filter_type_rounded,
@@ -485,7 +492,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "filter_floor",
-                                                    .location = (int*)&doom_state->defaults_storage.filter_floor,
+                                                    .location = (int*)&storage->filter_floor,
                                                     .default_value = doom_render_draw_filter_type_point,
                                                     .min_value = doom_render_draw_filter_type_point,
                                                     .max_value = doom_render_draw_filter_type_rounded,
@@ -493,7 +500,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "filter_sprite",
-                                                    .location = (int*)&doom_state->defaults_storage.filter_sprite,
+                                                    .location = (int*)&storage->filter_sprite,
                                                     .default_value = doom_render_draw_filter_type_point,
                                                     .min_value = doom_render_draw_filter_type_point,
                                                     .max_value = doom_render_draw_filter_type_rounded,
@@ -501,7 +508,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "filter_z",
-                                                    .location = (int*)&doom_state->defaults_storage.filter_z,
+                                                    .location = (int*)&storage->filter_z,
                                                     .default_value = doom_render_draw_filter_type_point,
                                                     .min_value = doom_render_draw_filter_type_point,
                                                     .max_value = doom_render_draw_filter_type_linear,
@@ -509,7 +516,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "filter_patch",
-                                                    .location = (int*)&doom_state->defaults_storage.filter_patch,
+                                                    .location = (int*)&storage->filter_patch,
                                                     .default_value = doom_render_draw_filter_type_point,
                                                     .min_value = doom_render_draw_filter_type_point,
                                                     .max_value = doom_render_draw_filter_type_rounded,
@@ -517,7 +524,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "filter_threshold",
-                                                    .location = &doom_state->defaults_storage.filter_threshold,
+                                                    .location = &storage->filter_threshold,
                                                     .default_value = 49152,
                                                     .min_value = 0,
                                                     .max_value = max_unset,
@@ -525,7 +532,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "sprite_edges",
-                                                    .location = (int*)&doom_state->defaults_storage.sprite_edges,
+                                                    .location = (int*)&storage->sprite_edges,
                                                     .default_value = doom_render_draw_sloped_edge_type_square,
                                                     .min_value = doom_render_draw_sloped_edge_type_square,
                                                     .max_value = doom_render_draw_sloped_edge_type_sloped,
@@ -533,7 +540,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "patch_edges",
-                                                    .location = (int*)&doom_state->defaults_storage.patch_edges,
+                                                    .location = (int*)&storage->patch_edges,
                                                     .default_value = doom_render_draw_sloped_edge_type_square,
                                                     .min_value = doom_render_draw_sloped_edge_type_square,
                                                     .max_value = doom_render_draw_sloped_edge_type_sloped,
@@ -543,109 +550,109 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("OpenGL settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_compatibility",
-                                                    .location = &doom_state->defaults_storage.gl_compatibility,
+                                                    .location = &storage->gl_compatibility,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_arb_multitexture",
-                                                    .location = &doom_state->defaults_storage.gl_arb.multitexture,
+                                                    .location = &storage->gl_arb.multitexture,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "gl_arb_texture_compression",
-                                         .location = &doom_state->defaults_storage.gl_arb.texture_compression,
+                                         .location = &storage->gl_arb.texture_compression,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "gl_arb_texture_non_power_of_two",
-                                         .location = &doom_state->defaults_storage.gl_arb.texture_non_power_of_two,
+                                         .location = &storage->gl_arb.texture_non_power_of_two,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "gl_ext_arb_vertex_buffer_object",
-                                         .location = &doom_state->defaults_storage.gl_ext.arb_vertex_buffer_object,
+                                         .location = &storage->gl_ext.arb_vertex_buffer_object,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "gl_arb_pixel_buffer_object",
-                                         .location = &doom_state->defaults_storage.gl_arb.pixel_buffer_object,
+                                         .location = &storage->gl_arb.pixel_buffer_object,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_arb_shader_objects",
-                                                    .location = &doom_state->defaults_storage.gl_arb.shader_objects,
+                                                    .location = &storage->gl_arb.shader_objects,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_ext_blend_color",
-                                                    .location = &doom_state->defaults_storage.gl_ext.blend_color,
+                                                    .location = &storage->gl_ext.blend_color,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_ext_framebuffer_object",
-                                                    .location = &doom_state->defaults_storage.gl_ext.framebuffer_object,
+                                                    .location = &storage->gl_ext.framebuffer_object,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "gl_ext_packed_depth_stencil",
-                                         .location = &doom_state->defaults_storage.gl_ext.packed_depth_stencil,
+                                         .location = &storage->gl_ext.packed_depth_stencil,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "gl_ext_texture_filter_anisotropic",
-                                         .location = &doom_state->defaults_storage.gl_ext.texture_filter_anisotropic,
+                                         .location = &storage->gl_ext.texture_filter_anisotropic,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_use_stencil",
-                                                    .location = &doom_state->defaults_storage.gl_use_stencil,
+                                                    .location = &storage->gl_use_stencil,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_use_display_lists",
-                                                    .location = &doom_state->defaults_storage.gl_use_display_lists,
+                                                    .location = &storage->gl_use_display_lists,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_finish",
-                                                    .location = &doom_state->defaults_storage.gl_finish,
+                                                    .location = &storage->gl_finish,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_clear",
-                                                    .location = &doom_state->defaults_storage.gl_clear,
+                                                    .location = &storage->gl_clear,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_ztrick",
-                                                    .location = &doom_state->defaults_storage.gl_ztrick,
+                                                    .location = &storage->gl_ztrick,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_nearclip",
-                                                    .location = &doom_state->defaults_storage.gl_nearclip,
+                                                    .location = &storage->gl_nearclip,
                                                     .default_value = 5,
                                                     .min_value = 0,
                                                     .max_value = max_unset,
@@ -653,7 +660,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_colorbuffer_bits",
-                                                    .location = &doom_state->defaults_storage.gl_colorbuffer_bits,
+                                                    .location = &storage->gl_colorbuffer_bits,
                                                     .default_value = 32,
                                                     .min_value = 16,
                                                     .max_value = 32,
@@ -661,7 +668,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_depthbuffer_bits",
-                                                    .location = &doom_state->defaults_storage.gl_depthbuffer_bits,
+                                                    .location = &storage->gl_depthbuffer_bits,
                                                     .default_value = 24,
                                                     .min_value = 16,
                                                     .max_value = 32,
@@ -670,7 +677,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "gl_texture_filter",
-                                         .location = (int*)&doom_state->defaults_storage.gl_texture_filter,
+                                         .location = (int*)&storage->gl_texture_filter,
                                          .default_value = doom_gl_struct_filter_texture_mode_nearest_mipmap_linear,
                                          .min_value = doom_gl_struct_filter_texture_mode_nearest,
                                          .max_value = doom_gl_struct_filter_texture_mode_count - 1,
@@ -679,7 +686,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "gl_sprite_filter",
-                                         .location = (int*)&doom_state->defaults_storage.gl_sprite_filter,
+                                         .location = (int*)&storage->gl_sprite_filter,
                                          .default_value = doom_gl_struct_filter_texture_mode_nearest,
                                          .min_value = doom_gl_struct_filter_texture_mode_nearest,
                                          .max_value = doom_gl_struct_filter_texture_mode_linear_mipmap_nearest,
@@ -687,7 +694,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_patch_filter",
-                                                    .location = (int*)&doom_state->defaults_storage.gl_patch_filter,
+                                                    .location = (int*)&storage->gl_patch_filter,
                                                     .default_value = doom_gl_struct_filter_texture_mode_nearest,
                                                     .min_value = doom_gl_struct_filter_texture_mode_nearest,
                                                     .max_value = doom_gl_struct_filter_texture_mode_linear,
@@ -696,7 +703,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "gl_texture_filter_anisotropic",
-                                         .location = (int*)&doom_state->defaults_storage.gl_texture_filter_anisotropic,
+                                         .location = (int*)&storage->gl_texture_filter_anisotropic,
                                          .default_value = doom_gl_struct_anisotropic_mode_on_8x,
                                          .min_value = doom_gl_struct_anisotropic_mode_off,
                                          .max_value = doom_gl_struct_anisotropic_mode_on_16x,
@@ -704,13 +711,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "gl_tex_format_string",
-                                                    .location = &doom_state->defaults_storage.gl_tex_format_string,
+                                                    .location = &storage->gl_tex_format_string,
                                                     .default_value = phyto_string_span_from_c("GL_RGBA"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_sprite_offset",
-                                                    .location = &doom_state->defaults_storage.gl_sprite_offset,
+                                                    .location = &storage->gl_sprite_offset,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 5,
@@ -718,13 +725,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_sprite_blend",
-                                                    .location = &doom_state->defaults_storage.gl_sprite_blend,
+                                                    .location = &storage->gl_sprite_blend,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_mask_sprite_threshold",
-                                                    .location = &doom_state->defaults_storage.gl_mask_sprite_threshold,
+                                                    .location = &storage->gl_mask_sprite_threshold,
                                                     .default_value = 50,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -732,7 +739,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_skymode",
-                                                    .location = (int*)&doom_state->defaults_storage.gl_skymode,
+                                                    .location = (int*)&storage->gl_skymode,
                                                     .default_value = doom_gl_struct_skytype_auto,
                                                     .min_value = doom_gl_struct_skytype_auto,
                                                     .max_value = doom_gl_struct_skytype_count - 1,
@@ -740,7 +747,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_sky_detail",
-                                                    .location = &doom_state->defaults_storage.gl_sky_detail,
+                                                    .location = &storage->gl_sky_detail,
                                                     .default_value = 16,
                                                     .min_value = 1,
                                                     .max_value = 32,
@@ -748,14 +755,14 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_use_paletted_texture",
-                                                    .location = &doom_state->defaults_storage.gl_use_paletted_texture,
+                                                    .location = &storage->gl_use_paletted_texture,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "gl_use_shared_texture_palette",
-                                         .location = &doom_state->defaults_storage.gl_use_shared_texture_palette,
+                                         .location = &storage->gl_use_shared_texture_palette,
                                          .default_value = false,
                                          .setup_screen = doom_misc_setup_screen_none,
                                      }));
@@ -763,7 +770,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Input settings"));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "input_profile",
-                                                    .location = &doom_state->defaults_storage.input_profile,
+                                                    .location = &storage->input_profile,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = doom_dsda_input_profile_count - 1,
@@ -1670,14 +1677,14 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Mouse settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "use_mouse",
-                                                    .location = &doom_state->defaults_storage.use_mouse,
+                                                    .location = &storage->use_mouse,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "mouse_sensitivity_horiz",
-                                         .location = &doom_state->defaults_storage.mouse_sensitivity_horizontal,
+                                         .location = &storage->mouse_sensitivity_horizontal,
                                          .default_value = 10,
                                          .min_value = 0,
                                          .max_value = max_unset,
@@ -1686,7 +1693,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "mouse_sensitivity_vert",
-                                         .location = &doom_state->defaults_storage.mouse_sensitivity_vertical,
+                                         .location = &storage->mouse_sensitivity_vertical,
                                          .default_value = 1,
                                          .min_value = 0,
                                          .max_value = max_unset,
@@ -1696,7 +1703,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Joystick settings"));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "use_joystick",
-                                                    .location = &doom_state->defaults_storage.use_joystick,
+                                                    .location = &storage->use_joystick,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 2,
@@ -1706,61 +1713,61 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Chat macros"));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro0",
-                                                    .location = &doom_state->defaults_storage.chat_macros[0],
+                                                    .location = &storage->chat_macros[0],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_0,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro1",
-                                                    .location = &doom_state->defaults_storage.chat_macros[1],
+                                                    .location = &storage->chat_macros[1],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_1,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro2",
-                                                    .location = &doom_state->defaults_storage.chat_macros[2],
+                                                    .location = &storage->chat_macros[2],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_2,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro3",
-                                                    .location = &doom_state->defaults_storage.chat_macros[3],
+                                                    .location = &storage->chat_macros[3],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_3,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro4",
-                                                    .location = &doom_state->defaults_storage.chat_macros[4],
+                                                    .location = &storage->chat_macros[4],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_4,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro5",
-                                                    .location = &doom_state->defaults_storage.chat_macros[5],
+                                                    .location = &storage->chat_macros[5],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_5,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro6",
-                                                    .location = &doom_state->defaults_storage.chat_macros[6],
+                                                    .location = &storage->chat_macros[6],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_6,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro7",
-                                                    .location = &doom_state->defaults_storage.chat_macros[7],
+                                                    .location = &storage->chat_macros[7],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_7,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro8",
-                                                    .location = &doom_state->defaults_storage.chat_macros[8],
+                                                    .location = &storage->chat_macros[8],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_8,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "chatmacro9",
-                                                    .location = &doom_state->defaults_storage.chat_macros[9],
+                                                    .location = &storage->chat_macros[9],
                                                     .default_value = DOOM_HUD_STRING_CHAT_MACRO_9,
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
@@ -1768,7 +1775,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Automap settings"));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_back",
-                                                    .location = &doom_state->defaults_storage.mapcolor_back,
+                                                    .location = &storage->mapcolor_back,
                                                     .default_value = 247,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1776,7 +1783,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_grid",
-                                                    .location = &doom_state->defaults_storage.mapcolor_grid,
+                                                    .location = &storage->mapcolor_grid,
                                                     .default_value = 104,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1784,7 +1791,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_wall",
-                                                    .location = &doom_state->defaults_storage.mapcolor_wall,
+                                                    .location = &storage->mapcolor_wall,
                                                     .default_value = 23,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1792,7 +1799,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_fchg",
-                                                    .location = &doom_state->defaults_storage.mapcolor_fchg,
+                                                    .location = &storage->mapcolor_fchg,
                                                     .default_value = 55,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1800,7 +1807,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_cchg",
-                                                    .location = &doom_state->defaults_storage.mapcolor_cchg,
+                                                    .location = &storage->mapcolor_cchg,
                                                     .default_value = 215,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1808,7 +1815,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_clsd",
-                                                    .location = &doom_state->defaults_storage.mapcolor_clsd,
+                                                    .location = &storage->mapcolor_clsd,
                                                     .default_value = 208,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1816,7 +1823,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_rkey",
-                                                    .location = &doom_state->defaults_storage.mapcolor_rkey,
+                                                    .location = &storage->mapcolor_rkey,
                                                     .default_value = 175,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1824,7 +1831,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_bkey",
-                                                    .location = &doom_state->defaults_storage.mapcolor_bkey,
+                                                    .location = &storage->mapcolor_bkey,
                                                     .default_value = 204,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1832,7 +1839,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_ykey",
-                                                    .location = &doom_state->defaults_storage.mapcolor_ykey,
+                                                    .location = &storage->mapcolor_ykey,
                                                     .default_value = 231,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1840,7 +1847,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_rdor",
-                                                    .location = &doom_state->defaults_storage.mapcolor_rdor,
+                                                    .location = &storage->mapcolor_rdor,
                                                     .default_value = 175,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1848,7 +1855,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_bdor",
-                                                    .location = &doom_state->defaults_storage.mapcolor_bdor,
+                                                    .location = &storage->mapcolor_bdor,
                                                     .default_value = 204,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1856,7 +1863,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_ydor",
-                                                    .location = &doom_state->defaults_storage.mapcolor_ydor,
+                                                    .location = &storage->mapcolor_ydor,
                                                     .default_value = 231,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1864,7 +1871,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_tele",
-                                                    .location = &doom_state->defaults_storage.mapcolor_tele,
+                                                    .location = &storage->mapcolor_tele,
                                                     .default_value = 119,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1872,7 +1879,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_secr",
-                                                    .location = &doom_state->defaults_storage.mapcolor_secr,
+                                                    .location = &storage->mapcolor_secr,
                                                     .default_value = 252,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1880,7 +1887,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_revsecr",
-                                                    .location = &doom_state->defaults_storage.mapcolor_revsecr,
+                                                    .location = &storage->mapcolor_revsecr,
                                                     .default_value = 112,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1888,7 +1895,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_exit",
-                                                    .location = &doom_state->defaults_storage.mapcolor_exit,
+                                                    .location = &storage->mapcolor_exit,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1896,7 +1903,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_unsn",
-                                                    .location = &doom_state->defaults_storage.mapcolor_unsn,
+                                                    .location = &storage->mapcolor_unsn,
                                                     .default_value = 104,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1904,7 +1911,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_flat",
-                                                    .location = &doom_state->defaults_storage.mapcolor_flat,
+                                                    .location = &storage->mapcolor_flat,
                                                     .default_value = 88,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1912,7 +1919,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_sprt",
-                                                    .location = &doom_state->defaults_storage.mapcolor_sprt,
+                                                    .location = &storage->mapcolor_sprt,
                                                     .default_value = 112,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1920,7 +1927,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_item",
-                                                    .location = &doom_state->defaults_storage.mapcolor_item,
+                                                    .location = &storage->mapcolor_item,
                                                     .default_value = 231,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1928,7 +1935,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_hair",
-                                                    .location = &doom_state->defaults_storage.mapcolor_hair,
+                                                    .location = &storage->mapcolor_hair,
                                                     .default_value = 208,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1936,7 +1943,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_sngl",
-                                                    .location = &doom_state->defaults_storage.mapcolor_sngl,
+                                                    .location = &storage->mapcolor_sngl,
                                                     .default_value = 208,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1944,7 +1951,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_me",
-                                                    .location = &doom_state->defaults_storage.mapcolor_me,
+                                                    .location = &storage->mapcolor_me,
                                                     .default_value = 112,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1952,7 +1959,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_enemy",
-                                                    .location = &doom_state->defaults_storage.mapcolor_enemy,
+                                                    .location = &storage->mapcolor_enemy,
                                                     .default_value = 177,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1960,7 +1967,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mapcolor_frnd",
-                                                    .location = &doom_state->defaults_storage.mapcolor_frnd,
+                                                    .location = &storage->mapcolor_frnd,
                                                     .default_value = 112,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -1968,25 +1975,25 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "map_secret_after",
-                                                    .location = &doom_state->defaults_storage.map_secret_after,
+                                                    .location = &storage->map_secret_after,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_auto,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "map_point_coord",
-                                                    .location = &doom_state->defaults_storage.map_point_coord,
+                                                    .location = &storage->map_point_coord,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_auto,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "map_level_stat",
-                                                    .location = &doom_state->defaults_storage.map_level_stat,
+                                                    .location = &storage->map_level_stat,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_auto,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_hexint_default((hexint_default_t){
                                                     .name = "automapmode",
-                                                    .location = (uint32_t*)&doom_state->defaults_storage.automapmode,
+                                                    .location = (uint32_t*)&storage->automapmode,
                                                     .default_value = doom_automap_mode_follow,
                                                     .min_value = 0,
                                                     .max_value = 31,
@@ -1994,13 +2001,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "map_always_updates",
-                                                    .location = &doom_state->defaults_storage.map_always_updates,
+                                                    .location = &storage->map_always_updates,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_auto,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "map_grid_size",
-                                                    .location = &doom_state->defaults_storage.map_grid_size,
+                                                    .location = &storage->map_grid_size,
                                                     .default_value = 128,
                                                     .min_value = 8,
                                                     .max_value = 256,
@@ -2008,7 +2015,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "map_scroll_speed",
-                                                    .location = &doom_state->defaults_storage.map_scroll_speed,
+                                                    .location = &storage->map_scroll_speed,
                                                     .default_value = 8,
                                                     .min_value = 1,
                                                     .max_value = 32,
@@ -2016,25 +2023,25 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "map_wheel_zoom",
-                                                    .location = &doom_state->defaults_storage.map_wheel_zoom,
+                                                    .location = &storage->map_wheel_zoom,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_auto,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "map_use_multisampling",
-                                                    .location = &doom_state->defaults_storage.map_use_multisampling,
+                                                    .location = &storage->map_use_multisampling,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_auto,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "map_textured",
-                                                    .location = &doom_state->defaults_storage.map_textured,
+                                                    .location = &storage->map_textured,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_auto,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "map_textured_trans",
-                                                    .location = &doom_state->defaults_storage.map_textured_translucency,
+                                                    .location = &storage->map_textured_translucency,
                                                     .default_value = 100,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -2043,7 +2050,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "map_textured_overlay_trans",
-                                         .location = &doom_state->defaults_storage.map_textured_overlay_translucency,
+                                         .location = &storage->map_textured_overlay_translucency,
                                          .default_value = 66,
                                          .min_value = 0,
                                          .max_value = 100,
@@ -2052,7 +2059,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "map_lines_overlay_trans",
-                                         .location = &doom_state->defaults_storage.map_lines_overlay_translucency,
+                                         .location = &storage->map_lines_overlay_translucency,
                                          .default_value = 100,
                                          .min_value = 0,
                                          .max_value = 100,
@@ -2060,7 +2067,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "map_overlay_pos_x",
-                                                    .location = &doom_state->defaults_storage.map_overlay_pos_x,
+                                                    .location = &storage->map_overlay_pos_x,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 319,
@@ -2068,7 +2075,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "map_overlay_pos_y",
-                                                    .location = &doom_state->defaults_storage.map_overlay_pos_y,
+                                                    .location = &storage->map_overlay_pos_y,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 199,
@@ -2076,7 +2083,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "map_overlay_pos_width",
-                                                    .location = &doom_state->defaults_storage.map_overlay_pos_width,
+                                                    .location = &storage->map_overlay_pos_width,
                                                     .default_value = 320,
                                                     .min_value = 0,
                                                     .max_value = 320,
@@ -2084,7 +2091,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "map_overlay_pos_height",
-                                                    .location = &doom_state->defaults_storage.map_overlay_pos_height,
+                                                    .location = &storage->map_overlay_pos_height,
                                                     .default_value = 200,
                                                     .min_value = 0,
                                                     .max_value = 200,
@@ -2093,7 +2100,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "map_things_appearance",
-                                         .location = (int*)&doom_state->defaults_storage.map_things_appearance,
+                                         .location = (int*)&storage->map_things_appearance,
                                          .default_value = doom_automap_things_appearance_count - 1,
                                          .min_value = 0,
                                          .max_value = doom_automap_things_appearance_count - 1,
@@ -2103,7 +2110,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Heads-up display settings"));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudcolor_titl",
-                                                    .location = &doom_state->defaults_storage.hudcolor_titl,
+                                                    .location = &storage->hudcolor_titl,
                                                     .default_value = 5,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -2111,7 +2118,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudcolor_xyco",
-                                                    .location = &doom_state->defaults_storage.hudcolor_xyco,
+                                                    .location = &storage->hudcolor_xyco,
                                                     .default_value = 3,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -2119,7 +2126,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudcolor_mapstat_title",
-                                                    .location = &doom_state->defaults_storage.hudcolor_mapstat_title,
+                                                    .location = &storage->hudcolor_mapstat_title,
                                                     .default_value = 6,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -2127,7 +2134,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudcolor_mapstat_value",
-                                                    .location = &doom_state->defaults_storage.hudcolor_mapstat_value,
+                                                    .location = &storage->hudcolor_mapstat_value,
                                                     .default_value = 2,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -2135,7 +2142,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudcolor_mapstat_time",
-                                                    .location = &doom_state->defaults_storage.hudcolor_mapstat_time,
+                                                    .location = &storage->hudcolor_mapstat_time,
                                                     .default_value = 2,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -2143,7 +2150,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudcolor_mesg",
-                                                    .location = &doom_state->defaults_storage.hudcolor_mesg,
+                                                    .location = &storage->hudcolor_mesg,
                                                     .default_value = 6,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -2151,7 +2158,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudcolor_chat",
-                                                    .location = &doom_state->defaults_storage.hudcolor_chat,
+                                                    .location = &storage->hudcolor_chat,
                                                     .default_value = 5,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -2159,7 +2166,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudcolor_list",
-                                                    .location = &doom_state->defaults_storage.hudcolor_list,
+                                                    .location = &storage->hudcolor_list,
                                                     .default_value = 5,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -2167,7 +2174,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hud_msg_lines",
-                                                    .location = &doom_state->defaults_storage.hud_msg_lines,
+                                                    .location = &storage->hud_msg_lines,
                                                     .default_value = 1,
                                                     .min_value = 1,
                                                     .max_value = 16,
@@ -2175,13 +2182,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hud_list_bgon",
-                                                    .location = &doom_state->defaults_storage.hud_list_bgon,
+                                                    .location = &storage->hud_list_bgon,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_messages,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "health_red",
-                                                    .location = &doom_state->defaults_storage.health_red,
+                                                    .location = &storage->health_red,
                                                     .default_value = 25,
                                                     .min_value = 0,
                                                     .max_value = 200,
@@ -2189,7 +2196,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "health_yellow",
-                                                    .location = &doom_state->defaults_storage.health_yellow,
+                                                    .location = &storage->health_yellow,
                                                     .default_value = 50,
                                                     .min_value = 0,
                                                     .max_value = 200,
@@ -2197,7 +2204,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "health_green",
-                                                    .location = &doom_state->defaults_storage.health_green,
+                                                    .location = &storage->health_green,
                                                     .default_value = 100,
                                                     .min_value = 0,
                                                     .max_value = 200,
@@ -2205,7 +2212,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "armor_red",
-                                                    .location = &doom_state->defaults_storage.armor_red,
+                                                    .location = &storage->armor_red,
                                                     .default_value = 25,
                                                     .min_value = 0,
                                                     .max_value = 200,
@@ -2213,7 +2220,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "armor_yellow",
-                                                    .location = &doom_state->defaults_storage.armor_yellow,
+                                                    .location = &storage->armor_yellow,
                                                     .default_value = 50,
                                                     .min_value = 0,
                                                     .max_value = 200,
@@ -2221,7 +2228,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "armor_green",
-                                                    .location = &doom_state->defaults_storage.armor_green,
+                                                    .location = &storage->armor_green,
                                                     .default_value = 100,
                                                     .min_value = 0,
                                                     .max_value = 200,
@@ -2229,7 +2236,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "ammo_red",
-                                                    .location = &doom_state->defaults_storage.ammo_red,
+                                                    .location = &storage->ammo_red,
                                                     .default_value = 25,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -2237,7 +2244,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "ammo_yellow",
-                                                    .location = &doom_state->defaults_storage.ammo_yellow,
+                                                    .location = &storage->ammo_yellow,
                                                     .default_value = 50,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -2245,7 +2252,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "ammo_color_behavior",
-                                                    .location = (int*)&doom_state->defaults_storage.ammo_color_behavior,
+                                                    .location = (int*)&storage->ammo_color_behavior,
                                                     .default_value = doom_status_bar_ammo_color_behavior_count - 1,
                                                     .min_value = 0,
                                                     .max_value = doom_status_bar_ammo_color_behavior_count - 1,
@@ -2253,7 +2260,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hud_num",
-                                                    .location = &doom_state->defaults_storage.hud_num,
+                                                    .location = &storage->hud_num,
                                                     .default_value = 6,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -2261,7 +2268,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hud_displayed",
-                                                    .location = &doom_state->defaults_storage.hud_displayed,
+                                                    .location = &storage->hud_displayed,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
@@ -2269,43 +2276,43 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ heads-up display settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hudadd_gamespeed",
-                                                    .location = &doom_state->defaults_storage.hudadd_gamespeed,
+                                                    .location = &storage->hudadd_gamespeed,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hudadd_leveltime",
-                                                    .location = &doom_state->defaults_storage.hudadd_leveltime,
+                                                    .location = &storage->hudadd_leveltime,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hudadd_demotime",
-                                                    .location = &doom_state->defaults_storage.hudadd_demotime,
+                                                    .location = &storage->hudadd_demotime,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hudadd_secretarea",
-                                                    .location = &doom_state->defaults_storage.hudadd_secretarea,
+                                                    .location = &storage->hudadd_secretarea,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hudadd_maxtotals",
-                                                    .location = &doom_state->defaults_storage.hudadd_maxtotals,
+                                                    .location = &storage->hudadd_maxtotals,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hudadd_demoprogressbar",
-                                                    .location = &doom_state->defaults_storage.hudadd_demoprogressbar,
+                                                    .location = &storage->hudadd_demoprogressbar,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudadd_crosshair",
-                                                    .location = &doom_state->defaults_storage.hudadd_crosshair,
+                                                    .location = &storage->hudadd_crosshair,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = doom_hud_crosshair_count - 1,
@@ -2313,13 +2320,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hudadd_crosshair_scale",
-                                                    .location = &doom_state->defaults_storage.hudadd_crosshair_scale,
+                                                    .location = &storage->hudadd_crosshair_scale,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "hudadd_crosshair_color",
-                                                    .location = &doom_state->defaults_storage.hudadd_crosshair_color,
+                                                    .location = &storage->hudadd_crosshair_color,
                                                     .default_value = 3,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -2327,20 +2334,20 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hudadd_crosshair_health",
-                                                    .location = &doom_state->defaults_storage.hudadd_crosshair_health,
+                                                    .location = &storage->hudadd_crosshair_health,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "hudadd_crosshair_target",
-                                                    .location = &doom_state->defaults_storage.hudadd_crosshair_target,
+                                                    .location = &storage->hudadd_crosshair_target,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "hudadd_crosshair_target_color",
-                                         .location = &doom_state->defaults_storage.hudadd_crosshair_target_color,
+                                         .location = &storage->hudadd_crosshair_target_color,
                                          .default_value = 9,
                                          .min_value = 0,
                                          .max_value = 9,
@@ -2349,7 +2356,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "hudadd_crosshair_lock_target",
-                                         .location = &doom_state->defaults_storage.hudadd_crosshair_lock_target,
+                                         .location = &storage->hudadd_crosshair_lock_target,
                                          .default_value = false,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
@@ -2357,7 +2364,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ mouse settings"));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mouse_acceleration",
-                                                    .location = &doom_state->defaults_storage.mouse_acceleration,
+                                                    .location = &storage->mouse_acceleration,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = max_unset,
@@ -2365,7 +2372,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "mouse_sensitivity_mlook",
-                                                    .location = &doom_state->defaults_storage.mouse_sensitivity_mlook,
+                                                    .location = &storage->mouse_sensitivity_mlook,
                                                     .default_value = 10,
                                                     .min_value = 0,
                                                     .max_value = max_unset,
@@ -2373,13 +2380,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "mouse_doubleclick_as_use",
-                                                    .location = &doom_state->defaults_storage.mouse_doubleclick_as_use,
+                                                    .location = &storage->mouse_doubleclick_as_use,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "mouse_carrytics",
-                                                    .location = &doom_state->defaults_storage.mouse_carrytics,
+                                                    .location = &storage->mouse_carrytics,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
@@ -2387,25 +2394,25 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ demo settings"));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "demo_demoex_filename",
-                                                    .location = &doom_state->defaults_storage.demo_demoex_filename,
+                                                    .location = &storage->demo_demoex_filename,
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "getwad_cmdline",
-                                                    .location = &doom_state->defaults_storage.getwad_cmdline,
+                                                    .location = &storage->getwad_cmdline,
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "demo_overwriteexisting",
-                                                    .location = &doom_state->defaults_storage.demo_overwriteexisting,
+                                                    .location = &storage->demo_overwriteexisting,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "quickstart_window_ms",
-                                                    .location = &doom_state->defaults_storage.quickstart_window_ms,
+                                                    .location = &storage->quickstart_window_ms,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 1000,
@@ -2415,25 +2422,25 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ game settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "movement_strafe50",
-                                                    .location = &doom_state->defaults_storage.movement_strafe50,
+                                                    .location = &storage->movement_strafe50,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "movement_strafe50onturns",
-                                                    .location = &doom_state->defaults_storage.movement_strafe50onturns,
+                                                    .location = &storage->movement_strafe50onturns,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "movement_shorttics",
-                                                    .location = &doom_state->defaults_storage.movement_shorttics,
+                                                    .location = &storage->movement_shorttics,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "interpolation_maxobjects",
-                                                    .location = &doom_state->defaults_storage.interpolation_maxobjects,
+                                                    .location = &storage->interpolation_maxobjects,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = max_unset,
@@ -2441,7 +2448,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "speed_step",
-                                                    .location = &doom_state->defaults_storage.speed_step,
+                                                    .location = &storage->speed_step,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 1000,
@@ -2451,31 +2458,31 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ miscellaneous settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "showendoom",
-                                                    .location = &doom_state->defaults_storage.showendoom,
+                                                    .location = &storage->showendoom,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "screenshot_dir",
-                                                    .location = &doom_state->defaults_storage.screenshot_dir,
+                                                    .location = &storage->screenshot_dir,
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "health_bar",
-                                                    .location = &doom_state->defaults_storage.health_bar,
+                                                    .location = &storage->health_bar,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "health_bar_full_length",
-                                                    .location = &doom_state->defaults_storage.health_bar_full_length,
+                                                    .location = &storage->health_bar_full_length,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "health_bar_red",
-                                                    .location = &doom_state->defaults_storage.health_bar_red,
+                                                    .location = &storage->health_bar_red,
                                                     .default_value = 50,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -2483,7 +2490,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "health_bar_yellow",
-                                                    .location = &doom_state->defaults_storage.health_bar_yellow,
+                                                    .location = &storage->health_bar_yellow,
                                                     .default_value = 99,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -2491,7 +2498,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "health_bar_green",
-                                                    .location = &doom_state->defaults_storage.health_bar_green,
+                                                    .location = &storage->health_bar_green,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -2501,20 +2508,20 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("DSDA-Doom settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_strict_mode",
-                                                    .location = &doom_state->defaults_storage.dsda.strict_mode,
+                                                    .location = &storage->dsda.strict_mode,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_cycle_ghost_colors",
-                                                    .location = &doom_state->defaults_storage.dsda.cycle_ghost_colors,
+                                                    .location = &storage->dsda.cycle_ghost_colors,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "dsda_auto_key_frame_interval",
-                                         .location = &doom_state->defaults_storage.dsda.auto_key_frame_interval,
+                                         .location = &storage->dsda.auto_key_frame_interval,
                                          .default_value = 1,
                                          .min_value = 1,
                                          .max_value = 600,
@@ -2522,7 +2529,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "dsda_auto_key_frame_depth",
-                                                    .location = &doom_state->defaults_storage.dsda.auto_key_frame_depth,
+                                                    .location = &storage->dsda.auto_key_frame_depth,
                                                     .default_value = 60,
                                                     .min_value = 1,
                                                     .max_value = 600,
@@ -2531,7 +2538,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "dsda_auto_key_frame_timeout",
-                                         .location = &doom_state->defaults_storage.dsda.auto_key_frame_timeout,
+                                         .location = &storage->dsda.auto_key_frame_timeout,
                                          .default_value = 10,
                                          .min_value = 0,
                                          .max_value = 25,
@@ -2539,25 +2546,25 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_exhud",
-                                                    .location = &doom_state->defaults_storage.dsda.exhud,
+                                                    .location = &storage->dsda.exhud,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_wipe_at_full_speed",
-                                                    .location = &doom_state->defaults_storage.dsda.wipe_at_full_speed,
+                                                    .location = &storage->dsda.wipe_at_full_speed,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_show_demo_attempts",
-                                                    .location = &doom_state->defaults_storage.dsda.show_demo_attempts,
+                                                    .location = &storage->dsda.show_demo_attempts,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "dsda_fine_sensitivity",
-                                                    .location = &doom_state->defaults_storage.dsda.fine_sensitivity,
+                                                    .location = &storage->dsda.fine_sensitivity,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 99,
@@ -2565,25 +2572,25 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_hide_horns",
-                                                    .location = &doom_state->defaults_storage.dsda.hide_horns,
+                                                    .location = &storage->dsda.hide_horns,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_organized_saves",
-                                                    .location = &doom_state->defaults_storage.dsda.organized_saves,
+                                                    .location = &storage->dsda.organized_saves,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_command_display",
-                                                    .location = &doom_state->defaults_storage.dsda.command_display,
+                                                    .location = &storage->dsda.command_display,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "dsda_command_history_size",
-                                                    .location = &doom_state->defaults_storage.dsda.command_history_size,
+                                                    .location = &storage->dsda.command_history_size,
                                                     .default_value = 10,
                                                     .min_value = 1,
                                                     .max_value = 20,
@@ -2591,38 +2598,38 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_hide_empty_commands",
-                                                    .location = &doom_state->defaults_storage.dsda.hide_empty_commands,
+                                                    .location = &storage->dsda.hide_empty_commands,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_coordinate_display",
-                                                    .location = &doom_state->defaults_storage.dsda.coordinate_display,
+                                                    .location = &storage->dsda.coordinate_display,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_skip_quit_prompt",
-                                                    .location = &doom_state->defaults_storage.dsda.skip_quit_prompt,
+                                                    .location = &storage->dsda.skip_quit_prompt,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_show_split_data",
-                                                    .location = &doom_state->defaults_storage.dsda.show_split_data,
+                                                    .location = &storage->dsda.show_split_data,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "dsda_player_name",
-                                                    .location = &doom_state->defaults_storage.dsda.player_name,
+                                                    .location = &storage->dsda.player_name,
                                                     .default_value = phyto_string_span_from_c("Anonymous"),
                                                     .setup_screen = doom_misc_setup_screen_chat,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "dsda_quickstart_cache_tics",
-                                         .location = &doom_state->defaults_storage.dsda.quickstart_cache_tics,
+                                         .location = &storage->dsda.quickstart_cache_tics,
                                          .default_value = 0,
                                          .min_value = 0,
                                          .max_value = 35,
@@ -2630,7 +2637,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "dsda_death_use_action",
-                                                    .location = &doom_state->defaults_storage.dsda.death_use_action,
+                                                    .location = &storage->dsda.death_use_action,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 2,
@@ -2638,31 +2645,31 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_mute_sfx",
-                                                    .location = &doom_state->defaults_storage.dsda.mute_sfx,
+                                                    .location = &storage->dsda.mute_sfx,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_mute_music",
-                                                    .location = &doom_state->defaults_storage.dsda.mute_music,
+                                                    .location = &storage->dsda.mute_music,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_cheat_codes",
-                                                    .location = &doom_state->defaults_storage.dsda.cheat_codes,
+                                                    .location = &storage->dsda.cheat_codes,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_allow_jumping",
-                                                    .location = &doom_state->defaults_storage.dsda.allow_jumping,
+                                                    .location = &storage->dsda.allow_jumping,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "dsda_parallel_sfx_limit",
-                                                    .location = &doom_state->defaults_storage.dsda.parallel_sfx_limit,
+                                                    .location = &storage->dsda.parallel_sfx_limit,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 32,
@@ -2670,7 +2677,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "dsda_parallel_sfx_window",
-                                                    .location = &doom_state->defaults_storage.dsda.parallel_sfx_window,
+                                                    .location = &storage->dsda.parallel_sfx_window,
                                                     .default_value = 1,
                                                     .min_value = 1,
                                                     .max_value = 32,
@@ -2679,19 +2686,19 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "dsda_switch_when_ammo_runs_out",
-                                         .location = &doom_state->defaults_storage.dsda.switch_when_ammo_runs_out,
+                                         .location = &storage->dsda.switch_when_ammo_runs_out,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_viewbob",
-                                                    .location = &doom_state->defaults_storage.dsda.viewbob,
+                                                    .location = &storage->dsda.viewbob,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "dsda_weaponbob",
-                                                    .location = &doom_state->defaults_storage.dsda.weaponbob,
+                                                    .location = &storage->dsda.weaponbob,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
@@ -2701,14 +2708,14 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
         &defaults,
         s_string_default((string_default_t){
             .name = "cap_soundcommand",
-            .location = &doom_state->defaults_storage.cap_soundcommand,
+            .location = &storage->cap_soundcommand,
             .default_value = phyto_string_span_from_c("ffmpeg -f s16le -ar %s -ac 2 -i - -c:a libopus -y temp_a.nut"),
             .setup_screen = doom_misc_setup_screen_none,
         }));
     doom_misc_default_dyarray_append(
         &defaults, s_string_default((string_default_t){
                        .name = "cap_videocommand",
-                       .location = &doom_state->defaults_storage.cap_videocommand,
+                       .location = &storage->cap_videocommand,
                        .default_value = phyto_string_span_from_c(
                            "ffmpeg -f rawvideo -pix_fmt rgb24 -r %r -s %wx%h -i - -c:v libx264 -y temp_v.nut"),
                        .setup_screen = doom_misc_setup_screen_none,
@@ -2716,31 +2723,31 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(
         &defaults, s_string_default((string_default_t){
                        .name = "cap_muxcommand",
-                       .location = &doom_state->defaults_storage.cap_muxcommand,
+                       .location = &storage->cap_muxcommand,
                        .default_value = phyto_string_span_from_c("ffmpeg -i temp_v.nut -i temp_a.nut -c copy -y %f"),
                        .setup_screen = doom_misc_setup_screen_none,
                    }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "cap_tempfile1",
-                                                    .location = &doom_state->defaults_storage.cap_tempfile1,
+                                                    .location = &storage->cap_tempfile1,
                                                     .default_value = phyto_string_span_from_c("temp_a.nut"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "cap_tempfile2",
-                                                    .location = &doom_state->defaults_storage.cap_tempfile2,
+                                                    .location = &storage->cap_tempfile2,
                                                     .default_value = phyto_string_span_from_c("temp_v.nut"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "cap_remove_tempfiles",
-                                                    .location = &doom_state->defaults_storage.cap_remove_tempfiles,
+                                                    .location = &storage->cap_remove_tempfiles,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "cap_fps",
-                                                    .location = &doom_state->defaults_storage.cap_fps,
+                                                    .location = &storage->cap_fps,
                                                     .default_value = 60,
                                                     .min_value = 16,
                                                     .max_value = 300,
@@ -2750,37 +2757,37 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ video settings"));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "sdl_video_window_pos",
-                                                    .location = &doom_state->defaults_storage.sdl_video_window_pos,
+                                                    .location = &storage->sdl_video_window_pos,
                                                     .default_value = phyto_string_span_from_c("center"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "palette_ondamage",
-                                                    .location = &doom_state->defaults_storage.palette_ondamage,
+                                                    .location = &storage->palette_ondamage,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "palette_onbonus",
-                                                    .location = &doom_state->defaults_storage.palette_onbonus,
+                                                    .location = &storage->palette_onbonus,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "palette_onpowers",
-                                                    .location = &doom_state->defaults_storage.palette_onpowers,
+                                                    .location = &storage->palette_onpowers,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "render_wipescreen",
-                                                    .location = &doom_state->defaults_storage.render_wipescreen,
+                                                    .location = &storage->render_wipescreen,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "render_screen_multiply",
-                                                    .location = &doom_state->defaults_storage.render_screen_multiply,
+                                                    .location = &storage->render_screen_multiply,
                                                     .default_value = 1,
                                                     .min_value = 1,
                                                     .max_value = 5,
@@ -2788,13 +2795,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "integer_scaling",
-                                                    .location = &doom_state->defaults_storage.integer_scaling,
+                                                    .location = &storage->integer_scaling,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "render_aspect",
-                                                    .location = &doom_state->defaults_storage.render_aspect,
+                                                    .location = &storage->render_aspect,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 4,
@@ -2802,19 +2809,19 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "render_doom_lightmaps",
-                                                    .location = &doom_state->defaults_storage.render_doom_lightmaps,
+                                                    .location = &storage->render_doom_lightmaps,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "fake_contrast",
-                                                    .location = &doom_state->defaults_storage.fake_contrast,
+                                                    .location = &storage->fake_contrast,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "render_stretch_hud",
-                                                    .location = (int*)&doom_state->defaults_storage.render_stretch_hud,
+                                                    .location = (int*)&storage->render_stretch_hud,
                                                     .default_value = doom_video_patch_stretch_16x10,
                                                     .min_value = 0,
                                                     .max_value = doom_video_patch_stretch_count - 1,
@@ -2822,7 +2829,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "render_patches_scalex",
-                                                    .location = &doom_state->defaults_storage.render_patches_scalex,
+                                                    .location = &storage->render_patches_scalex,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 16,
@@ -2830,7 +2837,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "render_patches_scaley",
-                                                    .location = &doom_state->defaults_storage.render_patches_scaley,
+                                                    .location = &storage->render_patches_scaley,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 16,
@@ -2838,13 +2845,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "render_stretchsky",
-                                                    .location = &doom_state->defaults_storage.render_stretchsky,
+                                                    .location = &storage->render_stretchsky,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "sprites_doom_order",
-                                                    .location = (int*)&doom_state->defaults_storage.sprites_doom_order,
+                                                    .location = (int*)&storage->sprites_doom_order,
                                                     .default_value = doom_render_things_sprite_order_static_order,
                                                     .min_value = 0,
                                                     .max_value = doom_render_things_sprite_order_count - 1,
@@ -2852,19 +2859,19 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "movement_mouselook",
-                                                    .location = &doom_state->defaults_storage.movement_mouselook,
+                                                    .location = &storage->movement_mouselook,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "movement_mousenovert",
-                                                    .location = &doom_state->defaults_storage.movement_mousenovert,
+                                                    .location = &storage->movement_mousenovert,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "movement_maxviewpitch",
-                                                    .location = &doom_state->defaults_storage.movement_maxviewpitch,
+                                                    .location = &storage->movement_maxviewpitch,
                                                     .default_value = 90,
                                                     .min_value = 0,
                                                     .max_value = 90,
@@ -2873,7 +2880,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "movement_mousestrafedivisor",
-                                         .location = &doom_state->defaults_storage.movement_mousestrafedivisor,
+                                         .location = &storage->movement_mousestrafedivisor,
                                          .default_value = 4,
                                          .min_value = 1,
                                          .max_value = 512,
@@ -2881,7 +2888,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "movement_mouseinvert",
-                                                    .location = &doom_state->defaults_storage.movement_mouseinvert,
+                                                    .location = &storage->movement_mouseinvert,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
@@ -2889,13 +2896,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ OpenGL settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_allow_detail_textures",
-                                                    .location = &doom_state->defaults_storage.gl_allow_detail_textures,
+                                                    .location = &storage->gl_allow_detail_textures,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_detail_maxdist",
-                                                    .location = &doom_state->defaults_storage.gl_detail_maxdist,
+                                                    .location = &storage->gl_detail_maxdist,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 65535,
@@ -2903,7 +2910,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "render_multisampling",
-                                                    .location = &doom_state->defaults_storage.render_multisampling,
+                                                    .location = &storage->render_multisampling,
                                                     .default_value = 0,
                                                     .min_value = 0,
                                                     .max_value = 8,
@@ -2911,7 +2918,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "render_fov",
-                                                    .location = &doom_state->defaults_storage.render_fov,
+                                                    .location = &storage->render_fov,
                                                     .default_value = 90,
                                                     .min_value = 20,
                                                     .max_value = 160,
@@ -2919,7 +2926,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_spriteclip",
-                                                    .location = (int*)&doom_state->defaults_storage.gl_spriteclip,
+                                                    .location = (int*)&storage->gl_spriteclip,
                                                     .default_value = doom_gl_struct_spriteclipmode_smart,
                                                     .min_value = 0,
                                                     .max_value = doom_gl_struct_spriteclipmode_smart,
@@ -2927,7 +2934,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_spriteclip_threshold",
-                                                    .location = &doom_state->defaults_storage.gl_spriteclip_threshold,
+                                                    .location = &storage->gl_spriteclip_threshold,
                                                     .default_value = 10,
                                                     .min_value = 0,
                                                     .max_value = 100,
@@ -2936,62 +2943,62 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "gl_sprites_frustum_culling",
-                                         .location = &doom_state->defaults_storage.gl_sprites_frustum_culling,
+                                         .location = &storage->gl_sprites_frustum_culling,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "render_paperitems",
-                                                    .location = &doom_state->defaults_storage.render_paperitems,
+                                                    .location = &storage->render_paperitems,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_boom_colormaps",
-                                                    .location = &doom_state->defaults_storage.gl_boom_colormaps,
+                                                    .location = &storage->gl_boom_colormaps,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_hires_24bit_colormap",
-                                                    .location = &doom_state->defaults_storage.gl_hires_24bit_colormap,
+                                                    .location = &storage->gl_hires_24bit_colormap,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_texture_internal_hires",
-                                                    .location = &doom_state->defaults_storage.gl_texture_internal_hires,
+                                                    .location = &storage->gl_texture_internal_hires,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_texture_external_hires",
-                                                    .location = &doom_state->defaults_storage.gl_texture_external_hires,
+                                                    .location = &storage->gl_texture_external_hires,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_hires_override_pwads",
-                                                    .location = &doom_state->defaults_storage.gl_hires_override_pwads,
+                                                    .location = &storage->gl_hires_override_pwads,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "gl_texture_hires_dir",
-                                                    .location = &doom_state->defaults_storage.gl_texture_hires_dir,
+                                                    .location = &storage->gl_texture_hires_dir,
                                                     .default_value = phyto_string_span_empty(),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_texture_hqresize",
-                                                    .location = &doom_state->defaults_storage.gl_texture_hqresize,
+                                                    .location = &storage->gl_texture_hqresize,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "gl_texture_hqresize_textures",
-                                         .location = (int*)&doom_state->defaults_storage.gl_texture_hqresize_textures,
+                                         .location = (int*)&storage->gl_texture_hqresize_textures,
                                          .default_value = doom_gl_struct_hqresizemode_on_2x,
                                          .min_value = 0,
                                          .max_value = doom_gl_struct_hqresizemode_count - 1,
@@ -3000,7 +3007,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "gl_texture_hqresize_sprites",
-                                         .location = (int*)&doom_state->defaults_storage.gl_texture_hqresize_sprites,
+                                         .location = (int*)&storage->gl_texture_hqresize_sprites,
                                          .default_value = doom_gl_struct_hqresizemode_none,
                                          .min_value = 0,
                                          .max_value = doom_gl_struct_hqresizemode_count - 1,
@@ -3009,7 +3016,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_integer_default((integer_default_t){
                                          .name = "gl_texture_hqresize_patches",
-                                         .location = (int*)&doom_state->defaults_storage.gl_texture_hqresize_patches,
+                                         .location = (int*)&storage->gl_texture_hqresize_patches,
                                          .default_value = doom_gl_struct_hqresizemode_on_2x,
                                          .min_value = 0,
                                          .max_value = doom_gl_struct_hqresizemode_count - 1,
@@ -3017,43 +3024,43 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_motionblur",
-                                                    .location = &doom_state->defaults_storage.gl_motionblur,
+                                                    .location = &storage->gl_motionblur,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "gl_motionblur_min_speed",
-                                                    .location = &doom_state->defaults_storage.gl_motionblur_min_speed,
+                                                    .location = &storage->gl_motionblur_min_speed,
                                                     .default_value = phyto_string_span_from_c("21.36"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "gl_motionblur_min_angle",
-                                                    .location = &doom_state->defaults_storage.gl_motionblur_min_angle,
+                                                    .location = &storage->gl_motionblur_min_angle,
                                                     .default_value = phyto_string_span_from_c("20.0"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "gl_motionblur_att_a",
-                                                    .location = &doom_state->defaults_storage.gl_motionblur_att_a,
+                                                    .location = &storage->gl_motionblur_att_a,
                                                     .default_value = phyto_string_span_from_c("55.0"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "gl_motionblur_att_b",
-                                                    .location = &doom_state->defaults_storage.gl_motionblur_att_b,
+                                                    .location = &storage->gl_motionblur_att_b,
                                                     .default_value = phyto_string_span_from_c("1.8"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "gl_motionblur_att_c",
-                                                    .location = &doom_state->defaults_storage.gl_motionblur_att_c,
+                                                    .location = &storage->gl_motionblur_att_c,
                                                     .default_value = phyto_string_span_from_c("0.9"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_lightmode",
-                                                    .location = (int*)&doom_state->defaults_storage.gl_lightmode,
+                                                    .location = (int*)&storage->gl_lightmode,
                                                     .default_value = doom_gl_struct_lightmode_glboom,
                                                     .min_value = 0,
                                                     .max_value = doom_gl_struct_lightmode_count - 1,
@@ -3061,7 +3068,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_light_ambient",
-                                                    .location = (int*)&doom_state->defaults_storage.gl_light_ambient,
+                                                    .location = (int*)&storage->gl_light_ambient,
                                                     .default_value = 20,
                                                     .min_value = 1,
                                                     .max_value = 255,
@@ -3069,13 +3076,13 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_fog",
-                                                    .location = &doom_state->defaults_storage.gl_fog,
+                                                    .location = &storage->gl_fog,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_hexint_default((hexint_default_t){
                                                     .name = "gl_fog_color",
-                                                    .location = &doom_state->defaults_storage.gl_fog_color,
+                                                    .location = &storage->gl_fog_color,
                                                     .default_value = 0x000000,
                                                     .min_value = 0x000000,
                                                     .max_value = 0xFFFFFF,
@@ -3083,7 +3090,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "useglgamma",
-                                                    .location = &doom_state->defaults_storage.useglgamma,
+                                                    .location = &storage->useglgamma,
                                                     .default_value = 6,
                                                     .min_value = 0,
                                                     .max_value = doom_gl_struct_max_glgamma,
@@ -3091,19 +3098,19 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_color_mip_levels",
-                                                    .location = &doom_state->defaults_storage.gl_color_mip_levels,
+                                                    .location = &storage->gl_color_mip_levels,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_shadows",
-                                                    .location = &doom_state->defaults_storage.gl_shadows,
+                                                    .location = &storage->gl_shadows,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_shadows_maxdist",
-                                                    .location = &doom_state->defaults_storage.gl_shadows_maxdist,
+                                                    .location = &storage->gl_shadows_maxdist,
                                                     .default_value = 1000,
                                                     .min_value = 0,
                                                     .max_value = 32767,
@@ -3111,7 +3118,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "gl_shadows_factor",
-                                                    .location = &doom_state->defaults_storage.gl_shadows_factor,
+                                                    .location = &storage->gl_shadows_factor,
                                                     .default_value = 128,
                                                     .min_value = 0,
                                                     .max_value = 255,
@@ -3119,7 +3126,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "gl_blend_animations",
-                                                    .location = &doom_state->defaults_storage.gl_blend_animations,
+                                                    .location = &storage->gl_blend_animations,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
@@ -3127,76 +3134,76 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ emulation settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "overrun_spechit_warn",
-                                                    .location = &doom_state->defaults_storage.overrun_spechit_warn,
+                                                    .location = &storage->overrun_spechit_warn,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "overrun_spechit_emulate",
-                                                    .location = &doom_state->defaults_storage.overrun_spechit_emulate,
+                                                    .location = &storage->overrun_spechit_emulate,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "overrun_reject_warn",
-                                                    .location = &doom_state->defaults_storage.overrun_reject_warn,
+                                                    .location = &storage->overrun_reject_warn,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "overrun_reject_emulate",
-                                                    .location = &doom_state->defaults_storage.overrun_reject_emulate,
+                                                    .location = &storage->overrun_reject_emulate,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "overrun_intercept_warn",
-                                                    .location = &doom_state->defaults_storage.overrun_intercept_warn,
+                                                    .location = &storage->overrun_intercept_warn,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "overrun_intercept_emulate",
-                                                    .location = &doom_state->defaults_storage.overrun_intercept_emulate,
+                                                    .location = &storage->overrun_intercept_emulate,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "overrun_playeringame_warn",
-                                                    .location = &doom_state->defaults_storage.overrun_playeringame_warn,
+                                                    .location = &storage->overrun_playeringame_warn,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "overrun_playeringame_emulate",
-                                         .location = &doom_state->defaults_storage.overrun_playeringame_emulate,
+                                         .location = &storage->overrun_playeringame_emulate,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "overrun_donut_warn",
-                                                    .location = &doom_state->defaults_storage.overrun_donut_warn,
+                                                    .location = &storage->overrun_donut_warn,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "overrun_donut_emulate",
-                                                    .location = &doom_state->defaults_storage.overrun_donut_emulate,
+                                                    .location = &storage->overrun_donut_emulate,
                                                     .default_value = true,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "overrun_missedbackside_warn",
-                                         .location = &doom_state->defaults_storage.overrun_missedbackside_warn,
+                                         .location = &storage->overrun_missedbackside_warn,
                                          .default_value = false,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
     doom_misc_default_dyarray_append(&defaults,
                                      s_boolean_default((boolean_default_t){
                                          .name = "overrun_missedbackside_emulate",
-                                         .location = &doom_state->defaults_storage.overrun_missedbackside_emulate,
+                                         .location = &storage->overrun_missedbackside_emulate,
                                          .default_value = true,
                                          .setup_screen = doom_misc_setup_screen_status_bar,
                                      }));
@@ -3204,31 +3211,31 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ 'bad' compatibility settings"));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "comperr_zerotag",
-                                                    .location = &doom_state->defaults_storage.comperr_zerotag,
+                                                    .location = &storage->comperr_zerotag,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "comperr_passuse",
-                                                    .location = &doom_state->defaults_storage.comperr_passuse,
+                                                    .location = &storage->comperr_passuse,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "comperr_hangsolid",
-                                                    .location = &doom_state->defaults_storage.comperr_hangsolid,
+                                                    .location = &storage->comperr_hangsolid,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "comperr_blockmap",
-                                                    .location = &doom_state->defaults_storage.comperr_blockmap,
+                                                    .location = &storage->comperr_blockmap,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_boolean_default((boolean_default_t){
                                                     .name = "comperr_freeaim",
-                                                    .location = &doom_state->defaults_storage.comperr_freeaim,
+                                                    .location = &storage->comperr_freeaim,
                                                     .default_value = false,
                                                     .setup_screen = doom_misc_setup_screen_status_bar,
                                                 }));
@@ -3236,14 +3243,14 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("PrBoom+ demo patterns list"));
     doom_misc_default_dyarray_append(&defaults, s_string_default((string_default_t){
                                                     .name = "demo_patterns_mask",
-                                                    .location = &doom_state->defaults_storage.demo_patterns_mask,
+                                                    .location = &storage->demo_patterns_mask,
                                                     .default_value = phyto_string_span_from_c("demo_pattern"),
                                                     .setup_screen = doom_misc_setup_screen_none,
                                                 }));
     doom_misc_default_dyarray_append(
         &defaults, s_owning_string_default((owning_string_default_t){
                        .name = "demo_pattern0",
-                       .location = &doom_state->defaults_storage.demo_patterns_list_def.data[0],
+                       .location = &storage->demo_patterns_list_def.data[0],
                        .default_value = phyto_string_span_from_c(
                            "DOOM 2: Hell on Earth/((lv)|(nm)|(pa)|(ty))\\d\\d.\\d\\d\\d\\.lmp/doom2.wad"),
                        .setup_screen = doom_misc_setup_screen_none,
@@ -3252,7 +3259,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
         &defaults,
         s_owning_string_default((owning_string_default_t){
             .name = "demo_pattern1",
-            .location = &doom_state->defaults_storage.demo_patterns_list_def.data[1],
+            .location = &storage->demo_patterns_list_def.data[1],
             .default_value = phyto_string_span_from_c(
                 "DOOM 2: Plutonia Experiment/p(c|f|l|n|p|r|s|t)\\d\\d.\\d\\d\\d\\.lmp/doom2.wad|plutonia.wad"),
             .setup_screen = doom_misc_setup_screen_none,
@@ -3260,7 +3267,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(
         &defaults, s_owning_string_default((owning_string_default_t){
                        .name = "demo_pattern2",
-                       .location = &doom_state->defaults_storage.demo_patterns_list_def.data[2],
+                       .location = &storage->demo_patterns_list_def.data[2],
                        .default_value = phyto_string_span_from_c(
                            "DOOM 2: TNT - Evilution/((e(c|f|v|p|r|s|t))|(tn))\\d\\d.\\d\\d\\d\\.lmp/doom2.wad|tnt.wad"),
                        .setup_screen = doom_misc_setup_screen_none,
@@ -3268,7 +3275,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(
         &defaults, s_owning_string_default((owning_string_default_t){
                        .name = "demo_pattern3",
-                       .location = &doom_state->defaults_storage.demo_patterns_list_def.data[3],
+                       .location = &storage->demo_patterns_list_def.data[3],
                        .default_value = phyto_string_span_from_c(
                            "The Ultimate DOOM/(((e|f|n|p|r|t|u)\\dm\\d)|(n\\ds\\d)).\\d\\d\\d\\.lmp/doomu.wad"),
                        .setup_screen = doom_misc_setup_screen_none,
@@ -3276,7 +3283,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(
         &defaults, s_owning_string_default((owning_string_default_t){
                        .name = "demo_pattern4",
-                       .location = &doom_state->defaults_storage.demo_patterns_list_def.data[4],
+                       .location = &storage->demo_patterns_list_def.data[4],
                        .default_value = phyto_string_span_from_c(
                            "Alien Vendetta/a(c|f|n|p|r|s|t|v)\\d\\d.\\d\\d\\d\\.lmp/doom2.wad|av.wad|av.deh"),
                        .setup_screen = doom_misc_setup_screen_none,
@@ -3285,7 +3292,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
         &defaults,
         s_owning_string_default((owning_string_default_t){
             .name = "demo_pattern5",
-            .location = &doom_state->defaults_storage.demo_patterns_list_def.data[5],
+            .location = &storage->demo_patterns_list_def.data[5],
             .default_value = phyto_string_span_from_c(
                 "Requiem/r(c|f|n|p|q|r|s|t)\\d\\d.\\d\\d\\d\\.lmp/doom2.wad|requiem.wad|req21fix.wad|reqmus.wad"),
             .setup_screen = doom_misc_setup_screen_none,
@@ -3293,7 +3300,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(
         &defaults, s_owning_string_default((owning_string_default_t){
                        .name = "demo_pattern6",
-                       .location = &doom_state->defaults_storage.demo_patterns_list_def.data[6],
+                       .location = &storage->demo_patterns_list_def.data[6],
                        .default_value = phyto_string_span_from_c(
                            "Hell Revealed/h(c|e|f|n|p|r|s|t)\\d\\d.\\d\\d\\d\\.lmp/doom2.wad|hr.wad|hrmus.wad"),
                        .setup_screen = doom_misc_setup_screen_none,
@@ -3301,7 +3308,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(
         &defaults, s_owning_string_default((owning_string_default_t){
                        .name = "demo_pattern7",
-                       .location = &doom_state->defaults_storage.demo_patterns_list_def.data[7],
+                       .location = &storage->demo_patterns_list_def.data[7],
                        .default_value =
                            phyto_string_span_from_c("Memento Mori/mm\\d\\d.\\d\\d\\d\\.lmp/doom2.wad|mm.wad|mmmus.wad"),
                        .setup_screen = doom_misc_setup_screen_none,
@@ -3309,7 +3316,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults,
                                      s_owning_string_default((owning_string_default_t){
                                          .name = "demo_pattern8",
-                                         .location = &doom_state->defaults_storage.demo_patterns_list_def.data[8],
+                                         .location = &storage->demo_patterns_list_def.data[8],
                                          .default_value = phyto_string_span_from_c(
                                              "Memento Mori 2/m2\\d\\d.\\d\\d\\d\\.lmp/doom2.wad|mm2.wad|mm2mus.wad"),
                                          .setup_screen = doom_misc_setup_screen_none,
@@ -3318,7 +3325,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     doom_misc_default_dyarray_append(&defaults, s_header_default("Weapon preferences"));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "weapon_choice_1",
-                                                    .location = &doom_state->defaults_storage.weapon_preferences[0][0],
+                                                    .location = &storage->weapon_preferences[0][0],
                                                     .default_value = 6,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -3326,7 +3333,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "weapon_choice_2",
-                                                    .location = &doom_state->defaults_storage.weapon_preferences[0][1],
+                                                    .location = &storage->weapon_preferences[0][1],
                                                     .default_value = 9,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -3334,7 +3341,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "weapon_choice_3",
-                                                    .location = &doom_state->defaults_storage.weapon_preferences[0][2],
+                                                    .location = &storage->weapon_preferences[0][2],
                                                     .default_value = 4,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -3342,7 +3349,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "weapon_choice_4",
-                                                    .location = &doom_state->defaults_storage.weapon_preferences[0][3],
+                                                    .location = &storage->weapon_preferences[0][3],
                                                     .default_value = 3,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -3350,7 +3357,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "weapon_choice_5",
-                                                    .location = &doom_state->defaults_storage.weapon_preferences[0][4],
+                                                    .location = &storage->weapon_preferences[0][4],
                                                     .default_value = 2,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -3358,7 +3365,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "weapon_choice_6",
-                                                    .location = &doom_state->defaults_storage.weapon_preferences[0][5],
+                                                    .location = &storage->weapon_preferences[0][5],
                                                     .default_value = 8,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -3366,7 +3373,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "weapon_choice_7",
-                                                    .location = &doom_state->defaults_storage.weapon_preferences[0][6],
+                                                    .location = &storage->weapon_preferences[0][6],
                                                     .default_value = 5,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -3374,7 +3381,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "weapon_choice_8",
-                                                    .location = &doom_state->defaults_storage.weapon_preferences[0][7],
+                                                    .location = &storage->weapon_preferences[0][7],
                                                     .default_value = 7,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -3382,7 +3389,7 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
                                                 }));
     doom_misc_default_dyarray_append(&defaults, s_integer_default((integer_default_t){
                                                     .name = "weapon_choice_9",
-                                                    .location = &doom_state->defaults_storage.weapon_preferences[0][8],
+                                                    .location = &storage->weapon_preferences[0][8],
                                                     .default_value = 1,
                                                     .min_value = 0,
                                                     .max_value = 9,
@@ -3392,7 +3399,87 @@ doom_misc_default_dyarray_t doom_misc_default_dyarray_new(void) {
     return defaults;
 }
 
+doom_misc_default_t* doom_misc_default_find(const char* name) {
+    for (size_t i = 0; i < doom_state->defaults.size; i++) {
+        doom_misc_default_t* entry = &doom_state->defaults.data[i];
+        if (entry->type != doom_misc_default_type_none && nonstd_stricmp(entry->name, name) == 0) {
+            return entry;
+        }
+    }
+    return NULL;
+}
+
+bool doom_misc_default_set_integer(doom_misc_default_t* entry, int32_t value) {
+    assert(entry->type == doom_misc_default_type_integer);
+    if (entry->min_value != min_unset && value < entry->min_value) {
+        value = entry->min_value;
+    }
+    if (entry->max_value != max_unset && value > entry->max_value) {
+        value = entry->max_value;
+    }
+    if (*entry->location.pi == value) {
+        return false;
+    }
+    *entry->location.pi = value;
+    doom_misc_default_changed(entry);
+    return true;
+}
+
+bool doom_misc_default_set_hex_integer(doom_misc_default_t* entry, uint32_t value) {
+    assert(entry->type == doom_misc_default_type_hex_integer);
+    if (*entry->location.px == value) {
+        return false;
+    }
+    *entry->location.px = value;
+    doom_misc_default_changed(entry);
+    return true;
+}
+
+bool doom_misc_default_set_boolean(doom_misc_default_t* entry, bool value) {
+    assert(entry->type == doom_misc_default_type_boolean);
+    if (*entry->location.pb == value) {
+        return false;
+    }
+    *entry->location.pb = value;
+    doom_misc_default_changed(entry);
+    return true;
+}
+
+bool doom_misc_default_set_string(doom_misc_default_t* entry, phyto_string_span_t value) {
+    assert(entry->type == doom_misc_default_type_string);
+    phyto_string_span_t* current = entry->location.ps;
+    if (current->size == value.size && (value.size == 0 || memcmp(current->begin, value.begin, value.size) == 0)) {
+        return false;
+    }
+    *current = value;
+    doom_misc_default_changed(entry);
+    return true;
+}
+
 void doom_misc_load_defaults(void) {
+    // There is no config file parser yet, so every default takes its built-in value. Going through the setters
+    // means subscribers see the initial load as a change, the same as a config file would produce.
+    for (size_t i = 0; i < doom_state->defaults.size; i++) {
+        doom_misc_default_t* entry = &doom_state->defaults.data[i];
+        switch (entry->type) {
+        case doom_misc_default_type_integer:
+            doom_misc_default_set_integer(entry, entry->default_value.i);
+            break;
+        case doom_misc_default_type_hex_integer:
+            doom_misc_default_set_hex_integer(entry, entry->default_value.x);
+            break;
+        case doom_misc_default_type_boolean:
+            doom_misc_default_set_boolean(entry, entry->default_value.b);
+            break;
+        case doom_misc_default_type_string:
+            doom_misc_default_set_string(entry, entry->default_value.s);
+            break;
+        default:
+            // Owning strings point into demo_patterns_list_def, which has no storage yet; inputs belong to the DSDA
+            // subsystem.
+            break;
+        }
+    }
 }
 
 doom_misc_default_t s_header_default(const char* name) {
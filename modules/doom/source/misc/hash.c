@@ -0,0 +1,19 @@
+#include "doom/misc/hash.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+static const uint64_t sc_fnv_offset = UINT64_C(0xCBF29CE484222325);
+static const uint64_t sc_fnv_prime = UINT64_C(0x100000001B3);
+
+uint64_t doom_misc_hash(const void* data, size_t size) {
+    return doom_misc_hash_continue(sc_fnv_offset, data, size);
+}
+
+uint64_t doom_misc_hash_continue(uint64_t hash, const void* data, size_t size) {
+    const uint8_t* bytes = data;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ bytes[i]) * sc_fnv_prime;
+    }
+    return hash;
+}
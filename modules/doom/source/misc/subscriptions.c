@@ -0,0 +1,118 @@
+#include "doom/misc/subscriptions.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/misc/defaults.h"
+#include "doom/state.h"
+
+#include <nonstd/alloc.h>
+#include <nonstd/stricmp.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL_TAGGED(doom_misc_subscription_list, doom_misc_subscription_t,
+                                            nonstd_alloc_tag_config);
+
+static void s_subscription_free(doom_misc_subscription_t* subscription);
+
+static const doom_misc_subscription_list_callbacks_t sc_subscription_list_callbacks = {
+    .free_cb = s_subscription_free,
+    .compare_cb = NULL,
+    .copy_cb = NULL,
+    .print_cb = NULL,
+};
+
+doom_misc_subscription_list_t doom_misc_subscription_list_new(void) {
+    return doom_misc_subscription_list_init(&sc_subscription_list_callbacks);
+}
+
+size_t doom_misc_subscribe(doom_misc_subscription_func_t func, void* userdata, const char* name) {
+    doom_misc_subscription_list_t* subscriptions = &doom_state->subscriptions;
+    doom_misc_subscription_t subscription = {
+        .func = func,
+        .userdata = userdata,
+        .name = name,
+        .watched_defaults_words = (doom_state->defaults.size + 63) / 64,
+        .active = true,
+    };
+    subscription.watched_defaults =
+        nonstd_calloc(subscription.watched_defaults_words, sizeof(uint64_t), nonstd_alloc_tag_config);
+
+    // Reuse a slot left by doom_misc_unsubscribe(), so handles stay small.
+    for (size_t i = 0; i < subscriptions->size; i++) {
+        if (!subscriptions->data[i].active) {
+            subscriptions->data[i] = subscription;
+            return i;
+        }
+    }
+    doom_misc_subscription_list_append(subscriptions, subscription);
+    return subscriptions->size - 1;
+}
+
+void doom_misc_subscribe_default(size_t id, const char* default_name) {
+    doom_misc_subscription_t* subscription = &doom_state->subscriptions.data[id];
+    for (size_t i = 0; i < doom_state->defaults.size; i++) {
+        const char* name = doom_state->defaults.data[i].name;
+        if (name != NULL && nonstd_stricmp(name, default_name) == 0) {
+            if (i / 64 < subscription->watched_defaults_words) {
+                subscription->watched_defaults[i / 64] |= UINT64_C(1) << (i % 64);
+            }
+            return;
+        }
+    }
+    DOOM_LOG(config, warn, "%s subscribed to %s, which is not a default.\n", subscription->name, default_name);
+}
+
+void doom_misc_subscribe_screen(size_t id, doom_misc_setup_screen_t screen) {
+    doom_state->subscriptions.data[id].watched_screens |= UINT32_C(1) << screen;
+}
+
+void doom_misc_unsubscribe(size_t id) {
+    s_subscription_free(&doom_state->subscriptions.data[id]);
+}
+
+void doom_misc_default_changed(const doom_misc_default_t* entry) {
+    size_t index = (size_t)(entry - doom_state->defaults.data);
+    uint64_t bit = UINT64_C(1) << (index % 64);
+    uint32_t screen_bit = UINT32_C(1) << entry->setup_screen;
+
+    doom_misc_subscription_list_t* subscriptions = &doom_state->subscriptions;
+    for (size_t i = 0; i < subscriptions->size; i++) {
+        doom_misc_subscription_t* subscription = &subscriptions->data[i];
+        if (!subscription->active || subscription->pending) {
+            continue;
+        }
+        if ((subscription->watched_screens & screen_bit) != 0 ||
+            (index / 64 < subscription->watched_defaults_words &&
+             (subscription->watched_defaults[index / 64] & bit) != 0)) {
+            subscription->pending = true;
+            doom_state->subscriptions_pending = true;
+        }
+    }
+}
+
+void doom_misc_dispatch_subscriptions(void) {
+    if (!doom_state->subscriptions_pending) {
+        return;
+    }
+    doom_state->subscriptions_pending = false;
+
+    // Callbacks may change other defaults; those are picked up at the next dispatch rather than recursing here.
+    for (size_t i = 0; i < doom_state->subscriptions.size; i++) {
+        doom_misc_subscription_t* subscription = &doom_state->subscriptions.data[i];
+        if (subscription->active && subscription->pending) {
+            subscription->pending = false;
+            subscription->func(subscription->userdata);
+        }
+    }
+}
+
+void s_subscription_free(doom_misc_subscription_t* subscription) {
+    nonstd_free(subscription->watched_defaults);
+    subscription->watched_defaults = NULL;
+    subscription->watched_defaults_words = 0;
+    subscription->watched_screens = 0;
+    subscription->pending = false;
+    subscription->active = false;
+}
@@ -0,0 +1,428 @@
+#include "doom/render/column.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/render/draw.h"
+#include "doom/sys/bench.h"
+#include "doom/sys/clock.h"
+#include "doom/sys/cpu.h"
+
+#include <nonstd/alloc.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if DOOM_SYS_CPU_X86
+#include <immintrin.h>
+#endif
+
+enum
+{
+    frac_half = 1 << (doom_render_column_frac_bits - 1),
+    colormap_size = 256,
+    // A gather reads 4 bytes at each index.
+    gather_width = 4,
+    bench_texture_height = 128,
+    bench_resolution_count = 2,
+};
+
+const uint8_t doom_render_dither[4][4] = {
+    {8, 136, 40, 168},
+    {200, 72, 232, 104},
+    {56, 184, 24, 152},
+    {248, 120, 216, 88},
+};
+
+static inline void s_draw_rows(const doom_render_column_t* column, doom_render_draw_filter_type_t filter,
+                               int32_t first);
+static void s_draw_point_scalar(const doom_render_column_t* column);
+static void s_draw_linear_scalar(const doom_render_column_t* column);
+static void s_draw_rounded_scalar(const doom_render_column_t* column);
+#if DOOM_SYS_CPU_X86
+static inline void s_draw_sse2(const doom_render_column_t* column, doom_render_draw_filter_type_t filter);
+static void s_draw_point_sse2(const doom_render_column_t* column);
+static void s_draw_linear_sse2(const doom_render_column_t* column);
+static void s_draw_rounded_sse2(const doom_render_column_t* column);
+static inline void s_draw_avx2(const doom_render_column_t* column, doom_render_draw_filter_type_t filter);
+static void s_draw_point_avx2(const doom_render_column_t* column);
+static void s_draw_linear_avx2(const doom_render_column_t* column);
+static void s_draw_rounded_avx2(const doom_render_column_t* column);
+#endif
+
+static const doom_render_column_func_t sc_drawers[doom_sys_cpu_isa_count][doom_render_draw_filter_type_count] = {
+    [doom_sys_cpu_isa_scalar] =
+        {
+            [doom_render_draw_filter_type_none] = s_draw_point_scalar,
+            [doom_render_draw_filter_type_point] = s_draw_point_scalar,
+            [doom_render_draw_filter_type_linear] = s_draw_linear_scalar,
+            [doom_render_draw_filter_type_rounded] = s_draw_rounded_scalar,
+        },
+#if DOOM_SYS_CPU_X86
+    [doom_sys_cpu_isa_sse2] =
+        {
+            [doom_render_draw_filter_type_none] = s_draw_point_sse2,
+            [doom_render_draw_filter_type_point] = s_draw_point_sse2,
+            [doom_render_draw_filter_type_linear] = s_draw_linear_sse2,
+            [doom_render_draw_filter_type_rounded] = s_draw_rounded_sse2,
+        },
+    [doom_sys_cpu_isa_avx2] =
+        {
+            [doom_render_draw_filter_type_none] = s_draw_point_avx2,
+            [doom_render_draw_filter_type_point] = s_draw_point_avx2,
+            [doom_render_draw_filter_type_linear] = s_draw_linear_avx2,
+            [doom_render_draw_filter_type_rounded] = s_draw_rounded_avx2,
+        },
+#endif
+};
+
+// The instruction set doom_render_draw_column() uses, picked on first use; -1 until then.
+static atomic_int s_isa = -1;
+
+doom_render_column_func_t doom_render_column_drawer(doom_render_draw_filter_type_t filter, doom_sys_cpu_isa_t isa) {
+    return sc_drawers[isa][filter];
+}
+
+void doom_render_draw_column(const doom_render_column_t* column, doom_render_draw_filter_type_t filter) {
+    int isa = atomic_load_explicit(&s_isa, memory_order_relaxed);
+    if (isa < 0) {
+        isa = (int)doom_sys_cpu_best_isa();
+        atomic_store_explicit(&s_isa, isa, memory_order_relaxed);
+    }
+    sc_drawers[isa][filter](column);
+}
+
+void doom_render_column_bench(void) {
+    static const int32_t sc_widths[bench_resolution_count] = {1920, 3840};
+    static const int32_t sc_heights[bench_resolution_count] = {1080, 2160};
+    static const doom_render_draw_filter_type_t sc_filters[] = {
+        doom_render_draw_filter_type_point,
+        doom_render_draw_filter_type_linear,
+        doom_render_draw_filter_type_rounded,
+    };
+    enum
+    {
+        filter_count = sizeof(sc_filters) / sizeof(sc_filters[0]),
+    };
+
+    uint8_t* screen = nonstd_malloc((size_t)sc_widths[1] * (size_t)sc_heights[1], nonstd_alloc_tag_bench);
+    uint8_t texture[bench_texture_height];
+    uint8_t colormaps[2][colormap_size];
+    // Any bytes will do, as long as the compiler can't see through them.
+    uint32_t seed = (uint32_t)doom_sys_clock_ns() | 1;
+    for (size_t i = 0; i < bench_texture_height; i++) {
+        seed = seed * 1664525 + 1013904223;
+        texture[i] = (uint8_t)(seed >> 24);
+    }
+    for (size_t i = 0; i < 2 * colormap_size; i++) {
+        seed = seed * 1664525 + 1013904223;
+        colormaps[i / colormap_size][i % colormap_size] = (uint8_t)(seed >> 24);
+    }
+
+    doom_sys_bench_t bench = doom_sys_bench_new("draw");
+    // Series names aren't copied, so they live here until the benchmark is freed.
+    char names[doom_sys_cpu_isa_count][filter_count][bench_resolution_count][32];
+    size_t series[doom_sys_cpu_isa_count][filter_count][bench_resolution_count];
+    for (doom_sys_cpu_isa_t isa = 0; isa < doom_sys_cpu_isa_count; isa++) {
+        for (size_t filter = 0; filter < filter_count; filter++) {
+            for (size_t resolution = 0; resolution < bench_resolution_count; resolution++) {
+                snprintf(names[isa][filter][resolution], sizeof(names[isa][filter][resolution]), "%s_%s_%dp",
+                         doom_sys_cpu_isa_name(isa), filter == 0 ? "point" : filter == 1 ? "linear" : "rounded",
+                         sc_heights[resolution]);
+                if (doom_sys_cpu_supports(isa) && sc_drawers[isa][sc_filters[filter]] != NULL) {
+                    series[isa][filter][resolution] = doom_sys_bench_series(&bench, names[isa][filter][resolution]);
+                }
+            }
+        }
+    }
+
+    for (size_t iteration = 0; iteration < doom_render_column_bench_iterations; iteration++) {
+        for (doom_sys_cpu_isa_t isa = 0; isa < doom_sys_cpu_isa_count; isa++) {
+            if (!doom_sys_cpu_supports(isa)) {
+                continue;
+            }
+            for (size_t filter = 0; filter < filter_count; filter++) {
+                doom_render_column_func_t drawer = sc_drawers[isa][sc_filters[filter]];
+                if (drawer == NULL) {
+                    continue;
+                }
+                for (size_t resolution = 0; resolution < bench_resolution_count; resolution++) {
+                    int32_t width = sc_widths[resolution];
+                    int32_t height = sc_heights[resolution];
+                    // Each column stretches the texture over the screen height, with half the light blended in.
+                    doom_render_column_t column = {
+                        .pitch = width,
+                        .count = height,
+                        .source = texture,
+                        .source_height = bench_texture_height,
+                        .step = (uint32_t)(((uint64_t)bench_texture_height << doom_render_column_frac_bits) /
+                                           (uint64_t)height),
+                        .colormap = colormaps[0],
+                        .next_colormap = colormaps[1],
+                        .z_weight = colormap_size / 2,
+                    };
+                    uint64_t start = doom_sys_clock_ns();
+                    for (int32_t x = 0; x < width; x++) {
+                        column.dest = screen + x;
+                        column.x = x;
+                        drawer(&column);
+                    }
+                    doom_sys_bench_record(&bench, series[isa][filter][resolution], doom_sys_clock_ns() - start);
+                }
+            }
+        }
+    }
+    bench.iterations = doom_render_column_bench_iterations;
+
+    doom_sys_bench_report(&bench);
+    for (size_t i = 0; i < bench.series.size; i++) {
+        doom_sys_bench_series_t* s = &bench.series.data[i];
+        doom_sys_bench_summary_t summary = doom_sys_bench_summarize(s);
+        // The resolution is the last thing in the name.
+        size_t resolution = strstr(s->name, "_1080p") != NULL ? 0 : 1;
+        double pixels = (double)sc_widths[resolution] * (double)sc_heights[resolution];
+        doom_log_printf(doom_log_level_info, "%-24s %10.1f Mpx/s\n", s->name,
+                        summary.median_ns > 0 ? pixels * 1e3 / (double)summary.median_ns : 0.0);
+    }
+    char* json_path = doom_sys_bench_json_path("benchdraw.json");
+    if (doom_sys_bench_write_json(&bench, json_path)) {
+        doom_log_printf(doom_log_level_info, "Wrote %s.\n", json_path);
+    } else {
+        DOOM_LOG(render, warn, "Could not write %s.\n", json_path);
+    }
+    nonstd_free(json_path);
+    doom_sys_bench_free(&bench);
+    nonstd_free(screen);
+}
+
+void s_draw_rows(const doom_render_column_t* column, doom_render_draw_filter_type_t filter, int32_t first) {
+    uint32_t height = (uint32_t)column->source_height;
+    bool power_of_two = (height & (height - 1)) == 0;
+    uint32_t x = (uint32_t)column->x & 3;
+    uint8_t* dest = column->dest + first * column->pitch;
+    uint32_t frac = column->frac + (uint32_t)first * column->step;
+    for (int32_t i = first; i < column->count; i++) {
+        uint32_t y = (uint32_t)(column->y + i) & 3;
+        // The texture filter reads the dither at [y][x] and filter_z at [x][y], so the two patterns don't line up.
+        uint32_t texel;
+        switch (filter) {
+            case doom_render_draw_filter_type_linear:
+                // The upper 8 fractional bits pick the next texel for that share of the dither pattern.
+                texel = (frac >> doom_render_column_frac_bits) +
+                        (((frac >> (doom_render_column_frac_bits - 8)) & 0xFF) > doom_render_dither[y][x]);
+                break;
+            case doom_render_draw_filter_type_rounded:
+                texel = (frac + frac_half) >> doom_render_column_frac_bits;
+                break;
+            case doom_render_draw_filter_type_none:
+            case doom_render_draw_filter_type_point:
+            default:
+                texel = frac >> doom_render_column_frac_bits;
+                break;
+        }
+        texel = power_of_two ? texel & (height - 1) : texel % height;
+        const uint8_t* colormap =
+            column->z_weight > doom_render_dither[x][y] ? column->next_colormap : column->colormap;
+        *dest = colormap[column->source[texel]];
+        dest += column->pitch;
+        frac += column->step;
+    }
+}
+
+void s_draw_point_scalar(const doom_render_column_t* column) {
+    s_draw_rows(column, doom_render_draw_filter_type_point, 0);
+}
+
+void s_draw_linear_scalar(const doom_render_column_t* column) {
+    s_draw_rows(column, doom_render_draw_filter_type_linear, 0);
+}
+
+void s_draw_rounded_scalar(const doom_render_column_t* column) {
+    s_draw_rows(column, doom_render_draw_filter_type_rounded, 0);
+}
+
+#if DOOM_SYS_CPU_X86
+
+// The dither thresholds repeat every 4 rows, so each SIMD lane always sees the same ones: the texture threshold, and
+// whether the lane uses the next colormap.
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_draw_sse2(const doom_render_column_t* column, doom_render_draw_filter_type_t filter) {
+    uint32_t height = (uint32_t)column->source_height;
+    if ((height & (height - 1)) != 0) {
+        // Wrapping around any other height is a division, which SSE2 doesn't have.
+        s_draw_rows(column, filter, 0);
+        return;
+    }
+
+    uint32_t x = (uint32_t)column->x & 3;
+    uint32_t thresholds[4];
+    const uint8_t* colormaps[4];
+    for (uint32_t lane = 0; lane < 4; lane++) {
+        uint32_t y = (uint32_t)(column->y + (int32_t)lane) & 3;
+        thresholds[lane] = doom_render_dither[y][x];
+        colormaps[lane] = column->z_weight > doom_render_dither[x][y] ? column->next_colormap : column->colormap;
+    }
+    __m128i threshold = _mm_loadu_si128((const __m128i*)thresholds);
+    __m128i mask = _mm_set1_epi32((int)(height - 1));
+    __m128i half = _mm_set1_epi32(frac_half);
+    __m128i byte = _mm_set1_epi32(0xFF);
+    uint32_t step = column->step;
+    __m128i frac = _mm_setr_epi32((int)column->frac, (int)(column->frac + step), (int)(column->frac + 2 * step),
+                                  (int)(column->frac + 3 * step));
+    __m128i step4 = _mm_set1_epi32((int)(4 * step));
+
+    const uint8_t* source = column->source;
+    ptrdiff_t pitch = column->pitch;
+    uint8_t* dest = column->dest;
+    int32_t i = 0;
+    for (; i + 4 <= column->count; i += 4) {
+        __m128i texel;
+        switch (filter) {
+            case doom_render_draw_filter_type_linear: {
+                // The comparison is -1 where the next texel is picked.
+                __m128i fraction = _mm_and_si128(_mm_srli_epi32(frac, doom_render_column_frac_bits - 8), byte);
+                texel = _mm_sub_epi32(_mm_srli_epi32(frac, doom_render_column_frac_bits),
+                                      _mm_cmpgt_epi32(fraction, threshold));
+                break;
+            }
+            case doom_render_draw_filter_type_rounded:
+                texel = _mm_srli_epi32(_mm_add_epi32(frac, half), doom_render_column_frac_bits);
+                break;
+            case doom_render_draw_filter_type_none:
+            case doom_render_draw_filter_type_point:
+            default:
+                texel = _mm_srli_epi32(frac, doom_render_column_frac_bits);
+                break;
+        }
+        uint32_t texels[4];
+        _mm_storeu_si128((__m128i*)texels, _mm_and_si128(texel, mask));
+        dest[0] = colormaps[0][source[texels[0]]];
+        dest[pitch] = colormaps[1][source[texels[1]]];
+        dest[2 * pitch] = colormaps[2][source[texels[2]]];
+        dest[3 * pitch] = colormaps[3][source[texels[3]]];
+        dest += 4 * pitch;
+        frac = _mm_add_epi32(frac, step4);
+    }
+    s_draw_rows(column, filter, i);
+}
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_draw_point_sse2(const doom_render_column_t* column) {
+    s_draw_sse2(column, doom_render_draw_filter_type_point);
+}
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_draw_linear_sse2(const doom_render_column_t* column) {
+    s_draw_sse2(column, doom_render_draw_filter_type_linear);
+}
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_draw_rounded_sse2(const doom_render_column_t* column) {
+    s_draw_sse2(column, doom_render_draw_filter_type_rounded);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_draw_avx2(const doom_render_column_t* column, doom_render_draw_filter_type_t filter) {
+    uint32_t height = (uint32_t)column->source_height;
+    if ((height & (height - 1)) != 0 || height < gather_width || column->count < 8) {
+        s_draw_rows(column, filter, 0);
+        return;
+    }
+
+    // Gathers read 4 bytes for each one they need. Each lane reads the aligned word its byte is in, which ends inside
+    // the texture (a multiple of 4 texels high) and the colormap (256 bytes), and shifts the byte down. One gather
+    // reads both colormaps: lanes on the next one add its distance from the first to their index, which must fit.
+    intptr_t distance = (intptr_t)column->next_colormap - (intptr_t)column->colormap;
+    if (distance < INT32_MIN || distance > INT32_MAX - colormap_size) {
+        s_draw_rows(column, filter, 0);
+        return;
+    }
+    uint32_t x = (uint32_t)column->x & 3;
+    uint32_t thresholds[8];
+    int32_t colormap_offsets[8];
+    uint32_t fracs[8];
+    for (uint32_t lane = 0; lane < 8; lane++) {
+        uint32_t y = (uint32_t)(column->y + (int32_t)lane) & 3;
+        thresholds[lane] = doom_render_dither[y][x];
+        colormap_offsets[lane] = column->z_weight > doom_render_dither[x][y] ? (int32_t)distance : 0;
+        fracs[lane] = column->frac + lane * column->step;
+    }
+    __m256i threshold = _mm256_loadu_si256((const __m256i*)thresholds);
+    __m256i colormap_offset = _mm256_loadu_si256((const __m256i*)colormap_offsets);
+    __m256i frac = _mm256_loadu_si256((const __m256i*)fracs);
+    __m256i step8 = _mm256_set1_epi32((int)(8 * column->step));
+    __m256i mask = _mm256_set1_epi32((int)(height - 1));
+    __m256i word = _mm256_set1_epi32(~(gather_width - 1));
+    __m256i byte_in_word = _mm256_set1_epi32(gather_width - 1);
+    __m256i half = _mm256_set1_epi32(frac_half);
+    __m256i byte = _mm256_set1_epi32(0xFF);
+    // Moves the low byte of each 32-bit lane into the low 4 bytes of its 128-bit half.
+    __m256i pack = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 4, 8, 12, -1, -1,
+                                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+
+    const int* source = (const int*)column->source;
+    const int* colormap = (const int*)column->colormap;
+    ptrdiff_t pitch = column->pitch;
+    uint8_t* dest = column->dest;
+    int32_t i = 0;
+    for (; i + 8 <= column->count; i += 8) {
+        __m256i texel;
+        switch (filter) {
+            case doom_render_draw_filter_type_linear: {
+                __m256i fraction = _mm256_and_si256(_mm256_srli_epi32(frac, doom_render_column_frac_bits - 8), byte);
+                texel = _mm256_sub_epi32(_mm256_srli_epi32(frac, doom_render_column_frac_bits),
+                                         _mm256_cmpgt_epi32(fraction, threshold));
+                break;
+            }
+            case doom_render_draw_filter_type_rounded:
+                texel = _mm256_srli_epi32(_mm256_add_epi32(frac, half), doom_render_column_frac_bits);
+                break;
+            case doom_render_draw_filter_type_none:
+            case doom_render_draw_filter_type_point:
+            default:
+                texel = _mm256_srli_epi32(frac, doom_render_column_frac_bits);
+                break;
+        }
+        texel = _mm256_and_si256(texel, mask);
+        __m256i pixel = _mm256_i32gather_epi32(source, _mm256_and_si256(texel, word), 1);
+        pixel = _mm256_and_si256(
+            _mm256_srlv_epi32(pixel, _mm256_slli_epi32(_mm256_and_si256(texel, byte_in_word), 3)), byte);
+        __m256i color =
+            _mm256_i32gather_epi32(colormap, _mm256_add_epi32(_mm256_and_si256(pixel, word), colormap_offset), 1);
+        color = _mm256_srlv_epi32(color, _mm256_slli_epi32(_mm256_and_si256(pixel, byte_in_word), 3));
+        color = _mm256_shuffle_epi8(color, pack);
+        uint32_t low = (uint32_t)_mm256_extract_epi32(color, 0);
+        uint32_t high = (uint32_t)_mm256_extract_epi32(color, 4);
+        dest[0] = (uint8_t)low;
+        dest[pitch] = (uint8_t)(low >> 8);
+        dest[2 * pitch] = (uint8_t)(low >> 16);
+        dest[3 * pitch] = (uint8_t)(low >> 24);
+        dest[4 * pitch] = (uint8_t)high;
+        dest[5 * pitch] = (uint8_t)(high >> 8);
+        dest[6 * pitch] = (uint8_t)(high >> 16);
+        dest[7 * pitch] = (uint8_t)(high >> 24);
+        dest += 8 * pitch;
+        frac = _mm256_add_epi32(frac, step8);
+    }
+    s_draw_rows(column, filter, i);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_draw_point_avx2(const doom_render_column_t* column) {
+    s_draw_avx2(column, doom_render_draw_filter_type_point);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_draw_linear_avx2(const doom_render_column_t* column) {
+    s_draw_avx2(column, doom_render_draw_filter_type_linear);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_draw_rounded_avx2(const doom_render_column_t* column) {
+    s_draw_avx2(column, doom_render_draw_filter_type_rounded);
+}
+
+#endif
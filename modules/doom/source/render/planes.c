@@ -0,0 +1,263 @@
+#include "doom/render/planes.h"
+
+#include "doom/render/column.h"
+#include "doom/render/draw.h"
+#include "doom/render/span.h"
+
+#include <math.h>
+#include <nonstd/alloc.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum
+{
+    min_plane_capacity = 128,
+    min_bucket_count = 128,
+    flat_bytes = doom_render_span_flat_size * doom_render_span_flat_size,
+    // Light levels are 16 steps of the sector light, 4 colormaps apart, as in vanilla.
+    light_shift = 4,
+    light_levels = 16,
+    colormaps_per_level = 4,
+};
+
+// How many colormaps darker the distance makes a plane: this many over (distance + 16), as in vanilla at 320 columns.
+static const float sc_distance_light = 1280.0f;
+
+static size_t s_bucket(const doom_render_planes_t* planes, int32_t height, int32_t pic, int32_t light);
+static size_t s_add(doom_render_planes_t* planes, int32_t height, int32_t pic, int32_t light);
+static void s_rehash(doom_render_planes_t* planes, size_t bucket_count);
+static void s_draw_plane(doom_render_planes_t* planes, const doom_render_planes_view_t* view, size_t index);
+static void s_map(const doom_render_planes_t* planes, const doom_render_planes_view_t* view,
+                  const doom_render_visplane_t* plane, int32_t y, int32_t x1, int32_t x2);
+static uint32_t s_fixed(double value);
+
+void doom_render_planes_init(doom_render_planes_t* planes, int32_t width, int32_t height) {
+    *planes = (doom_render_planes_t){
+        .width = width,
+        .height = height,
+        .span_start = nonstd_malloc((size_t)height * sizeof(int32_t), nonstd_alloc_tag_render),
+    };
+}
+
+void doom_render_planes_destroy(doom_render_planes_t* planes) {
+    nonstd_free(planes->planes);
+    nonstd_free(planes->slab);
+    nonstd_free(planes->buckets);
+    nonstd_free(planes->span_start);
+    *planes = (doom_render_planes_t){0};
+}
+
+void doom_render_planes_clear(doom_render_planes_t* planes) {
+    planes->plane_count = 0;
+    if (planes->bucket_count > 0) {
+        memset(planes->buckets, 0xFF, planes->bucket_count * sizeof(size_t));
+    }
+}
+
+size_t doom_render_planes_find(doom_render_planes_t* planes, int32_t height, int32_t pic, int32_t light) {
+    if (planes->bucket_count > 0) {
+        for (size_t index = planes->buckets[s_bucket(planes, height, pic, light)]; index != SIZE_MAX;
+             index = planes->planes[index].next) {
+            const doom_render_visplane_t* plane = &planes->planes[index];
+            if (plane->height == height && plane->pic == pic && plane->light == light) {
+                return index;
+            }
+        }
+    }
+    return s_add(planes, height, pic, light);
+}
+
+size_t doom_render_planes_check(doom_render_planes_t* planes, size_t plane, int32_t start, int32_t stop) {
+    doom_render_visplane_t* visplane = &planes->planes[plane];
+    if (visplane->min_x > visplane->max_x) {
+        visplane->min_x = start;
+        visplane->max_x = stop;
+        return plane;
+    }
+
+    // The columns can be added if none of those it already covers is marked.
+    int32_t first = start > visplane->min_x ? start : visplane->min_x;
+    int32_t last = stop < visplane->max_x ? stop : visplane->max_x;
+    const uint16_t* top = planes->slab + visplane->rows;
+    int32_t x = first;
+    while (x <= last && top[x] == doom_render_planes_unset) {
+        x++;
+    }
+    if (x > last) {
+        visplane->min_x = start < visplane->min_x ? start : visplane->min_x;
+        visplane->max_x = stop > visplane->max_x ? stop : visplane->max_x;
+        return plane;
+    }
+
+    size_t split = s_add(planes, visplane->height, visplane->pic, visplane->light);
+    planes->planes[split].min_x = start;
+    planes->planes[split].max_x = stop;
+    return split;
+}
+
+void doom_render_planes_mark(doom_render_planes_t* planes, size_t plane, int32_t x, int32_t top, int32_t bottom) {
+    if (x < 0 || x >= planes->width) {
+        return;
+    }
+    top = top < 0 ? 0 : top;
+    bottom = bottom >= planes->height ? planes->height - 1 : bottom;
+    if (top > bottom) {
+        return;
+    }
+    doom_render_visplane_t* visplane = &planes->planes[plane];
+    planes->slab[visplane->rows + (size_t)x] = (uint16_t)top;
+    planes->slab[visplane->rows + (size_t)planes->width + (size_t)x] = (uint16_t)bottom;
+    visplane->min_x = x < visplane->min_x ? x : visplane->min_x;
+    visplane->max_x = x > visplane->max_x ? x : visplane->max_x;
+}
+
+void doom_render_planes_draw(doom_render_planes_t* planes, const doom_render_planes_view_t* view) {
+    for (size_t plane = 0; plane < planes->plane_count; plane++) {
+        s_draw_plane(planes, view, plane);
+    }
+}
+
+size_t s_bucket(const doom_render_planes_t* planes, int32_t height, int32_t pic, int32_t light) {
+    uint64_t key = (uint64_t)(uint32_t)height << 32 | (uint64_t)(uint32_t)pic << 8 | (uint8_t)light;
+    return (size_t)((key * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & (planes->bucket_count - 1);
+}
+
+size_t s_add(doom_render_planes_t* planes, int32_t height, int32_t pic, int32_t light) {
+    size_t width = (size_t)planes->width;
+    if (planes->plane_count == planes->plane_capacity) {
+        size_t capacity = planes->plane_capacity == 0 ? min_plane_capacity : planes->plane_capacity * 2;
+        planes->planes =
+            nonstd_realloc(planes->planes, capacity * sizeof(doom_render_visplane_t), nonstd_alloc_tag_render);
+        planes->slab = nonstd_realloc(planes->slab, capacity * 2 * width * sizeof(uint16_t), nonstd_alloc_tag_render);
+        planes->plane_capacity = capacity;
+    }
+    if (planes->plane_count + 1 > planes->bucket_count) {
+        s_rehash(planes, planes->bucket_count == 0 ? min_bucket_count : planes->bucket_count * 2);
+    }
+
+    size_t index = planes->plane_count++;
+    size_t bucket = s_bucket(planes, height, pic, light);
+    planes->planes[index] = (doom_render_visplane_t){
+        .height = height,
+        .pic = pic,
+        .light = light,
+        .min_x = planes->width,
+        .max_x = -1,
+        .rows = index * 2 * width,
+        .next = planes->buckets[bucket],
+    };
+    planes->buckets[bucket] = index;
+    memset(planes->slab + index * 2 * width, 0xFF, width * sizeof(uint16_t));
+    return index;
+}
+
+void s_rehash(doom_render_planes_t* planes, size_t bucket_count) {
+    nonstd_free(planes->buckets);
+    planes->buckets = nonstd_malloc(bucket_count * sizeof(size_t), nonstd_alloc_tag_render);
+    planes->bucket_count = bucket_count;
+    memset(planes->buckets, 0xFF, bucket_count * sizeof(size_t));
+    for (size_t i = 0; i < planes->plane_count; i++) {
+        doom_render_visplane_t* plane = &planes->planes[i];
+        size_t bucket = s_bucket(planes, plane->height, plane->pic, plane->light);
+        plane->next = planes->buckets[bucket];
+        planes->buckets[bucket] = i;
+    }
+}
+
+void s_draw_plane(doom_render_planes_t* planes, const doom_render_planes_view_t* view, size_t index) {
+    const doom_render_visplane_t* plane = &planes->planes[index];
+    if (plane->min_x > plane->max_x) {
+        return;
+    }
+    const uint8_t* flat = view->flat(plane->pic, view->userdata);
+    if (flat == NULL) {
+        return;
+    }
+    // The copy is what the SIMD drawers may read past the end of.
+    memcpy(planes->flat, flat, flat_bytes);
+
+    // Walk the columns, closing the runs of rows the previous column had and this one doesn't, and opening those this
+    // one has and the previous didn't. Each run that closes is drawn as one span, however many columns (and walls)
+    // it crossed.
+    const uint16_t* tops = planes->slab + plane->rows;
+    const uint16_t* bottoms = tops + planes->width;
+    int32_t* span_start = planes->span_start;
+    int32_t previous_top = doom_render_planes_unset;
+    int32_t previous_bottom = 0;
+    for (int32_t x = plane->min_x; x <= plane->max_x + 1; x++) {
+        int32_t top = doom_render_planes_unset;
+        int32_t bottom = 0;
+        if (x <= plane->max_x && tops[x] != doom_render_planes_unset) {
+            top = tops[x];
+            bottom = bottoms[x];
+        }
+
+        int32_t closing_top = previous_top;
+        int32_t closing_bottom = previous_bottom;
+        while (closing_top < top && closing_top <= closing_bottom) {
+            s_map(planes, view, plane, closing_top, span_start[closing_top], x - 1);
+            closing_top++;
+        }
+        while (closing_bottom > bottom && closing_bottom >= closing_top) {
+            s_map(planes, view, plane, closing_bottom, span_start[closing_bottom], x - 1);
+            closing_bottom--;
+        }
+        int32_t opening_top = top;
+        int32_t opening_bottom = bottom;
+        while (opening_top < closing_top && opening_top <= opening_bottom) {
+            span_start[opening_top++] = x;
+        }
+        while (opening_bottom > closing_bottom && opening_bottom >= opening_top) {
+            span_start[opening_bottom--] = x;
+        }
+
+        previous_top = top;
+        previous_bottom = bottom;
+    }
+}
+
+void s_map(const doom_render_planes_t* planes, const doom_render_planes_view_t* view,
+           const doom_render_visplane_t* plane, int32_t y, int32_t x1, int32_t x2) {
+    float rows = fabsf((float)y + 0.5f - view->center_y);
+    float distance = fabsf((float)plane->height - view->view_z) * view->projection / rows;
+    // Map units per pixel along the row, which runs to the right of the view: (sin, -cos).
+    float scale = distance / view->projection;
+    float left = ((float)x1 + 0.5f - view->center_x) * scale;
+    float x = view->view_x + view->view_cos * distance + view->view_sin * left;
+    float y_world = view->view_y + view->view_sin * distance - view->view_cos * left;
+
+    float level = (float)((light_levels - 1 - (plane->light >> light_shift)) * colormaps_per_level) -
+                  sc_distance_light / (distance + 16.0f);
+    float darkest = (float)(view->colormap_count - 1);
+    level = level < 0.0f ? 0.0f : level > darkest ? darkest : level;
+    int32_t map = (int32_t)level;
+    int32_t next_map = map + 1 < view->colormap_count ? map + 1 : map;
+    uint32_t z_weight = 0;
+    if (view->z_filter == doom_render_draw_filter_type_linear) {
+        z_weight = (uint32_t)((level - (float)map) * 256.0f);
+    }
+
+    // Flats run along the map's x and against its y.
+    doom_render_span_t span = {
+        .dest = view->screen + (ptrdiff_t)y * view->pitch + x1,
+        .x = x1,
+        .y = y,
+        .count = x2 - x1 + 1,
+        .source = planes->flat,
+        .xfrac = s_fixed(x),
+        .yfrac = s_fixed(-y_world),
+        .xstep = s_fixed(view->view_sin * scale),
+        .ystep = s_fixed(view->view_cos * scale),
+        .colormap = view->colormaps + (size_t)map * 256,
+        .next_colormap = view->colormaps + (size_t)next_map * 256,
+        .z_weight = z_weight,
+    };
+    doom_render_draw_span(&span, view->filter);
+}
+
+uint32_t s_fixed(double value) {
+    // Through a signed 64-bit integer, so negative and far coordinates wrap like the flat does.
+    return (uint32_t)(int64_t)(value * (double)(1 << doom_render_column_frac_bits));
+}
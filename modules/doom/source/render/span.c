@@ -0,0 +1,314 @@
+#include "doom/render/span.h"
+
+#include "doom/render/column.h"
+#include "doom/render/draw.h"
+#include "doom/sys/cpu.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if DOOM_SYS_CPU_X86
+#include <immintrin.h>
+#endif
+
+enum
+{
+    frac_half = 1 << (doom_render_column_frac_bits - 1),
+    flat_mask = doom_render_span_flat_size - 1,
+    flat_shift = 6,
+    colormap_size = 256,
+    gather_padding = 4,
+};
+
+static inline void s_draw_pixels(const doom_render_span_t* span, doom_render_draw_filter_type_t filter, int32_t first);
+static void s_draw_point_scalar(const doom_render_span_t* span);
+static void s_draw_linear_scalar(const doom_render_span_t* span);
+static void s_draw_rounded_scalar(const doom_render_span_t* span);
+#if DOOM_SYS_CPU_X86
+static inline void s_draw_sse2(const doom_render_span_t* span, doom_render_draw_filter_type_t filter);
+static void s_draw_point_sse2(const doom_render_span_t* span);
+static void s_draw_linear_sse2(const doom_render_span_t* span);
+static void s_draw_rounded_sse2(const doom_render_span_t* span);
+static inline void s_draw_avx2(const doom_render_span_t* span, doom_render_draw_filter_type_t filter);
+static void s_draw_point_avx2(const doom_render_span_t* span);
+static void s_draw_linear_avx2(const doom_render_span_t* span);
+static void s_draw_rounded_avx2(const doom_render_span_t* span);
+#endif
+
+static const doom_render_span_func_t sc_drawers[doom_sys_cpu_isa_count][doom_render_draw_filter_type_count] = {
+    [doom_sys_cpu_isa_scalar] =
+        {
+            [doom_render_draw_filter_type_none] = s_draw_point_scalar,
+            [doom_render_draw_filter_type_point] = s_draw_point_scalar,
+            [doom_render_draw_filter_type_linear] = s_draw_linear_scalar,
+            [doom_render_draw_filter_type_rounded] = s_draw_rounded_scalar,
+        },
+#if DOOM_SYS_CPU_X86
+    [doom_sys_cpu_isa_sse2] =
+        {
+            [doom_render_draw_filter_type_none] = s_draw_point_sse2,
+            [doom_render_draw_filter_type_point] = s_draw_point_sse2,
+            [doom_render_draw_filter_type_linear] = s_draw_linear_sse2,
+            [doom_render_draw_filter_type_rounded] = s_draw_rounded_sse2,
+        },
+    [doom_sys_cpu_isa_avx2] =
+        {
+            [doom_render_draw_filter_type_none] = s_draw_point_avx2,
+            [doom_render_draw_filter_type_point] = s_draw_point_avx2,
+            [doom_render_draw_filter_type_linear] = s_draw_linear_avx2,
+            [doom_render_draw_filter_type_rounded] = s_draw_rounded_avx2,
+        },
+#endif
+};
+
+// The instruction set doom_render_draw_span() uses, picked on first use; -1 until then.
+static atomic_int s_isa = -1;
+
+doom_render_span_func_t doom_render_span_drawer(doom_render_draw_filter_type_t filter, doom_sys_cpu_isa_t isa) {
+    return sc_drawers[isa][filter];
+}
+
+void doom_render_draw_span(const doom_render_span_t* span, doom_render_draw_filter_type_t filter) {
+    int isa = atomic_load_explicit(&s_isa, memory_order_relaxed);
+    if (isa < 0) {
+        isa = (int)doom_sys_cpu_best_isa();
+        atomic_store_explicit(&s_isa, isa, memory_order_relaxed);
+    }
+    sc_drawers[isa][filter](span);
+}
+
+void s_draw_pixels(const doom_render_span_t* span, doom_render_draw_filter_type_t filter, int32_t first) {
+    uint32_t y = (uint32_t)span->y & 3;
+    uint32_t xfrac = span->xfrac + (uint32_t)first * span->xstep;
+    uint32_t yfrac = span->yfrac + (uint32_t)first * span->ystep;
+    for (int32_t i = first; i < span->count; i++) {
+        uint32_t x = (uint32_t)(span->x + i) & 3;
+        // The dither is read at [y][x] for the flat's x, [x][y] for its y, and shifted by 2 both ways for filter_z, so
+        // none of the patterns line up.
+        uint32_t u;
+        uint32_t v;
+        switch (filter) {
+            case doom_render_draw_filter_type_linear:
+                u = (xfrac >> doom_render_column_frac_bits) +
+                    (((xfrac >> (doom_render_column_frac_bits - 8)) & 0xFF) > doom_render_dither[y][x]);
+                v = (yfrac >> doom_render_column_frac_bits) +
+                    (((yfrac >> (doom_render_column_frac_bits - 8)) & 0xFF) > doom_render_dither[x][y]);
+                break;
+            case doom_render_draw_filter_type_rounded:
+                u = (xfrac + frac_half) >> doom_render_column_frac_bits;
+                v = (yfrac + frac_half) >> doom_render_column_frac_bits;
+                break;
+            case doom_render_draw_filter_type_none:
+            case doom_render_draw_filter_type_point:
+            default:
+                u = xfrac >> doom_render_column_frac_bits;
+                v = yfrac >> doom_render_column_frac_bits;
+                break;
+        }
+        const uint8_t* colormap =
+            span->z_weight > doom_render_dither[(y + 2) & 3][(x + 2) & 3] ? span->next_colormap : span->colormap;
+        span->dest[i] = colormap[span->source[(v & flat_mask) << flat_shift | (u & flat_mask)]];
+        xfrac += span->xstep;
+        yfrac += span->ystep;
+    }
+}
+
+void s_draw_point_scalar(const doom_render_span_t* span) {
+    s_draw_pixels(span, doom_render_draw_filter_type_point, 0);
+}
+
+void s_draw_linear_scalar(const doom_render_span_t* span) {
+    s_draw_pixels(span, doom_render_draw_filter_type_linear, 0);
+}
+
+void s_draw_rounded_scalar(const doom_render_span_t* span) {
+    s_draw_pixels(span, doom_render_draw_filter_type_rounded, 0);
+}
+
+#if DOOM_SYS_CPU_X86
+
+// As with the column drawers, the dither repeats every 4 pixels, so each lane always sees the same thresholds.
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_draw_sse2(const doom_render_span_t* span, doom_render_draw_filter_type_t filter) {
+    uint32_t y = (uint32_t)span->y & 3;
+    uint32_t u_thresholds[4];
+    uint32_t v_thresholds[4];
+    const uint8_t* colormaps[4];
+    for (uint32_t lane = 0; lane < 4; lane++) {
+        uint32_t x = (uint32_t)(span->x + (int32_t)lane) & 3;
+        u_thresholds[lane] = doom_render_dither[y][x];
+        v_thresholds[lane] = doom_render_dither[x][y];
+        colormaps[lane] =
+            span->z_weight > doom_render_dither[(y + 2) & 3][(x + 2) & 3] ? span->next_colormap : span->colormap;
+    }
+    __m128i u_threshold = _mm_loadu_si128((const __m128i*)u_thresholds);
+    __m128i v_threshold = _mm_loadu_si128((const __m128i*)v_thresholds);
+    __m128i mask = _mm_set1_epi32(flat_mask);
+    __m128i half = _mm_set1_epi32(frac_half);
+    __m128i byte = _mm_set1_epi32(0xFF);
+    uint32_t xstep = span->xstep;
+    uint32_t ystep = span->ystep;
+    __m128i xfrac = _mm_setr_epi32((int)span->xfrac, (int)(span->xfrac + xstep), (int)(span->xfrac + 2 * xstep),
+                                   (int)(span->xfrac + 3 * xstep));
+    __m128i yfrac = _mm_setr_epi32((int)span->yfrac, (int)(span->yfrac + ystep), (int)(span->yfrac + 2 * ystep),
+                                   (int)(span->yfrac + 3 * ystep));
+    __m128i xstep4 = _mm_set1_epi32((int)(4 * xstep));
+    __m128i ystep4 = _mm_set1_epi32((int)(4 * ystep));
+
+    const uint8_t* source = span->source;
+    uint8_t* dest = span->dest;
+    int32_t i = 0;
+    for (; i + 4 <= span->count; i += 4) {
+        __m128i u;
+        __m128i v;
+        switch (filter) {
+            case doom_render_draw_filter_type_linear: {
+                __m128i u_fraction = _mm_and_si128(_mm_srli_epi32(xfrac, doom_render_column_frac_bits - 8), byte);
+                __m128i v_fraction = _mm_and_si128(_mm_srli_epi32(yfrac, doom_render_column_frac_bits - 8), byte);
+                u = _mm_sub_epi32(_mm_srli_epi32(xfrac, doom_render_column_frac_bits),
+                                  _mm_cmpgt_epi32(u_fraction, u_threshold));
+                v = _mm_sub_epi32(_mm_srli_epi32(yfrac, doom_render_column_frac_bits),
+                                  _mm_cmpgt_epi32(v_fraction, v_threshold));
+                break;
+            }
+            case doom_render_draw_filter_type_rounded:
+                u = _mm_srli_epi32(_mm_add_epi32(xfrac, half), doom_render_column_frac_bits);
+                v = _mm_srli_epi32(_mm_add_epi32(yfrac, half), doom_render_column_frac_bits);
+                break;
+            case doom_render_draw_filter_type_none:
+            case doom_render_draw_filter_type_point:
+            default:
+                u = _mm_srli_epi32(xfrac, doom_render_column_frac_bits);
+                v = _mm_srli_epi32(yfrac, doom_render_column_frac_bits);
+                break;
+        }
+        __m128i spot = _mm_or_si128(_mm_slli_epi32(_mm_and_si128(v, mask), flat_shift), _mm_and_si128(u, mask));
+        uint32_t spots[4];
+        _mm_storeu_si128((__m128i*)spots, spot);
+        dest[i] = colormaps[0][source[spots[0]]];
+        dest[i + 1] = colormaps[1][source[spots[1]]];
+        dest[i + 2] = colormaps[2][source[spots[2]]];
+        dest[i + 3] = colormaps[3][source[spots[3]]];
+        xfrac = _mm_add_epi32(xfrac, xstep4);
+        yfrac = _mm_add_epi32(yfrac, ystep4);
+    }
+    s_draw_pixels(span, filter, i);
+}
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_draw_point_sse2(const doom_render_span_t* span) {
+    s_draw_sse2(span, doom_render_draw_filter_type_point);
+}
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_draw_linear_sse2(const doom_render_span_t* span) {
+    s_draw_sse2(span, doom_render_draw_filter_type_linear);
+}
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_draw_rounded_sse2(const doom_render_span_t* span) {
+    s_draw_sse2(span, doom_render_draw_filter_type_rounded);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_draw_avx2(const doom_render_span_t* span, doom_render_draw_filter_type_t filter) {
+    if (span->count < doom_render_span_min_avx2_count) {
+        s_draw_pixels(span, filter, 0);
+        return;
+    }
+
+    // The flat comes padded; both colormaps are copied into one padded buffer, and each lane offsets its index into
+    // the one it uses.
+    uint8_t colormaps[2 * colormap_size + gather_padding];
+    memcpy(colormaps, span->colormap, colormap_size);
+    memcpy(colormaps + colormap_size, span->next_colormap, colormap_size);
+    memset(colormaps + 2 * colormap_size, 0, gather_padding);
+
+    uint32_t y = (uint32_t)span->y & 3;
+    uint32_t u_thresholds[8];
+    uint32_t v_thresholds[8];
+    uint32_t colormap_offsets[8];
+    uint32_t xfracs[8];
+    uint32_t yfracs[8];
+    for (uint32_t lane = 0; lane < 8; lane++) {
+        uint32_t x = (uint32_t)(span->x + (int32_t)lane) & 3;
+        u_thresholds[lane] = doom_render_dither[y][x];
+        v_thresholds[lane] = doom_render_dither[x][y];
+        colormap_offsets[lane] = span->z_weight > doom_render_dither[(y + 2) & 3][(x + 2) & 3] ? colormap_size : 0;
+        xfracs[lane] = span->xfrac + lane * span->xstep;
+        yfracs[lane] = span->yfrac + lane * span->ystep;
+    }
+    __m256i u_threshold = _mm256_loadu_si256((const __m256i*)u_thresholds);
+    __m256i v_threshold = _mm256_loadu_si256((const __m256i*)v_thresholds);
+    __m256i colormap_offset = _mm256_loadu_si256((const __m256i*)colormap_offsets);
+    __m256i xfrac = _mm256_loadu_si256((const __m256i*)xfracs);
+    __m256i yfrac = _mm256_loadu_si256((const __m256i*)yfracs);
+    __m256i xstep8 = _mm256_set1_epi32((int)(8 * span->xstep));
+    __m256i ystep8 = _mm256_set1_epi32((int)(8 * span->ystep));
+    __m256i mask = _mm256_set1_epi32(flat_mask);
+    __m256i half = _mm256_set1_epi32(frac_half);
+    __m256i byte = _mm256_set1_epi32(0xFF);
+    // Moves the low byte of each 32-bit lane into the low 4 bytes of its 128-bit half, then both halves together.
+    __m256i pack = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 4, 8, 12, -1, -1,
+                                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i join = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+
+    uint8_t* dest = span->dest;
+    int32_t i = 0;
+    for (; i + 8 <= span->count; i += 8) {
+        __m256i u;
+        __m256i v;
+        switch (filter) {
+            case doom_render_draw_filter_type_linear: {
+                __m256i u_fraction = _mm256_and_si256(_mm256_srli_epi32(xfrac, doom_render_column_frac_bits - 8), byte);
+                __m256i v_fraction = _mm256_and_si256(_mm256_srli_epi32(yfrac, doom_render_column_frac_bits - 8), byte);
+                u = _mm256_sub_epi32(_mm256_srli_epi32(xfrac, doom_render_column_frac_bits),
+                                     _mm256_cmpgt_epi32(u_fraction, u_threshold));
+                v = _mm256_sub_epi32(_mm256_srli_epi32(yfrac, doom_render_column_frac_bits),
+                                     _mm256_cmpgt_epi32(v_fraction, v_threshold));
+                break;
+            }
+            case doom_render_draw_filter_type_rounded:
+                u = _mm256_srli_epi32(_mm256_add_epi32(xfrac, half), doom_render_column_frac_bits);
+                v = _mm256_srli_epi32(_mm256_add_epi32(yfrac, half), doom_render_column_frac_bits);
+                break;
+            case doom_render_draw_filter_type_none:
+            case doom_render_draw_filter_type_point:
+            default:
+                u = _mm256_srli_epi32(xfrac, doom_render_column_frac_bits);
+                v = _mm256_srli_epi32(yfrac, doom_render_column_frac_bits);
+                break;
+        }
+        __m256i spot =
+            _mm256_or_si256(_mm256_slli_epi32(_mm256_and_si256(v, mask), flat_shift), _mm256_and_si256(u, mask));
+        __m256i pixel = _mm256_and_si256(_mm256_i32gather_epi32((const int*)span->source, spot, 1), byte);
+        __m256i color =
+            _mm256_i32gather_epi32((const int*)colormaps, _mm256_add_epi32(pixel, colormap_offset), 1);
+        color = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(color, pack), join);
+        _mm_storel_epi64((__m128i*)(dest + i), _mm256_castsi256_si128(color));
+        xfrac = _mm256_add_epi32(xfrac, xstep8);
+        yfrac = _mm256_add_epi32(yfrac, ystep8);
+    }
+    s_draw_pixels(span, filter, i);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_draw_point_avx2(const doom_render_span_t* span) {
+    s_draw_avx2(span, doom_render_draw_filter_type_point);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_draw_linear_avx2(const doom_render_span_t* span) {
+    s_draw_avx2(span, doom_render_draw_filter_type_linear);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_draw_rounded_avx2(const doom_render_span_t* span) {
+    s_draw_avx2(span, doom_render_draw_filter_type_rounded);
+}
+
+#endif
@@ -0,0 +1,253 @@
+#include "doom/render/strips.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/render/column.h"
+#include "doom/render/draw.h"
+#include "doom/state.h"
+#include "doom/sys/bench.h"
+#include "doom/sys/clock.h"
+#include "doom/sys/jobs.h"
+
+#include <nonstd/alloc.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <threads.h>
+
+enum
+{
+    bench_width = 3840,
+    bench_height = 2160,
+    bench_texture_height = 128,
+    // Frames rendered before timing, so the strips have settled.
+    bench_warmup_frames = 10,
+    // How many times the expensive part of the synthetic view is drawn over.
+    bench_overdraw = 4,
+};
+
+typedef struct {
+    uint8_t* screen;
+    const uint8_t* texture;
+    const uint8_t* colormap;
+} s_bench_frame_t;
+
+static void s_render(doom_render_strips_t* strips);
+static void s_job(void* userdata);
+static void s_rebalance(doom_render_strips_t* strips);
+static void s_split(doom_render_strips_t* strips);
+static void s_bench_strip(int32_t first_x, int32_t end_x, void* userdata);
+
+void doom_render_strips_init(doom_render_strips_t* strips, int32_t width, size_t strip_count) {
+    *strips = (doom_render_strips_t){0};
+    if (strip_count == 0) {
+        strip_count = 1;
+    }
+    if (width > 0 && strip_count > (size_t)width) {
+        strip_count = (size_t)width;
+    }
+    strips->width = width;
+    strips->strip_count = strip_count;
+    strips->bounds = nonstd_malloc((strip_count + 1) * sizeof(int32_t), nonstd_alloc_tag_render);
+    strips->strip_ns = nonstd_calloc(strip_count, sizeof(uint64_t), nonstd_alloc_tag_render);
+    // Unmeasured columns cost nothing, which splits the first frame evenly.
+    strips->column_cost = nonstd_calloc((size_t)width + 1, sizeof(double), nonstd_alloc_tag_render);
+    s_split(strips);
+    if (mtx_init(&strips->mutex, mtx_plain) != thrd_success || cnd_init(&strips->finished) != thrd_success) {
+        doom_log_error("Could not create the synchronization objects of the render strips");
+    }
+}
+
+void doom_render_strips_destroy(doom_render_strips_t* strips) {
+    cnd_destroy(&strips->finished);
+    mtx_destroy(&strips->mutex);
+    nonstd_free(strips->bounds);
+    nonstd_free(strips->strip_ns);
+    nonstd_free(strips->column_cost);
+    *strips = (doom_render_strips_t){0};
+}
+
+void doom_render_strips_run(doom_render_strips_t* strips, doom_render_strip_func_t func, void* userdata) {
+    strips->func = func;
+    strips->userdata = userdata;
+    strips->state = doom_state;
+    atomic_store(&strips->next, 0);
+
+    size_t jobs = strips->strip_count - 1;
+    if (jobs > doom_sys_jobs_worker_count()) {
+        jobs = doom_sys_jobs_worker_count();
+    }
+    mtx_lock(&strips->mutex);
+    strips->jobs_outstanding = jobs;
+    mtx_unlock(&strips->mutex);
+    for (size_t i = 0; i < jobs; i++) {
+        doom_sys_jobs_submit(s_job, strips);
+    }
+    s_render(strips);
+
+    doom_sys_jobs_wait(&strips->jobs_outstanding, &strips->mutex, &strips->finished);
+    s_rebalance(strips);
+}
+
+void doom_render_strips_bench(void) {
+    uint8_t* screen = nonstd_malloc((size_t)bench_width * bench_height, nonstd_alloc_tag_bench);
+    uint8_t texture[bench_texture_height];
+    uint8_t colormap[256];
+    for (size_t i = 0; i < bench_texture_height; i++) {
+        texture[i] = (uint8_t)(i * 7);
+    }
+    for (size_t i = 0; i < sizeof(colormap); i++) {
+        colormap[i] = (uint8_t)(255 - i);
+    }
+    s_bench_frame_t frame = {.screen = screen, .texture = texture, .colormap = colormap};
+
+    size_t max_threads = doom_sys_jobs_worker_count() + 1;
+    doom_sys_bench_t bench = doom_sys_bench_new("strips");
+    // Series names aren't copied, so they live here until the benchmark is freed.
+    char names[doom_sys_jobs_max_workers + 1][32];
+    double imbalance[doom_sys_jobs_max_workers + 1];
+    for (size_t threads = 1; threads <= max_threads; threads++) {
+        snprintf(names[threads - 1], sizeof(names[threads - 1]), "threads_%zu", threads);
+        size_t series = doom_sys_bench_series(&bench, names[threads - 1]);
+
+        doom_render_strips_t strips;
+        doom_render_strips_init(&strips, bench_width, threads);
+        for (size_t i = 0; i < bench_warmup_frames + doom_render_strips_bench_frames; i++) {
+            uint64_t start = doom_sys_clock_ns();
+            doom_render_strips_run(&strips, s_bench_strip, &frame);
+            if (i >= bench_warmup_frames) {
+                doom_sys_bench_record(&bench, series, doom_sys_clock_ns() - start);
+            }
+        }
+        // How much longer the slowest strip of the last frame took than the average one.
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+        for (size_t i = 0; i < strips.strip_count; i++) {
+            total_ns += strips.strip_ns[i];
+            max_ns = strips.strip_ns[i] > max_ns ? strips.strip_ns[i] : max_ns;
+        }
+        imbalance[threads - 1] = total_ns > 0 ? (double)max_ns * (double)strips.strip_count / (double)total_ns : 1.0;
+        doom_render_strips_destroy(&strips);
+    }
+    bench.iterations = doom_render_strips_bench_frames;
+
+    doom_sys_bench_report(&bench);
+    uint64_t single_ns = doom_sys_bench_summarize(&bench.series.data[0]).median_ns;
+    for (size_t i = 0; i < bench.series.size; i++) {
+        uint64_t median_ns = doom_sys_bench_summarize(&bench.series.data[i]).median_ns;
+        doom_log_printf(doom_log_level_info, "%-12s speedup %5.2fx, slowest strip %5.2fx the mean\n",
+                        bench.series.data[i].name, median_ns > 0 ? (double)single_ns / (double)median_ns : 0.0,
+                        imbalance[i]);
+    }
+    char* json_path = doom_sys_bench_json_path("benchstrips.json");
+    if (doom_sys_bench_write_json(&bench, json_path)) {
+        doom_log_printf(doom_log_level_info, "Wrote %s.\n", json_path);
+    } else {
+        DOOM_LOG(render, warn, "Could not write %s.\n", json_path);
+    }
+    nonstd_free(json_path);
+    doom_sys_bench_free(&bench);
+    nonstd_free(screen);
+}
+
+void s_render(doom_render_strips_t* strips) {
+    for (;;) {
+        size_t strip = atomic_fetch_add_explicit(&strips->next, 1, memory_order_relaxed);
+        if (strip >= strips->strip_count) {
+            return;
+        }
+        uint64_t start = doom_sys_clock_ns();
+        strips->func(strips->bounds[strip], strips->bounds[strip + 1], strips->userdata);
+        strips->strip_ns[strip] = doom_sys_clock_ns() - start;
+    }
+}
+
+void s_job(void* userdata) {
+    doom_render_strips_t* strips = userdata;
+    doom_state_t* previous = doom_state;
+    doom_state = strips->state;
+    s_render(strips);
+    mtx_lock(&strips->mutex);
+    strips->jobs_outstanding--;
+    cnd_broadcast(&strips->finished);
+    mtx_unlock(&strips->mutex);
+    doom_state = previous;
+}
+
+void s_rebalance(doom_render_strips_t* strips) {
+    // Spread each strip's time evenly over its columns, averaged with the earlier frames so a single slow frame (or a
+    // thread that got preempted) doesn't swing the boundaries back and forth.
+    for (size_t strip = 0; strip < strips->strip_count; strip++) {
+        int32_t first = strips->bounds[strip];
+        int32_t end = strips->bounds[strip + 1];
+        double cost = (double)strips->strip_ns[strip] / (double)(end - first);
+        for (int32_t x = first; x < end; x++) {
+            double previous = strips->column_cost[x];
+            strips->column_cost[x] = previous == 0.0 ? cost : (previous + cost) / 2.0;
+        }
+    }
+    s_split(strips);
+}
+
+void s_split(doom_render_strips_t* strips) {
+    size_t count = strips->strip_count;
+    int32_t width = strips->width;
+    double total = 0.0;
+    for (int32_t x = 0; x < width; x++) {
+        total += strips->column_cost[x];
+    }
+
+    strips->bounds[0] = 0;
+    if (total <= 0.0) {
+        for (size_t strip = 1; strip < count; strip++) {
+            strips->bounds[strip] = (int32_t)((int64_t)width * (int64_t)strip / (int64_t)count);
+        }
+    } else {
+        // Each boundary goes where the running cost reaches its share of the total.
+        double running = 0.0;
+        size_t strip = 1;
+        for (int32_t x = 0; x < width && strip < count; x++) {
+            running += strips->column_cost[x];
+            while (strip < count && running >= total * (double)strip / (double)count) {
+                strips->bounds[strip++] = x + 1;
+            }
+        }
+        while (strip < count) {
+            strips->bounds[strip++] = width;
+        }
+    }
+    strips->bounds[count] = width;
+
+    // Every strip keeps at least one column, so its cost can still be measured.
+    for (size_t strip = 1; strip < count; strip++) {
+        int32_t lowest = strips->bounds[strip - 1] + 1;
+        int32_t highest = width - (int32_t)(count - strip);
+        int32_t bound = strips->bounds[strip];
+        strips->bounds[strip] = bound < lowest ? lowest : bound > highest ? highest : bound;
+    }
+}
+
+void s_bench_strip(int32_t first_x, int32_t end_x, void* userdata) {
+    const s_bench_frame_t* frame = userdata;
+    doom_render_column_t column = {
+        .pitch = bench_width,
+        .count = bench_height,
+        .source = frame->texture,
+        .source_height = bench_texture_height,
+        .step = ((uint32_t)bench_texture_height << doom_render_column_frac_bits) / bench_height,
+        .colormap = frame->colormap,
+        .next_colormap = frame->colormap,
+    };
+    for (int32_t x = first_x; x < end_x; x++) {
+        column.dest = frame->screen + x;
+        column.x = x;
+        // The left third of the view is drawn over several times, like a room full of sprites and masked walls, so
+        // equal strips would be badly balanced.
+        int32_t layers = x < bench_width / 3 ? bench_overdraw : 1;
+        for (int32_t layer = 0; layer < layers; layer++) {
+            doom_render_draw_column(&column, doom_render_draw_filter_type_point);
+        }
+    }
+}
@@ -1,22 +1,30 @@
 #include "doom/state.h"
 
+#include "doom/deh/tables.h"
 #include "doom/misc/argv.h"
 #include "doom/misc/defaults.h"
+#include "doom/misc/subscriptions.h"
 #include "doom/sys/system.h"
+#include "doom/video/colormap.h"
+#include "doom/video/tranmap.h"
+#include "doom/wad/cache.h"
+#include "doom/wad/precache.h"
+#include "doom/wad/texture.h"
+#include "doom/wad/wad.h"
 #include "phyto/string/string.h"
 
-#include <nonstd/strdup.h>
+#include <nonstd/alloc.h>
 #include <stddef.h>
-#include <stdlib.h>
 #include <string.h>
 
 doom_state_t* doom_state_new(int argc, char** argv) {
-    doom_state_t* state = calloc(1, sizeof(doom_state_t));
+    doom_state_t* state = nonstd_calloc(1, sizeof(doom_state_t), nonstd_alloc_tag_state);
     state->params = doom_misc_parameters_new();
     doom_misc_parameters_resize(&state->params, argc);
     for (int i = 0; i < argc; i++) {
         doom_misc_parameters_append(&state->params, phyto_string_from_c(argv[i]));
     }
+    state->subscriptions = doom_misc_subscription_list_new();
     return state;
 }
 
@@ -31,12 +39,21 @@ void doom_state_free(doom_state_t** p_state) {
         doom_sys_atexit_list_entry_t* entry = state->exit_funcs[ep];
         while (entry != NULL) {
             doom_sys_atexit_list_entry_t* next = entry->next;
-            free(entry);
+            nonstd_free(entry);
             entry = next;
         }
         state->exit_funcs[ep] = NULL;
     }
+    doom_misc_subscription_list_free(&state->subscriptions);
     doom_misc_default_dyarray_free(&state->defaults);
-    free(state);
+    // The precache workers use everything below, so they are stopped first.
+    doom_wad_precache_destroy(&state->precache);
+    doom_wad_cache_destroy(&state->lump_cache);
+    doom_wad_textures_destroy(&state->textures);
+    doom_wad_destroy(&state->wad);
+    doom_deh_tables_destroy(&state->deh);
+    doom_video_tranmap_destroy(&state->tranmap);
+    doom_video_colormap_destroy(&state->colormaps);
+    nonstd_free(state);
     *p_state = NULL;
 }
@@ -0,0 +1,135 @@
+#include "doom/sys/bench.h"
+
+#include "doom/log/printf.h"
+#include "doom/misc/argv.h"
+
+#include <nonstd/alloc.h>
+#include <nonstd/strdup.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL_TAGGED(doom_sys_bench_samples, uint64_t, nonstd_alloc_tag_bench);
+PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL_TAGGED(doom_sys_bench_series_list, doom_sys_bench_series_t,
+                                            nonstd_alloc_tag_bench);
+
+static int32_t s_compare_samples(uint64_t a, uint64_t b);
+static void s_series_free(doom_sys_bench_series_t* series);
+static uint64_t s_rank(const doom_sys_bench_samples_t* samples, uint32_t percent);
+
+static const doom_sys_bench_samples_callbacks_t sc_samples_callbacks = {
+    .free_cb = NULL,
+    .compare_cb = s_compare_samples,
+    .copy_cb = NULL,
+    .print_cb = NULL,
+};
+
+static const doom_sys_bench_series_list_callbacks_t sc_series_list_callbacks = {
+    .free_cb = s_series_free,
+    .compare_cb = NULL,
+    .copy_cb = NULL,
+    .print_cb = NULL,
+};
+
+doom_sys_bench_t doom_sys_bench_new(const char* name) {
+    return (doom_sys_bench_t){
+        .name = name,
+        .series = doom_sys_bench_series_list_init(&sc_series_list_callbacks),
+    };
+}
+
+void doom_sys_bench_free(doom_sys_bench_t* bench) {
+    doom_sys_bench_series_list_free(&bench->series);
+}
+
+size_t doom_sys_bench_series(doom_sys_bench_t* bench, const char* name) {
+    for (size_t i = 0; i < bench->series.size; i++) {
+        if (strcmp(bench->series.data[i].name, name) == 0) {
+            return i;
+        }
+    }
+    doom_sys_bench_series_list_append(&bench->series,
+                                      (doom_sys_bench_series_t){
+                                          .name = name,
+                                          .samples = doom_sys_bench_samples_init(&sc_samples_callbacks),
+                                      });
+    return bench->series.size - 1;
+}
+
+void doom_sys_bench_record(doom_sys_bench_t* bench, size_t series, uint64_t ns) {
+    doom_sys_bench_samples_append(&bench->series.data[series].samples, ns);
+}
+
+doom_sys_bench_summary_t doom_sys_bench_summarize(doom_sys_bench_series_t* series) {
+    doom_sys_bench_samples_t* samples = &series->samples;
+    if (samples->size == 0) {
+        return (doom_sys_bench_summary_t){0};
+    }
+    doom_sys_bench_samples_sort(samples);
+
+    double sum = 0;
+    for (size_t i = 0; i < samples->size; i++) {
+        sum += (double)samples->data[i];
+    }
+    return (doom_sys_bench_summary_t){
+        .min_ns = samples->data[0],
+        .median_ns = s_rank(samples, 50),
+        .p99_ns = s_rank(samples, 99),
+        .max_ns = samples->data[samples->size - 1],
+        .mean_ns = sum / (double)samples->size,
+    };
+}
+
+void doom_sys_bench_report(doom_sys_bench_t* bench) {
+    doom_log_printf(doom_log_level_info, "Benchmark %s, %zu iterations (microseconds):\n", bench->name,
+                    bench->iterations);
+    doom_log_printf(doom_log_level_info, "%-20s %10s %10s %10s %10s %10s\n", "series", "min", "median", "p99", "max",
+                    "mean");
+    for (size_t i = 0; i < bench->series.size; i++) {
+        doom_sys_bench_summary_t summary = doom_sys_bench_summarize(&bench->series.data[i]);
+        doom_log_printf(doom_log_level_info, "%-20s %10.1f %10.1f %10.1f %10.1f %10.1f\n", bench->series.data[i].name,
+                        (double)summary.min_ns / 1000.0, (double)summary.median_ns / 1000.0,
+                        (double)summary.p99_ns / 1000.0, (double)summary.max_ns / 1000.0, summary.mean_ns / 1000.0);
+    }
+}
+
+bool doom_sys_bench_write_json(doom_sys_bench_t* bench, const char* path) {
+    FILE* fp = fopen(path, "w");
+    if (fp == NULL) {
+        return false;
+    }
+    fprintf(fp, "{\n  \"benchmark\": \"%s\",\n  \"iterations\": %zu,\n  \"series\": [", bench->name,
+            bench->iterations);
+    for (size_t i = 0; i < bench->series.size; i++) {
+        doom_sys_bench_summary_t summary = doom_sys_bench_summarize(&bench->series.data[i]);
+        fprintf(fp,
+                "%s\n    {\"name\": \"%s\", \"min_ns\": %llu, \"median_ns\": %llu, \"p99_ns\": %llu, \"max_ns\": %llu, "
+                "\"mean_ns\": %.1f}",
+                i == 0 ? "" : ",", bench->series.data[i].name, (unsigned long long)summary.min_ns,
+                (unsigned long long)summary.median_ns, (unsigned long long)summary.p99_ns,
+                (unsigned long long)summary.max_ns, summary.mean_ns);
+    }
+    fprintf(fp, "\n  ]\n}\n");
+    return fclose(fp) == 0;
+}
+
+char* doom_sys_bench_json_path(const char* fallback) {
+    char* path = doom_misc_parameter_argument("-benchjson");
+    return path != NULL ? path : nonstd_strdup(fallback);
+}
+
+int32_t s_compare_samples(uint64_t a, uint64_t b) {
+    return (a > b) - (a < b);
+}
+
+void s_series_free(doom_sys_bench_series_t* series) {
+    doom_sys_bench_samples_free(&series->samples);
+}
+
+uint64_t s_rank(const doom_sys_bench_samples_t* samples, uint32_t percent) {
+    // Nearest rank: the smallest sample that at least `percent` percent of the samples don't exceed.
+    size_t rank = (samples->size * percent + 99) / 100;
+    return samples->data[rank == 0 ? 0 : rank - 1];
+}
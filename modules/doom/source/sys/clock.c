@@ -0,0 +1,181 @@
+#include "doom/sys/clock.h"
+
+#include "doom/init.h"
+#include "doom/misc/subscriptions.h"
+#include "doom/state.h"
+
+#include <math.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <errno.h>
+#include <time.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define CPU_RELAX() _mm_pause()
+#else
+#define CPU_RELAX() ((void)0)
+#endif
+
+enum
+{
+    ns_per_second = 1000 * 1000 * 1000,
+};
+
+static uint64_t s_game_ns_at(const doom_sys_clock_state_t* clock, uint64_t now);
+static void s_settings_changed(void* userdata);
+static void s_record_jitter(doom_sys_clock_jitter_t* jitter, int64_t miss_ns);
+
+uint64_t doom_sys_clock_ns(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    LARGE_INTEGER counter;
+    QueryPerformanceCounter(&counter);
+    uint64_t seconds = (uint64_t)counter.QuadPart / (uint64_t)frequency.QuadPart;
+    uint64_t remainder = (uint64_t)counter.QuadPart % (uint64_t)frequency.QuadPart;
+    return seconds * ns_per_second + remainder * ns_per_second / (uint64_t)frequency.QuadPart;
+#else
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t)now.tv_sec * ns_per_second + (uint64_t)now.tv_nsec;
+#endif
+}
+
+void doom_sys_clock_sleep_until(uint64_t deadline_ns) {
+#ifdef _WIN32
+    uint64_t now = doom_sys_clock_ns();
+    if (deadline_ns > now) {
+        Sleep((DWORD)((deadline_ns - now) / (1000 * 1000)));
+    }
+#else
+    // The clock is CLOCK_MONOTONIC, so the deadline can be passed as an absolute time, which doesn't drift when the
+    // thread is preempted between reading the clock and sleeping.
+    struct timespec deadline = {
+        .tv_sec = (time_t)(deadline_ns / ns_per_second),
+        .tv_nsec = (long)(deadline_ns % ns_per_second),
+    };
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &deadline, NULL) == EINTR) {
+    }
+#endif
+}
+
+void doom_sys_clock_init(void) {
+    doom_sys_clock_state_t* clock = &doom_state->clock;
+    clock->base_ns = doom_sys_clock_ns();
+    clock->base_game_ns = 0;
+    clock->next_frame_ns = 0;
+    doom_sys_clock_jitter_reset();
+
+    clock->subscription = DOOM_MISC_SUBSCRIBE(s_settings_changed, clock);
+    doom_misc_subscribe_default(clock->subscription, "realtic_clock_rate");
+    doom_misc_subscribe_default(clock->subscription, "dsda_fps_limit");
+    s_settings_changed(clock);
+}
+
+uint64_t doom_sys_clock_game_ns(void) {
+    return s_game_ns_at(&doom_state->clock, doom_sys_clock_ns());
+}
+
+int32_t doom_sys_clock_tic(void) {
+    return (int32_t)(doom_sys_clock_game_ns() * doom_sys_ticrate / ns_per_second);
+}
+
+uint64_t doom_sys_clock_ns_until_next_tic(void) {
+    const doom_sys_clock_state_t* clock = &doom_state->clock;
+    uint64_t game_ns = doom_sys_clock_game_ns();
+    uint64_t next_tic = game_ns * doom_sys_ticrate / ns_per_second + 1;
+    // Round up, so that the next tic has surely started by then.
+    uint64_t next_tic_game_ns = (next_tic * ns_per_second + doom_sys_ticrate - 1) / doom_sys_ticrate;
+    return ((next_tic_game_ns - game_ns) * 100 + (uint64_t)clock->rate - 1) / (uint64_t)clock->rate;
+}
+
+void doom_sys_clock_frame_wait(void) {
+    // Settings changed during the frame take effect before the next one, including the limit itself.
+    doom_misc_dispatch_subscriptions();
+
+    doom_sys_clock_state_t* clock = &doom_state->clock;
+    if (clock->fps_limit <= 0) {
+        clock->next_frame_ns = 0;
+        return;
+    }
+
+    uint64_t period = ns_per_second / (uint64_t)clock->fps_limit;
+    uint64_t now = doom_sys_clock_ns();
+    if (clock->next_frame_ns == 0 || now > clock->next_frame_ns + period) {
+        // First frame, or far behind: start a new schedule instead of rushing frames out to catch up.
+        clock->next_frame_ns = now + period;
+    }
+
+    uint64_t deadline = clock->next_frame_ns;
+    if (deadline > now + doom_sys_clock_spin_ns) {
+        doom_sys_clock_sleep_until(deadline - doom_sys_clock_spin_ns);
+    }
+    while ((now = doom_sys_clock_ns()) < deadline) {
+        CPU_RELAX();
+    }
+
+    s_record_jitter(&clock->jitter, (int64_t)(now - deadline));
+    clock->next_frame_ns = deadline + period;
+}
+
+double doom_sys_clock_jitter_stddev_ns(const doom_sys_clock_jitter_t* jitter) {
+    if (jitter->frames < 2) {
+        return 0.0;
+    }
+    return sqrt(jitter->m2 / (double)(jitter->frames - 1));
+}
+
+void doom_sys_clock_jitter_reset(void) {
+    doom_state->clock.jitter = (doom_sys_clock_jitter_t){.min_ns = INT64_MAX, .max_ns = INT64_MIN};
+}
+
+uint64_t s_game_ns_at(const doom_sys_clock_state_t* clock, uint64_t now) {
+    return clock->base_game_ns + (now - clock->base_ns) * (uint64_t)clock->rate / 100;
+}
+
+void s_settings_changed(void* userdata) {
+    doom_sys_clock_state_t* clock = userdata;
+
+    int32_t rate = doom_state->defaults_storage.realtic_clock_rate;
+    if (rate < 1) {
+        // A stopped clock would hang the game loop.
+        rate = 1;
+    }
+    if (rate != clock->rate) {
+        uint64_t now = doom_sys_clock_ns();
+        if (clock->rate != 0) {
+            clock->base_game_ns = s_game_ns_at(clock, now);
+        }
+        clock->base_ns = now;
+        clock->rate = rate;
+    }
+
+    if (doom_state->defaults_storage.dsda.fps_limit != clock->fps_limit) {
+        clock->fps_limit = doom_state->defaults_storage.dsda.fps_limit;
+        clock->next_frame_ns = 0;
+        doom_sys_clock_jitter_reset();
+    }
+}
+
+void s_record_jitter(doom_sys_clock_jitter_t* jitter, int64_t miss_ns) {
+    // Welford's online algorithm, which stays accurate over long runs.
+    jitter->frames++;
+    double delta = (double)miss_ns - jitter->mean_ns;
+    jitter->mean_ns += delta / (double)jitter->frames;
+    jitter->m2 += delta * ((double)miss_ns - jitter->mean_ns);
+    if (miss_ns < jitter->min_ns) {
+        jitter->min_ns = miss_ns;
+    }
+    if (miss_ns > jitter->max_ns) {
+        jitter->max_ns = miss_ns;
+    }
+}
@@ -0,0 +1,67 @@
+#include "doom/sys/cpu.h"
+
+#include "doom/init.h"
+#include "doom/misc/argv.h"
+
+#include <stdbool.h>
+#include <threads.h>
+
+#if DOOM_SYS_CPU_X86 && defined(_MSC_VER)
+#include <immintrin.h>
+#include <intrin.h>
+#endif
+
+static void s_detect(void);
+
+static once_flag s_detect_once = ONCE_FLAG_INIT;
+static bool s_supported[doom_sys_cpu_isa_count];
+
+static const char* const sc_isa_names[] = {
+#define X(x) #x,
+    DOOM_SYS_CPU_ISAS_X
+#undef X
+};
+
+bool doom_sys_cpu_supports(doom_sys_cpu_isa_t isa) {
+    call_once(&s_detect_once, s_detect);
+    return isa < doom_sys_cpu_isa_count && s_supported[isa];
+}
+
+doom_sys_cpu_isa_t doom_sys_cpu_best_isa(void) {
+    if (doom_state != NULL && doom_misc_check_parameter("-nosimd") > 0) {
+        return doom_sys_cpu_isa_scalar;
+    }
+    doom_sys_cpu_isa_t best = doom_sys_cpu_isa_scalar;
+    for (doom_sys_cpu_isa_t isa = doom_sys_cpu_isa_scalar; isa < doom_sys_cpu_isa_count; isa++) {
+        if (doom_sys_cpu_supports(isa)) {
+            best = isa;
+        }
+    }
+    return best;
+}
+
+const char* doom_sys_cpu_isa_name(doom_sys_cpu_isa_t isa) {
+    return sc_isa_names[isa];
+}
+
+void s_detect(void) {
+    s_supported[doom_sys_cpu_isa_scalar] = true;
+#if DOOM_SYS_CPU_X86 && defined(__GNUC__)
+    __builtin_cpu_init();
+    s_supported[doom_sys_cpu_isa_sse2] = __builtin_cpu_supports("sse2");
+    // This also checks that the OS saves the YMM registers.
+    s_supported[doom_sys_cpu_isa_avx2] = __builtin_cpu_supports("avx2");
+#elif DOOM_SYS_CPU_X86 && defined(_MSC_VER)
+    int info[4];
+    __cpuid(info, 0);
+    int max_leaf = info[0];
+    __cpuid(info, 1);
+    s_supported[doom_sys_cpu_isa_sse2] = (info[3] & (1 << 26)) != 0;
+    // AVX2 also needs the OS to save the YMM registers, which OSXSAVE and XCR0 tell.
+    bool ymm_saved = (info[2] & (1 << 27)) != 0 && (_xgetbv(0) & 0x6) == 0x6;
+    if (max_leaf >= 7 && ymm_saved) {
+        __cpuidex(info, 7, 0);
+        s_supported[doom_sys_cpu_isa_avx2] = (info[1] & (1 << 5)) != 0;
+    }
+#endif
+}
@@ -0,0 +1,353 @@
+#include "doom/sys/inflate.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+enum
+{
+    max_code_length = 15,
+    max_literal_codes = 288,
+    max_distance_codes = 30,
+    code_length_codes = 19,
+    // Codes up to this long are decoded with one table lookup; longer ones bit by bit.
+    fast_bits = 10,
+    // A fast table entry is `length << symbol_bits | symbol`; a length of 0 means the code is longer than fast_bits.
+    symbol_bits = 9,
+    end_of_block = 256,
+};
+
+typedef struct {
+    // The number of codes of each length.
+    uint16_t counts[max_code_length + 1];
+    // The symbols, ordered by code.
+    uint16_t symbols[max_literal_codes];
+    uint16_t fast[1 << fast_bits];
+} s_huffman_t;
+
+typedef struct {
+    const uint8_t* in;
+    size_t in_size;
+    size_t in_position;
+    uint64_t bits;
+    uint32_t bit_count;
+    // The zero bits added past the end of the input.
+    size_t padding;
+
+    uint8_t* out;
+    size_t out_size;
+    size_t out_position;
+} s_stream_t;
+
+static const uint16_t sc_length_base[] = {3,  4,  5,  6,  7,  8,  9,  10, 11,  13,  15,  17,  19,  23, 27,
+                                          31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258};
+static const uint8_t sc_length_extra[] = {0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2,
+                                          2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0};
+static const uint16_t sc_distance_base[] = {1,    2,    3,    4,    5,    7,     9,     13,    17,  25,
+                                            33,   49,   65,   97,   129,  193,   257,   385,   513, 769,
+                                            1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577};
+static const uint8_t sc_distance_extra[] = {0, 0, 0, 0, 1, 1, 2, 2,  3,  3,  4,  4,  5,  5,  6,
+                                            6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13};
+static const uint8_t sc_code_length_order[code_length_codes] = {16, 17, 18, 0, 8,  7, 9,  6, 10, 5,
+                                                                11, 4,  12, 3, 13, 2, 14, 1, 15};
+
+static void s_refill(s_stream_t* stream);
+static size_t s_consumed(const s_stream_t* stream);
+static bool s_overrun(const s_stream_t* stream);
+static uint32_t s_bits(s_stream_t* stream, uint32_t count);
+static bool s_build(s_huffman_t* huffman, const uint8_t* lengths, size_t count);
+static int32_t s_decode(s_stream_t* stream, const s_huffman_t* huffman);
+static bool s_stored(s_stream_t* stream);
+static bool s_fixed(s_huffman_t* literals, s_huffman_t* distances);
+static bool s_dynamic(s_stream_t* stream, s_huffman_t* literals, s_huffman_t* distances);
+static bool s_codes(s_stream_t* stream, const s_huffman_t* literals, const s_huffman_t* distances);
+
+bool doom_sys_inflate(const uint8_t* in, size_t in_size, uint8_t* out, size_t out_size) {
+    s_stream_t stream = {.in = in, .in_size = in_size, .out = out, .out_size = out_size};
+    s_huffman_t literals_storage;
+    s_huffman_t distances_storage;
+    s_huffman_t* literals = &literals_storage;
+    s_huffman_t* distances = &distances_storage;
+
+    bool last;
+    do {
+        last = s_bits(&stream, 1) != 0;
+        uint32_t type = s_bits(&stream, 2);
+        bool ok;
+        switch (type) {
+            case 0:
+                ok = s_stored(&stream);
+                break;
+            case 1:
+                ok = s_fixed(literals, distances) && s_codes(&stream, literals, distances);
+                break;
+            case 2:
+                ok = s_dynamic(&stream, literals, distances) && s_codes(&stream, literals, distances);
+                break;
+            default:
+                ok = false;
+                break;
+        }
+        if (!ok || s_overrun(&stream)) {
+            return false;
+        }
+    } while (!last);
+
+    return stream.out_position == out_size;
+}
+
+void s_refill(s_stream_t* stream) {
+    while (stream->bit_count <= 56) {
+        if (stream->in_position < stream->in_size) {
+            stream->bits |= (uint64_t)stream->in[stream->in_position++] << stream->bit_count;
+        } else {
+            // Past the end, zeros are shifted in so lookups can peek; consuming them is caught by s_overrun().
+            stream->padding += 8;
+        }
+        stream->bit_count += 8;
+    }
+}
+
+size_t s_consumed(const s_stream_t* stream) {
+    return stream->in_position * 8 + stream->padding - stream->bit_count;
+}
+
+bool s_overrun(const s_stream_t* stream) {
+    return s_consumed(stream) > stream->in_size * 8;
+}
+
+uint32_t s_bits(s_stream_t* stream, uint32_t count) {
+    if (count == 0) {
+        return 0;
+    }
+    if (stream->bit_count < count) {
+        s_refill(stream);
+    }
+    uint32_t value = (uint32_t)(stream->bits & ((UINT64_C(1) << count) - 1));
+    stream->bits >>= count;
+    stream->bit_count -= count;
+    return value;
+}
+
+bool s_build(s_huffman_t* huffman, const uint8_t* lengths, size_t count) {
+    memset(huffman->counts, 0, sizeof(huffman->counts));
+    memset(huffman->fast, 0, sizeof(huffman->fast));
+    for (size_t symbol = 0; symbol < count; symbol++) {
+        huffman->counts[lengths[symbol]]++;
+    }
+    huffman->counts[0] = 0;
+
+    // Reject over-subscribed codes. Incomplete codes are allowed; their missing codes fail to decode.
+    int32_t left = 1;
+    for (uint32_t length = 1; length <= max_code_length; length++) {
+        left = (left << 1) - huffman->counts[length];
+        if (left < 0) {
+            return false;
+        }
+    }
+
+    uint16_t offsets[max_code_length + 2];
+    uint32_t next_code[max_code_length + 1];
+    offsets[1] = 0;
+    uint32_t code = 0;
+    for (uint32_t length = 1; length <= max_code_length; length++) {
+        offsets[length + 1] = (uint16_t)(offsets[length] + huffman->counts[length]);
+        next_code[length] = code;
+        code = (code + huffman->counts[length]) << 1;
+    }
+
+    for (size_t symbol = 0; symbol < count; symbol++) {
+        uint32_t length = lengths[symbol];
+        if (length == 0) {
+            continue;
+        }
+        huffman->symbols[offsets[length]++] = (uint16_t)symbol;
+
+        uint32_t symbol_code = next_code[length]++;
+        if (length > fast_bits) {
+            continue;
+        }
+        // The stream holds codes starting with their most significant bit, so the table is indexed by reversed codes.
+        uint32_t reversed = 0;
+        for (uint32_t i = 0; i < length; i++) {
+            reversed |= ((symbol_code >> i) & 1) << (length - 1 - i);
+        }
+        for (uint32_t i = reversed; i < (1U << fast_bits); i += 1U << length) {
+            huffman->fast[i] = (uint16_t)(length << symbol_bits | symbol);
+        }
+    }
+    return true;
+}
+
+int32_t s_decode(s_stream_t* stream, const s_huffman_t* huffman) {
+    if (stream->bit_count < max_code_length) {
+        s_refill(stream);
+    }
+    uint16_t entry = huffman->fast[stream->bits & ((1U << fast_bits) - 1)];
+    if (entry != 0) {
+        uint32_t length = entry >> symbol_bits;
+        stream->bits >>= length;
+        stream->bit_count -= length;
+        return entry & ((1U << symbol_bits) - 1);
+    }
+
+    // Canonical decoding, one bit at a time: codes of each length are consecutive, starting at `first`.
+    int32_t code = 0;
+    int32_t first = 0;
+    int32_t index = 0;
+    for (uint32_t length = 1; length <= max_code_length; length++) {
+        code |= (int32_t)s_bits(stream, 1);
+        int32_t count = huffman->counts[length];
+        if (code - count < first) {
+            return huffman->symbols[index + (code - first)];
+        }
+        index += count;
+        first = (first + count) << 1;
+        code <<= 1;
+    }
+    return -1;
+}
+
+bool s_stored(s_stream_t* stream) {
+    // Skip to the next byte, then go back to reading whole bytes from the input.
+    s_bits(stream, stream->bit_count % 8);
+    if (s_overrun(stream)) {
+        return false;
+    }
+    stream->in_position = s_consumed(stream) / 8;
+    stream->bits = 0;
+    stream->bit_count = 0;
+    stream->padding = 0;
+
+    if (stream->in_size - stream->in_position < 4) {
+        return false;
+    }
+    const uint8_t* header = stream->in + stream->in_position;
+    uint32_t length = (uint32_t)header[0] | (uint32_t)header[1] << 8;
+    uint32_t complement = (uint32_t)header[2] | (uint32_t)header[3] << 8;
+    stream->in_position += 4;
+    if (length != (~complement & 0xFFFF) || stream->in_size - stream->in_position < length ||
+        stream->out_size - stream->out_position < length) {
+        return false;
+    }
+    memcpy(stream->out + stream->out_position, stream->in + stream->in_position, length);
+    stream->in_position += length;
+    stream->out_position += length;
+    return true;
+}
+
+bool s_fixed(s_huffman_t* literals, s_huffman_t* distances) {
+    uint8_t lengths[max_literal_codes];
+    for (size_t symbol = 0; symbol < max_literal_codes; symbol++) {
+        lengths[symbol] = symbol < 144 ? 8 : symbol < 256 ? 9 : symbol < 280 ? 7 : 8;
+    }
+    if (!s_build(literals, lengths, max_literal_codes)) {
+        return false;
+    }
+    for (size_t symbol = 0; symbol < max_distance_codes; symbol++) {
+        lengths[symbol] = 5;
+    }
+    return s_build(distances, lengths, max_distance_codes);
+}
+
+bool s_dynamic(s_stream_t* stream, s_huffman_t* literals, s_huffman_t* distances) {
+    uint32_t literal_count = s_bits(stream, 5) + 257;
+    uint32_t distance_count = s_bits(stream, 5) + 1;
+    uint32_t code_length_count = s_bits(stream, 4) + 4;
+    if (literal_count > max_literal_codes || distance_count > max_distance_codes) {
+        return false;
+    }
+
+    uint8_t lengths[max_literal_codes + max_distance_codes] = {0};
+    for (uint32_t i = 0; i < code_length_count; i++) {
+        lengths[sc_code_length_order[i]] = (uint8_t)s_bits(stream, 3);
+    }
+    s_huffman_t* code_lengths = literals;
+    if (!s_build(code_lengths, lengths, code_length_codes)) {
+        return false;
+    }
+
+    // The literal and distance code lengths form one sequence, with runs that may cross from one into the other.
+    uint32_t total = literal_count + distance_count;
+    memset(lengths, 0, sizeof(lengths));
+    for (uint32_t i = 0; i < total;) {
+        int32_t symbol = s_decode(stream, code_lengths);
+        if (symbol < 0) {
+            return false;
+        }
+        if (symbol < 16) {
+            lengths[i++] = (uint8_t)symbol;
+            continue;
+        }
+        uint8_t repeated = 0;
+        uint32_t repeat;
+        if (symbol == 16) {
+            if (i == 0) {
+                return false;
+            }
+            repeated = lengths[i - 1];
+            repeat = 3 + s_bits(stream, 2);
+        } else if (symbol == 17) {
+            repeat = 3 + s_bits(stream, 3);
+        } else {
+            repeat = 11 + s_bits(stream, 7);
+        }
+        if (i + repeat > total) {
+            return false;
+        }
+        while (repeat-- > 0) {
+            lengths[i++] = repeated;
+        }
+    }
+    if (lengths[end_of_block] == 0) {
+        return false;
+    }
+
+    return s_build(literals, lengths, literal_count) && s_build(distances, lengths + literal_count, distance_count);
+}
+
+bool s_codes(s_stream_t* stream, const s_huffman_t* literals, const s_huffman_t* distances) {
+    while (true) {
+        int32_t symbol = s_decode(stream, literals);
+        if (symbol < 0 || s_overrun(stream)) {
+            return false;
+        }
+        if (symbol < 256) {
+            if (stream->out_position == stream->out_size) {
+                return false;
+            }
+            stream->out[stream->out_position++] = (uint8_t)symbol;
+            continue;
+        }
+        if (symbol == end_of_block) {
+            return true;
+        }
+
+        symbol -= 257;
+        if (symbol >= (int32_t)(sizeof(sc_length_base) / sizeof(sc_length_base[0]))) {
+            return false;
+        }
+        size_t length = sc_length_base[symbol] + s_bits(stream, sc_length_extra[symbol]);
+        int32_t distance_symbol = s_decode(stream, distances);
+        if (distance_symbol < 0 || distance_symbol >= max_distance_codes) {
+            return false;
+        }
+        size_t distance = sc_distance_base[distance_symbol] + s_bits(stream, sc_distance_extra[distance_symbol]);
+        if (distance > stream->out_position || stream->out_size - stream->out_position < length) {
+            return false;
+        }
+
+        uint8_t* destination = stream->out + stream->out_position;
+        const uint8_t* source = destination - distance;
+        if (distance >= length) {
+            memcpy(destination, source, length);
+        } else {
+            // The copy overlaps what it writes, repeating the last `distance` bytes.
+            for (size_t i = 0; i < length; i++) {
+                destination[i] = source[i];
+            }
+        }
+        stream->out_position += length;
+    }
+}
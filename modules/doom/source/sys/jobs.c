@@ -0,0 +1,451 @@
+#include "doom/sys/jobs.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/misc/argv.h"
+#include "doom/state.h"
+#include "doom/sys/clock.h"
+#include "doom/sys/system.h"
+
+#include <nonstd/alloc.h>
+#include <setjmp.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <unistd.h>
+#endif
+
+typedef struct {
+    doom_sys_job_func_t func;
+    void* userdata;
+} s_job_t;
+
+static atomic_bool s_running;
+static thrd_t s_workers[doom_sys_jobs_max_workers];
+static size_t s_worker_count;
+static mtx_t s_mutex;
+static cnd_t s_wake;
+static bool s_stopping;
+static s_job_t s_queue[doom_sys_jobs_queue_capacity];
+static size_t s_queue_head;
+static size_t s_queue_count;
+// 1 and up on the workers, 0 everywhere else.
+static _Thread_local uint32_t s_worker_index;
+// The graph whose task this thread is running, if any, and where a fatal error in the task jumps to.
+static _Thread_local doom_sys_task_graph_t* s_task_graph;
+static _Thread_local jmp_buf* s_task_jump;
+
+static int s_worker_main(void* arg);
+static size_t s_cpu_count(void);
+static s_job_t s_pop(void);
+static bool s_run_queued(void);
+static bool s_run_one(doom_sys_task_graph_t* graph);
+static bool s_run_task(doom_sys_task_t* task);
+static void s_graph_job(void* userdata);
+static void s_submit_graph_jobs(doom_sys_task_graph_t* graph, size_t count);
+static void s_wait(doom_sys_task_graph_t* graph, uint64_t tasks);
+
+bool doom_sys_jobs_start(size_t workers) {
+    if (atomic_load(&s_running)) {
+        return true;
+    }
+    if (workers > doom_sys_jobs_max_workers) {
+        workers = doom_sys_jobs_max_workers;
+    }
+
+    if (mtx_init(&s_mutex, mtx_plain) != thrd_success) {
+        return false;
+    }
+    if (cnd_init(&s_wake) != thrd_success) {
+        mtx_destroy(&s_mutex);
+        return false;
+    }
+    s_stopping = false;
+    s_queue_head = 0;
+    s_queue_count = 0;
+    s_worker_count = 0;
+    for (size_t i = 0; i < workers; i++) {
+        if (thrd_create(&s_workers[i], s_worker_main, (void*)(uintptr_t)(i + 1)) != thrd_success) {
+            break;
+        }
+        s_worker_count++;
+    }
+    atomic_store(&s_running, true);
+    return s_worker_count == workers;
+}
+
+void doom_sys_jobs_stop(void) {
+    if (!atomic_load(&s_running)) {
+        return;
+    }
+    // Jobs submitted from here on run on the submitting thread; the workers drain what is already queued.
+    atomic_store(&s_running, false);
+    mtx_lock(&s_mutex);
+    s_stopping = true;
+    cnd_broadcast(&s_wake);
+    mtx_unlock(&s_mutex);
+    for (size_t i = 0; i < s_worker_count; i++) {
+        thrd_join(s_workers[i], NULL);
+    }
+    s_worker_count = 0;
+
+    cnd_destroy(&s_wake);
+    mtx_destroy(&s_mutex);
+}
+
+size_t doom_sys_jobs_worker_count(void) {
+    return atomic_load(&s_running) ? s_worker_count : 0;
+}
+
+size_t doom_sys_jobs_default_worker_count(void) {
+    char* workers_argument = doom_misc_parameter_argument("-workers");
+    if (workers_argument != NULL) {
+        long workers = strtol(workers_argument, NULL, 10);
+        nonstd_free(workers_argument);
+        return workers > 0 ? (size_t)workers : 0;
+    }
+    // The main thread takes part too, by running tasks while it waits.
+    size_t cpus = s_cpu_count();
+    return cpus > 1 ? cpus - 1 : 0;
+}
+
+void doom_sys_jobs_submit(doom_sys_job_func_t func, void* userdata) {
+    if (doom_sys_jobs_worker_count() > 0) {
+        mtx_lock(&s_mutex);
+        if (s_queue_count < doom_sys_jobs_queue_capacity) {
+            s_queue[(s_queue_head + s_queue_count) % doom_sys_jobs_queue_capacity] = (s_job_t){func, userdata};
+            s_queue_count++;
+            cnd_signal(&s_wake);
+            mtx_unlock(&s_mutex);
+            return;
+        }
+        mtx_unlock(&s_mutex);
+    }
+    func(userdata);
+}
+
+void doom_sys_jobs_wait(const size_t* outstanding, mtx_t* mutex, cnd_t* finished) {
+    mtx_lock(mutex);
+    while (*outstanding > 0) {
+        mtx_unlock(mutex);
+        bool ran = s_run_queued();
+        mtx_lock(mutex);
+        if (!ran) {
+            // Nothing is queued, so the remaining jobs are running on other threads already.
+            while (*outstanding > 0) {
+                cnd_wait(finished, mutex);
+            }
+        }
+    }
+    mtx_unlock(mutex);
+}
+
+void doom_sys_task_graph_init(doom_sys_task_graph_t* graph) {
+    *graph = (doom_sys_task_graph_t){.state = doom_state};
+    if (mtx_init(&graph->mutex, mtx_plain) != thrd_success || cnd_init(&graph->changed) != thrd_success) {
+        doom_log_error("Could not create the synchronization objects of a task graph");
+    }
+}
+
+void doom_sys_task_graph_free(doom_sys_task_graph_t* graph) {
+    // A worker may still be about to find out that a waiting thread ran its task already.
+    doom_sys_jobs_wait(&graph->jobs_outstanding, &graph->mutex, &graph->changed);
+
+    cnd_destroy(&graph->changed);
+    mtx_destroy(&graph->mutex);
+}
+
+size_t doom_sys_task_graph_add(doom_sys_task_graph_t* graph, const char* name, doom_sys_job_func_t func,
+                               void* userdata, uint64_t dependencies) {
+    size_t index = graph->task_count;
+    if (index == doom_sys_task_graph_max_tasks) {
+        doom_log_error("Too many tasks in a task graph, at %s", name);
+    }
+    if ((dependencies >> index) != 0) {
+        doom_log_error("Task %s depends on a task that was added after it", name);
+    }
+
+    graph->tasks[index] = (doom_sys_task_t){
+        .name = name,
+        .func = func,
+        .userdata = userdata,
+        .dependencies = dependencies,
+    };
+    graph->task_count++;
+    return index;
+}
+
+void doom_sys_task_graph_run(doom_sys_task_graph_t* graph) {
+    graph->start_ns = doom_sys_clock_ns();
+
+    size_t ready = 0;
+    mtx_lock(&graph->mutex);
+    for (size_t i = 0; i < graph->task_count; i++) {
+        doom_sys_task_t* task = &graph->tasks[i];
+        task->remaining = (uint32_t)__builtin_popcountll(task->dependencies);
+        if (task->remaining == 0) {
+            graph->ready[graph->ready_tail++ % doom_sys_task_graph_max_tasks] = i;
+            ready++;
+        }
+    }
+    mtx_unlock(&graph->mutex);
+
+    s_submit_graph_jobs(graph, ready);
+}
+
+void doom_sys_task_graph_wait(doom_sys_task_graph_t* graph, size_t task) {
+    s_wait(graph, UINT64_C(1) << task);
+}
+
+void doom_sys_task_graph_wait_all(doom_sys_task_graph_t* graph) {
+    if (graph->task_count == 0) {
+        return;
+    }
+    s_wait(graph, UINT64_MAX >> (64 - graph->task_count));
+}
+
+void doom_sys_task_graph_fail_task(int32_t exit_code) {
+    doom_sys_task_graph_t* graph = s_task_graph;
+    if (graph == NULL) {
+        return;
+    }
+    mtx_lock(&graph->mutex);
+    if (!graph->failed) {
+        graph->failed = true;
+        graph->exit_code = exit_code;
+    }
+    cnd_broadcast(&graph->changed);
+    mtx_unlock(&graph->mutex);
+    longjmp(*s_task_jump, 1);
+}
+
+void doom_sys_task_graph_report(const doom_sys_task_graph_t* graph) {
+    if (!DOOM_LOG_LEVEL_COMPILED(debug) || !doom_log_enabled(doom_log_channel_system, doom_log_level_debug)) {
+        return;
+    }
+
+    // The longest chain of dependencies ending at each task, by the time the tasks took.
+    uint64_t chain_ns[doom_sys_task_graph_max_tasks];
+    size_t chain_previous[doom_sys_task_graph_max_tasks];
+    size_t last = 0;
+    uint64_t end_ns = graph->start_ns;
+    for (size_t i = 0; i < graph->task_count; i++) {
+        const doom_sys_task_t* task = &graph->tasks[i];
+        chain_ns[i] = 0;
+        chain_previous[i] = SIZE_MAX;
+        for (size_t dependency = 0; dependency < i; dependency++) {
+            if ((task->dependencies & (UINT64_C(1) << dependency)) != 0 && chain_ns[dependency] > chain_ns[i]) {
+                chain_ns[i] = chain_ns[dependency];
+                chain_previous[i] = dependency;
+            }
+        }
+        chain_ns[i] += task->end_ns - task->start_ns;
+        if (chain_ns[i] > chain_ns[last]) {
+            last = i;
+        }
+        if (task->end_ns > end_ns) {
+            end_ns = task->end_ns;
+        }
+    }
+
+    DOOM_LOG(system, debug, "Task timeline (%zu tasks, %.3f ms):\n", graph->task_count,
+             (double)(end_ns - graph->start_ns) / 1e6);
+    for (size_t i = 0; i < graph->task_count; i++) {
+        const doom_sys_task_t* task = &graph->tasks[i];
+        char thread_name[16];
+        if (task->worker == 0) {
+            snprintf(thread_name, sizeof(thread_name), "caller");
+        } else {
+            snprintf(thread_name, sizeof(thread_name), "worker %u", task->worker);
+        }
+        DOOM_LOG(system, debug, "  %-20s %-10s %9.3f -> %9.3f ms (%.3f ms)\n", task->name, thread_name,
+                 (double)(task->start_ns - graph->start_ns) / 1e6, (double)(task->end_ns - graph->start_ns) / 1e6,
+                 (double)(task->end_ns - task->start_ns) / 1e6);
+    }
+
+    if (graph->task_count == 0) {
+        return;
+    }
+    size_t path[doom_sys_task_graph_max_tasks];
+    size_t path_length = 0;
+    for (size_t i = last; i != SIZE_MAX; i = chain_previous[i]) {
+        path[path_length++] = i;
+    }
+    char path_text[doom_log_max_message_length];
+    size_t path_text_length = 0;
+    for (size_t i = path_length; i-- > 0;) {
+        int written = snprintf(path_text + path_text_length, sizeof(path_text) - path_text_length, "%s%s",
+                               graph->tasks[path[i]].name, i > 0 ? " -> " : "");
+        if (written < 0 || (size_t)written >= sizeof(path_text) - path_text_length) {
+            break;
+        }
+        path_text_length += (size_t)written;
+    }
+    DOOM_LOG(system, debug, "Critical path (%.3f ms): %s\n", (double)chain_ns[last] / 1e6, path_text);
+}
+
+int s_worker_main(void* arg) {
+    s_worker_index = (uint32_t)(uintptr_t)arg;
+
+    mtx_lock(&s_mutex);
+    while (true) {
+        while (s_queue_count == 0 && !s_stopping) {
+            cnd_wait(&s_wake, &s_mutex);
+        }
+        if (s_queue_count == 0) {
+            break;
+        }
+        s_job_t job = s_pop();
+        mtx_unlock(&s_mutex);
+        job.func(job.userdata);
+        mtx_lock(&s_mutex);
+    }
+    mtx_unlock(&s_mutex);
+    return 0;
+}
+
+size_t s_cpu_count(void) {
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors;
+#else
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    return cpus > 0 ? (size_t)cpus : 1;
+#endif
+}
+
+s_job_t s_pop(void) {
+    s_job_t job = s_queue[s_queue_head];
+    s_queue_head = (s_queue_head + 1) % doom_sys_jobs_queue_capacity;
+    s_queue_count--;
+    return job;
+}
+
+bool s_run_queued(void) {
+    if (doom_sys_jobs_worker_count() == 0) {
+        return false;
+    }
+    mtx_lock(&s_mutex);
+    if (s_queue_count == 0) {
+        mtx_unlock(&s_mutex);
+        return false;
+    }
+    s_job_t job = s_pop();
+    mtx_unlock(&s_mutex);
+    job.func(job.userdata);
+    return true;
+}
+
+bool s_run_one(doom_sys_task_graph_t* graph) {
+    mtx_lock(&graph->mutex);
+    if (graph->failed || graph->ready_head == graph->ready_tail) {
+        mtx_unlock(&graph->mutex);
+        return false;
+    }
+    size_t index = graph->ready[graph->ready_head++ % doom_sys_task_graph_max_tasks];
+    mtx_unlock(&graph->mutex);
+
+    doom_sys_task_t* task = &graph->tasks[index];
+    doom_state_t* previous = doom_state;
+    doom_state = graph->state;
+    task->worker = s_worker_index;
+    task->start_ns = doom_sys_clock_ns();
+    doom_sys_task_graph_t* previous_graph = s_task_graph;
+    s_task_graph = graph;
+    bool finished = s_run_task(task);
+    s_task_graph = previous_graph;
+    task->end_ns = doom_sys_clock_ns();
+    doom_state = previous;
+    if (!finished) {
+        // Its dependents never become ready; the waiting thread sees that the graph failed.
+        return true;
+    }
+
+    size_t ready = 0;
+    mtx_lock(&graph->mutex);
+    graph->done |= UINT64_C(1) << index;
+    for (size_t i = index + 1; i < graph->task_count; i++) {
+        doom_sys_task_t* dependent = &graph->tasks[i];
+        if ((dependent->dependencies & (UINT64_C(1) << index)) != 0 && --dependent->remaining == 0) {
+            graph->ready[graph->ready_tail++ % doom_sys_task_graph_max_tasks] = i;
+            ready++;
+        }
+    }
+    cnd_broadcast(&graph->changed);
+    mtx_unlock(&graph->mutex);
+
+    s_submit_graph_jobs(graph, ready);
+    return true;
+}
+
+bool s_run_task(doom_sys_task_t* task) {
+    jmp_buf jump;
+    jmp_buf* previous = s_task_jump;
+    s_task_jump = &jump;
+    if (setjmp(jump) != 0) {
+        s_task_jump = previous;
+        return false;
+    }
+    task->func(task->userdata);
+    s_task_jump = previous;
+    return true;
+}
+
+void s_graph_job(void* userdata) {
+    doom_sys_task_graph_t* graph = userdata;
+    s_run_one(graph);
+
+    mtx_lock(&graph->mutex);
+    graph->jobs_outstanding--;
+    cnd_broadcast(&graph->changed);
+    mtx_unlock(&graph->mutex);
+}
+
+void s_submit_graph_jobs(doom_sys_task_graph_t* graph, size_t count) {
+    // Without workers, the waiting threads run everything themselves.
+    if (count == 0 || doom_sys_jobs_worker_count() == 0) {
+        return;
+    }
+    mtx_lock(&graph->mutex);
+    graph->jobs_outstanding += count;
+    mtx_unlock(&graph->mutex);
+    // Each job runs whichever task is ready first, which need not be the one that made it submit the job.
+    for (size_t i = 0; i < count; i++) {
+        doom_sys_jobs_submit(s_graph_job, graph);
+    }
+}
+
+void s_wait(doom_sys_task_graph_t* graph, uint64_t tasks) {
+    mtx_lock(&graph->mutex);
+    while ((graph->done & tasks) != tasks) {
+        if (graph->failed) {
+            // The error was logged by the task. Exit here, once no job can touch the graph or the instance any more.
+            mtx_unlock(&graph->mutex);
+            doom_sys_jobs_wait(&graph->jobs_outstanding, &graph->mutex, &graph->changed);
+            doom_sys_safe_exit(graph->exit_code);
+        }
+        if (graph->ready_head != graph->ready_tail) {
+            mtx_unlock(&graph->mutex);
+            s_run_one(graph);
+            mtx_lock(&graph->mutex);
+            continue;
+        }
+        // Nothing of the graph to run, so help with the queue, which may hold the jobs of a running task.
+        mtx_unlock(&graph->mutex);
+        bool ran = s_run_queued();
+        mtx_lock(&graph->mutex);
+        if (!ran && (graph->done & tasks) != tasks && !graph->failed && graph->ready_head == graph->ready_tail) {
+            cnd_wait(&graph->changed, &graph->mutex);
+        }
+    }
+    mtx_unlock(&graph->mutex);
+}
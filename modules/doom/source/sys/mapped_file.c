@@ -0,0 +1,156 @@
+#include "doom/sys/mapped_file.h"
+
+#include <nonstd/alloc.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool s_map(doom_sys_mapped_file_t* mapped, const char* path, size_t size, bool create);
+static char* s_temporary_path(const char* path);
+
+bool doom_sys_map_file(doom_sys_mapped_file_t* mapped, const char* path) {
+    return s_map(mapped, path, 0, false);
+}
+
+bool doom_sys_map_file_create(doom_sys_mapped_file_t* mapped, const char* path, size_t size) {
+    if (size == 0) {
+        return false;
+    }
+    return s_map(mapped, path, size, true);
+}
+
+bool doom_sys_map_file_replace(doom_sys_mapped_file_t* mapped, const char* path, size_t size) {
+    char* temporary = s_temporary_path(path);
+    bool created = doom_sys_map_file_create(mapped, temporary, size);
+    nonstd_free(temporary);
+    return created;
+}
+
+bool doom_sys_map_file_replace_commit(doom_sys_mapped_file_t* mapped, const char* path) {
+    doom_sys_unmap_file(mapped);
+    char* temporary = s_temporary_path(path);
+    // Some systems won't rename over an existing file.
+    bool replaced = rename(temporary, path) == 0 || (remove(path) == 0 && rename(temporary, path) == 0);
+    if (!replaced) {
+        remove(temporary);
+    }
+    nonstd_free(temporary);
+    return replaced;
+}
+
+char* s_temporary_path(const char* path) {
+    size_t size = strlen(path) + sizeof(".tmp");
+    char* temporary = nonstd_malloc(size, nonstd_alloc_tag_general);
+    snprintf(temporary, size, "%s.tmp", path);
+    return temporary;
+}
+
+#ifdef _WIN32
+
+void doom_sys_unmap_file(doom_sys_mapped_file_t* mapped) {
+    if (mapped->data == NULL) {
+        return;
+    }
+    UnmapViewOfFile(mapped->data);
+    CloseHandle(mapped->mapping_handle);
+    CloseHandle(mapped->file_handle);
+    *mapped = (doom_sys_mapped_file_t){0};
+}
+
+bool s_map(doom_sys_mapped_file_t* mapped, const char* path, size_t size, bool create) {
+    *mapped = (doom_sys_mapped_file_t){0};
+
+    HANDLE file = CreateFileA(path, create ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ, FILE_SHARE_READ, NULL,
+                              create ? CREATE_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    if (!create) {
+        LARGE_INTEGER file_size;
+        if (!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+            CloseHandle(file);
+            return false;
+        }
+        size = (size_t)file_size.QuadPart;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, NULL, create ? PAGE_READWRITE : PAGE_READONLY,
+                                        (DWORD)((uint64_t)size >> 32), (DWORD)size, NULL);
+    if (mapping == NULL) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* data = MapViewOfFile(mapping, create ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+    if (data == NULL) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    mapped->data = data;
+    mapped->size = size;
+    mapped->writable = create;
+    mapped->file_handle = file;
+    mapped->mapping_handle = mapping;
+    return true;
+}
+
+#else
+
+void doom_sys_unmap_file(doom_sys_mapped_file_t* mapped) {
+    if (mapped->data == NULL) {
+        return;
+    }
+    munmap(mapped->data, mapped->size);
+    *mapped = (doom_sys_mapped_file_t){0};
+}
+
+bool s_map(doom_sys_mapped_file_t* mapped, const char* path, size_t size, bool create) {
+    *mapped = (doom_sys_mapped_file_t){0};
+
+    int fd = create ? open(path, O_RDWR | O_CREAT | O_TRUNC, 0644) : open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (create) {
+        if (ftruncate(fd, (off_t)size) != 0) {
+            close(fd);
+            return false;
+        }
+    } else {
+        struct stat st;
+        if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+            close(fd);
+            return false;
+        }
+        size = (size_t)st.st_size;
+    }
+
+    void* data = mmap(NULL, size, create ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    // The mapping keeps the file alive.
+    close(fd);
+    if (data == MAP_FAILED) {
+        return false;
+    }
+
+    mapped->data = data;
+    mapped->size = size;
+    mapped->writable = create;
+    return true;
+}
+
+#endif
@@ -0,0 +1,193 @@
+#ifdef __linux__
+// For sched_setaffinity() and friends.
+#define _GNU_SOURCE
+#endif
+
+#include "doom/sys/priority.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/state.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __linux__
+#include <errno.h>
+#include <malloc.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+// GCC says so directly; Clang only through __has_feature. The shadow memory of the thread and memory sanitizers can't
+// be locked either.
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+#define SANITIZED_BUILD 1
+#elif defined(__has_feature)
+#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer) || __has_feature(memory_sanitizer)
+#define SANITIZED_BUILD 1
+#endif
+#endif
+
+static const char* const sc_role_names[] = {
+#define X(x) #x,
+    DOOM_SYS_THREAD_ROLES_X
+#undef X
+};
+
+#ifdef __linux__
+// The nice value asked for at each level.
+static const int32_t sc_nice_levels[] = {0, -5, -10};
+// The SCHED_FIFO priority of each role at level 2. Audio comes first, since an underrun is heard.
+static const int32_t sc_fifo_priorities[] = {1, 1, 2};
+
+static void s_choose_cpus(doom_sys_priority_state_t* priority);
+static void s_lock_memory(doom_sys_priority_state_t* priority);
+#endif
+
+void doom_sys_priority_apply(void) {
+    doom_sys_priority_state_t* priority = &doom_state->priority;
+    priority->level = doom_state->defaults_storage.process_priority;
+    for (int32_t role = 0; role < doom_sys_thread_role_count; role++) {
+        priority->cpus[role] = -1;
+        priority->realtime[role] = false;
+    }
+
+    if (priority->level <= 0) {
+        return;
+    }
+
+#ifdef __linux__
+    errno = 0;
+    int32_t current = getpriority(PRIO_PROCESS, 0);
+    if (errno != 0) {
+        current = 0;
+    }
+    int32_t wanted = sc_nice_levels[priority->level];
+    if (wanted < current && setpriority(PRIO_PROCESS, 0, wanted) == 0) {
+        priority->nice = wanted;
+        DOOM_LOG(system, info, "process_priority: nice %d.\n", wanted);
+    } else {
+        priority->nice = current;
+        if (wanted < current) {
+            DOOM_LOG(system, info, "process_priority: nice %d refused (%s); staying at %d.\n", wanted,
+                     strerror(errno), current);
+        }
+    }
+
+    s_choose_cpus(priority);
+
+    if (priority->level >= 2) {
+        s_lock_memory(priority);
+    }
+
+    doom_sys_priority_enter_thread(doom_sys_thread_role_main);
+#else
+    DOOM_LOG(system, info, "process_priority is only supported on Linux; ignoring it.\n");
+#endif
+}
+
+void doom_sys_priority_enter_thread(doom_sys_thread_role_t role) {
+    doom_sys_priority_state_t* priority = &doom_state->priority;
+    if (priority->level <= 0) {
+        return;
+    }
+
+#ifdef __linux__
+    int32_t cpu = priority->cpus[role];
+    if (cpu >= 0) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        int result = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (result == 0) {
+            DOOM_LOG(system, info, "process_priority: %s thread pinned to CPU %d.\n", sc_role_names[role], cpu);
+        } else {
+            DOOM_LOG(system, info, "process_priority: could not pin the %s thread (%s).\n", sc_role_names[role],
+                     strerror(result));
+        }
+    }
+
+    if (priority->level >= 2) {
+        struct sched_param param = {.sched_priority = sc_fifo_priorities[role]};
+        int result = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        priority->realtime[role] = result == 0;
+        if (result == 0) {
+            DOOM_LOG(system, info, "process_priority: %s thread runs SCHED_FIFO at priority %d.\n",
+                     sc_role_names[role], param.sched_priority);
+        } else {
+            DOOM_LOG(system, info, "process_priority: SCHED_FIFO refused for the %s thread (%s).\n",
+                     sc_role_names[role], strerror(result));
+        }
+    }
+#else
+    (void)role;
+#endif
+}
+
+#ifdef __linux__
+
+void s_choose_cpus(doom_sys_priority_state_t* priority) {
+    cpu_set_t allowed;
+    if (sched_getaffinity(0, sizeof(allowed), &allowed) != 0) {
+        DOOM_LOG(system, info, "process_priority: could not read the CPU affinity (%s).\n", strerror(errno));
+        return;
+    }
+    int32_t count = CPU_COUNT(&allowed);
+    if (count < 2) {
+        // Pinning everything to the one CPU would gain nothing.
+        DOOM_LOG(system, info, "process_priority: only one CPU is available; threads are not pinned.\n");
+        return;
+    }
+
+    // Give each role its own CPU, from the last allowed ones, since CPU 0 tends to take most interrupts. With fewer
+    // CPUs than roles, they wrap around.
+    int32_t cpus[CPU_SETSIZE];
+    int32_t found = 0;
+    for (int32_t cpu = CPU_SETSIZE - 1; cpu >= 0 && found < count; cpu--) {
+        if (CPU_ISSET(cpu, &allowed)) {
+            cpus[found++] = cpu;
+        }
+    }
+    for (int32_t role = 0; role < doom_sys_thread_role_count; role++) {
+        priority->cpus[role] = cpus[role % found];
+    }
+}
+
+void s_lock_memory(doom_sys_priority_state_t* priority) {
+#ifdef SANITIZED_BUILD
+    // The sanitizer shadow reserves terabytes of address space, which can't be locked.
+    (void)priority;
+    DOOM_LOG(system, info, "process_priority: memory locking is disabled in sanitized builds.\n");
+#else
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        DOOM_LOG(system, info, "process_priority: mlockall refused (%s).\n", strerror(errno));
+        return;
+    }
+    priority->memory_locked = true;
+
+    // Keep allocations on the heap and never give freed memory back, so that after prefaulting, allocating doesn't
+    // fault in new pages.
+    mallopt(M_MMAP_MAX, 0);
+    mallopt(M_TRIM_THRESHOLD, -1);
+
+    char* block = malloc(doom_sys_priority_prefault_bytes);
+    if (block != NULL) {
+        long page_size = sysconf(_SC_PAGESIZE);
+        for (size_t i = 0; i < doom_sys_priority_prefault_bytes; i += (size_t)page_size) {
+            ((volatile char*)block)[i] = 0;
+        }
+        free(block);
+    }
+    DOOM_LOG(system, info, "process_priority: memory locked, %d MiB of heap prefaulted.\n",
+             doom_sys_priority_prefault_bytes / (1024 * 1024));
+#endif
+}
+
+#endif
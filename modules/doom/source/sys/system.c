@@ -2,19 +2,41 @@
 
 #include "doom/init.h"
 #include "doom/log/printf.h"
+#include "doom/misc/argv.h"
+#include "doom/sys/jobs.h"
 
 #include <config.h>
+#include <nonstd/alloc.h>
+#include <nonstd/strdup.h>
+#include <setjmp.h>
+#include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+static char* s_cache_directory(void);
+static char* s_join_path(const char* directory, const char* name);
+static bool s_make_directories(char* path);
 
 void doom_sys_atexit(doom_sys_atexit_func_t func, bool run_if_error, const char* name,
                      doom_sys_exit_priority_t priority) {
-    doom_sys_atexit_list_entry_t* entry = malloc(sizeof(doom_sys_atexit_list_entry_t));
+    doom_sys_atexit_ex(func, run_if_error, name, priority, doom_state->exit_funcs);
+}
+
+void doom_sys_atexit_ex(doom_sys_atexit_func_t func, bool run_if_error, const char* name,
+                        doom_sys_exit_priority_t priority, doom_sys_atexit_list_entry_t* exit_funcs[]) {
+    doom_sys_atexit_list_entry_t* entry = nonstd_malloc(sizeof(doom_sys_atexit_list_entry_t), nonstd_alloc_tag_atexit);
     entry->func = func;
     entry->run_if_error = run_if_error;
     entry->name = name;
-    entry->next = doom_state->exit_funcs[priority];
-    doom_state->exit_funcs[priority] = entry;
+    entry->next = exit_funcs[priority];
+    exit_funcs[priority] = entry;
 }
 
 const char* doom_sys_get_version_string(char* buffer, size_t buffer_len) {
@@ -22,19 +44,127 @@ const char* doom_sys_get_version_string(char* buffer, size_t buffer_len) {
     return buffer;
 }
 
-void doom_sys_safe_exit(int32_t exit_code) {
+char* doom_sys_cache_path(const char* name) {
+    char* directory = s_cache_directory();
+    if (directory == NULL || !s_make_directories(directory)) {
+        if (directory != NULL) {
+            DOOM_LOG(system, warn, "Could not create the cache directory %s; caching in the working directory.\n",
+                     directory);
+        }
+        nonstd_free(directory);
+        return nonstd_strdup(name);
+    }
+    char* path = s_join_path(directory, name);
+    nonstd_free(directory);
+    return path;
+}
+
+void doom_sys_print_memstats(void) {
+    nonstd_alloc_stats_t total = {0};
+    doom_log_printf(doom_log_level_info, "%-12s %12s %12s %10s %10s %10s\n", "tag", "live", "peak", "allocs",
+                    "reallocs", "frees");
+    for (nonstd_alloc_tag_t tag = 0; tag < nonstd_alloc_tag_count; tag++) {
+        nonstd_alloc_stats_t stats;
+        nonstd_alloc_get_stats(tag, &stats);
+        if (stats.allocations == 0) {
+            continue;
+        }
+        doom_log_printf(doom_log_level_info, "%-12s %12zu %12zu %10zu %10zu %10zu\n", nonstd_alloc_tag_name(tag),
+                        stats.live_bytes, stats.peak_bytes, stats.allocations, stats.reallocations, stats.frees);
+        total.live_bytes += stats.live_bytes;
+        // The tags peaked at different times, so this is only an upper bound of the overall peak.
+        total.peak_bytes += stats.peak_bytes;
+        total.allocations += stats.allocations;
+        total.reallocations += stats.reallocations;
+        total.frees += stats.frees;
+    }
+    doom_log_printf(doom_log_level_info, "%-12s %12zu %12zu %10zu %10zu %10zu\n", "total", total.live_bytes,
+                    total.peak_bytes, total.allocations, total.reallocations, total.frees);
+}
+
+void doom_sys_run_atexit(int32_t exit_code) {
+    doom_sys_run_atexit_ex(exit_code, doom_state->exit_funcs);
+}
+
+void doom_sys_run_atexit_ex(int32_t exit_code, doom_sys_atexit_list_entry_t* exit_funcs[]) {
     for (doom_sys_exit_priority_t exit_priority = doom_sys_exit_priority_first;
          exit_priority < doom_sys_exit_priority_max; ++exit_priority) {
         doom_sys_atexit_list_entry_t* entry;
-        while ((entry = doom_state->exit_funcs[exit_priority]) != NULL) {
-            doom_state->exit_funcs[exit_priority] = entry->next;
+        while ((entry = exit_funcs[exit_priority]) != NULL) {
+            exit_funcs[exit_priority] = entry->next;
             if (entry->run_if_error || exit_code == 0) {
-                doom_log_printf(doom_log_level_info, "Exit Sequence [%d]: %s (%d)\n", exit_priority, entry->name,
-                                exit_code);
+                DOOM_LOG(system, info, "Exit Sequence [%d]: %s (%d)\n", exit_priority, entry->name, exit_code);
                 entry->func();
             }
-            free(entry);
+            nonstd_free(entry);
         }
     }
+}
+
+void doom_sys_safe_exit(int32_t exit_code) {
+    // In a graph task, the thread waiting for the graph exits instead; this doesn't return there.
+    doom_sys_task_graph_fail_task(exit_code);
+    doom_sys_run_atexit(exit_code);
+    if (doom_state->fatal_jump != NULL) {
+        doom_state->fatal_exit_code = exit_code;
+        longjmp(*doom_state->fatal_jump, 1);
+    }
     exit(exit_code);
 }
+
+char* s_cache_directory(void) {
+    char* directory = doom_misc_parameter_argument("-cachedir");
+    if (directory != NULL) {
+        return directory;
+    }
+#ifdef _WIN32
+    const char* local_app_data = getenv("LOCALAPPDATA");
+    return local_app_data != NULL && local_app_data[0] != '\0' ? s_join_path(local_app_data, PROJECT_NAME) : NULL;
+#else
+    const char* xdg_cache_home = getenv("XDG_CACHE_HOME");
+    if (xdg_cache_home != NULL && xdg_cache_home[0] == '/') {
+        return s_join_path(xdg_cache_home, PROJECT_NAME);
+    }
+    const char* home = getenv("HOME");
+    if (home == NULL || home[0] == '\0') {
+        return NULL;
+    }
+    char* cache = s_join_path(home, ".cache");
+    directory = s_join_path(cache, PROJECT_NAME);
+    nonstd_free(cache);
+    return directory;
+#endif
+}
+
+char* s_join_path(const char* directory, const char* name) {
+    size_t size = strlen(directory) + 1 + strlen(name) + 1;
+    char* path = nonstd_malloc(size, nonstd_alloc_tag_general);
+    snprintf(path, size, "%s/%s", directory, name);
+    return path;
+}
+
+bool s_make_directories(char* path) {
+    // Each parent first, by cutting the path short at each separator in turn.
+    for (char* cursor = path + 1; *cursor != '\0'; cursor++) {
+        if (*cursor != '/' && *cursor != '\\') {
+            continue;
+        }
+        char separator = *cursor;
+        *cursor = '\0';
+#ifdef _WIN32
+        _mkdir(path);
+#else
+        mkdir(path, 0755);
+#endif
+        *cursor = separator;
+    }
+#ifdef _WIN32
+    _mkdir(path);
+    struct _stat info;
+    return _stat(path, &info) == 0 && (info.st_mode & _S_IFDIR) != 0;
+#else
+    mkdir(path, 0755);
+    struct stat info;
+    return stat(path, &info) == 0 && S_ISDIR(info.st_mode);
+#endif
+}
@@ -0,0 +1,262 @@
+#include "doom/video/colormap.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/misc/hash.h"
+#include "doom/misc/subscriptions.h"
+#include "doom/state.h"
+#include "doom/sys/clock.h"
+#include "doom/sys/jobs.h"
+#include "doom/video/palette.h"
+#include "doom/wad/wad.h"
+
+#include <math.h>
+#include <nonstd/alloc.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <threads.h>
+
+enum
+{
+    colormap_size = 256,
+    lump_bytes = doom_video_colormap_doom_maps * colormap_size,
+    min_set_capacity = 4,
+    // Each distance step is 16 map units.
+    light_z_shift = 4,
+    // How many colormaps darker the nearest distance step is, out of doom_maps: vanilla's 160 / (z + 1) / 2 at 320
+    // columns.
+    distance_maps = 80,
+};
+
+
+static void s_settings_changed(void* userdata);
+static void s_select(doom_video_colormap_engine_t* engine, bool background);
+static doom_video_colormaps_t* s_find(const doom_video_colormap_engine_t* engine, const doom_video_colormap_key_t* key);
+static void s_remember(doom_video_colormap_engine_t* engine, doom_video_colormaps_t* colormaps);
+static void s_job(void* userdata);
+static void s_generate_map(uint8_t* map, const doom_video_palette_t* palette, int32_t brightness, int32_t map_count);
+
+void doom_video_colormap_init(void) {
+    doom_video_colormap_engine_t* engine = &doom_state->colormaps;
+    *engine = (doom_video_colormap_engine_t){0};
+    if (mtx_init(&engine->mutex, mtx_plain) != thrd_success || cnd_init(&engine->finished) != thrd_success) {
+        doom_log_error("Could not create the synchronization objects of the colormap engine");
+    }
+    engine->initialized = true;
+    engine->subscription = DOOM_MISC_SUBSCRIBE(s_settings_changed, engine);
+    doom_misc_subscribe_default(engine->subscription, "render_doom_lightmaps");
+    doom_misc_subscribe_default(engine->subscription, "fake_contrast");
+    doom_misc_subscribe_default(engine->subscription, "usegamma");
+    s_select(engine, false);
+}
+
+void doom_video_colormap_destroy(doom_video_colormap_engine_t* engine) {
+    if (!engine->initialized) {
+        return;
+    }
+    if (engine->building != NULL) {
+        mtx_lock(&engine->mutex);
+        while (!atomic_load(&engine->built)) {
+            cnd_wait(&engine->finished, &engine->mutex);
+        }
+        mtx_unlock(&engine->mutex);
+        doom_video_colormap_free(engine->building);
+    }
+    for (size_t i = 0; i < engine->set_count; i++) {
+        doom_video_colormap_free(engine->sets[i]);
+    }
+    nonstd_free(engine->sets);
+    cnd_destroy(&engine->finished);
+    mtx_destroy(&engine->mutex);
+    *engine = (doom_video_colormap_engine_t){0};
+}
+
+const doom_video_colormaps_t* doom_video_colormaps(void) {
+    doom_video_colormap_engine_t* engine = &doom_state->colormaps;
+    if (engine->building != NULL && atomic_load_explicit(&engine->built, memory_order_acquire)) {
+        // The room for it was made when the build started, so this doesn't allocate.
+        s_remember(engine, engine->building);
+        engine->current = engine->building;
+        engine->building = NULL;
+        if (engine->stale) {
+            engine->stale = false;
+            s_select(engine, true);
+        }
+    }
+    return engine->current;
+}
+
+void doom_video_colormap_build(doom_video_colormaps_t* colormaps, const doom_video_palette_t* palette,
+                               const uint8_t* lump) {
+    const doom_video_colormap_key_t* key = &colormaps->key;
+    bool doom_lightmaps = key->doom_lightmaps;
+    int32_t level_count = doom_lightmaps ? doom_video_colormap_doom_levels : doom_video_colormap_smooth_levels;
+    int32_t map_count = doom_lightmaps ? doom_video_colormap_doom_maps : doom_video_colormap_smooth_maps;
+    colormaps->level_count = level_count;
+    colormaps->map_count = map_count;
+    colormaps->maps = nonstd_malloc((size_t)map_count * colormap_size, nonstd_alloc_tag_video);
+    colormaps->zlight =
+        nonstd_malloc((size_t)level_count * doom_video_colormap_max_light_z, nonstd_alloc_tag_video);
+    colormaps->contrast = key->fake_contrast ? level_count / doom_video_colormap_doom_levels : 0;
+
+    if (doom_lightmaps && lump != NULL) {
+        memcpy(colormaps->maps, lump, lump_bytes);
+    } else {
+        for (int32_t map = 0; map < map_count; map++) {
+            s_generate_map(colormaps->maps + (size_t)map * colormap_size, palette, map_count - map, map_count);
+        }
+    }
+
+    // Vanilla's zlight: each light level starts 2 * map_count / level_count colormaps darker than the one above it,
+    // and lightens up close to the eye.
+    for (int32_t level = 0; level < level_count; level++) {
+        int32_t start = (level_count - 1 - level) * 2 * map_count / level_count;
+        for (int32_t z = 0; z < doom_video_colormap_max_light_z; z++) {
+            int32_t map = start - distance_maps * map_count / doom_video_colormap_doom_maps / (z + 1);
+            map = map < 0 ? 0 : map >= map_count ? map_count - 1 : map;
+            colormaps->zlight[level * doom_video_colormap_max_light_z + z] = (uint8_t)map;
+        }
+    }
+
+    // Each usegamma step lowers the exponent of a power curve, which brightens the darks the most.
+    double exponent = 1.0 - (double)key->gamma / 8.0;
+    uint8_t gamma[256];
+    for (int32_t i = 0; i < 256; i++) {
+        gamma[i] = (uint8_t)lround(255.0 * pow((double)i / 255.0, exponent));
+    }
+    for (size_t i = 0; i < doom_video_palette_bytes; i++) {
+        colormaps->palette[i] = gamma[palette->rgb[i]];
+    }
+}
+
+void doom_video_colormap_free(doom_video_colormaps_t* colormaps) {
+    if (colormaps == NULL) {
+        return;
+    }
+    nonstd_free(colormaps->maps);
+    nonstd_free(colormaps->zlight);
+    nonstd_free(colormaps);
+}
+
+int32_t doom_video_colormap_level(const doom_video_colormaps_t* colormaps, int32_t light,
+                                  doom_video_colormap_wall_t wall) {
+    int32_t level = light * colormaps->level_count / 256;
+    if (wall == doom_video_colormap_wall_along_x) {
+        level -= colormaps->contrast;
+    } else if (wall == doom_video_colormap_wall_along_y) {
+        level += colormaps->contrast;
+    }
+    return level < 0 ? 0 : level >= colormaps->level_count ? colormaps->level_count - 1 : level;
+}
+
+const uint8_t* doom_video_colormap_z(const doom_video_colormaps_t* colormaps, int32_t level, float distance) {
+    int32_t z = distance > 0.0f ? (int32_t)distance >> light_z_shift : 0;
+    z = z >= doom_video_colormap_max_light_z ? doom_video_colormap_max_light_z - 1 : z;
+    return colormaps->maps + (size_t)colormaps->zlight[level * doom_video_colormap_max_light_z + z] * colormap_size;
+}
+
+void s_settings_changed(void* userdata) {
+    s_select(userdata, true);
+}
+
+void s_select(doom_video_colormap_engine_t* engine, bool background) {
+    if (engine->building != NULL) {
+        // One build at a time; the settings are looked at again when it's done.
+        engine->stale = true;
+        return;
+    }
+    doom_video_palette_t palette;
+    if (!doom_video_palette_load(&palette, 0)) {
+        DOOM_LOG(render, debug, "No PLAYPAL; there are no colormaps.\n");
+        engine->current = NULL;
+        return;
+    }
+
+    const doom_misc_default_storage_t* defaults = &doom_state->defaults_storage;
+    doom_video_colormap_key_t key = {
+        .palette_hash = palette.hash,
+        .doom_lightmaps = defaults->render_doom_lightmaps,
+        .fake_contrast = defaults->fake_contrast,
+        .gamma = defaults->usegamma < 0                                    ? 0
+                 : defaults->usegamma >= doom_video_colormap_gamma_levels ? doom_video_colormap_gamma_levels - 1
+                                                                          : defaults->usegamma,
+    };
+    const uint8_t* lump = NULL;
+    if (key.doom_lightmaps) {
+        int32_t index = doom_wad_find("COLORMAP");
+        doom_wad_lump_data_t data = index >= 0 ? doom_wad_lump_data(index) : (doom_wad_lump_data_t){0};
+        if (data.size >= lump_bytes) {
+            lump = data.begin;
+            key.lump_hash = doom_misc_hash(lump, lump_bytes);
+        }
+    }
+
+    doom_video_colormaps_t* found = s_find(engine, &key);
+    if (found != NULL) {
+        engine->current = found;
+        return;
+    }
+
+    doom_video_colormaps_t* colormaps = nonstd_calloc(1, sizeof(doom_video_colormaps_t), nonstd_alloc_tag_video);
+    colormaps->key = key;
+    if (engine->set_count == engine->set_capacity) {
+        engine->set_capacity = engine->set_capacity == 0 ? min_set_capacity : engine->set_capacity * 2;
+        engine->sets = nonstd_realloc(engine->sets, engine->set_capacity * sizeof(doom_video_colormaps_t*),
+                                      nonstd_alloc_tag_video);
+    }
+    if (!background) {
+        uint64_t start = doom_sys_clock_ns();
+        doom_video_colormap_build(colormaps, &palette, lump);
+        DOOM_LOG(render, debug, "Built %d colormaps in %.1f ms.\n", colormaps->map_count,
+                 (double)(doom_sys_clock_ns() - start) / 1e6);
+        s_remember(engine, colormaps);
+        engine->current = colormaps;
+        return;
+    }
+
+    // The frame goes on with the current colormaps until doom_video_colormaps() sees these are built.
+    engine->building = colormaps;
+    engine->building_palette = palette;
+    engine->building_lump = lump;
+    atomic_store(&engine->built, false);
+    doom_sys_jobs_submit(s_job, engine);
+}
+
+doom_video_colormaps_t* s_find(const doom_video_colormap_engine_t* engine, const doom_video_colormap_key_t* key) {
+    for (size_t i = 0; i < engine->set_count; i++) {
+        const doom_video_colormap_key_t* other = &engine->sets[i]->key;
+        if (other->palette_hash == key->palette_hash && other->lump_hash == key->lump_hash &&
+            other->doom_lightmaps == key->doom_lightmaps && other->fake_contrast == key->fake_contrast &&
+            other->gamma == key->gamma) {
+            return engine->sets[i];
+        }
+    }
+    return NULL;
+}
+
+void s_remember(doom_video_colormap_engine_t* engine, doom_video_colormaps_t* colormaps) {
+    engine->sets[engine->set_count++] = colormaps;
+}
+
+void s_job(void* userdata) {
+    doom_video_colormap_engine_t* engine = userdata;
+    doom_video_colormap_build(engine->building, &engine->building_palette, engine->building_lump);
+    mtx_lock(&engine->mutex);
+    atomic_store_explicit(&engine->built, true, memory_order_release);
+    cnd_broadcast(&engine->finished);
+    mtx_unlock(&engine->mutex);
+}
+
+void s_generate_map(uint8_t* map, const doom_video_palette_t* palette, int32_t brightness, int32_t map_count) {
+    // Every color scaled towards black by brightness / map_count, then matched back to the palette.
+    const uint8_t* rgb = palette->rgb;
+    int32_t round = map_count / 2;
+    for (size_t i = 0; i < colormap_size; i++) {
+        map[i] = doom_video_palette_nearest(palette, (rgb[3 * i] * brightness + round) / map_count,
+                                            (rgb[3 * i + 1] * brightness + round) / map_count,
+                                            (rgb[3 * i + 2] * brightness + round) / map_count);
+    }
+}
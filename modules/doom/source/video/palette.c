@@ -0,0 +1,158 @@
+#include "doom/video/palette.h"
+
+#include "doom/misc/hash.h"
+#include "doom/sys/cpu.h"
+#include "doom/wad/wad.h"
+
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if DOOM_SYS_CPU_X86
+#include <immintrin.h>
+#endif
+
+
+static uint8_t s_nearest_scalar(const doom_video_palette_t* palette, int32_t red, int32_t green, int32_t blue);
+#if DOOM_SYS_CPU_X86
+static uint8_t s_nearest_sse2(const doom_video_palette_t* palette, int32_t red, int32_t green, int32_t blue);
+static uint8_t s_nearest_avx2(const doom_video_palette_t* palette, int32_t red, int32_t green, int32_t blue);
+static uint8_t s_best_lane(const int32_t* distances, const int32_t* indices, size_t lanes);
+#endif
+
+static const doom_video_palette_nearest_func_t sc_searches[doom_sys_cpu_isa_count] = {
+    [doom_sys_cpu_isa_scalar] = s_nearest_scalar,
+#if DOOM_SYS_CPU_X86
+    [doom_sys_cpu_isa_sse2] = s_nearest_sse2,
+    [doom_sys_cpu_isa_avx2] = s_nearest_avx2,
+#endif
+};
+
+// The instruction set doom_video_palette_nearest() uses, picked on first use; -1 until then.
+static atomic_int s_isa = -1;
+
+void doom_video_palette_init(doom_video_palette_t* palette, const uint8_t rgb[doom_video_palette_bytes]) {
+    memcpy(palette->rgb, rgb, doom_video_palette_bytes);
+    palette->hash = doom_misc_hash(rgb, doom_video_palette_bytes);
+    for (size_t i = 0; i < doom_video_palette_colors; i++) {
+        palette->red_green[i][0] = rgb[3 * i];
+        palette->red_green[i][1] = rgb[3 * i + 1];
+        palette->blue[i][0] = rgb[3 * i + 2];
+        palette->blue[i][1] = 0;
+    }
+}
+
+bool doom_video_palette_load(doom_video_palette_t* palette, size_t index) {
+    int32_t lump = doom_wad_find("PLAYPAL");
+    if (lump < 0) {
+        return false;
+    }
+    doom_wad_lump_data_t data = doom_wad_lump_data(lump);
+    if (data.size < (index + 1) * doom_video_palette_bytes) {
+        return false;
+    }
+    doom_video_palette_init(palette, data.begin + index * doom_video_palette_bytes);
+    return true;
+}
+
+doom_video_palette_nearest_func_t doom_video_palette_nearest_func(doom_sys_cpu_isa_t isa) {
+    return sc_searches[isa];
+}
+
+uint8_t doom_video_palette_nearest(const doom_video_palette_t* palette, int32_t red, int32_t green, int32_t blue) {
+    int isa = atomic_load_explicit(&s_isa, memory_order_relaxed);
+    if (isa < 0) {
+        isa = (int)doom_sys_cpu_best_isa();
+        atomic_store_explicit(&s_isa, isa, memory_order_relaxed);
+    }
+    return sc_searches[isa](palette, red, green, blue);
+}
+
+uint8_t s_nearest_scalar(const doom_video_palette_t* palette, int32_t red, int32_t green, int32_t blue) {
+    int32_t best_distance = INT32_MAX;
+    uint8_t best = 0;
+    for (size_t i = 0; i < doom_video_palette_colors; i++) {
+        int32_t dr = palette->red_green[i][0] - red;
+        int32_t dg = palette->red_green[i][1] - green;
+        int32_t db = palette->blue[i][0] - blue;
+        int32_t distance = dr * dr + dg * dg + db * db;
+        if (distance < best_distance) {
+            best_distance = distance;
+            best = (uint8_t)i;
+            if (distance == 0) {
+                break;
+            }
+        }
+    }
+    return best;
+}
+
+#if DOOM_SYS_CPU_X86
+
+// Each lane keeps the nearest of the colors it has seen, the earliest on a tie, and the lanes are compared at the end.
+// The differences fit 16 bits, so madd squares a (red, green) or (blue, 0) pair and sums it into 32 bits in one go.
+
+DOOM_SYS_CPU_TARGET("sse2")
+uint8_t s_nearest_sse2(const doom_video_palette_t* palette, int32_t red, int32_t green, int32_t blue) {
+    __m128i query_red_green = _mm_set1_epi32((int)((uint32_t)(uint16_t)green << 16 | (uint16_t)red));
+    __m128i query_blue = _mm_set1_epi32(blue);
+    __m128i best_distance = _mm_set1_epi32(INT32_MAX);
+    __m128i best_index = _mm_setzero_si128();
+    __m128i index = _mm_setr_epi32(0, 1, 2, 3);
+    __m128i four = _mm_set1_epi32(4);
+    for (size_t i = 0; i < doom_video_palette_colors; i += 4) {
+        __m128i red_green = _mm_sub_epi16(_mm_loadu_si128((const __m128i*)palette->red_green[i]), query_red_green);
+        __m128i blue_zero = _mm_sub_epi16(_mm_loadu_si128((const __m128i*)palette->blue[i]), query_blue);
+        __m128i distance = _mm_add_epi32(_mm_madd_epi16(red_green, red_green), _mm_madd_epi16(blue_zero, blue_zero));
+        __m128i nearer = _mm_cmpgt_epi32(best_distance, distance);
+        best_distance = _mm_or_si128(_mm_and_si128(nearer, distance), _mm_andnot_si128(nearer, best_distance));
+        best_index = _mm_or_si128(_mm_and_si128(nearer, index), _mm_andnot_si128(nearer, best_index));
+        index = _mm_add_epi32(index, four);
+    }
+    int32_t distances[4];
+    int32_t indices[4];
+    _mm_storeu_si128((__m128i*)distances, best_distance);
+    _mm_storeu_si128((__m128i*)indices, best_index);
+    return s_best_lane(distances, indices, 4);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+uint8_t s_nearest_avx2(const doom_video_palette_t* palette, int32_t red, int32_t green, int32_t blue) {
+    __m256i query_red_green = _mm256_set1_epi32((int)((uint32_t)(uint16_t)green << 16 | (uint16_t)red));
+    __m256i query_blue = _mm256_set1_epi32(blue);
+    __m256i best_distance = _mm256_set1_epi32(INT32_MAX);
+    __m256i best_index = _mm256_setzero_si256();
+    __m256i index = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i eight = _mm256_set1_epi32(8);
+    for (size_t i = 0; i < doom_video_palette_colors; i += 8) {
+        __m256i red_green =
+            _mm256_sub_epi16(_mm256_loadu_si256((const __m256i*)palette->red_green[i]), query_red_green);
+        __m256i blue_zero = _mm256_sub_epi16(_mm256_loadu_si256((const __m256i*)palette->blue[i]), query_blue);
+        __m256i distance =
+            _mm256_add_epi32(_mm256_madd_epi16(red_green, red_green), _mm256_madd_epi16(blue_zero, blue_zero));
+        __m256i nearer = _mm256_cmpgt_epi32(best_distance, distance);
+        best_distance = _mm256_blendv_epi8(best_distance, distance, nearer);
+        best_index = _mm256_blendv_epi8(best_index, index, nearer);
+        index = _mm256_add_epi32(index, eight);
+    }
+    int32_t distances[8];
+    int32_t indices[8];
+    _mm256_storeu_si256((__m256i*)distances, best_distance);
+    _mm256_storeu_si256((__m256i*)indices, best_index);
+    return s_best_lane(distances, indices, 8);
+}
+
+uint8_t s_best_lane(const int32_t* distances, const int32_t* indices, size_t lanes) {
+    size_t best = 0;
+    for (size_t lane = 1; lane < lanes; lane++) {
+        if (distances[lane] < distances[best] ||
+            (distances[lane] == distances[best] && indices[lane] < indices[best])) {
+            best = lane;
+        }
+    }
+    return (uint8_t)indices[best];
+}
+
+#endif
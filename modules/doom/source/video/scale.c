@@ -0,0 +1,351 @@
+#include "doom/video/scale.h"
+
+#include "doom/log/printf.h"
+#include "doom/sys/bench.h"
+#include "doom/sys/clock.h"
+#include "doom/sys/cpu.h"
+
+#include <math.h>
+#include <nonstd/alloc.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#if DOOM_SYS_CPU_X86
+#include <immintrin.h>
+#endif
+
+enum
+{
+    // A gather reads 4 bytes at each index, so it stops 3 columns short of the end of the row.
+    gather_overread = 3,
+    bench_size_count = 10,
+    bench_max_source_bytes = 1920 * 1080,
+    bench_max_dest_bytes = 3840 * 2160,
+};
+
+typedef struct {
+    int32_t source_width;
+    int32_t source_height;
+    int32_t dest_width;
+    int32_t dest_height;
+} s_bench_size_t;
+
+static void s_row_map_scalar(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler);
+static inline void s_row_map_from(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler, int32_t x);
+#if DOOM_SYS_CPU_X86
+static void s_row_double_sse2(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler);
+static void s_row_quadruple_sse2(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler);
+static void s_row_replicate_avx2(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler);
+static void s_row_map_avx2(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler);
+
+// For each factor, the source byte of each output byte of the factor's 16-byte blocks that 16 source bytes become.
+static const uint8_t sc_replicate_masks[doom_video_scale_max_simd_factor + 1][doom_video_scale_max_simd_factor][16] = {
+    [2] =
+        {
+            {0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7},
+            {8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13, 14, 14, 15, 15},
+        },
+    [3] =
+        {
+            {0, 0, 0, 1, 1, 1, 2, 2, 2, 3, 3, 3, 4, 4, 4, 5},
+            {5, 5, 6, 6, 6, 7, 7, 7, 8, 8, 8, 9, 9, 9, 10, 10},
+            {10, 11, 11, 11, 12, 12, 12, 13, 13, 13, 14, 14, 14, 15, 15, 15},
+        },
+    [4] =
+        {
+            {0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3},
+            {4, 4, 4, 4, 5, 5, 5, 5, 6, 6, 6, 6, 7, 7, 7, 7},
+            {8, 8, 8, 8, 9, 9, 9, 9, 10, 10, 10, 10, 11, 11, 11, 11},
+            {12, 12, 12, 12, 13, 13, 13, 13, 14, 14, 14, 14, 15, 15, 15, 15},
+        },
+    [5] =
+        {
+            {0, 0, 0, 0, 0, 1, 1, 1, 1, 1, 2, 2, 2, 2, 2, 3},
+            {3, 3, 3, 3, 4, 4, 4, 4, 4, 5, 5, 5, 5, 5, 6, 6},
+            {6, 6, 6, 7, 7, 7, 7, 7, 8, 8, 8, 8, 8, 9, 9, 9},
+            {9, 9, 10, 10, 10, 10, 10, 11, 11, 11, 11, 11, 12, 12, 12, 12},
+            {12, 13, 13, 13, 13, 13, 14, 14, 14, 14, 14, 15, 15, 15, 15, 15},
+        },
+};
+#endif
+
+static const s_bench_size_t sc_bench_sizes[bench_size_count] = {
+    // render_screen_multiply 2 to 5 of vanilla.
+    {320, 200, 640, 400},
+    {320, 200, 960, 600},
+    {320, 200, 1280, 800},
+    {320, 200, 1600, 1000},
+    // Vanilla, aspect corrected to 4:3 at 1080p and 4K.
+    {320, 200, 1440, 1080},
+    {640, 400, 2880, 2160},
+    // Larger framebuffers.
+    {640, 400, 2560, 1600},
+    {1280, 720, 3840, 2160},
+    {960, 540, 3840, 2160},
+    {1920, 1080, 3840, 2160},
+};
+
+void doom_video_scale_fit(int32_t source_width, int32_t source_height, int32_t output_width, int32_t output_height,
+                          int32_t multiply, bool integer_scaling, int32_t aspect, int32_t* dest_width,
+                          int32_t* dest_height) {
+    // The width of the shown image over its height.
+    double ratio;
+    switch (aspect) {
+        case 1:
+            ratio = 16.0 / 9.0;
+            break;
+        case 2:
+            ratio = 16.0 / 10.0;
+            break;
+        case 3:
+            ratio = 4.0 / 3.0;
+            break;
+        case 4:
+            ratio = 5.0 / 4.0;
+            break;
+        default:
+            ratio = source_width * 10 == source_height * 16 ? 4.0 / 3.0 : (double)source_width / (double)source_height;
+            break;
+    }
+
+    int32_t width;
+    if (multiply > 1) {
+        width = source_width * multiply;
+    } else if (integer_scaling) {
+        int32_t factor = output_width / source_width;
+        int32_t tallest = (int32_t)((double)output_height * ratio / (double)source_width);
+        factor = tallest < factor ? tallest : factor;
+        width = source_width * (factor > 1 ? factor : 1);
+    } else {
+        double fitting = (double)output_height * ratio;
+        width = fitting < (double)output_width ? (int32_t)fitting : output_width;
+    }
+    int32_t height = (int32_t)lround((double)width / ratio);
+    *dest_width = width > 1 ? width : 1;
+    *dest_height = height > 1 ? height : 1;
+}
+
+void doom_video_scaler_init(doom_video_scaler_t* scaler, int32_t source_width, int32_t source_height,
+                            int32_t dest_width, int32_t dest_height) {
+    *scaler = (doom_video_scaler_t){
+        .source_width = source_width,
+        .source_height = source_height,
+        .dest_width = dest_width,
+        .dest_height = dest_height,
+        .factor = dest_width % source_width == 0 ? dest_width / source_width : 0,
+        .columns = nonstd_malloc((size_t)dest_width * sizeof(int32_t), nonstd_alloc_tag_video),
+        .rows = nonstd_malloc(((size_t)source_height + 1) * sizeof(int32_t), nonstd_alloc_tag_video),
+    };
+    // Output column x shows source column x * source_width / dest_width, so source row y starts at the first output
+    // row that rounds down to it.
+    for (int32_t x = 0; x < dest_width; x++) {
+        scaler->columns[x] = (int32_t)((int64_t)x * source_width / dest_width);
+    }
+    for (int32_t y = 0; y <= source_height; y++) {
+        scaler->rows[y] = (int32_t)(((int64_t)y * dest_height + source_height - 1) / source_height);
+    }
+    scaler->row = doom_video_scaler_row_func(scaler, doom_sys_cpu_best_isa());
+}
+
+void doom_video_scaler_destroy(doom_video_scaler_t* scaler) {
+    nonstd_free(scaler->columns);
+    nonstd_free(scaler->rows);
+    *scaler = (doom_video_scaler_t){0};
+}
+
+doom_video_scale_row_func_t doom_video_scaler_row_func(const doom_video_scaler_t* scaler, doom_sys_cpu_isa_t isa) {
+    switch (isa) {
+        case doom_sys_cpu_isa_scalar:
+            return s_row_map_scalar;
+#if DOOM_SYS_CPU_X86
+        case doom_sys_cpu_isa_sse2:
+            // Without a byte shuffle, only doubling and quadrupling are worth doing in vectors.
+            return scaler->factor == 2   ? s_row_double_sse2
+                   : scaler->factor == 4 ? s_row_quadruple_sse2
+                                         : s_row_map_scalar;
+        case doom_sys_cpu_isa_avx2:
+            return scaler->factor >= doom_video_scale_min_simd_factor &&
+                           scaler->factor <= doom_video_scale_max_simd_factor
+                       ? s_row_replicate_avx2
+                       : s_row_map_avx2;
+#endif
+        default:
+            return NULL;
+    }
+}
+
+void doom_video_scale(const doom_video_scaler_t* scaler, const uint8_t* source, ptrdiff_t source_pitch, uint8_t* dest,
+                      ptrdiff_t dest_pitch) {
+    for (int32_t y = 0; y < scaler->source_height; y++) {
+        int32_t first = scaler->rows[y];
+        int32_t end = scaler->rows[y + 1];
+        if (first == end) {
+            continue;
+        }
+        uint8_t* row = dest + (ptrdiff_t)first * dest_pitch;
+        scaler->row(row, source + (ptrdiff_t)y * source_pitch, scaler);
+        for (int32_t repeat = first + 1; repeat < end; repeat++) {
+            memcpy(dest + (ptrdiff_t)repeat * dest_pitch, row, (size_t)scaler->dest_width);
+        }
+    }
+}
+
+void doom_video_scale_bench(void) {
+    uint8_t* source = nonstd_malloc(bench_max_source_bytes, nonstd_alloc_tag_bench);
+    uint8_t* dest = nonstd_malloc(bench_max_dest_bytes, nonstd_alloc_tag_bench);
+    // Any bytes will do, as long as the compiler can't see through them.
+    uint32_t seed = (uint32_t)doom_sys_clock_ns() | 1;
+    for (size_t i = 0; i < bench_max_source_bytes; i++) {
+        seed = seed * 1664525 + 1013904223;
+        source[i] = (uint8_t)(seed >> 24);
+    }
+
+    doom_sys_bench_t bench = doom_sys_bench_new("scale");
+    doom_video_scaler_t scalers[bench_size_count];
+    // Series names aren't copied, so they live here until the benchmark is freed.
+    char names[doom_sys_cpu_isa_count][bench_size_count][40];
+    size_t series[doom_sys_cpu_isa_count][bench_size_count];
+    // Which size each series scales, for the report.
+    size_t series_sizes[doom_sys_cpu_isa_count * bench_size_count];
+    for (size_t size = 0; size < bench_size_count; size++) {
+        const s_bench_size_t* s = &sc_bench_sizes[size];
+        doom_video_scaler_init(&scalers[size], s->source_width, s->source_height, s->dest_width, s->dest_height);
+    }
+    for (doom_sys_cpu_isa_t isa = 0; isa < doom_sys_cpu_isa_count; isa++) {
+        for (size_t size = 0; size < bench_size_count; size++) {
+            const s_bench_size_t* s = &sc_bench_sizes[size];
+            snprintf(names[isa][size], sizeof(names[isa][size]), "%s_%dx%d_to_%dx%d", doom_sys_cpu_isa_name(isa),
+                     s->source_width, s->source_height, s->dest_width, s->dest_height);
+            if (doom_sys_cpu_supports(isa) && doom_video_scaler_row_func(&scalers[size], isa) != NULL) {
+                series[isa][size] = doom_sys_bench_series(&bench, names[isa][size]);
+                series_sizes[series[isa][size]] = size;
+            }
+        }
+    }
+
+    for (size_t iteration = 0; iteration < doom_video_scale_bench_iterations; iteration++) {
+        for (doom_sys_cpu_isa_t isa = 0; isa < doom_sys_cpu_isa_count; isa++) {
+            if (!doom_sys_cpu_supports(isa)) {
+                continue;
+            }
+            for (size_t size = 0; size < bench_size_count; size++) {
+                doom_video_scaler_t scaler = scalers[size];
+                scaler.row = doom_video_scaler_row_func(&scaler, isa);
+                if (scaler.row == NULL) {
+                    continue;
+                }
+                uint64_t start = doom_sys_clock_ns();
+                doom_video_scale(&scaler, source, scaler.source_width, dest, scaler.dest_width);
+                doom_sys_bench_record(&bench, series[isa][size], doom_sys_clock_ns() - start);
+            }
+        }
+    }
+    bench.iterations = doom_video_scale_bench_iterations;
+
+    doom_sys_bench_report(&bench);
+    for (size_t i = 0; i < bench.series.size; i++) {
+        doom_sys_bench_series_t* s = &bench.series.data[i];
+        doom_sys_bench_summary_t summary = doom_sys_bench_summarize(s);
+        const s_bench_size_t* size = &sc_bench_sizes[series_sizes[i]];
+        double pixels = (double)size->dest_width * (double)size->dest_height;
+        doom_log_printf(doom_log_level_info, "%-32s %10.1f Mpx/s\n", s->name,
+                        summary.median_ns > 0 ? pixels * 1e3 / (double)summary.median_ns : 0.0);
+    }
+    char* json_path = doom_sys_bench_json_path("benchscale.json");
+    if (doom_sys_bench_write_json(&bench, json_path)) {
+        doom_log_printf(doom_log_level_info, "Wrote %s.\n", json_path);
+    } else {
+        DOOM_LOG(render, warn, "Could not write %s.\n", json_path);
+    }
+    nonstd_free(json_path);
+    doom_sys_bench_free(&bench);
+    for (size_t size = 0; size < bench_size_count; size++) {
+        doom_video_scaler_destroy(&scalers[size]);
+    }
+    nonstd_free(dest);
+    nonstd_free(source);
+}
+
+void s_row_map_scalar(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler) {
+    s_row_map_from(dest, source, scaler, 0);
+}
+
+void s_row_map_from(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler, int32_t x) {
+    const int32_t* columns = scaler->columns;
+    for (; x < scaler->dest_width; x++) {
+        dest[x] = source[columns[x]];
+    }
+}
+
+#if DOOM_SYS_CPU_X86
+
+// The replicating scalers take 16 source columns at a time, and leave the rest to the column map.
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_row_double_sse2(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler) {
+    int32_t x = 0;
+    for (; x + 16 <= scaler->source_width; x += 16) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(source + x));
+        _mm_storeu_si128((__m128i*)(dest + 2 * x), _mm_unpacklo_epi8(pixels, pixels));
+        _mm_storeu_si128((__m128i*)(dest + 2 * x + 16), _mm_unpackhi_epi8(pixels, pixels));
+    }
+    s_row_map_from(dest, source, scaler, 2 * x);
+}
+
+DOOM_SYS_CPU_TARGET("sse2")
+void s_row_quadruple_sse2(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler) {
+    int32_t x = 0;
+    for (; x + 16 <= scaler->source_width; x += 16) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(source + x));
+        __m128i low = _mm_unpacklo_epi8(pixels, pixels);
+        __m128i high = _mm_unpackhi_epi8(pixels, pixels);
+        _mm_storeu_si128((__m128i*)(dest + 4 * x), _mm_unpacklo_epi16(low, low));
+        _mm_storeu_si128((__m128i*)(dest + 4 * x + 16), _mm_unpackhi_epi16(low, low));
+        _mm_storeu_si128((__m128i*)(dest + 4 * x + 32), _mm_unpacklo_epi16(high, high));
+        _mm_storeu_si128((__m128i*)(dest + 4 * x + 48), _mm_unpackhi_epi16(high, high));
+    }
+    s_row_map_from(dest, source, scaler, 4 * x);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_row_replicate_avx2(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler) {
+    int32_t factor = scaler->factor;
+    __m128i masks[doom_video_scale_max_simd_factor];
+    for (int32_t block = 0; block < factor; block++) {
+        masks[block] = _mm_loadu_si128((const __m128i*)sc_replicate_masks[factor][block]);
+    }
+    int32_t x = 0;
+    for (; x + 16 <= scaler->source_width; x += 16) {
+        __m128i pixels = _mm_loadu_si128((const __m128i*)(source + x));
+        uint8_t* out = dest + factor * x;
+        for (int32_t block = 0; block < factor; block++) {
+            _mm_storeu_si128((__m128i*)(out + 16 * block), _mm_shuffle_epi8(pixels, masks[block]));
+        }
+    }
+    s_row_map_from(dest, source, scaler, factor * x);
+}
+
+DOOM_SYS_CPU_TARGET("avx2")
+void s_row_map_avx2(uint8_t* dest, const uint8_t* source, const doom_video_scaler_t* scaler) {
+    const int32_t* columns = scaler->columns;
+    __m256i byte = _mm256_set1_epi32(0xFF);
+    // Moves the low byte of each 32-bit lane into the low 4 bytes of its 128-bit half, then both halves together.
+    __m256i pack = _mm256_setr_epi8(0, 4, 8, 12, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 0, 4, 8, 12, -1, -1,
+                                    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+    __m256i join = _mm256_setr_epi32(0, 4, 1, 1, 1, 1, 1, 1);
+    // The columns only grow, so the gathers are safe up to the first block that reaches the last few columns.
+    int32_t last_safe = scaler->source_width - 1 - gather_overread;
+    int32_t x = 0;
+    for (; x + 8 <= scaler->dest_width && columns[x + 7] <= last_safe; x += 8) {
+        __m256i index = _mm256_loadu_si256((const __m256i*)(columns + x));
+        __m256i pixels = _mm256_and_si256(_mm256_i32gather_epi32((const int*)source, index, 1), byte);
+        pixels = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(pixels, pack), join);
+        _mm_storel_epi64((__m128i*)(dest + x), _mm256_castsi256_si128(pixels));
+    }
+    s_row_map_from(dest, source, scaler, x);
+}
+
+#endif
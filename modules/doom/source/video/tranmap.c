@@ -0,0 +1,246 @@
+#include "doom/video/tranmap.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/misc/argv.h"
+#include "doom/misc/subscriptions.h"
+#include "doom/state.h"
+#include "doom/sys/clock.h"
+#include "doom/sys/cpu.h"
+#include "doom/sys/jobs.h"
+#include "doom/sys/mapped_file.h"
+#include "doom/sys/system.h"
+#include "doom/video/palette.h"
+
+#include <nonstd/alloc.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <threads.h>
+
+enum
+{
+    // Boom's fixed point for the blend weights.
+    weight_bits = 12,
+    // The background rows each job claims at a time.
+    rows_per_claim = 8,
+};
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    int32_t pct;
+    uint32_t reserved;
+    uint64_t palette_hash;
+} s_cache_header_t;
+
+typedef struct {
+    uint8_t* table;
+    const doom_video_palette_t* palette;
+    doom_video_palette_nearest_func_t nearest;
+    int32_t foreground_weight;
+    atomic_size_t next_row;
+    size_t jobs_outstanding;
+    mtx_t mutex;
+    cnd_t finished;
+} s_generation_t;
+
+// "TRAN", read as a native integer, so a cache from a machine of the other byte order is rejected.
+static const uint32_t sc_cache_magic = 0x4E415254;
+
+static void s_settings_changed(void* userdata);
+static void s_update(doom_video_tranmap_t* tranmap);
+static void s_release(doom_video_tranmap_t* tranmap);
+static int32_t s_pct(void);
+static char* s_cache_path(int32_t pct, uint64_t palette_hash);
+static bool s_load_cache(doom_video_tranmap_t* tranmap, const char* path, int32_t pct, uint64_t palette_hash);
+static bool s_save_cache(const char* path, const uint8_t* table, int32_t pct, uint64_t palette_hash);
+static void s_job(void* userdata);
+static void s_generate_rows(s_generation_t* generation);
+
+void doom_video_tranmap_init(void) {
+    doom_video_tranmap_t* tranmap = &doom_state->tranmap;
+    *tranmap = (doom_video_tranmap_t){.stale = true};
+    tranmap->subscription = DOOM_MISC_SUBSCRIBE(s_settings_changed, tranmap);
+    doom_misc_subscribe_default(tranmap->subscription, "tran_filter_pct");
+    s_update(tranmap);
+}
+
+void doom_video_tranmap_destroy(doom_video_tranmap_t* tranmap) {
+    s_release(tranmap);
+    *tranmap = (doom_video_tranmap_t){0};
+}
+
+const uint8_t* doom_video_tranmap(void) {
+    doom_video_tranmap_t* tranmap = &doom_state->tranmap;
+    if (tranmap->stale) {
+        s_update(tranmap);
+    }
+    return tranmap->table;
+}
+
+void doom_video_tranmap_generate(uint8_t* table, const doom_video_palette_t* palette, int32_t pct) {
+    pct = pct < 0 ? 0 : pct > 100 ? 100 : pct;
+    s_generation_t generation = {
+        .table = table,
+        .palette = palette,
+        .nearest = doom_video_palette_nearest_func(doom_sys_cpu_best_isa()),
+        .foreground_weight = (pct << weight_bits) / 100,
+    };
+    if (mtx_init(&generation.mutex, mtx_plain) != thrd_success || cnd_init(&generation.finished) != thrd_success) {
+        doom_log_error("Could not create the synchronization objects of the tranmap generation");
+    }
+
+    size_t jobs = doom_sys_jobs_worker_count();
+    mtx_lock(&generation.mutex);
+    generation.jobs_outstanding = jobs;
+    mtx_unlock(&generation.mutex);
+    for (size_t i = 0; i < jobs; i++) {
+        doom_sys_jobs_submit(s_job, &generation);
+    }
+    s_generate_rows(&generation);
+
+    // This may be a task on the only worker, so the jobs may still be queued with nobody else to run them.
+    doom_sys_jobs_wait(&generation.jobs_outstanding, &generation.mutex, &generation.finished);
+    cnd_destroy(&generation.finished);
+    mtx_destroy(&generation.mutex);
+}
+
+void s_settings_changed(void* userdata) {
+    doom_video_tranmap_t* tranmap = userdata;
+    // Remade when it's next asked for, not here, so a setting that's being scrolled through isn't remade at each step.
+    tranmap->stale = tranmap->table == NULL || tranmap->pct != s_pct();
+}
+
+void s_update(doom_video_tranmap_t* tranmap) {
+    tranmap->stale = false;
+    doom_video_palette_t palette;
+    if (!doom_video_palette_load(&palette, 0)) {
+        DOOM_LOG(render, debug, "No PLAYPAL; there is no translucency table.\n");
+        s_release(tranmap);
+        return;
+    }
+    int32_t pct = s_pct();
+    if (tranmap->table != NULL && tranmap->pct == pct && tranmap->palette_hash == palette.hash) {
+        return;
+    }
+    s_release(tranmap);
+    tranmap->pct = pct;
+    tranmap->palette_hash = palette.hash;
+
+    bool use_cache = doom_misc_check_parameter("-notranmapcache") <= 0;
+    char* cache_path = s_cache_path(pct, palette.hash);
+    if (use_cache && s_load_cache(tranmap, cache_path, pct, palette.hash)) {
+        DOOM_LOG(render, debug, "Mapped the translucency table for %d%% from %s.\n", pct, cache_path);
+        nonstd_free(cache_path);
+        return;
+    }
+
+    uint64_t start = doom_sys_clock_ns();
+    tranmap->buffer = nonstd_malloc(doom_video_tranmap_size, nonstd_alloc_tag_video);
+    doom_video_tranmap_generate(tranmap->buffer, &palette, pct);
+    tranmap->table = tranmap->buffer;
+    DOOM_LOG(render, info, "Generated the translucency table for %d%% in %.1f ms.\n", pct,
+             (double)(doom_sys_clock_ns() - start) / 1e6);
+    if (use_cache && !s_save_cache(cache_path, tranmap->buffer, pct, palette.hash)) {
+        DOOM_LOG(render, warn, "Could not write the translucency table cache %s.\n", cache_path);
+    }
+    nonstd_free(cache_path);
+}
+
+void s_release(doom_video_tranmap_t* tranmap) {
+    doom_sys_unmap_file(&tranmap->mapped);
+    nonstd_free(tranmap->buffer);
+    tranmap->buffer = NULL;
+    tranmap->table = NULL;
+}
+
+int32_t s_pct(void) {
+    int32_t pct = doom_state->defaults_storage.tran_filter_pct;
+    return pct < 0 ? 0 : pct > 100 ? 100 : pct;
+}
+
+char* s_cache_path(int32_t pct, uint64_t palette_hash) {
+    // One file per palette and percentage, so going back to a setting finds its table, and instances that differ
+    // don't keep replacing each other's.
+    char name[sizeof("tranmap-0123456789abcdef-100.cache")];
+    snprintf(name, sizeof(name), "tranmap-%016llx-%d.cache", (unsigned long long)palette_hash, (int)pct);
+    return doom_sys_cache_path(name);
+}
+
+bool s_load_cache(doom_video_tranmap_t* tranmap, const char* path, int32_t pct, uint64_t palette_hash) {
+    if (!doom_sys_map_file(&tranmap->mapped, path)) {
+        return false;
+    }
+    s_cache_header_t header = {0};
+    if (tranmap->mapped.size >= sizeof(header)) {
+        memcpy(&header, tranmap->mapped.data, sizeof(header));
+    }
+    bool valid = header.magic == sc_cache_magic && header.version == doom_video_tranmap_cache_version &&
+                 header.pct == pct && header.palette_hash == palette_hash &&
+                 tranmap->mapped.size == sizeof(header) + doom_video_tranmap_size;
+    if (!valid) {
+        doom_sys_unmap_file(&tranmap->mapped);
+        return false;
+    }
+    // The table is used where it's mapped.
+    tranmap->table = (const uint8_t*)tranmap->mapped.data + sizeof(header);
+    return true;
+}
+
+bool s_save_cache(const char* path, const uint8_t* table, int32_t pct, uint64_t palette_hash) {
+    // Written aside and renamed over the cache, so another instance that has the old one mapped keeps a whole table.
+    doom_sys_mapped_file_t mapped;
+    if (!doom_sys_map_file_replace(&mapped, path, sizeof(s_cache_header_t) + doom_video_tranmap_size)) {
+        return false;
+    }
+    s_cache_header_t header = {
+        .magic = sc_cache_magic,
+        .version = doom_video_tranmap_cache_version,
+        .pct = pct,
+        .palette_hash = palette_hash,
+    };
+    memcpy((uint8_t*)mapped.data + sizeof(header), table, doom_video_tranmap_size);
+    // The header goes last, so a cache that was cut short doesn't match.
+    memcpy(mapped.data, &header, sizeof(header));
+    return doom_sys_map_file_replace_commit(&mapped, path);
+}
+
+void s_job(void* userdata) {
+    s_generation_t* generation = userdata;
+    s_generate_rows(generation);
+    mtx_lock(&generation->mutex);
+    generation->jobs_outstanding--;
+    cnd_broadcast(&generation->finished);
+    mtx_unlock(&generation->mutex);
+}
+
+void s_generate_rows(s_generation_t* generation) {
+    const uint8_t* rgb = generation->palette->rgb;
+    int32_t foreground_weight = generation->foreground_weight;
+    int32_t background_weight = (1 << weight_bits) - foreground_weight;
+    int32_t round = 1 << (weight_bits - 1);
+    for (;;) {
+        size_t first = atomic_fetch_add_explicit(&generation->next_row, rows_per_claim, memory_order_relaxed);
+        if (first >= doom_video_palette_colors) {
+            return;
+        }
+        size_t end = first + rows_per_claim < doom_video_palette_colors ? first + rows_per_claim
+                                                                        : doom_video_palette_colors;
+        for (size_t background = first; background < end; background++) {
+            int32_t red = rgb[3 * background] * background_weight + round;
+            int32_t green = rgb[3 * background + 1] * background_weight + round;
+            int32_t blue = rgb[3 * background + 2] * background_weight + round;
+            uint8_t* row = generation->table + background * doom_video_palette_colors;
+            for (size_t foreground = 0; foreground < doom_video_palette_colors; foreground++) {
+                row[foreground] = generation->nearest(
+                    generation->palette, (red + rgb[3 * foreground] * foreground_weight) >> weight_bits,
+                    (green + rgb[3 * foreground + 1] * foreground_weight) >> weight_bits,
+                    (blue + rgb[3 * foreground + 2] * foreground_weight) >> weight_bits);
+            }
+        }
+    }
+}
@@ -0,0 +1,294 @@
+#include "doom/wad/cache.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/misc/argv.h"
+#include "doom/state.h"
+
+#include <nonstd/alloc.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <threads.h>
+
+enum
+{
+    min_entry_capacity = 256,
+    min_bucket_count = 256,
+};
+
+static const uint32_t sc_no_entry = UINT32_MAX;
+
+static uint64_t s_key(int32_t lump, uint32_t variant);
+static size_t s_bucket(const doom_wad_cache_t* cache, uint64_t key);
+static uint32_t s_lookup(const doom_wad_cache_t* cache, uint64_t key);
+static uint32_t s_add(doom_wad_cache_t* cache, uint64_t key, void* data, size_t size);
+static void s_grow_entries(doom_wad_cache_t* cache);
+static void s_rehash(doom_wad_cache_t* cache, size_t bucket_count);
+static void s_remove(doom_wad_cache_t* cache, uint32_t index);
+static void s_evict(doom_wad_cache_t* cache);
+
+void doom_wad_cache_init(void) {
+    doom_wad_cache_t* cache = &doom_state->lump_cache;
+    size_t budget_mib = doom_wad_cache_default_budget_mib;
+    char* argument = doom_misc_parameter_argument("-resourcemem");
+    if (argument != NULL) {
+        long mib = strtol(argument, NULL, 10);
+        if (mib > 0) {
+            budget_mib = (size_t)mib;
+        } else {
+            DOOM_LOG(wad, warn, "Ignoring bad -resourcemem value %s.\n", argument);
+        }
+        nonstd_free(argument);
+    }
+
+    *cache = (doom_wad_cache_t){
+        .free_entry = sc_no_entry,
+        .stats = {.budget = budget_mib * 1024 * 1024},
+    };
+    if (mtx_init(&cache->mutex, mtx_plain) != thrd_success) {
+        doom_log_error("Could not create the resource cache lock");
+    }
+    cache->initialized = true;
+}
+
+void doom_wad_cache_destroy(doom_wad_cache_t* cache) {
+    if (!cache->initialized) {
+        return;
+    }
+    DOOM_LOG(wad, debug,
+             "Resource cache: %llu hits, %llu misses, %llu evictions, %zu resources in %zu of %zu bytes.\n",
+             (unsigned long long)cache->stats.hits, (unsigned long long)cache->stats.misses,
+             (unsigned long long)cache->stats.evictions, cache->stats.entries, cache->stats.bytes,
+             cache->stats.budget);
+    for (size_t i = 0; i < cache->entry_capacity; i++) {
+        nonstd_free(cache->entries[i].data);
+    }
+    nonstd_free(cache->entries);
+    nonstd_free(cache->buckets);
+    mtx_destroy(&cache->mutex);
+    *cache = (doom_wad_cache_t){0};
+}
+
+const void* doom_wad_cache_get(int32_t lump, uint32_t variant, doom_wad_cache_decode_t decode, void* userdata,
+                               size_t* size) {
+    const void* found = doom_wad_cache_find(lump, variant, size);
+    if (found != NULL) {
+        return found;
+    }
+
+    size_t decoded_size = 0;
+    void* decoded = decode(lump, variant, &decoded_size, userdata);
+    if (decoded == NULL) {
+        return NULL;
+    }
+
+    doom_wad_cache_t* cache = &doom_state->lump_cache;
+    uint64_t key = s_key(lump, variant);
+    mtx_lock(&cache->mutex);
+    uint32_t index = s_lookup(cache, key);
+    if (index != sc_no_entry) {
+        // Someone else decoded it first.
+        nonstd_free(decoded);
+    } else {
+        index = s_add(cache, key, decoded, decoded_size);
+    }
+    doom_wad_cache_entry_t* entry = &cache->entries[index];
+    entry->pins++;
+    entry->referenced = true;
+    s_evict(cache);
+    const void* data = entry->data;
+    if (size != NULL) {
+        *size = entry->size;
+    }
+    mtx_unlock(&cache->mutex);
+    return data;
+}
+
+const void* doom_wad_cache_find(int32_t lump, uint32_t variant, size_t* size) {
+    doom_wad_cache_t* cache = &doom_state->lump_cache;
+    mtx_lock(&cache->mutex);
+    uint32_t index = s_lookup(cache, s_key(lump, variant));
+    if (index == sc_no_entry) {
+        cache->stats.misses++;
+        mtx_unlock(&cache->mutex);
+        return NULL;
+    }
+    cache->stats.hits++;
+    doom_wad_cache_entry_t* entry = &cache->entries[index];
+    entry->pins++;
+    entry->referenced = true;
+    const void* data = entry->data;
+    if (size != NULL) {
+        *size = entry->size;
+    }
+    mtx_unlock(&cache->mutex);
+    return data;
+}
+
+bool doom_wad_cache_contains(int32_t lump, uint32_t variant) {
+    doom_wad_cache_t* cache = &doom_state->lump_cache;
+    mtx_lock(&cache->mutex);
+    bool contains = s_lookup(cache, s_key(lump, variant)) != sc_no_entry;
+    mtx_unlock(&cache->mutex);
+    return contains;
+}
+
+void doom_wad_cache_insert(int32_t lump, uint32_t variant, void* data, size_t size) {
+    doom_wad_cache_t* cache = &doom_state->lump_cache;
+    uint64_t key = s_key(lump, variant);
+    mtx_lock(&cache->mutex);
+    if (s_lookup(cache, key) != sc_no_entry) {
+        mtx_unlock(&cache->mutex);
+        nonstd_free(data);
+        return;
+    }
+    uint32_t index = s_add(cache, key, data, size);
+    // Give it one pass of the hand, so it isn't the first to go before anyone had a chance to use it.
+    cache->entries[index].referenced = true;
+    s_evict(cache);
+    mtx_unlock(&cache->mutex);
+}
+
+void doom_wad_cache_release(int32_t lump, uint32_t variant) {
+    doom_wad_cache_t* cache = &doom_state->lump_cache;
+    mtx_lock(&cache->mutex);
+    uint32_t index = s_lookup(cache, s_key(lump, variant));
+    if (index == sc_no_entry || cache->entries[index].pins == 0) {
+        mtx_unlock(&cache->mutex);
+        doom_log_error("Released resource %d/%u, which isn't pinned", lump, variant);
+    }
+    if (--cache->entries[index].pins == 0) {
+        // It may have been kept over the budget only because it was pinned.
+        s_evict(cache);
+    }
+    mtx_unlock(&cache->mutex);
+}
+
+void doom_wad_cache_set_budget(size_t bytes) {
+    doom_wad_cache_t* cache = &doom_state->lump_cache;
+    mtx_lock(&cache->mutex);
+    cache->stats.budget = bytes;
+    s_evict(cache);
+    mtx_unlock(&cache->mutex);
+}
+
+doom_wad_cache_stats_t doom_wad_cache_stats(void) {
+    doom_wad_cache_t* cache = &doom_state->lump_cache;
+    mtx_lock(&cache->mutex);
+    doom_wad_cache_stats_t stats = cache->stats;
+    mtx_unlock(&cache->mutex);
+    return stats;
+}
+
+uint64_t s_key(int32_t lump, uint32_t variant) {
+    return (uint64_t)(uint32_t)lump << 32 | variant;
+}
+
+size_t s_bucket(const doom_wad_cache_t* cache, uint64_t key) {
+    return (size_t)((key * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & (cache->bucket_count - 1);
+}
+
+uint32_t s_lookup(const doom_wad_cache_t* cache, uint64_t key) {
+    if (cache->bucket_count == 0) {
+        return sc_no_entry;
+    }
+    for (uint32_t index = cache->buckets[s_bucket(cache, key)]; index != sc_no_entry;
+         index = cache->entries[index].next) {
+        if (cache->entries[index].key == key) {
+            return index;
+        }
+    }
+    return sc_no_entry;
+}
+
+uint32_t s_add(doom_wad_cache_t* cache, uint64_t key, void* data, size_t size) {
+    if (cache->free_entry == sc_no_entry) {
+        s_grow_entries(cache);
+    }
+    if (cache->stats.entries + 1 > cache->bucket_count) {
+        s_rehash(cache, cache->bucket_count == 0 ? min_bucket_count : cache->bucket_count * 2);
+    }
+
+    uint32_t index = cache->free_entry;
+    doom_wad_cache_entry_t* entry = &cache->entries[index];
+    cache->free_entry = entry->next;
+
+    size_t bucket = s_bucket(cache, key);
+    *entry = (doom_wad_cache_entry_t){
+        .key = key,
+        .data = data,
+        .size = size,
+        .next = cache->buckets[bucket],
+    };
+    cache->buckets[bucket] = index;
+    cache->stats.entries++;
+    cache->stats.bytes += size;
+    return index;
+}
+
+void s_grow_entries(doom_wad_cache_t* cache) {
+    size_t old_capacity = cache->entry_capacity;
+    size_t capacity = old_capacity == 0 ? min_entry_capacity : old_capacity * 2;
+    cache->entries =
+        nonstd_realloc(cache->entries, capacity * sizeof(doom_wad_cache_entry_t), nonstd_alloc_tag_resource);
+    // Chain the new entries onto the free list, lowest index first.
+    for (size_t i = capacity; i-- > old_capacity;) {
+        cache->entries[i] = (doom_wad_cache_entry_t){.next = cache->free_entry};
+        cache->free_entry = (uint32_t)i;
+    }
+    cache->entry_capacity = capacity;
+}
+
+void s_rehash(doom_wad_cache_t* cache, size_t bucket_count) {
+    nonstd_free(cache->buckets);
+    cache->buckets = nonstd_malloc(bucket_count * sizeof(uint32_t), nonstd_alloc_tag_resource);
+    cache->bucket_count = bucket_count;
+    for (size_t i = 0; i < bucket_count; i++) {
+        cache->buckets[i] = sc_no_entry;
+    }
+    for (size_t i = 0; i < cache->entry_capacity; i++) {
+        doom_wad_cache_entry_t* entry = &cache->entries[i];
+        if (entry->data == NULL) {
+            continue;
+        }
+        size_t bucket = s_bucket(cache, entry->key);
+        entry->next = cache->buckets[bucket];
+        cache->buckets[bucket] = (uint32_t)i;
+    }
+}
+
+void s_remove(doom_wad_cache_t* cache, uint32_t index) {
+    doom_wad_cache_entry_t* entry = &cache->entries[index];
+    uint32_t* link = &cache->buckets[s_bucket(cache, entry->key)];
+    while (*link != index) {
+        link = &cache->entries[*link].next;
+    }
+    *link = entry->next;
+
+    cache->stats.entries--;
+    cache->stats.bytes -= entry->size;
+    nonstd_free(entry->data);
+    *entry = (doom_wad_cache_entry_t){.next = cache->free_entry};
+    cache->free_entry = index;
+}
+
+void s_evict(doom_wad_cache_t* cache) {
+    // Two full turns are enough: the first clears every reference bit, the second evicts whatever is unpinned.
+    size_t steps = cache->entry_capacity * 2;
+    while (cache->stats.bytes > cache->stats.budget && steps-- > 0) {
+        doom_wad_cache_entry_t* entry = &cache->entries[cache->hand];
+        uint32_t index = (uint32_t)cache->hand;
+        cache->hand = (cache->hand + 1) % cache->entry_capacity;
+        if (entry->data == NULL || entry->pins > 0) {
+            continue;
+        }
+        if (entry->referenced) {
+            entry->referenced = false;
+            continue;
+        }
+        s_remove(cache, index);
+        cache->stats.evictions++;
+    }
+}
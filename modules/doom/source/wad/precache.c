@@ -0,0 +1,262 @@
+#include "doom/wad/precache.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/state.h"
+#include "doom/sys/bench.h"
+#include "doom/sys/clock.h"
+#include "doom/sys/jobs.h"
+#include "doom/wad/cache.h"
+#include "doom/wad/texture.h"
+#include "doom/wad/wad.h"
+
+#include <nonstd/alloc.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <threads.h>
+
+enum
+{
+    // The lumps that may follow a map marker: THINGS, LINEDEFS, SIDEDEFS, VERTEXES, SEGS, SSECTORS, NODES, SECTORS,
+    // REJECT and BLOCKMAP.
+    map_lump_count = 10,
+    // xoffset, yoffset, upper, lower and middle texture, sector.
+    sidedef_size = 30,
+    // floor and ceiling height, floor and ceiling flat, light level, special, tag.
+    sector_size = 26,
+    page_size = 4096,
+};
+
+static bool s_collect(doom_wad_precache_t* precache, const char* map);
+static int32_t s_find_map_lump(int32_t marker, const char* name);
+static void s_add_item(doom_wad_precache_t* precache, bool* seen, doom_wad_precache_kind_t kind, int32_t index);
+static void s_precache_item(const doom_wad_precache_item_t* item);
+static void s_job(void* userdata);
+static void s_clear_cache(void);
+
+size_t doom_wad_precache_level(const char* map) {
+    doom_wad_precache_t* precache = &doom_state->precache;
+    if (!precache->initialized) {
+        if (mtx_init(&precache->mutex, mtx_plain) != thrd_success || cnd_init(&precache->finished) != thrd_success) {
+            doom_log_error("Could not create the synchronization objects of the precache");
+        }
+        precache->initialized = true;
+    }
+    doom_wad_precache_stop();
+    doom_wad_precache_wait();
+    precache->item_count = 0;
+
+    if (!doom_state->defaults_storage.level_precache || !s_collect(precache, map)) {
+        return 0;
+    }
+
+    atomic_store(&precache->next, 0);
+    atomic_store(&precache->stopping, false);
+    // With no workers, the one job runs right here as it's submitted, so the level is still precached.
+    size_t jobs = doom_sys_jobs_worker_count();
+    if (jobs == 0) {
+        jobs = 1;
+    }
+    if (jobs > precache->item_count) {
+        jobs = precache->item_count;
+    }
+    mtx_lock(&precache->mutex);
+    precache->jobs_outstanding = jobs;
+    mtx_unlock(&precache->mutex);
+    DOOM_LOG(wad, debug, "Precaching %zu resources of %s in %zu jobs.\n", precache->item_count, map, jobs);
+    // Each job keeps taking items until there are none left, so one per worker is enough.
+    for (size_t i = 0; i < jobs; i++) {
+        doom_sys_jobs_submit(s_job, doom_state);
+    }
+    return precache->item_count;
+}
+
+void doom_wad_precache_stop(void) {
+    atomic_store(&doom_state->precache.stopping, true);
+}
+
+void doom_wad_precache_wait(void) {
+    doom_wad_precache_t* precache = &doom_state->precache;
+    if (!precache->initialized) {
+        return;
+    }
+    doom_sys_jobs_wait(&precache->jobs_outstanding, &precache->mutex, &precache->finished);
+}
+
+void doom_wad_precache_destroy(doom_wad_precache_t* precache) {
+    if (precache->initialized) {
+        atomic_store(&precache->stopping, true);
+        doom_sys_jobs_wait(&precache->jobs_outstanding, &precache->mutex, &precache->finished);
+        cnd_destroy(&precache->finished);
+        mtx_destroy(&precache->mutex);
+    }
+    nonstd_free(precache->items);
+    *precache = (doom_wad_precache_t){0};
+}
+
+void doom_wad_precache_bench(const char* map) {
+    doom_wad_precache_t* precache = &doom_state->precache;
+    bool level_precache = doom_state->defaults_storage.level_precache;
+    doom_state->defaults_storage.level_precache = true;
+
+    doom_sys_bench_t bench = doom_sys_bench_new("precache");
+    size_t collect_series = doom_sys_bench_series(&bench, "collect");
+    size_t background_series = doom_sys_bench_series(&bench, "background");
+    size_t on_demand_series = doom_sys_bench_series(&bench, "on_demand");
+
+    size_t items = 0;
+    for (size_t iteration = 0; iteration < doom_wad_precache_bench_iterations; iteration++) {
+        // From a cold cache, the workers precache everything...
+        s_clear_cache();
+        uint64_t start = doom_sys_clock_ns();
+        items = doom_wad_precache_level(map);
+        uint64_t collected = doom_sys_clock_ns();
+        doom_wad_precache_wait();
+        uint64_t finished = doom_sys_clock_ns();
+        doom_sys_bench_record(&bench, collect_series, collected - start);
+        doom_sys_bench_record(&bench, background_series, finished - collected);
+
+        // ...or the main thread decodes everything the first time it's needed.
+        s_clear_cache();
+        start = doom_sys_clock_ns();
+        for (size_t i = 0; i < precache->item_count; i++) {
+            s_precache_item(&precache->items[i]);
+        }
+        doom_sys_bench_record(&bench, on_demand_series, doom_sys_clock_ns() - start);
+    }
+    bench.iterations = doom_wad_precache_bench_iterations;
+    doom_state->defaults_storage.level_precache = level_precache;
+
+    doom_log_printf(doom_log_level_info, "%s: %zu resources, %zu workers\n", map, items,
+                    doom_sys_jobs_worker_count());
+    doom_sys_bench_report(&bench);
+    char* json_path = doom_sys_bench_json_path("benchprecache.json");
+    if (doom_sys_bench_write_json(&bench, json_path)) {
+        doom_log_printf(doom_log_level_info, "Wrote %s.\n", json_path);
+    } else {
+        DOOM_LOG(wad, warn, "Could not write %s.\n", json_path);
+    }
+    nonstd_free(json_path);
+    doom_sys_bench_free(&bench);
+}
+
+bool s_collect(doom_wad_precache_t* precache, const char* map) {
+    int32_t marker = doom_wad_find(map);
+    if (marker < 0) {
+        DOOM_LOG(wad, warn, "Can't precache %s: no such map.\n", map);
+        return false;
+    }
+
+    size_t texture_count = doom_state->textures.texture_count;
+    size_t lump_count = doom_wad_lump_count();
+    bool* seen = nonstd_calloc(texture_count + lump_count + 1, sizeof(bool), nonstd_alloc_tag_wad);
+
+    int32_t sidedefs = s_find_map_lump(marker, "SIDEDEFS");
+    if (sidedefs >= 0) {
+        doom_wad_lump_data_t data = doom_wad_lump_data(sidedefs);
+        for (size_t offset = 0; offset + sidedef_size <= data.size; offset += sidedef_size) {
+            // The upper, lower and middle textures.
+            for (size_t name = 4; name <= 20; name += 8) {
+                int32_t texture = doom_wad_texture_find((const char*)data.begin + offset + name);
+                if (texture >= 0) {
+                    s_add_item(precache, seen, doom_wad_precache_kind_texture, texture);
+                }
+            }
+        }
+    }
+
+    int32_t sectors = s_find_map_lump(marker, "SECTORS");
+    if (sectors >= 0) {
+        doom_wad_lump_data_t data = doom_wad_lump_data(sectors);
+        for (size_t offset = 0; offset + sector_size <= data.size; offset += sector_size) {
+            // The floor and ceiling flats.
+            for (size_t name = 4; name <= 12; name += 8) {
+                int32_t flat = doom_wad_find_flat((const char*)data.begin + offset + name);
+                if (flat >= 0) {
+                    s_add_item(precache, seen + texture_count, doom_wad_precache_kind_flat, flat);
+                }
+            }
+        }
+    }
+
+    nonstd_free(seen);
+    return precache->item_count > 0;
+}
+
+int32_t s_find_map_lump(int32_t marker, const char* name) {
+    const doom_wad_state_t* wad = &doom_state->wad;
+    uint64_t key = doom_wad_name_key(name);
+    // The map lumps follow the marker in the same WAD.
+    const doom_wad_file_t* file = &wad->files[wad->lumps[marker].file];
+    size_t end = (size_t)file->first_lump + file->lump_count;
+    for (size_t lump = (size_t)marker + 1; lump < end && lump <= (size_t)marker + map_lump_count; lump++) {
+        if (wad->lumps[lump].key == key) {
+            return (int32_t)lump;
+        }
+    }
+    return -1;
+}
+
+void s_add_item(doom_wad_precache_t* precache, bool* seen, doom_wad_precache_kind_t kind, int32_t index) {
+    if (seen[index]) {
+        return;
+    }
+    seen[index] = true;
+    if (precache->item_count == precache->item_capacity) {
+        precache->item_capacity = precache->item_capacity == 0 ? 256 : precache->item_capacity * 2;
+        precache->items = nonstd_realloc(precache->items, precache->item_capacity * sizeof(doom_wad_precache_item_t),
+                                         nonstd_alloc_tag_wad);
+    }
+    precache->items[precache->item_count++] = (doom_wad_precache_item_t){.kind = kind, .index = index};
+}
+
+void s_precache_item(const doom_wad_precache_item_t* item) {
+    switch (item->kind) {
+        case doom_wad_precache_kind_texture:
+            if (!doom_wad_cache_contains(item->index, doom_wad_texture_cache_variant)) {
+                size_t size;
+                doom_wad_composite_t* composite = doom_wad_texture_composite(item->index, &size);
+                doom_wad_cache_insert(item->index, doom_wad_texture_cache_variant, composite, size);
+            }
+            break;
+        case doom_wad_precache_kind_flat: {
+            // Flats are drawn straight from the mapping, so there's nothing to decode; reading a byte of each page
+            // faults it in now rather than on first sight.
+            doom_wad_lump_data_t data = doom_wad_lump_data(item->index);
+            volatile uint8_t sink = 0;
+            for (size_t offset = 0; offset < data.size; offset += page_size) {
+                sink ^= data.begin[offset];
+            }
+            (void)sink;
+            break;
+        }
+    }
+}
+
+void s_job(void* userdata) {
+    doom_state_t* previous = doom_state;
+    doom_state = userdata;
+    doom_wad_precache_t* precache = &doom_state->precache;
+
+    while (!atomic_load_explicit(&precache->stopping, memory_order_relaxed)) {
+        size_t index = atomic_fetch_add_explicit(&precache->next, 1, memory_order_relaxed);
+        if (index >= precache->item_count) {
+            break;
+        }
+        s_precache_item(&precache->items[index]);
+    }
+
+    mtx_lock(&precache->mutex);
+    precache->jobs_outstanding--;
+    cnd_broadcast(&precache->finished);
+    mtx_unlock(&precache->mutex);
+    doom_state = previous;
+}
+
+void s_clear_cache(void) {
+    size_t budget = doom_wad_cache_stats().budget;
+    doom_wad_cache_set_budget(0);
+    doom_wad_cache_set_budget(budget);
+}
@@ -0,0 +1,228 @@
+#include "doom/wad/texture.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/state.h"
+#include "doom/wad/cache.h"
+#include "doom/wad/wad.h"
+
+#include <nonstd/alloc.h>
+#include <nonstd/qsort.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+    // name[8], masked, width, height, columndirectory, patchcount.
+    texture_header_size = 22,
+    // originx, originy, patch, stepdir, colormap.
+    texture_patch_size = 10,
+    // width, height, leftoffset, topoffset.
+    patch_header_size = 8,
+};
+
+static uint32_t s_read_le32(const uint8_t* bytes);
+static int16_t s_read_le16(const uint8_t* bytes);
+static void s_add_textures(doom_wad_textures_t* textures, const char* lump_name);
+static int s_compare_by_name(const void* a, const void* b, void* userdata);
+static void s_draw_patch(doom_wad_composite_t* composite, int32_t lump, int32_t origin_x, int32_t origin_y);
+static void* s_decode(int32_t lump, uint32_t variant, size_t* size, void* userdata);
+
+void doom_wad_textures_init(void) {
+    doom_wad_textures_t* textures = &doom_state->textures;
+    int32_t pnames = doom_wad_find("PNAMES");
+    if (pnames < 0) {
+        return;
+    }
+
+    doom_wad_lump_data_t names = doom_wad_lump_data(pnames);
+    size_t patch_count = names.size >= 4 ? s_read_le32(names.begin) : 0;
+    if (names.size < 4 || patch_count > (names.size - 4) / doom_wad_lump_name_length) {
+        DOOM_LOG(wad, warn, "PNAMES is truncated.\n");
+        patch_count = names.size >= 4 ? (names.size - 4) / doom_wad_lump_name_length : 0;
+    }
+    textures->patch_lumps = nonstd_malloc((patch_count + 1) * sizeof(int32_t), nonstd_alloc_tag_wad);
+    textures->patch_count = patch_count;
+    for (size_t i = 0; i < patch_count; i++) {
+        textures->patch_lumps[i] = doom_wad_find((const char*)names.begin + 4 + i * doom_wad_lump_name_length);
+    }
+
+    s_add_textures(textures, "TEXTURE1");
+    s_add_textures(textures, "TEXTURE2");
+
+    textures->by_name = nonstd_malloc((textures->texture_count + 1) * sizeof(uint32_t), nonstd_alloc_tag_wad);
+    for (size_t i = 0; i < textures->texture_count; i++) {
+        textures->by_name[i] = (uint32_t)i;
+    }
+    nonstd_qsort_r(textures->by_name, textures->texture_count, sizeof(uint32_t), s_compare_by_name, textures);
+    DOOM_LOG(wad, debug, "Indexed %zu textures and %zu patches.\n", textures->texture_count, patch_count);
+}
+
+void doom_wad_textures_destroy(doom_wad_textures_t* textures) {
+    nonstd_free(textures->textures);
+    nonstd_free(textures->by_name);
+    nonstd_free(textures->patch_lumps);
+    *textures = (doom_wad_textures_t){0};
+}
+
+int32_t doom_wad_texture_find(const char* name) {
+    if (name[0] == '-') {
+        return -1;
+    }
+    const doom_wad_textures_t* textures = &doom_state->textures;
+    uint64_t key = doom_wad_name_key(name);
+
+    // Find the last texture with the name, so TEXTURE2 overrides TEXTURE1 like PWAD lumps override IWAD lumps.
+    size_t low = 0;
+    size_t high = textures->texture_count;
+    while (low < high) {
+        size_t middle = low + (high - low) / 2;
+        if (textures->textures[textures->by_name[middle]].key <= key) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if (low == 0 || textures->textures[textures->by_name[low - 1]].key != key) {
+        return -1;
+    }
+    return (int32_t)textures->by_name[low - 1];
+}
+
+doom_wad_composite_t* doom_wad_texture_composite(int32_t texture, size_t* size) {
+    const doom_wad_texture_t* t = &doom_state->textures.textures[texture];
+    size_t pixel_count = (size_t)t->width * (size_t)t->height;
+    *size = sizeof(doom_wad_composite_t) + pixel_count;
+    doom_wad_composite_t* composite = nonstd_calloc(1, *size, nonstd_alloc_tag_resource);
+    composite->width = t->width;
+    composite->height = t->height;
+
+    size_t patch_count = (size_t)s_read_le16(t->definition + 20);
+    for (size_t i = 0; i < patch_count; i++) {
+        const uint8_t* patch = t->definition + texture_header_size + i * texture_patch_size;
+        int16_t patch_index = s_read_le16(patch + 4);
+        if (patch_index < 0 || (size_t)patch_index >= doom_state->textures.patch_count ||
+            doom_state->textures.patch_lumps[patch_index] < 0) {
+            continue;
+        }
+        s_draw_patch(composite, doom_state->textures.patch_lumps[patch_index], s_read_le16(patch),
+                     s_read_le16(patch + 2));
+    }
+    return composite;
+}
+
+const doom_wad_composite_t* doom_wad_texture_get(int32_t texture) {
+    return doom_wad_cache_get(texture, doom_wad_texture_cache_variant, s_decode, NULL, NULL);
+}
+
+void doom_wad_texture_release(int32_t texture) {
+    doom_wad_cache_release(texture, doom_wad_texture_cache_variant);
+}
+
+uint32_t s_read_le32(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+int16_t s_read_le16(const uint8_t* bytes) {
+    return (int16_t)((uint16_t)bytes[0] | (uint16_t)bytes[1] << 8);
+}
+
+void s_add_textures(doom_wad_textures_t* textures, const char* lump_name) {
+    int32_t lump = doom_wad_find(lump_name);
+    if (lump < 0) {
+        return;
+    }
+    doom_wad_lump_data_t data = doom_wad_lump_data(lump);
+    size_t count = data.size >= 4 ? s_read_le32(data.begin) : 0;
+    if (data.size < 4 || count > (data.size - 4) / 4) {
+        DOOM_LOG(wad, warn, "%s is truncated.\n", lump_name);
+        return;
+    }
+
+    size_t capacity = textures->texture_count + count;
+    textures->textures =
+        nonstd_realloc(textures->textures, capacity * sizeof(doom_wad_texture_t), nonstd_alloc_tag_wad);
+    for (size_t i = 0; i < count; i++) {
+        uint32_t offset = s_read_le32(data.begin + 4 + i * 4);
+        if (offset > data.size || data.size - offset < texture_header_size) {
+            DOOM_LOG(wad, warn, "Texture %zu of %s is out of bounds.\n", i, lump_name);
+            continue;
+        }
+        const uint8_t* definition = data.begin + offset;
+        int16_t width = s_read_le16(definition + 12);
+        int16_t height = s_read_le16(definition + 14);
+        int16_t patch_count = s_read_le16(definition + 20);
+        if (width <= 0 || height <= 0 || patch_count < 0 ||
+            (size_t)patch_count > (data.size - offset - texture_header_size) / texture_patch_size) {
+            DOOM_LOG(wad, warn, "Texture %.8s of %s is malformed.\n", (const char*)definition, lump_name);
+            continue;
+        }
+        textures->textures[textures->texture_count++] = (doom_wad_texture_t){
+            .key = doom_wad_name_key((const char*)definition),
+            .definition = definition,
+            .definition_size = texture_header_size + (size_t)patch_count * texture_patch_size,
+            .width = width,
+            .height = height,
+        };
+    }
+}
+
+int s_compare_by_name(const void* a, const void* b, void* userdata) {
+    const doom_wad_textures_t* textures = userdata;
+    uint32_t left = *(const uint32_t*)a;
+    uint32_t right = *(const uint32_t*)b;
+    uint64_t left_key = textures->textures[left].key;
+    uint64_t right_key = textures->textures[right].key;
+    if (left_key != right_key) {
+        return left_key < right_key ? -1 : 1;
+    }
+    // Keep equal names in definition order, so the last one is found.
+    return left < right ? -1 : left > right;
+}
+
+void s_draw_patch(doom_wad_composite_t* composite, int32_t lump, int32_t origin_x, int32_t origin_y) {
+    doom_wad_lump_data_t patch = doom_wad_lump_data(lump);
+    if (patch.size < patch_header_size) {
+        return;
+    }
+    int32_t width = s_read_le16(patch.begin);
+    if (width <= 0 || (size_t)width > (patch.size - patch_header_size) / 4) {
+        return;
+    }
+
+    int32_t first = origin_x < 0 ? -origin_x : 0;
+    int32_t last = composite->width - origin_x < width ? composite->width - origin_x : width;
+    for (int32_t x = first; x < last; x++) {
+        uint8_t* column = composite->pixels + (size_t)(origin_x + x) * (size_t)composite->height;
+        size_t offset = s_read_le32(patch.begin + patch_header_size + (size_t)x * 4);
+        int32_t top = -1;
+        // Each post is: top delta, length, a padding byte, the pixels and another padding byte. 0xFF ends the column.
+        while (offset < patch.size && patch.begin[offset] != 0xFF) {
+            if (patch.size - offset < 4) {
+                break;
+            }
+            int32_t delta = patch.begin[offset];
+            // Tall patches (DeePsea): a delta that doesn't move down is relative to the previous post.
+            top = delta <= top ? top + delta : delta;
+            size_t length = patch.begin[offset + 1];
+            if (patch.size - offset - 3 < length) {
+                break;
+            }
+            const uint8_t* source = patch.begin + offset + 3;
+            for (size_t i = 0; i < length; i++) {
+                int32_t y = origin_y + top + (int32_t)i;
+                if (y >= 0 && y < composite->height) {
+                    column[y] = source[i];
+                }
+            }
+            offset += length + 4;
+        }
+    }
+}
+
+void* s_decode(int32_t lump, uint32_t variant, size_t* size, void* userdata) {
+    (void)variant;
+    (void)userdata;
+    return doom_wad_texture_composite(lump, size);
+}
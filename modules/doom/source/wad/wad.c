@@ -0,0 +1,521 @@
+#include "doom/wad/wad.h"
+
+#include "doom/init.h"
+#include "doom/log/printf.h"
+#include "doom/misc/argv.h"
+#include "doom/state.h"
+#include "doom/sys/inflate.h"
+#include "doom/sys/mapped_file.h"
+
+#include <nonstd/alloc.h>
+#include <nonstd/ctype.h>
+#include <nonstd/strdup.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+enum
+{
+    min_hash_capacity = 1024,
+    // The fixed part of the zip records, before their variable-length fields.
+    zip_end_size = 22,
+    zip_central_header_size = 46,
+    zip_local_header_size = 30,
+    // The end of central directory is followed by a comment of at most this size.
+    zip_max_comment_size = 0xFFFF,
+    zip_method_stored = 0,
+    zip_method_deflated = 8,
+    zip_flag_encrypted = 1,
+    // DEFLATE can't do better than 1032 to 1, so a larger claimed size is a lie meant to make us allocate.
+    zip_max_inflate_ratio = 1032,
+    // Far beyond any real lump; the rest of the engine can't cope with anything near this anyway.
+    zip_max_inflated_size = 256 * 1024 * 1024,
+};
+
+static const uint32_t sc_empty_slot = UINT32_MAX;
+static const uint32_t sc_zip_end_signature = 0x06054B50;
+static const uint32_t sc_zip_central_signature = 0x02014B50;
+static const uint32_t sc_zip_local_signature = 0x04034B50;
+
+static bool s_mount_wad(const doom_sys_mapped_file_t* mapped, const char* path);
+static bool s_mount_zip(const doom_sys_mapped_file_t* mapped, const char* path);
+static uint32_t s_add_file(const doom_sys_mapped_file_t* mapped, const char* path, doom_wad_format_t format,
+                           size_t lump_count);
+static void s_add_lump(uint32_t file, uint64_t key, const uint8_t* entry, bool flat);
+static bool s_zip_lump_name(const uint8_t* header, char name[doom_wad_lump_name_length + 1]);
+static bool s_zip_in_flats(const uint8_t* header);
+static doom_wad_lump_data_t s_zip_lump_data(const doom_wad_file_t* file, const uint8_t* header, uint32_t index);
+static uint16_t s_read_le16(const uint8_t* bytes);
+static uint32_t s_read_le32(const uint8_t* bytes);
+static size_t s_hash_slot(uint64_t key, size_t capacity);
+static void s_hash_insert(doom_wad_state_t* wad, uint32_t lump);
+static void s_hash_reserve(doom_wad_state_t* wad, size_t lump_count);
+
+void doom_wad_init(void) {
+    char* iwad = doom_misc_parameter_argument("-iwad");
+    if (iwad != NULL) {
+        if (!doom_wad_mount(iwad)) {
+            // Freed first, since the error may only end this instance rather than the process.
+            char message[doom_log_max_message_length];
+            snprintf(message, sizeof(message), "Could not mount the IWAD %s", iwad);
+            nonstd_free(iwad);
+            doom_log_error("%s", message);
+        }
+        nonstd_free(iwad);
+    }
+
+    // wad_files[0] is the IWAD in the config format, which has no setting of its own.
+    for (size_t i = 1; i < doom_maxloadfiles; i++) {
+        phyto_string_span_t path = doom_state->defaults_storage.wad_files[i];
+        if (path.size == 0) {
+            continue;
+        }
+        char* path_c = nonstd_strndup(path.begin, path.size);
+        doom_wad_mount(path_c);
+        nonstd_free(path_c);
+    }
+
+    int32_t file_index = doom_misc_check_parameter("-file");
+    if (file_index > 0) {
+        doom_misc_parameters_t params = doom_state->params;
+        // Every argument up to the next parameter is a file.
+        for (size_t i = (size_t)file_index + 1;
+             i < params.size && params.data[i].size > 0 && params.data[i].data[0] != '-'; i++) {
+            char* path_c = nonstd_strndup(params.data[i].data, params.data[i].size);
+            doom_wad_mount(path_c);
+            nonstd_free(path_c);
+        }
+    }
+
+    if (doom_state->wad.file_count > 0) {
+        DOOM_LOG(wad, info, "Mounted %zu lumps from %zu WADs.\n", doom_state->wad.lump_count,
+                 doom_state->wad.file_count);
+    }
+}
+
+void doom_wad_destroy(doom_wad_state_t* wad) {
+    for (size_t i = 0; i < wad->file_count; i++) {
+        doom_wad_file_t* file = &wad->files[i];
+        if (file->inflated != NULL) {
+            for (size_t lump = 0; lump < file->lump_count; lump++) {
+                nonstd_free(atomic_load(&file->inflated[lump]));
+            }
+            nonstd_free(file->inflated);
+        }
+        doom_sys_unmap_file(&file->mapped);
+        nonstd_free(file->path);
+    }
+    nonstd_free(wad->files);
+    nonstd_free(wad->lumps);
+    nonstd_free(wad->hash);
+    *wad = (doom_wad_state_t){0};
+}
+
+bool doom_wad_mount(const char* path) {
+    doom_sys_mapped_file_t mapped;
+    if (!doom_sys_map_file(&mapped, path)) {
+        DOOM_LOG(wad, warn, "Could not open %s.\n", path);
+        return false;
+    }
+
+    // A zip archive starts with a local header, or with the end of central directory if it's empty.
+    bool zip = mapped.size >= 4 && (memcmp(mapped.data, "PK\3\4", 4) == 0 || memcmp(mapped.data, "PK\5\6", 4) == 0);
+    bool mounted = zip ? s_mount_zip(&mapped, path) : s_mount_wad(&mapped, path);
+    if (!mounted) {
+        doom_sys_unmap_file(&mapped);
+    }
+    return mounted;
+}
+
+int32_t doom_wad_find(const char* name) {
+    const doom_wad_state_t* wad = &doom_state->wad;
+    if (wad->hash_capacity == 0) {
+        return -1;
+    }
+    uint64_t key = doom_wad_name_key(name);
+    for (size_t slot = s_hash_slot(key, wad->hash_capacity);; slot = (slot + 1) & (wad->hash_capacity - 1)) {
+        uint32_t lump = wad->hash[slot];
+        if (lump == sc_empty_slot) {
+            return -1;
+        }
+        if (wad->lumps[lump].key == key) {
+            return (int32_t)lump;
+        }
+    }
+}
+
+int32_t doom_wad_find_required(const char* name) {
+    int32_t lump = doom_wad_find(name);
+    if (lump < 0) {
+        doom_log_error("Lump %.8s not found", name);
+    }
+    return lump;
+}
+
+int32_t doom_wad_find_flat(const char* name) {
+    const doom_wad_state_t* wad = &doom_state->wad;
+    int32_t last = doom_wad_find(name);
+    if (last < 0 || wad->lumps[last].flat) {
+        return last;
+    }
+    // Something else took the name later; the flat, if there is one, comes before it.
+    uint64_t key = wad->lumps[last].key;
+    for (int32_t lump = last - 1; lump >= 0; lump--) {
+        if (wad->lumps[lump].flat && wad->lumps[lump].key == key) {
+            return lump;
+        }
+    }
+    return -1;
+}
+
+size_t doom_wad_lump_count(void) {
+    return doom_state->wad.lump_count;
+}
+
+doom_wad_lump_data_t doom_wad_lump_data(int32_t lump) {
+    const doom_wad_state_t* wad = &doom_state->wad;
+    const doom_wad_lump_t* l = &wad->lumps[lump];
+    const doom_wad_file_t* file = &wad->files[l->file];
+    if (file->format == doom_wad_format_zip) {
+        return s_zip_lump_data(file, l->entry, (uint32_t)lump - file->first_lump);
+    }
+    const uint8_t* file_data = file->mapped.data;
+    uint32_t size = s_read_le32(l->entry + 4);
+    const uint8_t* begin = size > 0 ? file_data + s_read_le32(l->entry) : file_data;
+    doom_wad_lump_data_t data = PHYTO_SPAN_NEW(begin, begin + size);
+    return data;
+}
+
+void doom_wad_lump_name(int32_t lump, char name[doom_wad_lump_name_length + 1]) {
+    const doom_wad_lump_t* l = &doom_state->wad.lumps[lump];
+    if (doom_state->wad.files[l->file].format == doom_wad_format_zip) {
+        s_zip_lump_name(l->entry, name);
+        return;
+    }
+    memcpy(name, l->entry + 8, doom_wad_lump_name_length);
+    name[doom_wad_lump_name_length] = '\0';
+}
+
+uint64_t doom_wad_name_key(const char* name) {
+    uint8_t bytes[doom_wad_lump_name_length] = {0};
+    for (size_t i = 0; i < doom_wad_lump_name_length && name[i] != '\0'; i++) {
+        bytes[i] = (uint8_t)nonstd_toupper(name[i]);
+    }
+    uint64_t key;
+    memcpy(&key, bytes, sizeof(key));
+    return key;
+}
+
+uint16_t s_read_le16(const uint8_t* bytes) {
+    return (uint16_t)(bytes[0] | bytes[1] << 8);
+}
+
+uint32_t s_read_le32(const uint8_t* bytes) {
+    return (uint32_t)bytes[0] | (uint32_t)bytes[1] << 8 | (uint32_t)bytes[2] << 16 | (uint32_t)bytes[3] << 24;
+}
+
+size_t s_hash_slot(uint64_t key, size_t capacity) {
+    // Fibonacci hashing; the multiplication mixes every byte of the name into the upper half.
+    return (size_t)((key * UINT64_C(0x9E3779B97F4A7C15)) >> 32) & (capacity - 1);
+}
+
+void s_hash_insert(doom_wad_state_t* wad, uint32_t lump) {
+    uint64_t key = wad->lumps[lump].key;
+    for (size_t slot = s_hash_slot(key, wad->hash_capacity);; slot = (slot + 1) & (wad->hash_capacity - 1)) {
+        uint32_t existing = wad->hash[slot];
+        // Lumps are inserted in mount order, so replacing a match makes the last one win.
+        if (existing == sc_empty_slot || wad->lumps[existing].key == key) {
+            wad->hash[slot] = lump;
+            return;
+        }
+    }
+}
+
+void s_hash_reserve(doom_wad_state_t* wad, size_t lump_count) {
+    // At most half full, so probe sequences stay short.
+    if (lump_count * 2 <= wad->hash_capacity) {
+        return;
+    }
+    size_t capacity = wad->hash_capacity == 0 ? min_hash_capacity : wad->hash_capacity;
+    while (lump_count * 2 > capacity) {
+        capacity *= 2;
+    }
+    nonstd_free(wad->hash);
+    wad->hash = nonstd_malloc(capacity * sizeof(uint32_t), nonstd_alloc_tag_wad);
+    memset(wad->hash, 0xFF, capacity * sizeof(uint32_t));
+    wad->hash_capacity = capacity;
+    for (uint32_t lump = 0; lump < wad->lump_count; lump++) {
+        s_hash_insert(wad, lump);
+    }
+}
+
+bool s_mount_wad(const doom_sys_mapped_file_t* mapped, const char* path) {
+    const doom_wad_state_t* wad = &doom_state->wad;
+    const uint8_t* data = mapped->data;
+    if (mapped->size < doom_wad_header_size || (memcmp(data, "IWAD", 4) != 0 && memcmp(data, "PWAD", 4) != 0)) {
+        DOOM_LOG(wad, warn, "%s is not a WAD.\n", path);
+        return false;
+    }
+    uint32_t lump_count = s_read_le32(data + 4);
+    uint32_t directory_offset = s_read_le32(data + 8);
+    if (directory_offset > mapped->size || lump_count > (mapped->size - directory_offset) / doom_wad_entry_size ||
+        wad->lump_count + lump_count > INT32_MAX) {
+        DOOM_LOG(wad, warn, "%s has a bad directory.\n", path);
+        return false;
+    }
+    const uint8_t* directory = data + directory_offset;
+    for (uint32_t i = 0; i < lump_count; i++) {
+        const uint8_t* entry = directory + (size_t)i * doom_wad_entry_size;
+        uint32_t offset = s_read_le32(entry);
+        uint32_t size = s_read_le32(entry + 4);
+        if (size > 0 && (offset > mapped->size || size > mapped->size - offset)) {
+            DOOM_LOG(wad, warn, "Lump %u of %s is out of bounds.\n", i, path);
+            return false;
+        }
+    }
+
+    uint32_t file = s_add_file(mapped, path, doom_wad_format_wad, lump_count);
+    doom_state->wad.files[file].iwad = data[0] == 'I';
+    uint64_t flats_start = doom_wad_name_key("F_START");
+    uint64_t flats_end = doom_wad_name_key("F_END");
+    uint64_t pwad_flats_start = doom_wad_name_key("FF_START");
+    uint64_t pwad_flats_end = doom_wad_name_key("FF_END");
+    bool in_flats = false;
+    for (uint32_t i = 0; i < lump_count; i++) {
+        const uint8_t* entry = directory + (size_t)i * doom_wad_entry_size;
+        uint64_t key = doom_wad_name_key((const char*)entry + 8);
+        // The markers themselves are outside, and a namespace ends with its WAD even if the end marker is missing.
+        if (key == flats_start || key == pwad_flats_start) {
+            in_flats = true;
+        } else if (key == flats_end || key == pwad_flats_end) {
+            in_flats = false;
+        }
+        s_add_lump(file, key, entry, in_flats && key != flats_start && key != pwad_flats_start);
+    }
+
+    DOOM_LOG(wad, debug, "Mounted %s (%s, %u lumps).\n", path, data[0] == 'I' ? "IWAD" : "PWAD", lump_count);
+    return true;
+}
+
+bool s_mount_zip(const doom_sys_mapped_file_t* mapped, const char* path) {
+    const uint8_t* data = mapped->data;
+    size_t size = mapped->size;
+
+    // The end of central directory is the last record, but a comment may follow it.
+    const uint8_t* end = NULL;
+    for (size_t offset = size >= zip_end_size ? size - zip_end_size + 1 : 0;
+         offset > 0 && size - (offset - 1) <= zip_end_size + zip_max_comment_size; offset--) {
+        if (s_read_le32(data + offset - 1) == sc_zip_end_signature) {
+            end = data + offset - 1;
+            break;
+        }
+    }
+    if (end == NULL) {
+        DOOM_LOG(wad, warn, "%s is not a zip archive.\n", path);
+        return false;
+    }
+    uint16_t entry_count = s_read_le16(end + 10);
+    uint32_t directory_size = s_read_le32(end + 12);
+    uint32_t directory_offset = s_read_le32(end + 16);
+    if (entry_count == UINT16_MAX || directory_offset == UINT32_MAX) {
+        DOOM_LOG(wad, warn, "%s is a ZIP64 archive, which isn't supported.\n", path);
+        return false;
+    }
+    if (directory_offset > size || directory_size > size - directory_offset) {
+        DOOM_LOG(wad, warn, "%s has a bad central directory.\n", path);
+        return false;
+    }
+
+    // Check every header before adding any, so a damaged archive adds nothing.
+    const uint8_t* directory = data + directory_offset;
+    size_t offset = 0;
+    for (uint16_t i = 0; i < entry_count; i++) {
+        const uint8_t* header = directory + offset;
+        if (directory_size - offset < zip_central_header_size || s_read_le32(header) != sc_zip_central_signature) {
+            DOOM_LOG(wad, warn, "%s has a bad central directory.\n", path);
+            return false;
+        }
+        size_t header_size = (size_t)zip_central_header_size + s_read_le16(header + 28) + s_read_le16(header + 30) +
+                             s_read_le16(header + 32);
+        if (directory_size - offset < header_size) {
+            DOOM_LOG(wad, warn, "%s has a bad central directory.\n", path);
+            return false;
+        }
+        offset += header_size;
+    }
+    if (doom_state->wad.lump_count + entry_count > INT32_MAX) {
+        DOOM_LOG(wad, warn, "%s has too many files.\n", path);
+        return false;
+    }
+
+    uint32_t file = s_add_file(mapped, path, doom_wad_format_zip, entry_count);
+    doom_state->wad.files[file].inflated =
+        nonstd_calloc(entry_count + 1, sizeof(_Atomic(uint8_t*)), nonstd_alloc_tag_wad);
+    size_t compressed = 0;
+    offset = 0;
+    for (uint16_t i = 0; i < entry_count; i++) {
+        const uint8_t* header = directory + offset;
+        offset += (size_t)zip_central_header_size + s_read_le16(header + 28) + s_read_le16(header + 30) +
+                  s_read_le16(header + 32);
+
+        uint16_t flags = s_read_le16(header + 8);
+        uint16_t method = s_read_le16(header + 10);
+        char name[doom_wad_lump_name_length + 1];
+        if (!s_zip_lump_name(header, name)) {
+            // Directories.
+            continue;
+        }
+        if ((flags & zip_flag_encrypted) != 0 || (method != zip_method_stored && method != zip_method_deflated) ||
+            (method == zip_method_stored && s_read_le32(header + 20) != s_read_le32(header + 24))) {
+            DOOM_LOG(wad, warn, "Skipping %.*s in %s: unsupported compression or encryption.\n",
+                     (int)s_read_le16(header + 28), (const char*)header + zip_central_header_size, path);
+            continue;
+        }
+        // The inflated size decides what is allocated, so it can't be taken on trust.
+        uint64_t compressed_size = s_read_le32(header + 20);
+        uint32_t uncompressed_size = s_read_le32(header + 24);
+        bool too_large = uncompressed_size > zip_max_inflated_size ||
+                         uncompressed_size > compressed_size * zip_max_inflate_ratio;
+        if (method == zip_method_deflated && too_large) {
+            DOOM_LOG(wad, warn, "Skipping %.*s in %s: it claims to inflate to %u bytes.\n",
+                     (int)s_read_le16(header + 28), (const char*)header + zip_central_header_size, path,
+                     uncompressed_size);
+            continue;
+        }
+        compressed += method == zip_method_deflated;
+        s_add_lump(file, doom_wad_name_key(name), header, s_zip_in_flats(header));
+    }
+
+    DOOM_LOG(wad, debug, "Mounted %s (zip, %u lumps, %zu compressed).\n", path,
+             doom_state->wad.files[file].lump_count, compressed);
+    return true;
+}
+
+uint32_t s_add_file(const doom_sys_mapped_file_t* mapped, const char* path, doom_wad_format_t format,
+                    size_t lump_count) {
+    doom_wad_state_t* wad = &doom_state->wad;
+    if (wad->file_count == wad->file_capacity) {
+        wad->file_capacity = wad->file_capacity == 0 ? 4 : wad->file_capacity * 2;
+        wad->files = nonstd_realloc(wad->files, wad->file_capacity * sizeof(doom_wad_file_t), nonstd_alloc_tag_wad);
+    }
+    if (wad->lump_count + lump_count > wad->lump_capacity) {
+        size_t capacity = wad->lump_capacity == 0 ? 1024 : wad->lump_capacity;
+        while (capacity < wad->lump_count + lump_count) {
+            capacity *= 2;
+        }
+        wad->lumps = nonstd_realloc(wad->lumps, capacity * sizeof(doom_wad_lump_t), nonstd_alloc_tag_wad);
+        wad->lump_capacity = capacity;
+    }
+    s_hash_reserve(wad, wad->lump_count + lump_count);
+
+    uint32_t file = (uint32_t)wad->file_count++;
+    wad->files[file] = (doom_wad_file_t){
+        .mapped = *mapped,
+        .path = nonstd_strdup(path),
+        .format = format,
+        .first_lump = (uint32_t)wad->lump_count,
+    };
+    return file;
+}
+
+void s_add_lump(uint32_t file, uint64_t key, const uint8_t* entry, bool flat) {
+    doom_wad_state_t* wad = &doom_state->wad;
+    uint32_t lump = (uint32_t)wad->lump_count++;
+    wad->lumps[lump] = (doom_wad_lump_t){
+        .key = key,
+        .entry = entry,
+        .file = file,
+        .flat = flat,
+    };
+    wad->files[file].lump_count++;
+    s_hash_insert(wad, lump);
+}
+
+bool s_zip_lump_name(const uint8_t* header, char name[doom_wad_lump_name_length + 1]) {
+    const char* path = (const char*)header + zip_central_header_size;
+    size_t path_length = s_read_le16(header + 28);
+    size_t start = 0;
+    size_t stop = path_length;
+    for (size_t i = 0; i < path_length; i++) {
+        if (path[i] == '/' || path[i] == '\\') {
+            start = i + 1;
+            stop = path_length;
+        } else if (path[i] == '.' && i > start) {
+            stop = i;
+        }
+    }
+    if (stop <= start) {
+        return false;
+    }
+    size_t length = stop - start < doom_wad_lump_name_length ? stop - start : doom_wad_lump_name_length;
+    memset(name, 0, doom_wad_lump_name_length + 1);
+    for (size_t i = 0; i < length; i++) {
+        name[i] = (char)nonstd_toupper(path[start + i]);
+    }
+    return true;
+}
+
+bool s_zip_in_flats(const uint8_t* header) {
+    static const char sc_flats_directory[] = "flats/";
+    const char* path = (const char*)header + zip_central_header_size;
+    size_t length = sizeof(sc_flats_directory) - 1;
+    if (s_read_le16(header + 28) <= length) {
+        return false;
+    }
+    for (size_t i = 0; i < length; i++) {
+        char c = path[i] == '\\' ? '/' : (char)nonstd_tolower(path[i]);
+        if (c != sc_flats_directory[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+doom_wad_lump_data_t s_zip_lump_data(const doom_wad_file_t* file, const uint8_t* header, uint32_t index) {
+    const uint8_t* data = file->mapped.data;
+    size_t size = file->mapped.size;
+    doom_wad_lump_data_t empty = PHYTO_SPAN_EMPTY;
+
+    // The data follows the local header, whose variable fields may differ from the central directory's.
+    uint32_t local = s_read_le32(header + 42);
+    uint32_t compressed_size = s_read_le32(header + 20);
+    uint32_t uncompressed_size = s_read_le32(header + 24);
+    if (local > size || size - local < zip_local_header_size || s_read_le32(data + local) != sc_zip_local_signature) {
+        DOOM_LOG(wad, warn, "Entry %u of %s has a bad local header.\n", index, file->path);
+        return empty;
+    }
+    size_t start = (size_t)local + zip_local_header_size + s_read_le16(data + local + 26) +
+                   s_read_le16(data + local + 28);
+    if (start > size || compressed_size > size - start) {
+        DOOM_LOG(wad, warn, "Entry %u of %s is out of bounds.\n", index, file->path);
+        return empty;
+    }
+
+    if (s_read_le16(header + 10) == zip_method_stored) {
+        doom_wad_lump_data_t stored = PHYTO_SPAN_NEW(data + start, data + start + compressed_size);
+        return stored;
+    }
+
+    uint8_t* inflated = atomic_load_explicit(&file->inflated[index], memory_order_acquire);
+    if (inflated == NULL) {
+        uint8_t* buffer = nonstd_malloc(uncompressed_size > 0 ? uncompressed_size : 1, nonstd_alloc_tag_wad);
+        if (!doom_sys_inflate(data + start, compressed_size, buffer, uncompressed_size)) {
+            DOOM_LOG(wad, warn, "Entry %u of %s does not inflate.\n", index, file->path);
+            nonstd_free(buffer);
+            return empty;
+        }
+        // Two threads may inflate the same lump; the first to publish its copy wins.
+        inflated = NULL;
+        if (atomic_compare_exchange_strong_explicit(&file->inflated[index], &inflated, buffer, memory_order_acq_rel,
+                                                    memory_order_acquire)) {
+            inflated = buffer;
+        } else {
+            nonstd_free(buffer);
+        }
+    }
+    doom_wad_lump_data_t result = PHYTO_SPAN_NEW(inflated, inflated + uncompressed_size);
+    return result;
+}
@@ -0,0 +1,51 @@
+#ifndef NONSTD_ALLOC_H_
+#define NONSTD_ALLOC_H_
+
+#include <stddef.h>
+
+// Allocation tags, one per subsystem. Every allocation made through nonstd_malloc() and friends is counted against
+// its tag.
+#define NONSTD_ALLOC_TAGS_X                                                                                            \
+    X(general)                                                                                                         \
+    X(collections)                                                                                                     \
+    X(string)                                                                                                          \
+    X(strdup)                                                                                                          \
+    X(state)                                                                                                           \
+    X(atexit)                                                                                                          \
+    X(params)                                                                                                          \
+    X(config)                                                                                                          \
+    X(log)                                                                                                             \
+    X(bench)                                                                                                           \
+    X(wad)                                                                                                             \
+    X(resource)                                                                                                        \
+    X(deh)                                                                                                             \
+    X(render)                                                                                                          \
+    X(video)                                                                                                           \
+    X(count)
+
+typedef enum
+{
+#define X(x) nonstd_alloc_tag_##x,
+    NONSTD_ALLOC_TAGS_X
+#undef X
+} nonstd_alloc_tag_t;
+
+typedef struct {
+    size_t live_bytes;
+    size_t peak_bytes;
+    size_t allocations;
+    size_t reallocations;
+    size_t frees;
+} nonstd_alloc_stats_t;
+
+// These behave like their standard counterparts, but memory from them must be released with nonstd_free().
+void* nonstd_malloc(size_t size, nonstd_alloc_tag_t tag);
+void* nonstd_calloc(size_t count, size_t size, nonstd_alloc_tag_t tag);
+// A NULL `ptr` allocates with `tag`; otherwise the block keeps the tag it was allocated with. A zero `size` frees.
+void* nonstd_realloc(void* ptr, size_t size, nonstd_alloc_tag_t tag);
+void nonstd_free(void* ptr);
+
+void nonstd_alloc_get_stats(nonstd_alloc_tag_t tag, nonstd_alloc_stats_t* out_stats);
+const char* nonstd_alloc_tag_name(nonstd_alloc_tag_t tag);
+
+#endif // NONSTD_ALLOC_H_
@@ -0,0 +1,134 @@
+#include "nonstd/alloc.h"
+
+#include <assert.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define HEADER_MAGIC 0xA110C8EDU
+
+// Prepended to every block. Its alignment keeps the returned pointer as aligned as malloc's.
+typedef struct {
+    alignas(max_align_t) size_t size;
+    uint32_t tag;
+    uint32_t magic;
+} header_t;
+
+// One cache line per tag, so threads working in different subsystems don't contend.
+typedef struct {
+    alignas(64) atomic_size_t live_bytes;
+    atomic_size_t peak_bytes;
+    atomic_size_t allocations;
+    atomic_size_t reallocations;
+    atomic_size_t frees;
+} counters_t;
+
+static counters_t counters[nonstd_alloc_tag_count];
+
+static const char* const tag_names[] = {
+#define X(x) #x,
+    NONSTD_ALLOC_TAGS_X
+#undef X
+};
+
+static void add_live(counters_t* c, size_t size) {
+    size_t live = atomic_fetch_add_explicit(&c->live_bytes, size, memory_order_relaxed) + size;
+    size_t peak = atomic_load_explicit(&c->peak_bytes, memory_order_relaxed);
+    while (live > peak &&
+           !atomic_compare_exchange_weak_explicit(&c->peak_bytes, &peak, live, memory_order_relaxed,
+                                                  memory_order_relaxed)) {
+    }
+}
+
+static header_t* header_of(void* ptr) {
+    header_t* header = (header_t*)ptr - 1;
+    assert(header->magic == HEADER_MAGIC && "pointer was not allocated by nonstd_malloc");
+    return header;
+}
+
+void* nonstd_malloc(size_t size, nonstd_alloc_tag_t tag) {
+    if (size > SIZE_MAX - sizeof(header_t)) {
+        return NULL;
+    }
+    header_t* header = malloc(sizeof(header_t) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size = size;
+    header->tag = (uint32_t)tag;
+    header->magic = HEADER_MAGIC;
+
+    counters_t* c = &counters[tag];
+    atomic_fetch_add_explicit(&c->allocations, 1, memory_order_relaxed);
+    add_live(c, size);
+    return header + 1;
+}
+
+void* nonstd_calloc(size_t count, size_t size, nonstd_alloc_tag_t tag) {
+    if (size != 0 && count > SIZE_MAX / size) {
+        return NULL;
+    }
+    void* result = nonstd_malloc(count * size, tag);
+    if (result != NULL) {
+        memset(result, 0, count * size);
+    }
+    return result;
+}
+
+void* nonstd_realloc(void* ptr, size_t size, nonstd_alloc_tag_t tag) {
+    if (ptr == NULL) {
+        return nonstd_malloc(size, tag);
+    }
+    if (size == 0) {
+        nonstd_free(ptr);
+        return NULL;
+    }
+    if (size > SIZE_MAX - sizeof(header_t)) {
+        return NULL;
+    }
+
+    header_t* header = header_of(ptr);
+    size_t old_size = header->size;
+    header = realloc(header, sizeof(header_t) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+    header->size = size;
+
+    counters_t* c = &counters[header->tag];
+    atomic_fetch_add_explicit(&c->reallocations, 1, memory_order_relaxed);
+    if (size > old_size) {
+        add_live(c, size - old_size);
+    } else {
+        atomic_fetch_sub_explicit(&c->live_bytes, old_size - size, memory_order_relaxed);
+    }
+    return header + 1;
+}
+
+void nonstd_free(void* ptr) {
+    if (ptr == NULL) {
+        return;
+    }
+    header_t* header = header_of(ptr);
+    counters_t* c = &counters[header->tag];
+    atomic_fetch_add_explicit(&c->frees, 1, memory_order_relaxed);
+    atomic_fetch_sub_explicit(&c->live_bytes, header->size, memory_order_relaxed);
+    header->magic = 0;
+    free(header);
+}
+
+void nonstd_alloc_get_stats(nonstd_alloc_tag_t tag, nonstd_alloc_stats_t* out_stats) {
+    const counters_t* c = &counters[tag];
+    out_stats->live_bytes = atomic_load_explicit(&c->live_bytes, memory_order_relaxed);
+    out_stats->peak_bytes = atomic_load_explicit(&c->peak_bytes, memory_order_relaxed);
+    out_stats->allocations = atomic_load_explicit(&c->allocations, memory_order_relaxed);
+    out_stats->reallocations = atomic_load_explicit(&c->reallocations, memory_order_relaxed);
+    out_stats->frees = atomic_load_explicit(&c->frees, memory_order_relaxed);
+}
+
+const char* nonstd_alloc_tag_name(nonstd_alloc_tag_t tag) {
+    return tag_names[tag];
+}
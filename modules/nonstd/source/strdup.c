@@ -1,18 +1,19 @@
 #include "nonstd/strdup.h"
 
-#include <stdlib.h>
+#include "nonstd/alloc.h"
+
 #include <string.h>
 
 char* nonstd_strdup(const char* str) {
     size_t len = strlen(str);
-    char* result = malloc(len + 1);
+    char* result = nonstd_malloc(len + 1, nonstd_alloc_tag_strdup);
     memcpy(result, str, len);
     result[len] = '\0';
     return result;
 }
 
 char* nonstd_strndup(const char* str, size_t n) {
-    char* result = malloc(n + 1);
+    char* result = nonstd_malloc(n + 1, nonstd_alloc_tag_strdup);
     if (n > 0) {
         memcpy(result, str, n);
     }
@@ -24,7 +25,7 @@ void* nonstd_memdup(const void* mem, size_t nbytes) {
     if (nbytes == 0) {
         return NULL;
     }
-    void* result = malloc(nbytes);
+    void* result = nonstd_malloc(nbytes, nonstd_alloc_tag_strdup);
     memcpy(result, mem, nbytes);
     return result;
 }
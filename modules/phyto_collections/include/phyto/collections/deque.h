@@ -3,6 +3,7 @@
 
 #include "phyto/collections/callbacks.h"
 
+#include <nonstd/alloc.h>
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
@@ -68,7 +69,10 @@ typedef enum
     void Name##_string(Name##_t deque, void (*string_cb)(char* data, size_t size, void* context), void* context);      \
     void Name##_print(Name##_t deque, FILE* stream, const char* sep);
 
-#define PHYTO_COLLECTIONS_DEQUE_IMPL(Name, V)                                                                          \
+#define PHYTO_COLLECTIONS_DEQUE_IMPL(Name, V) PHYTO_COLLECTIONS_DEQUE_IMPL_TAGGED(Name, V, nonstd_alloc_tag_collections)
+
+// Like PHYTO_COLLECTIONS_DEQUE_IMPL, but counts the deque's memory against the given nonstd_alloc_tag_t.
+#define PHYTO_COLLECTIONS_DEQUE_IMPL_TAGGED(Name, V, Tag)                                                              \
     Name##_t Name##_new(size_t capacity, const Name##_callbacks_t* callbacks) {                                        \
         if (capacity < 1) {                                                                                            \
             return (Name##_t){.error_flag = phyto_deque_error_flag_invalid};                                           \
@@ -77,7 +81,7 @@ typedef enum
             return (Name##_t){.error_flag = phyto_deque_error_flag_invalid};                                           \
         }                                                                                                              \
         Name##_t deque;                                                                                                \
-        deque.data = calloc(capacity, sizeof(V));                                                                      \
+        deque.data = nonstd_calloc(capacity, sizeof(V), Tag);                                                          \
         if (!deque.data) {                                                                                             \
             deque.error_flag = phyto_deque_error_flag_alloc;                                                           \
             return deque;                                                                                              \
@@ -109,7 +113,7 @@ typedef enum
                 i = (i + 1) % deque->capacity;                                                                         \
             }                                                                                                          \
         }                                                                                                              \
-        free(deque->data);                                                                                             \
+        nonstd_free(deque->data);                                                                                      \
         deque->data = NULL;                                                                                            \
         deque->capacity = 0;                                                                                           \
         deque->count = 0;                                                                                              \
@@ -210,7 +214,7 @@ typedef enum
         if (capacity < deque->count) {                                                                                 \
             return true;                                                                                               \
         }                                                                                                              \
-        V* new_data = malloc(sizeof(V) * capacity);                                                                    \
+        V* new_data = nonstd_malloc(sizeof(V) * capacity, Tag);                                                        \
         if (new_data == NULL) {                                                                                        \
             deque->error_flag = phyto_deque_error_flag_alloc;                                                          \
             return false;                                                                                              \
@@ -219,7 +223,7 @@ typedef enum
             new_data[j] = deque->data[i];                                                                              \
             i = (i + 1) % deque->capacity;                                                                             \
         }                                                                                                              \
-        free(deque->data);                                                                                             \
+        nonstd_free(deque->data);                                                                                      \
         deque->data = new_data;                                                                                        \
         deque->capacity = capacity;                                                                                    \
         deque->front = 0;                                                                                              \
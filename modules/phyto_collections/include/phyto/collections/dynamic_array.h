@@ -3,6 +3,7 @@
 
 #include "phyto/collections/callbacks.h"
 
+#include <nonstd/alloc.h>
 #include <nonstd/qsort.h>
 #include <phyto/span/span.h>
 #include <stdbool.h>
@@ -67,6 +68,10 @@
     Name##_span_t Name##_as_span(Name##_t self);
 
 #define PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL(Name, DataType)                                                           \
+    PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL_TAGGED(Name, DataType, nonstd_alloc_tag_collections)
+
+// Like PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL, but counts the array's memory against the given nonstd_alloc_tag_t.
+#define PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL_TAGGED(Name, DataType, Tag)                                               \
     const char* Name##_explain_error(Name##_error_flag_t error_flag) {                                                 \
         switch (error_flag) {                                                                                          \
         case Name##_error_flag_ok:                                                                                     \
@@ -125,7 +130,7 @@
                 self->callbacks->free_cb(&self->data[i]);                                                              \
             }                                                                                                          \
         }                                                                                                              \
-        free(self->data);                                                                                              \
+        nonstd_free(self->data);                                                                                       \
         self->data = NULL;                                                                                             \
         self->size = 0;                                                                                                \
         self->capacity = 0;                                                                                            \
@@ -140,7 +145,7 @@
         while (new_capacity > self->capacity) {                                                                        \
             self->capacity = self->capacity * 2 + 1;                                                                   \
         }                                                                                                              \
-        DataType* new_data = realloc(self->data, self->capacity * sizeof(DataType));                                   \
+        DataType* new_data = nonstd_realloc(self->data, self->capacity * sizeof(DataType), Tag);                       \
         if (!new_data) {                                                                                               \
             self->error_flag = Name##_error_flag_out_of_memory;                                                        \
             return false;                                                                                              \
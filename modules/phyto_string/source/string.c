@@ -2,7 +2,7 @@
 
 #include <stdio.h>
 
-PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL(phyto_string, char);
+PHYTO_COLLECTIONS_DYNAMIC_ARRAY_IMPL_TAGGED(phyto_string, char, nonstd_alloc_tag_string);
 
 int32_t charcmp(char a, char b) {
     return (a > b) - (a < b);